@@ -2,11 +2,73 @@
 
 #include "runtime/core/ados_core.h"
 
+#include <set>
+
+#include "utils/common/trace_event_tool.h"
+
 namespace nxpilot::runtime::core {
 
-AdosCore::AdosCore() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {
+namespace {
+
+constexpr std::string_view kStateNameArray[] = {
+    "PreInit", "PreInitConfigurator", "PostInitConfigurator", "PreInitPlugin", "PostInitPlugin",
+    "PreInitExecutor", "PostInitExecutor", "PreInitLog", "PostInitLog", "PreInitAllocator",
+    "PostInitAllocator", "PreInitRpc", "PostInitRpc", "PreInitChannel", "PostInitChannel",
+    "PreInitParameter", "PostInitParameter", "PreInitModules", "PostInitModules", "PostInit",
+    "PreStart", "PreStartConfigurator", "PostStartConfigurator", "PreStartPlugin",
+    "PostStartPlugin", "PreStartExecutor", "PostStartExecutor", "PreStartLog", "PostStartLog",
+    "PreStartAllocator", "PostStartAllocator", "PreStartRpc", "PostStartRpc", "PreStartChannel",
+    "PostStartChannel", "PreStartParameter", "PostStartParameter", "PreStartModules",
+    "PostStartModules", "PostStart", "PreShutdown", "PreShutdownModules", "PostShutdownModules",
+    "PreShutdownParameter", "PostShutdownParameter", "PreShutdownChannel", "PostShutdownChannel",
+    "PreShutdownRpc", "PostShutdownRpc", "PreShutdownAllocator", "PostShutdownAllocator",
+    "PreShutdownLog", "PostShutdownLog", "PreShutdownExecutor", "PostShutdownExecutor",
+    "PreShutdownPlugin", "PostShutdownPlugin", "PreShutdownConfigurator",
+    "PostShutdownConfigurator", "PostShutdown"};
+constexpr size_t kStateNum = static_cast<size_t>(AdosCore::State::kMaxStateNum);
+static_assert(sizeof(kStateNameArray) / sizeof(kStateNameArray[0]) == kStateNum,
+              "kStateNameArray does not match AdosCore::State");
+
+uint32_t GetCoreLogLevel(YAML::Node log_options_node) {
+  if (log_options_node.IsMap() && log_options_node["core_lvl"]) {
+    return nxpilot::utils::common::GetLogLevelFromName(
+        log_options_node["core_lvl"].as<std::string>());
+  }
+  return nxpilot::utils::common::kLogLevelTrace;
+}
+
+uint64_t GetCurrentTid() {
+  thread_local uint64_t tid(syscall(SYS_gettid));
+  return tid;
+}
+
+}  // namespace
+
+std::string_view AdosCore::GetStateName(State state) {
+  auto idx = static_cast<size_t>(state);
+  return idx < kStateNum ? kStateNameArray[idx] : "Unknown";
+}
+
+AdosCore::AdosCore()
+    : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()),
+      construct_time_point_(std::chrono::steady_clock::now()) {
+  logger_ptr_->get_log_level_func = [this]() {
+    return core_log_lvl_.load(std::memory_order_relaxed);
+  };
   NXPILOT_INFO("AdosCore constuctor");
-  hook_task_vec_array_.resize(static_cast<uint32_t>(State::kMaxStateNum));
+  hook_task_vec_array_.resize(kStateNum);
+  state_enter_time_point_vec_.resize(kStateNum);
+
+  // 'PostInitRpc' closes the stage opened by 'PreInitRpc', and so on.
+  pre_state_idx_vec_.resize(kStateNum, -1);
+  for (size_t ii = 0; ii < kStateNum; ++ii) {
+    std::string_view name = kStateNameArray[ii];
+    if (!name.starts_with("Post")) continue;
+    std::string pre_name = "Pre" + std::string(name.substr(4));
+    for (size_t jj = 0; jj < kStateNum; ++jj) {
+      if (kStateNameArray[jj] == pre_name) pre_state_idx_vec_[ii] = static_cast<int32_t>(jj);
+    }
+  }
 }
 
 AdosCore::~AdosCore() {
@@ -23,17 +85,108 @@ void AdosCore::Initialize(const Options& options) {
 
   options_ = options;
 
-  // Init configurator
-  EnterState(State::kPreInitConfigurator);
-  configurator_manager_.SetLogger(logger_ptr_);
-  configurator_manager_.Initialize(options_.cfg_file_path);
-  EnterState(State::kPostInitConfigurator);
+  // Managers are initialized as a dependency graph, independent ones run in parallel.
+  nxpilot::utils::common::DependencyGraph init_graph;
+
+  init_graph.AddNode("configurator", [this]() {
+    EnterState(State::kPreInitConfigurator);
+    configurator_manager_.SetLogger(logger_ptr_);
+    configurator_manager_.Initialize(
+        options_.cfg_file_path,
+        std::vector<std::filesystem::path>(options_.cfg_overlay_paths.begin(),
+                                           options_.cfg_overlay_paths.end()),
+        options_.cfg_snapshot_path);
+    UpdateCoreLogLevel(configurator_manager_.GetNodeOptionsByKey("log"));
+    EnterState(State::kPostInitConfigurator);
+  });
+
+  init_graph.AddNode(
+      "plugin",
+      [this]() {
+        EnterState(State::kPreInitPlugin);
+        plugin_manager_.SetLogger(logger_ptr_);
+        plugin_manager_.SetCorePtr(this);
+        plugin_manager_.Initialize(configurator_manager_.GetNodeOptionsByKey("plugin"));
+        EnterState(State::kPostInitPlugin);
+      },
+      {"configurator"});
+
+  // MainThreadExecutor takes over the thread it is initialized on, so this stage stays on the
+  // calling thread. Plugins may register executor types, so it also waits for them.
+  init_graph.AddNode(
+      "executor",
+      [this]() {
+        EnterState(State::kPreInitExecutor);
+        executor_manager_.SetLogger(logger_ptr_);
+        executor_manager_.Initialize(configurator_manager_.GetNodeOptionsByKey("executor"));
+        EnterState(State::kPostInitExecutor);
+      },
+      {"plugin"}, true);
+
+  init_graph.AddNode(
+      "rpc",
+      [this]() {
+        EnterState(State::kPreInitRpc);
+        rpc_manager_.SetLogger(logger_ptr_);
+        rpc_manager_.RegisterGetExecutorFunc(
+            [this](std::string_view executor_name)
+                -> nxpilot::runtime::core::executor::ExecutorBase* {
+              return executor_manager_.GetExecutor(executor_name);
+            });
+        rpc_manager_.Initialize(configurator_manager_.GetNodeOptionsByKey("rpc"));
+        EnterState(State::kPostInitRpc);
+      },
+      {"executor"});
+
+  init_graph.AddNode(
+      "channel",
+      [this]() {
+        EnterState(State::kPreInitChannel);
+        channel_manager_.SetLogger(logger_ptr_);
+        channel_manager_.RegisterGetExecutorFunc(
+            [this](std::string_view executor_name)
+                -> nxpilot::runtime::core::executor::ExecutorBase* {
+              return executor_manager_.GetExecutor(executor_name);
+            });
+        channel_manager_.SetTimeSource(&executor_manager_.GetTimeSource());
+        channel_manager_.Initialize(configurator_manager_.GetNodeOptionsByKey("channel"));
+        EnterState(State::kPostInitChannel);
+      },
+      {"executor"});
+
+  init_graph.AddNode(
+      "parameter",
+      [this]() {
+        EnterState(State::kPreInitParameter);
+        parameter_manager_.SetLogger(logger_ptr_);
+        parameter_manager_.Initialize(configurator_manager_.GetNodeOptionsByKey("parameter"));
+        EnterState(State::kPostInitParameter);
+      },
+      {"plugin"});
+
+  init_graph.AddNode(
+      "module",
+      [this]() {
+        EnterState(State::kPreInitModules);
+        module_manager_.SetLogger(logger_ptr_);
+        module_manager_.RegisterGetExecutorFunc(
+            [this](std::string_view executor_name)
+                -> nxpilot::runtime::core::executor::ExecutorBase* {
+              return executor_manager_.GetExecutor(executor_name);
+            });
+        module_manager_.SetRpcManager(&rpc_manager_);
+        module_manager_.SetChannelManager(&channel_manager_);
+        module_manager_.SetParameterManager(&parameter_manager_);
+        module_manager_.SetTimeSource(&executor_manager_.GetTimeSource());
+        module_manager_.Initialize(configurator_manager_.GetNodeOptionsByKey("module"));
+        EnterState(State::kPostInitModules);
+      },
+      {"executor", "rpc", "channel", "parameter"});
+
+  RunStageGraph("init", init_graph);
 
-  // Init Executor
-  EnterState(State::kPreInitExecutor);
-  executor_manager_.SetLogger(logger_ptr_);
-  executor_manager_.Initialize(configurator_manager_.GetNodeOptionsByKey("executor"));
-  EnterState(State::kPostInitExecutor);
+  metrics_exporter_.SetLogger(logger_ptr_);
+  metrics_exporter_.Initialize(configurator_manager_.GetNodeOptionsByKey("metrics"));
 
   EnterState(State::kPostInit);
 }
@@ -53,37 +206,349 @@ void AdosCore::Shutdown() {
   shutdown_promise_.set_value();
 }
 
+void AdosCore::RegisterHookFunc(State state, HookTask&& task, std::string_view name) {
+  auto idx = static_cast<size_t>(state);
+  NXPILOT_CHECK_ERROR(idx < kStateNum, "Invalid state {}", idx);
+
+  std::lock_guard<std::mutex> lck(hook_task_mutex_);
+  auto& hook_task_vec = hook_task_vec_array_[idx];
+  std::string hook_name =
+      name.empty() ? std::format("{}#{}", kStateNameArray[idx], hook_task_vec.size())
+                   : std::string(name);
+  hook_task_vec.emplace_back(
+      HookTaskWrapper{.name = std::move(hook_name), .task = std::move(task)});
+}
+
 void AdosCore::EnterState(State state) {
-  state_ = state;
+  auto begin_time_point = std::chrono::steady_clock::now();
+
+  // Stages of a phase run in parallel and enter their states in any order, keep the furthest one
+  // so 'GetState' never goes backwards.
+  auto cur_state = state_.load();
+  while (cur_state < state && !state_.compare_exchange_weak(cur_state, state)) {
+  }
+
+  const auto idx = static_cast<size_t>(state);
+
+  // Copy out, so that hooks are allowed to register other hooks.
+  std::vector<HookTaskWrapper> hook_task_vec;
+  {
+    std::lock_guard<std::mutex> lck(hook_task_mutex_);
+    hook_task_vec = hook_task_vec_array_[idx];
+    state_enter_time_point_vec_[idx] = begin_time_point;
+  }
+
+  for (const auto& hook : hook_task_vec) {
+    auto hook_begin_time_point = std::chrono::steady_clock::now();
+    hook.task();
+    AddLifecycleRecord(LifecycleRecord{.name = hook.name,
+                                       .category = "hook",
+                                       .tid = GetCurrentTid(),
+                                       .begin_time_point = hook_begin_time_point,
+                                       .end_time_point = std::chrono::steady_clock::now()});
+  }
+
+  auto end_time_point = std::chrono::steady_clock::now();
+  AddLifecycleRecord(LifecycleRecord{.name = std::string(kStateNameArray[idx]),
+                                     .category = "state",
+                                     .tid = GetCurrentTid(),
+                                     .begin_time_point = begin_time_point,
+                                     .end_time_point = end_time_point});
 
-  for (const auto& func : hook_task_vec_array_[static_cast<uint32_t>(state)]) {
-    func();
+  if (int32_t pre_idx = pre_state_idx_vec_[idx]; pre_idx >= 0) {
+    std::chrono::steady_clock::time_point stage_begin_time_point;
+    {
+      std::lock_guard<std::mutex> lck(hook_task_mutex_);
+      stage_begin_time_point = state_enter_time_point_vec_[pre_idx];
+    }
+    AddLifecycleRecord(LifecycleRecord{.name = std::string(kStateNameArray[idx].substr(4)),
+                                       .category = "stage",
+                                       .tid = GetCurrentTid(),
+                                       .begin_time_point = stage_begin_time_point,
+                                       .end_time_point = end_time_point});
   }
 }
 
+void AdosCore::AddLifecycleRecord(LifecycleRecord&& record) {
+  std::lock_guard<std::mutex> lck(lifecycle_record_mutex_);
+  lifecycle_record_vec_.emplace_back(std::move(record));
+}
+
+std::vector<AdosCore::LifecycleRecord> AdosCore::GetLifecycleRecords() const {
+  std::lock_guard<std::mutex> lck(lifecycle_record_mutex_);
+  return lifecycle_record_vec_;
+}
+
+void AdosCore::ExportLifecycleTrace(const std::string& file_path) const {
+  auto to_us = [this](std::chrono::steady_clock::time_point tp) -> uint64_t {
+    return std::chrono::duration_cast<std::chrono::microseconds>(tp - construct_time_point_)
+        .count();
+  };
+
+  std::vector<nxpilot::utils::common::TraceEvent> event_vec;
+  for (const auto& record : GetLifecycleRecords()) {
+    event_vec.emplace_back(nxpilot::utils::common::TraceEvent{
+        .name = record.name,
+        .category = record.category,
+        .ts_us = to_us(record.begin_time_point),
+        .dur_us = to_us(record.end_time_point) - to_us(record.begin_time_point),
+        .tid = record.tid});
+  }
+  nxpilot::utils::common::WriteChromeTraceFile(file_path, event_vec);
+
+  NXPILOT_INFO("AdosCore lifecycle trace exported to '{}', {} events", file_path,
+               event_vec.size());
+}
+
 void AdosCore::StartImpl() {
   EnterState(State::kPreStart);
 
-  EnterState(State::kPreStartConfigurator);
-  configurator_manager_.Start();
-  EnterState(State::kPostStartConfigurator);
+  nxpilot::utils::common::DependencyGraph start_graph;
+
+  start_graph.AddNode("configurator", [this]() {
+    EnterState(State::kPreStartConfigurator);
+    configurator_manager_.Start();
+    EnterState(State::kPostStartConfigurator);
+  });
+
+  start_graph.AddNode(
+      "plugin",
+      [this]() {
+        EnterState(State::kPreStartPlugin);
+        plugin_manager_.Start();
+        EnterState(State::kPostStartPlugin);
+      },
+      {"configurator"});
 
-  EnterState(State::kPreStartExecutor);
-  executor_manager_.Start();
-  EnterState(State::kPostStartExecutor);
+  start_graph.AddNode(
+      "executor",
+      [this]() {
+        EnterState(State::kPreStartExecutor);
+        executor_manager_.Start();
+        EnterState(State::kPostStartExecutor);
+      },
+      {"plugin"});
+
+  start_graph.AddNode(
+      "rpc",
+      [this]() {
+        EnterState(State::kPreStartRpc);
+        rpc_manager_.Start();
+        EnterState(State::kPostStartRpc);
+      },
+      {"executor"});
+
+  start_graph.AddNode(
+      "channel",
+      [this]() {
+        EnterState(State::kPreStartChannel);
+        channel_manager_.Start();
+        EnterState(State::kPostStartChannel);
+      },
+      {"executor"});
+
+  start_graph.AddNode(
+      "parameter",
+      [this]() {
+        EnterState(State::kPreStartParameter);
+        parameter_manager_.Start();
+        EnterState(State::kPostStartParameter);
+      },
+      {"plugin"});
+
+  start_graph.AddNode(
+      "module",
+      [this]() {
+        EnterState(State::kPreStartModules);
+        module_manager_.Start();
+        EnterState(State::kPostStartModules);
+      },
+      {"executor", "rpc", "channel", "parameter"});
+
+  RunStageGraph("start", start_graph);
+
+  if (nxpilot::runtime::core::supervisor::HeartbeatSender::IsSupervised()) {
+    heartbeat_sender_.SetLogger(logger_ptr_);
+    heartbeat_sender_.Start([this](std::string_view executor_name)
+                                -> nxpilot::runtime::core::executor::ExecutorBase* {
+      return executor_manager_.GetExecutor(executor_name);
+    });
+  }
+
+  if (const auto& metrics_options = metrics_exporter_.GetOptions(); metrics_options.enable) {
+    const std::string_view executor_name = metrics_options.executor.empty()
+                                               ? executor_manager_.GetGuardThreadName()
+                                               : std::string_view(metrics_options.executor);
+    auto* executor_ptr = executor_manager_.GetExecutor(executor_name);
+    NXPILOT_CHECK_ERROR(executor_ptr != nullptr, "Invalid metrics executor '{}'", executor_name);
+    metrics_exporter_.Start(executor_ptr);
+  }
+
+  if (options_.cfg_hot_reload) {
+    config_watcher_.SetLogger(logger_ptr_);
+    config_watcher_.Start(configurator_manager_.GetSourceFiles(), std::chrono::milliseconds(200),
+                          [this]() { ReloadConfig(); });
+  }
 
   EnterState(State::kPostStart);
 }
 
+std::vector<std::string> AdosCore::ReloadConfig() {
+  std::lock_guard<std::mutex> lck(cfg_reload_mutex_);
+  NXPILOT_CHECK_ERROR(state_.load() == State::kPostStart && !shutdown_impl_flag_.load(),
+                      "Config can only be reloaded when state is 'PostStart'.");
+
+  const YAML::Node old_root_node = configurator_manager_.GetRootOptionsNode();
+  auto loaded_config = configurator_manager_.Load();
+  const YAML::Node new_root_node = loaded_config.root_options_node;
+
+  const YAML::Node old_nxpilot_node = old_root_node["nxpilot"];
+  const YAML::Node new_nxpilot_node = new_root_node["nxpilot"];
+  auto get_section = [](const YAML::Node& nxpilot_node, const std::string& key) {
+    return (nxpilot_node.IsMap() && nxpilot_node[key]) ? YAML::Clone(nxpilot_node[key])
+                                                         : YAML::Node();
+  };
+
+  std::set<std::string> key_set;
+  for (const auto* nxpilot_node : {&old_nxpilot_node, &new_nxpilot_node}) {
+    if (!nxpilot_node->IsMap()) continue;
+    for (const auto& itr : *nxpilot_node) key_set.emplace(itr.first.as<std::string>());
+  }
+
+  struct SectionChange {
+    std::string key;
+    YAML::Node old_section;
+    YAML::Node new_section;
+  };
+  std::vector<SectionChange> change_vec;
+  for (const auto& key : key_set) {
+    YAML::Node old_section = get_section(old_nxpilot_node, key);
+    YAML::Node new_section = get_section(new_nxpilot_node, key);
+    if (YAML::Dump(old_section) == YAML::Dump(new_section)) continue;
+    change_vec.emplace_back(SectionChange{
+        .key = key, .old_section = old_section, .new_section = new_section});
+  }
+
+  // Check every section before applying any, so an invalid config changes nothing.
+  for (const auto& [key, old_section, new_section] : change_vec) {
+    if (key == "executor") {
+      executor_manager_.CheckOptions(new_section);
+    } else if (key == "module") {
+      module_manager_.CheckOptions(new_section);
+    } else if (key == "log") {
+      GetCoreLogLevel(new_section);
+    }
+  }
+
+  std::vector<std::string> restart_reason_vec;
+  for (auto& [key, old_section, new_section] : change_vec) {
+    std::vector<std::string> reason_vec;
+    if (key == "executor") {
+      reason_vec = executor_manager_.UpdateOptions(new_section);
+    } else if (key == "module") {
+      reason_vec = module_manager_.UpdateOptions(new_section);
+    } else if (key == "log") {
+      UpdateCoreLogLevel(new_section);
+      // Only 'core_lvl' applies live, the log backends do not.
+      for (auto* section : {&old_section, &new_section}) {
+        if (!section->IsMap()) continue;
+        section->remove("core_lvl");
+        if (section->size() == 0) section->reset();
+      }
+      if (YAML::Dump(old_section) != YAML::Dump(new_section)) {
+        reason_vec.emplace_back("'log' is changed");
+      }
+    } else {
+      reason_vec.emplace_back("'" + key + "' is changed");
+    }
+    restart_reason_vec.insert(restart_reason_vec.end(), reason_vec.begin(), reason_vec.end());
+  }
+
+  configurator_manager_.Reload(std::move(loaded_config));
+  if (options_.cfg_hot_reload) {
+    config_watcher_.UpdateFiles(configurator_manager_.GetSourceFiles());
+  }
+
+  for (const auto& reason : restart_reason_vec) {
+    NXPILOT_WARN("Config reloaded, but this change needs a restart: {}", reason);
+  }
+  NXPILOT_INFO("Config reloaded, {} changes need a restart", restart_reason_vec.size());
+  return restart_reason_vec;
+}
+
+void AdosCore::UpdateCoreLogLevel(YAML::Node log_options_node) {
+  const uint32_t log_lvl = GetCoreLogLevel(log_options_node);
+  if (std::atomic_exchange(&core_log_lvl_, log_lvl) != log_lvl) {
+    NXPILOT_INFO("Core log level set to {}", log_lvl);
+  }
+}
+
+void AdosCore::RunStageGraph(std::string_view phase_name,
+                             nxpilot::utils::common::DependencyGraph& graph) {
+  auto begin_time_point = std::chrono::steady_clock::now();
+
+  auto log_records = [&]() {
+    for (const auto& record : graph.GetRecords()) {
+      if (!record.finished) continue;
+      NXPILOT_INFO("AdosCore {} stage '{}' cost {} us", phase_name, record.name,
+                   std::chrono::duration_cast<std::chrono::microseconds>(
+                       record.end_time_point - record.begin_time_point)
+                       .count());
+    }
+  };
+
+  try {
+    graph.Run();
+  } catch (...) {
+    log_records();
+    throw;
+  }
+
+  log_records();
+  NXPILOT_INFO("AdosCore {} completed in {} us", phase_name,
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - begin_time_point)
+                   .count());
+}
+
 void AdosCore::ShutdownImpl() {
   if (std::atomic_exchange(&shutdown_impl_flag_, true)) return;
 
+  // Stop config reloads, and wait for one in progress.
+  config_watcher_.Stop();
+  { std::lock_guard<std::mutex> lck(cfg_reload_mutex_); }
+
   EnterState(State::kPreShutdown);
 
+  EnterState(State::kPreShutdownModules);
+  module_manager_.Shutdown();
+  EnterState(State::kPostShutdownModules);
+
+  EnterState(State::kPreShutdownParameter);
+  parameter_manager_.Shutdown();
+  EnterState(State::kPostShutdownParameter);
+
+  EnterState(State::kPreShutdownChannel);
+  channel_manager_.Shutdown();
+  EnterState(State::kPostShutdownChannel);
+
+  EnterState(State::kPreShutdownRpc);
+  rpc_manager_.Shutdown();
+  EnterState(State::kPostShutdownRpc);
+
+  // The watched executors keep running the heartbeat probes until here.
+  heartbeat_sender_.Stop();
+  // Scrapes run on an executor, stop accepting them before the executors shut down.
+  metrics_exporter_.Stop();
+
   EnterState(State::kPreShutdownExecutor);
   executor_manager_.Shutdown();
   EnterState(State::kPostShutdownExecutor);
 
+  EnterState(State::kPreShutdownPlugin);
+  plugin_manager_.Shutdown();
+  EnterState(State::kPostShutdownPlugin);
+
   EnterState(State::kPreShutdownConfigurator);
   configurator_manager_.Shutdown();
   EnterState(State::kPostShutdownConfigurator);
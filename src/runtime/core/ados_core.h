@@ -2,12 +2,24 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <future>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "runtime/core/channel/channel_manager.h"
+#include "runtime/core/configurator/config_watcher.h"
 #include "runtime/core/configurator/configurator_manager.h"
 #include "runtime/core/executor/executor_manager.h"
+#include "runtime/core/metrics/metrics_exporter.h"
+#include "runtime/core/module/module_manager.h"
+#include "runtime/core/parameter/parameter_manager.h"
+#include "runtime/core/plugin/plugin_manager.h"
+#include "runtime/core/rpc/rpc_manager.h"
+#include "runtime/core/supervisor/heartbeat.h"
+#include "utils/common/dependency_graph.h"
 #include "utils/common/log_tool.h"
 
 namespace nxpilot::runtime::core {
@@ -22,6 +34,12 @@ class AdosCore {
 
   struct Options {
     std::string cfg_file_path;
+    // Merged onto 'cfg_file_path' in order, e.g. per-vehicle overlays.
+    std::vector<std::string> cfg_overlay_paths;
+    // Optional binary snapshot of 'cfg_file_path', used instead of parsing YAML when up to date.
+    std::string cfg_snapshot_path;
+    // Watch the config files after start and call 'ReloadConfig' when they change.
+    bool cfg_hot_reload = false;
   };
 
   enum class State : uint32_t {
@@ -123,32 +141,110 @@ class AdosCore {
 
   using HookTask = std::function<void()>;
 
+  // One entry of the startup/shutdown profile, 'category' is "state", "hook" or "stage".
+  struct LifecycleRecord {
+    std::string name;
+    std::string category;
+    uint64_t tid = 0;
+    std::chrono::steady_clock::time_point begin_time_point;
+    std::chrono::steady_clock::time_point end_time_point;
+  };
+
+  static std::string_view GetStateName(State state);
+
   const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
 
+  // Hooks run in registration order when the core enters 'state', on the thread running that
+  // stage. Hooks of a state that has already been entered will never run. 'name' is only used in
+  // the lifecycle profile.
+  void RegisterHookFunc(State state, HookTask&& task, std::string_view name = "");
+
+  // Modules can only be registered before 'Initialize'.
+  void RegisterModule(std::unique_ptr<nxpilot::runtime::core::module::ModuleBase> module_ptr) {
+    module_manager_.RegisterModule(std::move(module_ptr));
+  }
+
   void Initialize(const Options& options);
   void Start();
   void Shutdown();
 
-  State GetState() const { return state_; }
+  // The furthest state entered so far.
+  State GetState() const { return state_.load(); }
+
+  nxpilot::runtime::core::executor::ExecutorManager& GetExecutorManager() {
+    return executor_manager_;
+  }
+  nxpilot::runtime::core::rpc::RpcManager& GetRpcManager() { return rpc_manager_; }
+  nxpilot::runtime::core::channel::ChannelManager& GetChannelManager() {
+    return channel_manager_;
+  }
+  nxpilot::runtime::core::parameter::ParameterManager& GetParameterManager() {
+    return parameter_manager_;
+  }
+
+  // Load the config files again and apply what can change while running: the core log level
+  // ('log.core_lvl'), module log levels, and executor options such as queue thresholds and
+  // thread placement. Return the changes that only take effect after restart. Throw if the new
+  // config is invalid, every section is checked first, so nothing is applied then. Only allowed
+  // after 'Start'.
+  std::vector<std::string> ReloadConfig();
+
+  // Wall time of every state, hook and stage entered so far.
+  std::vector<LifecycleRecord> GetLifecycleRecords() const;
+  // Write the lifecycle profile as a Chrome trace JSON file.
+  void ExportLifecycleTrace(const std::string& file_path) const;
 
  private:
+  // Independent stages run in parallel, so hooks of different stages may run concurrently.
   void EnterState(State state);
+  void RunStageGraph(std::string_view phase_name, nxpilot::utils::common::DependencyGraph& graph);
+  void AddLifecycleRecord(LifecycleRecord&& record);
+  void UpdateCoreLogLevel(YAML::Node log_options_node);
+
+ private:
+  struct HookTaskWrapper {
+    std::string name;
+    HookTask task;
+  };
   void StartImpl();
   void ShutdownImpl();
 
  private:
   std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
   Options options_;
-  State state_ = State::kPreInit;
+  std::atomic<State> state_ = State::kPreInit;
 
   std::atomic_bool shutdown_flag_ = false;
   std::promise<void> shutdown_promise_;
   std::atomic_bool shutdown_impl_flag_ = false;
 
-  std::vector<std::vector<HookTask>> hook_task_vec_array_;
-
+  std::mutex hook_task_mutex_;
+  std::vector<std::vector<HookTaskWrapper>> hook_task_vec_array_;
+
+  const std::chrono::steady_clock::time_point construct_time_point_;
+  // For every 'PostXxx' state, the index of the matching 'PreXxx' state, or -1.
+  std::vector<int32_t> pre_state_idx_vec_;
+  std::vector<std::chrono::steady_clock::time_point> state_enter_time_point_vec_;
+  mutable std::mutex lifecycle_record_mutex_;
+  std::vector<LifecycleRecord> lifecycle_record_vec_;
+
+  // Read on every log call of the core logger.
+  std::atomic_uint32_t core_log_lvl_ = nxpilot::utils::common::kLogLevelTrace;
+  std::mutex cfg_reload_mutex_;
+  nxpilot::runtime::core::configurator::ConfigWatcher config_watcher_;
+  // Beats while started, if the process was launched by a supervisor.
+  nxpilot::runtime::core::supervisor::HeartbeatSender heartbeat_sender_;
+  // Serves the metrics registry while started, configured by the 'metrics' options.
+  nxpilot::runtime::core::metrics::MetricsExporter metrics_exporter_;
+
+  // Declared first so that the plugin shared objects are closed after everything they created.
+  nxpilot::runtime::core::plugin::PluginManager plugin_manager_;
   nxpilot::runtime::core::configurator::ConfiguratorManager configurator_manager_;
   nxpilot::runtime::core::executor::ExecutorManager executor_manager_;
+  nxpilot::runtime::core::rpc::RpcManager rpc_manager_;
+  nxpilot::runtime::core::channel::ChannelManager channel_manager_;
+  nxpilot::runtime::core::parameter::ParameterManager parameter_manager_;
+  nxpilot::runtime::core::module::ModuleManager module_manager_;
 };
 
 }  // namespace nxpilot::runtime::core
@@ -0,0 +1,232 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/ados_core.h"
+
+namespace nxpilot::runtime::core {
+
+class AdosCoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    cfg_file_path_ = std::filesystem::temp_directory_path() / "ados_core_test_cfg.yaml";
+    std::ofstream ofs(cfg_file_path_);
+    ofs << R"str(
+nxpilot:
+  executor:
+    executors:
+      - name: ados_core_test_time_wheel
+        type: time_wheel
+)str";
+  }
+
+  void TearDown() override { std::filesystem::remove(cfg_file_path_); }
+
+  void RewriteCfgFile(std::string_view content) {
+    // Replace by rename, as deploy tools do.
+    auto tmp_path = cfg_file_path_;
+    tmp_path += ".tmp";
+    std::ofstream(tmp_path) << content;
+    std::filesystem::rename(tmp_path, cfg_file_path_);
+  }
+
+  std::filesystem::path cfg_file_path_;
+};
+
+TEST_F(AdosCoreTest, hook_and_lifecycle_profile) {
+  AdosCore core;
+
+  std::vector<std::string> hook_record_vec;
+  core.RegisterHookFunc(AdosCore::State::kPostInitExecutor, [&]() {
+    hook_record_vec.emplace_back("post_init_executor");
+    EXPECT_NE(core.GetExecutorManager().GetExecutor("ados_core_test_time_wheel"), nullptr);
+  });
+  core.RegisterHookFunc(
+      AdosCore::State::kPostStart,
+      [&]() {
+        hook_record_vec.emplace_back("post_start");
+        core.Shutdown();
+      },
+      "shutdown_after_start");
+  core.RegisterHookFunc(AdosCore::State::kPostShutdown,
+                        [&]() { hook_record_vec.emplace_back("post_shutdown"); });
+
+  core.Initialize(AdosCore::Options{.cfg_file_path = cfg_file_path_.string()});
+  core.Start();
+
+  EXPECT_EQ(hook_record_vec,
+            (std::vector<std::string>{"post_init_executor", "post_start", "post_shutdown"}));
+  EXPECT_EQ(core.GetState(), AdosCore::State::kPostShutdown);
+  EXPECT_EQ(AdosCore::GetStateName(AdosCore::State::kPreInitRpc), "PreInitRpc");
+
+  auto record_vec = core.GetLifecycleRecords();
+  auto contains = [&](std::string_view name, std::string_view category) {
+    return std::ranges::any_of(record_vec, [&](const auto& record) {
+      return record.name == name && record.category == category &&
+             record.begin_time_point <= record.end_time_point;
+    });
+  };
+  EXPECT_TRUE(contains("InitExecutor", "stage"));
+  EXPECT_TRUE(contains("ShutdownRpc", "stage"));
+  EXPECT_TRUE(contains("Init", "stage"));
+  EXPECT_TRUE(contains("PostInitExecutor#0", "hook"));
+  EXPECT_TRUE(contains("shutdown_after_start", "hook"));
+  EXPECT_TRUE(contains("PreStart", "state"));
+
+  auto trace_file_path = std::filesystem::temp_directory_path() / "ados_core_test_trace.json";
+  core.ExportLifecycleTrace(trace_file_path.string());
+  EXPECT_GT(std::filesystem::file_size(trace_file_path), 0);
+  std::filesystem::remove(trace_file_path);
+}
+
+TEST_F(AdosCoreTest, state_never_goes_backwards) {
+  AdosCore core;
+
+  // Hooks of parallel stages run concurrently, the states they see must still be ordered.
+  std::mutex state_mutex;
+  std::vector<AdosCore::State> state_vec;
+  for (uint32_t ii = 1; ii < static_cast<uint32_t>(AdosCore::State::kMaxStateNum); ++ii) {
+    const auto state = static_cast<AdosCore::State>(ii);
+    core.RegisterHookFunc(state, [&core, &state_mutex, &state_vec, state]() {
+      std::lock_guard<std::mutex> lck(state_mutex);
+      EXPECT_GE(core.GetState(), state);
+      state_vec.emplace_back(core.GetState());
+    });
+  }
+  core.RegisterHookFunc(AdosCore::State::kPostStart, [&core]() { core.Shutdown(); });
+
+  core.Initialize(AdosCore::Options{.cfg_file_path = cfg_file_path_.string()});
+  core.Start();
+
+  EXPECT_TRUE(std::ranges::is_sorted(state_vec));
+  EXPECT_EQ(state_vec.back(), AdosCore::State::kPostShutdown);
+}
+
+TEST_F(AdosCoreTest, reload_config) {
+  AdosCore core;
+
+  std::vector<std::string> restart_reason_vec;
+  core.RegisterHookFunc(AdosCore::State::kPostStart, [&]() {
+    RewriteCfgFile(R"str(
+nxpilot:
+  log:
+    core_lvl: Warn
+  executor:
+    executors:
+      - name: ados_core_test_guard
+        type: guard_thread
+        options:
+          queue_threshold: 100
+      - name: ados_core_test_time_wheel
+        type: time_wheel
+        options:
+          dt_us: 500
+      - name: ados_core_test_new_time_wheel
+        type: time_wheel
+  rpc:
+    default_timeout_ms: 10
+)str");
+    restart_reason_vec = core.ReloadConfig();
+    core.Shutdown();
+  });
+
+  core.Initialize(AdosCore::Options{.cfg_file_path = cfg_file_path_.string()});
+  core.Start();
+
+  EXPECT_EQ(core.GetLogger().GetLogLevel(), nxpilot::utils::common::kLogLevelWarn);
+
+  auto contains = [&](std::string_view str) {
+    return std::ranges::any_of(restart_reason_vec, [&](const auto& reason) {
+      return reason.find(str) != std::string::npos;
+    });
+  };
+  EXPECT_EQ(restart_reason_vec.size(), 4);
+  EXPECT_TRUE(contains("'ados_core_test_guard' is added"));
+  EXPECT_TRUE(contains("'ados_core_test_new_time_wheel' is added"));
+  EXPECT_TRUE(contains("dt_us"));
+  EXPECT_TRUE(contains("'rpc' is changed"));
+}
+
+TEST_F(AdosCoreTest, reload_invalid_config_changes_nothing) {
+  AdosCore core;
+
+  bool reload_throw = false;
+  uint32_t log_lvl_after_throw = 0;
+  std::vector<std::string> restart_reason_vec;
+  core.RegisterHookFunc(AdosCore::State::kPostStart, [&]() {
+    // The executor and log sections are valid, the module one is checked last and is not.
+    RewriteCfgFile(R"str(
+nxpilot:
+  log:
+    core_lvl: Warn
+  executor:
+    executors:
+      - name: ados_core_test_time_wheel
+        type: time_wheel
+        options:
+          shutdown_flush_timers: true
+  module:
+    modules:
+      - name: ados_core_test_module
+        log_lvl: Bogus
+)str");
+    try {
+      core.ReloadConfig();
+    } catch (const std::exception&) {
+      reload_throw = true;
+    }
+    log_lvl_after_throw = core.GetLogger().GetLogLevel();
+
+    // Compared with the config of the last successful load, the module is not there.
+    RewriteCfgFile(R"str(
+nxpilot:
+  executor:
+    executors:
+      - name: ados_core_test_time_wheel
+        type: time_wheel
+)str");
+    restart_reason_vec = core.ReloadConfig();
+    core.Shutdown();
+  });
+
+  core.Initialize(AdosCore::Options{.cfg_file_path = cfg_file_path_.string()});
+  core.Start();
+
+  EXPECT_TRUE(reload_throw);
+  EXPECT_EQ(log_lvl_after_throw, nxpilot::utils::common::kLogLevelTrace);
+  EXPECT_TRUE(restart_reason_vec.empty());
+}
+
+TEST_F(AdosCoreTest, hot_reload) {
+  AdosCore core;
+
+  std::thread writer_thread;
+  bool reloaded = false;
+  core.RegisterHookFunc(AdosCore::State::kPostStart, [&]() {
+    writer_thread = std::thread([&]() {
+      RewriteCfgFile("nxpilot:\n  log:\n    core_lvl: Error\n");
+      for (int ii = 0; ii < 500 && !reloaded; ++ii) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        reloaded = (core.GetLogger().GetLogLevel() == nxpilot::utils::common::kLogLevelError);
+      }
+      core.Shutdown();
+    });
+  });
+
+  core.Initialize(AdosCore::Options{.cfg_file_path = cfg_file_path_.string(),
+                                    .cfg_hot_reload = true});
+  core.Start();
+  writer_thread.join();
+
+  EXPECT_TRUE(reloaded);
+}
+
+}  // namespace nxpilot::runtime::core
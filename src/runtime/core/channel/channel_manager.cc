@@ -0,0 +1,264 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/channel/channel_manager.h"
+
+#include <algorithm>
+
+#include "runtime/core/channel/channel_player.h"
+#include "runtime/core/channel/channel_recorder.h"
+#include "runtime/core/channel/channel_synchronizer.h"
+#include "runtime/core/configurator/options_checker.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::channel::ChannelManager::Options> {
+  using Options = nxpilot::runtime::core::channel::ChannelManager::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    if (rhs.recorder_options) node["recorder"] = rhs.recorder_options;
+    if (rhs.player_options) node["player"] = rhs.player_options;
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["recorder"]) rhs.recorder_options = node["recorder"];
+    if (node["player"]) rhs.player_options = node["player"];
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::channel {
+
+ChannelManager::ChannelManager()
+    : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+
+ChannelManager::~ChannelManager() = default;
+
+void ChannelManager::RegisterRecordChunkCodec(RecordChunkCodec&& codec) {
+  NXPILOT_CHECK_ERROR(state_.load() == State::kPreInit,
+                      "Record chunk codec can only be registered before 'Initialize'.");
+  NXPILOT_CHECK_ERROR(!codec.name.empty() && codec.name.size() < kRecordCodecNameSize &&
+                          codec.name != "none",
+                      "Invalid record chunk codec name '{}'", codec.name);
+  NXPILOT_CHECK_ERROR(codec.compress && codec.decompress,
+                      "Record chunk codec '{}' requires compress and decompress funcs",
+                      codec.name);
+  NXPILOT_CHECK_ERROR(
+      std::ranges::find(codec_vec_, codec.name, &RecordChunkCodec::name) == codec_vec_.end(),
+      "Duplicate record chunk codec '{}'", codec.name);
+
+  codec_vec_.emplace_back(std::move(codec));
+}
+
+void ChannelManager::Initialize(YAML::Node options_node) {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
+                      "ChannelManager can only be initialized once.");
+
+  auto err = configurator::CheckOptionsKeys(options_node, {"recorder", "player"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid channel options, {}", err);
+
+  if (options_node && !options_node.IsNull()) {
+    options_ = options_node.as<Options>();
+  }
+
+  const auto& recorder_options = options_.recorder_options;
+  if (recorder_options.IsMap() && recorder_options["enable"] &&
+      recorder_options["enable"].as<bool>()) {
+    recorder_ptr_ = std::make_unique<ChannelRecorder>();
+    recorder_ptr_->SetLogger(logger_ptr_);
+    recorder_ptr_->RegisterGetExecutorFunc(GetExecutorFunc(get_executor_func_));
+    for (const auto& codec : codec_vec_) recorder_ptr_->RegisterChunkCodec(codec);
+    recorder_ptr_->Initialize(recorder_options);
+
+    // Recorded inline, the publisher only pays for a serialization and a copy.
+    const auto& channel_vec = recorder_ptr_->GetOptions().channels;
+    for (uint32_t ii = 0; ii < channel_vec.size(); ++ii) {
+      SubscribeRaw(channel_vec[ii], [recorder_ptr = recorder_ptr_.get(),
+                                     ii](const ChannelMessage& msg) {
+        recorder_ptr->Record(ii, msg);
+      });
+    }
+  }
+
+  const auto& player_options = options_.player_options;
+  if (player_options.IsMap() && player_options["enable"] && player_options["enable"].as<bool>()) {
+    player_ptr_ = std::make_unique<ChannelPlayer>();
+    player_ptr_->SetLogger(logger_ptr_);
+    player_ptr_->RegisterGetExecutorFunc(GetExecutorFunc(get_executor_func_));
+    player_ptr_->Initialize(player_options, this, codec_vec_);
+  }
+
+  NXPILOT_INFO("ChannelManager init completed");
+}
+
+void ChannelManager::Start() {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
+                      "Method can only be called when state is 'Init'.");
+
+  if (recorder_ptr_) recorder_ptr_->Start();
+  if (player_ptr_) player_ptr_->Start();
+
+  NXPILOT_INFO("ChannelManager start completed, {} channels subscribed", channel_map_.size());
+}
+
+void ChannelManager::Shutdown() {
+  if (std::atomic_exchange(&state_, State::kShutdown) == State::kShutdown) {
+    return;
+  }
+
+  if (player_ptr_) player_ptr_->Shutdown();
+  if (recorder_ptr_) recorder_ptr_->Shutdown();
+
+  NXPILOT_INFO("ChannelManager shutdown");
+}
+
+void ChannelManager::SubscribeImpl(std::string_view channel, std::type_index type,
+                                   const ChannelTypeSupport* type_support,
+                                   RawSubscribeCallback&& callback,
+                                   const SubscribeOptions& options) {
+  auto state = state_.load();
+  NXPILOT_CHECK_ERROR(state == State::kPreInit || state == State::kInit,
+                      "Channel can only be subscribed before 'Start'.");
+  NXPILOT_CHECK_ERROR(options.executor == nullptr || options.executor->ThreadSafe(),
+                      "Subscriber executor of channel '{}' is not thread safe", channel);
+
+  auto& channel_info = channel_map_[std::string(channel)];
+  if (channel_info.trace_stage.empty()) {
+    channel_info.trace_stage = "channel:" + std::string(channel);
+  }
+  if (type != typeid(void)) {
+    if (channel_info.type == typeid(void)) {
+      channel_info.type = type;
+      channel_info.type_support = type_support;
+    }
+    NXPILOT_CHECK_ERROR(channel_info.type == type,
+                        "Channel '{}' is subscribed with different types", channel);
+  }
+
+  channel_info.subscriber_vec.emplace_back(
+      Subscriber{.callback = std::move(callback), .executor_ptr = options.executor});
+}
+
+const ChannelSynchronizer* ChannelManager::SubscribeSyncedImpl(
+    const std::vector<SyncChannel>& sync_channel_vec, RawSyncCallback&& callback,
+    const SyncOptions& options) {
+  auto state = state_.load();
+  NXPILOT_CHECK_ERROR(state == State::kPreInit || state == State::kInit,
+                      "Channel can only be subscribed before 'Start'.");
+
+  // Owned before subscribing, a failed subscription may leave the previous ones in place.
+  auto* synchronizer_ptr =
+      synchronizer_vec_
+          .emplace_back(std::make_unique<ChannelSynchronizer>(sync_channel_vec.size(), options,
+                                                              std::move(callback)))
+          .get();
+  synchronizer_ptr->SetLogger(logger_ptr_);
+
+  // The synchronizer buffers the messages itself, they are handed over inline.
+  for (size_t ii = 0; ii < sync_channel_vec.size(); ++ii) {
+    const auto& sync_channel = sync_channel_vec[ii];
+    SubscribeImpl(sync_channel.channel, sync_channel.type, sync_channel.type_support,
+                  [synchronizer_ptr, ii](const ChannelMessage& msg) {
+                    synchronizer_ptr->Add(ii, msg);
+                  },
+                  {});
+  }
+
+  return synchronizer_ptr;
+}
+
+void ChannelManager::PublishImpl(std::string_view channel, uint64_t timestamp_ns,
+                                 std::type_index type, const ChannelTypeSupport* type_support,
+                                 std::shared_ptr<const void> data) noexcept {
+  if (state_.load() != State::kStart) [[unlikely]] {
+    NXPILOT_ERROR("Channel '{}' can only be published when state is 'Start'.", channel);
+    return;
+  }
+
+  auto iter = channel_map_.find(channel);
+  if (iter == channel_map_.end()) return;
+
+  const auto& channel_info = iter->second;
+  if (channel_info.type != typeid(void) && channel_info.type != type) [[unlikely]] {
+    NXPILOT_ERROR("Channel '{}' published with mismatched type.", channel);
+    return;
+  }
+
+  Deliver(ChannelMessage{.channel = iter->first,
+                         .timestamp_ns = timestamp_ns,
+                         .type = type,
+                         .type_support = type_support,
+                         .data = std::move(data),
+                         .trace_ptr = ForkTrace(channel_info)},
+          channel_info);
+}
+
+void ChannelManager::PublishSerialized(std::string_view channel, std::string_view payload,
+                                       uint64_t timestamp_ns) noexcept {
+  if (state_.load() != State::kStart) [[unlikely]] {
+    NXPILOT_ERROR("Channel '{}' can only be published when state is 'Start'.", channel);
+    return;
+  }
+
+  auto iter = channel_map_.find(channel);
+  if (iter == channel_map_.end() || iter->second.type_support == nullptr) return;
+
+  const auto& channel_info = iter->second;
+  std::shared_ptr<void> data;
+  try {
+    data = channel_info.type_support->create();
+    if (!channel_info.type_support->deserialize(payload, data.get())) {
+      NXPILOT_ERROR("Deserialize msg of channel '{}' failed.", channel);
+      return;
+    }
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("Deserialize msg of channel '{}' get exception, {}", channel, e.what());
+    return;
+  }
+
+  Deliver(ChannelMessage{.channel = iter->first,
+                         .timestamp_ns = timestamp_ns,
+                         .type = channel_info.type,
+                         .type_support = channel_info.type_support,
+                         .data = std::move(data),
+                         .trace_ptr = ForkTrace(channel_info)},
+          channel_info);
+}
+
+void ChannelManager::Deliver(const ChannelMessage& msg, const Channel& channel_info) noexcept {
+  // Inline subscribers run with the trace of the message, traced executors carry it on.
+  nxpilot::runtime::core::trace::ScopedLatencyTrace scoped_trace(msg.trace_ptr.get());
+
+  for (const auto& subscriber : channel_info.subscriber_vec) {
+    if (subscriber.executor_ptr) {
+      subscriber.executor_ptr->Execute(
+          [callback_ptr = &subscriber.callback, msg]() { (*callback_ptr)(msg); });
+      continue;
+    }
+
+    try {
+      subscriber.callback(msg);
+    } catch (const std::exception& e) {
+      NXPILOT_ERROR("Subscriber of channel '{}' get exception, {}", msg.channel, e.what());
+    }
+  }
+}
+
+std::shared_ptr<const nxpilot::runtime::core::trace::LatencyTraceContext> ChannelManager::ForkTrace(
+    const Channel& channel_info) noexcept {
+  if (!nxpilot::runtime::core::trace::GetLatencyTracker().IsEnabled()) return nullptr;
+
+  try {
+    return std::make_shared<const nxpilot::runtime::core::trace::LatencyTraceContext>(
+        nxpilot::runtime::core::trace::ForkLatencyTrace(channel_info.trace_stage.c_str()));
+  } catch (const std::exception&) {
+    return nullptr;
+  }
+}
+
+}  // namespace nxpilot::runtime::core::channel
@@ -0,0 +1,238 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "runtime/core/channel/record_format.h"
+#include "runtime/core/executor/executor_base.h"
+#include "runtime/core/executor/time_source.h"
+#include "runtime/core/rpc/rpc_type_support.h"
+#include "runtime/core/trace/latency_trace.h"
+#include "utils/common/log_tool.h"
+#include "utils/common/string_tool.h"
+#include "utils/common/time_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::channel {
+
+class ChannelPlayer;
+class ChannelRecorder;
+class ChannelSynchronizer;
+
+// Channels share the type-erased (de)serialization functions of rpc.
+using ChannelTypeSupport = nxpilot::runtime::core::rpc::RpcTypeSupport;
+
+template <typename T>
+const ChannelTypeSupport* GetChannelTypeSupport() {
+  return nxpilot::runtime::core::rpc::GetRpcTypeSupport<T>();
+}
+
+// A published message as seen by raw subscribers. 'channel' stays valid as long as the manager.
+struct ChannelMessage {
+  std::string_view channel;
+  uint64_t timestamp_ns = 0;
+  std::type_index type = typeid(void);
+  const ChannelTypeSupport* type_support = nullptr;  // nullptr if the type is not serializable
+  std::shared_ptr<const void> data;
+  // Set while latency tracing is enabled, subscribers run with it as their current trace.
+  std::shared_ptr<const nxpilot::runtime::core::trace::LatencyTraceContext> trace_ptr;
+};
+
+template <typename T>
+using SubscribeCallback = std::function<void(const std::shared_ptr<const T>&, uint64_t)>;
+
+using RawSubscribeCallback = std::function<void(const ChannelMessage&)>;
+
+struct SubscribeOptions {
+  // Deliver messages on this executor, nullptr means calling the callback inline on the
+  // publisher thread.
+  nxpilot::runtime::core::executor::ExecutorBase* executor = nullptr;
+};
+
+// Called with one message per synced channel, in the order of the channels.
+template <typename... Ts>
+using SyncCallback = std::function<void(const std::shared_ptr<const Ts>&...)>;
+
+using RawSyncCallback = std::function<void(const std::vector<ChannelMessage>&)>;
+
+struct SyncOptions {
+  // Max timestamp difference between the messages of a tuple, 0 means exact matches only.
+  uint64_t tolerance_ns = 0;
+  // Max messages buffered per channel while waiting for the other channels.
+  uint32_t queue_size = 16;
+  // Deliver tuples on this executor, nullptr means calling the callback inline on the thread
+  // publishing the message that completes the tuple.
+  nxpilot::runtime::core::executor::ExecutorBase* executor = nullptr;
+};
+
+class ChannelManager {
+ public:
+  ChannelManager();
+  ~ChannelManager();
+
+  ChannelManager(const ChannelManager&) = delete;
+  ChannelManager& operator=(const ChannelManager&) = delete;
+
+  struct Options {
+    YAML::Node recorder_options;
+    YAML::Node player_options;
+  };
+
+  enum class State : uint32_t {
+    kPreInit,
+    kInit,
+    kStart,
+    kShutdown,
+  };
+
+  using GetExecutorFunc =
+      std::function<nxpilot::runtime::core::executor::ExecutorBase*(std::string_view)>;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  void RegisterGetExecutorFunc(GetExecutorFunc&& get_executor_func) {
+    get_executor_func_ = std::move(get_executor_func);
+  }
+
+  // Messages published without a timestamp are stamped with this time source.
+  void SetTimeSource(const nxpilot::runtime::core::executor::TimeSource* time_source_ptr) {
+    time_source_ptr_ = time_source_ptr;
+  }
+
+  // Codecs can only be registered before 'Initialize', e.g. by plugins.
+  void RegisterRecordChunkCodec(RecordChunkCodec&& codec);
+
+  void Initialize(YAML::Node options_node);
+  void Start();
+  void Shutdown();
+
+  State GetState() const { return state_.load(); }
+
+  // Subscribers can only be added before 'Start', the channel table is read-only afterwards. All
+  // typed subscribers of a channel must use the same type.
+  template <typename T>
+  void Subscribe(std::string_view channel, SubscribeCallback<T>&& callback,
+                 const SubscribeOptions& options = {}) {
+    SubscribeImpl(channel, typeid(T), GetChannelTypeSupport<T>(),
+                  [callback{std::move(callback)}](const ChannelMessage& msg) {
+                    callback(std::static_pointer_cast<const T>(msg.data), msg.timestamp_ns);
+                  },
+                  options);
+  }
+
+  // Receive the messages of a channel whatever their type, e.g. to record them.
+  void SubscribeRaw(std::string_view channel, RawSubscribeCallback&& callback,
+                    const SubscribeOptions& options = {}) {
+    SubscribeImpl(channel, typeid(void), nullptr, std::move(callback), options);
+  }
+
+  // Receive tuples of messages of 'channels' matched by timestamp, see 'ChannelSynchronizer'. Same
+  // rules as 'Subscribe'. The returned synchronizer lives as long as the manager.
+  template <typename... Ts>
+  const ChannelSynchronizer* SubscribeSynced(
+      const std::array<std::string_view, sizeof...(Ts)>& channels,
+      std::type_identity_t<SyncCallback<Ts...>>&& callback, const SyncOptions& options = {}) {
+    static_assert(sizeof...(Ts) >= 2, "Synced subscription requires at least 2 channels");
+    return SubscribeSyncedImpl(
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+          return std::vector<SyncChannel>{
+              SyncChannel{.channel = channels[Is],
+                          .type = typeid(Ts),
+                          .type_support = GetChannelTypeSupport<Ts>()}...};
+        }(std::index_sequence_for<Ts...>{}),
+        [callback{std::move(callback)}](const std::vector<ChannelMessage>& msg_vec) {
+          [&]<size_t... Is>(std::index_sequence<Is...>) {
+            callback(std::static_pointer_cast<const Ts>(msg_vec[Is].data)...);
+          }(std::index_sequence_for<Ts...>{});
+        },
+        options);
+  }
+
+  // Only when state is 'Start'. Messages of channels nobody subscribes to are dropped. The
+  // message is shared with all subscribers, it must not be modified after publishing.
+  template <typename T>
+  void Publish(std::string_view channel, std::shared_ptr<const T> msg) noexcept {
+    Publish<T>(channel, std::move(msg),
+               nxpilot::utils::common::GetTimestampNs(time_source_ptr_->Now()));
+  }
+
+  template <typename T>
+  void Publish(std::string_view channel, std::shared_ptr<const T> msg,
+               uint64_t timestamp_ns) noexcept {
+    PublishImpl(channel, timestamp_ns, typeid(T), GetChannelTypeSupport<T>(), std::move(msg));
+  }
+
+  // Publish a serialized message, deserialized with the type of the typed subscribers of the
+  // channel. Dropped if there are none.
+  void PublishSerialized(std::string_view channel, std::string_view payload,
+                         uint64_t timestamp_ns) noexcept;
+
+  // nullptr if recording is not enabled.
+  const ChannelRecorder* GetRecorder() const { return recorder_ptr_.get(); }
+  // nullptr if playback is not enabled.
+  ChannelPlayer* GetPlayer() { return player_ptr_.get(); }
+
+ private:
+  struct Subscriber {
+    RawSubscribeCallback callback;
+    nxpilot::runtime::core::executor::ExecutorBase* executor_ptr = nullptr;
+  };
+
+  struct Channel {
+    std::type_index type = typeid(void);  // void until a typed subscriber is added
+    const ChannelTypeSupport* type_support = nullptr;
+    std::vector<Subscriber> subscriber_vec;
+    std::string trace_stage;  // the latency trace hop of a publish
+  };
+
+  struct SyncChannel {
+    std::string_view channel;
+    std::type_index type = typeid(void);
+    const ChannelTypeSupport* type_support = nullptr;
+  };
+
+  void SubscribeImpl(std::string_view channel, std::type_index type,
+                     const ChannelTypeSupport* type_support, RawSubscribeCallback&& callback,
+                     const SubscribeOptions& options);
+  const ChannelSynchronizer* SubscribeSyncedImpl(const std::vector<SyncChannel>& sync_channel_vec,
+                                                 RawSyncCallback&& callback,
+                                                 const SyncOptions& options);
+  void PublishImpl(std::string_view channel, uint64_t timestamp_ns, std::type_index type,
+                   const ChannelTypeSupport* type_support,
+                   std::shared_ptr<const void> data) noexcept;
+  void Deliver(const ChannelMessage& msg, const Channel& channel_info) noexcept;
+  static std::shared_ptr<const nxpilot::runtime::core::trace::LatencyTraceContext> ForkTrace(
+      const Channel& channel_info) noexcept;
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  std::atomic<State> state_ = State::kPreInit;
+
+  GetExecutorFunc get_executor_func_;
+  const nxpilot::runtime::core::executor::TimeSource* time_source_ptr_ =
+      &nxpilot::runtime::core::executor::GetSystemTimeSource();
+
+  std::vector<RecordChunkCodec> codec_vec_;
+  std::unique_ptr<ChannelRecorder> recorder_ptr_;
+  std::unique_ptr<ChannelPlayer> player_ptr_;
+  std::vector<std::unique_ptr<ChannelSynchronizer>> synchronizer_vec_;
+
+  std::unordered_map<std::string, Channel, nxpilot::utils::common::StringHash, std::equal_to<>>
+      channel_map_;
+};
+
+}  // namespace nxpilot::runtime::core::channel
@@ -0,0 +1,79 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/channel/channel_manager.h"
+#include "runtime/core/executor/guard_thread_executor.h"
+
+namespace nxpilot::runtime::core::channel {
+
+TEST(ChannelManagerTest, publish_subscribe) {
+  ChannelManager channel_manager;
+
+  std::vector<std::pair<std::string, uint64_t>> received_vec;
+  channel_manager.Subscribe<std::string>(
+      "a", [&](const std::shared_ptr<const std::string>& msg, uint64_t timestamp_ns) {
+        received_vec.emplace_back(*msg, timestamp_ns);
+      });
+  std::vector<std::string> raw_vec;
+  channel_manager.SubscribeRaw("a", [&](const ChannelMessage& msg) {
+    EXPECT_EQ(msg.type, typeid(std::string));
+    EXPECT_NE(msg.type_support, nullptr);
+    raw_vec.emplace_back(msg.channel);
+  });
+
+  channel_manager.Initialize(YAML::Node());
+  channel_manager.Start();
+
+  auto msg = std::make_shared<const std::string>("hello");
+  channel_manager.Publish<std::string>("a", msg, 100);
+  channel_manager.Publish<std::string>("b", msg, 200);
+  // Mismatched type, dropped.
+  channel_manager.Publish<int>("a", std::make_shared<const int>(1), 300);
+  channel_manager.Publish<std::string>("a", msg);
+
+  ASSERT_EQ(received_vec.size(), 2);
+  EXPECT_EQ(received_vec[0], std::make_pair(std::string("hello"), uint64_t(100)));
+  EXPECT_GT(received_vec[1].second, 100);
+  EXPECT_EQ(raw_vec, (std::vector<std::string>{"a", "a"}));
+
+  EXPECT_THROW(channel_manager.SubscribeRaw("c", [](const ChannelMessage&) {}), std::exception);
+
+  channel_manager.Shutdown();
+  channel_manager.Publish<std::string>("a", msg, 400);
+  EXPECT_EQ(received_vec.size(), 2);
+}
+
+TEST(ChannelManagerTest, subscribe_on_executor) {
+  executor::GuardThreadExecutor executor;
+  executor.Initialize("channel_sub_test", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+
+  ChannelManager channel_manager;
+  std::promise<const int*> received_promise;
+  channel_manager.Subscribe<int>(
+      "a",
+      [&](const std::shared_ptr<const int>& msg, uint64_t) {
+        received_promise.set_value(msg.get());
+      },
+      SubscribeOptions{.executor = &executor});
+  EXPECT_THROW(channel_manager.Subscribe<double>("a", [](const auto&, uint64_t) {}),
+               std::exception);
+
+  channel_manager.Initialize(YAML::Node());
+  channel_manager.Start();
+
+  // Subscribers share the published message, it is not copied.
+  auto msg = std::make_shared<const int>(42);
+  channel_manager.Publish<int>("a", msg, 1);
+  EXPECT_EQ(received_promise.get_future().get(), msg.get());
+
+  channel_manager.Shutdown();
+  executor.Shutdown();
+}
+
+}  // namespace nxpilot::runtime::core::channel
@@ -0,0 +1,235 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/channel/channel_player.h"
+
+#include <algorithm>
+
+#include "runtime/core/configurator/options_checker.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::channel::ChannelPlayer::Options> {
+  using Options = nxpilot::runtime::core::channel::ChannelPlayer::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["enable"] = rhs.enable;
+    node["file_path"] = rhs.file_path;
+    node["channels"] = rhs.channels;
+    node["rate"] = rhs.rate;
+    node["start_offset_ms"] = rhs.start_offset_ms;
+    node["executor"] = rhs.executor;
+    node["readahead_chunk_num"] = rhs.readahead_chunk_num;
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["enable"]) rhs.enable = node["enable"].as<bool>();
+    if (node["file_path"]) rhs.file_path = node["file_path"].as<std::string>();
+    if (node["channels"]) rhs.channels = node["channels"].as<std::vector<std::string>>();
+    if (node["rate"]) rhs.rate = node["rate"].as<double>();
+    if (node["start_offset_ms"]) rhs.start_offset_ms = node["start_offset_ms"].as<uint64_t>();
+    if (node["executor"]) rhs.executor = node["executor"].as<std::string>();
+    if (node["readahead_chunk_num"])
+      rhs.readahead_chunk_num = node["readahead_chunk_num"].as<uint32_t>();
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::channel {
+
+void ChannelPlayer::Initialize(YAML::Node options_node, ChannelManager* channel_manager_ptr,
+                               const std::vector<RecordChunkCodec>& codec_vec) {
+  auto err = configurator::CheckOptionsKeys(
+      options_node, {"enable", "file_path", "channels", "rate", "start_offset_ms", "executor",
+                     "readahead_chunk_num"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid player options, {}", err);
+
+  if (options_node && !options_node.IsNull()) {
+    options_ = options_node.as<Options>();
+  }
+  NXPILOT_CHECK_ERROR(options_.rate >= 0, "Player 'rate' is negative");
+
+  NXPILOT_CHECK_ERROR(get_executor_func_, "ChannelPlayer requires a get executor func.");
+  executor_ptr_ = get_executor_func_(options_.executor);
+  NXPILOT_CHECK_ERROR(executor_ptr_ != nullptr && executor_ptr_->ThreadSafe() &&
+                          executor_ptr_->SupportTimerSchedule(),
+                      "Invalid player executor '{}', it must be a thread safe timer executor",
+                      options_.executor);
+  channel_manager_ptr_ = channel_manager_ptr;
+  rate_ = options_.rate;
+
+  reader_.SetLogger(logger_ptr_);
+  reader_.Open(options_.file_path, codec_vec);
+
+  const auto& channel_vec = reader_.GetChannels();
+  for (const auto& channel : options_.channels) {
+    NXPILOT_CHECK_ERROR(std::ranges::find(channel_vec, channel) != channel_vec.end(),
+                        "Channel '{}' is not in record file '{}'", channel, options_.file_path);
+  }
+  play_channel_vec_.clear();
+  for (const auto& channel : channel_vec) {
+    play_channel_vec_.emplace_back(options_.channels.empty() ||
+                                   std::ranges::find(options_.channels, channel) !=
+                                       options_.channels.end());
+  }
+
+  NXPILOT_INFO("ChannelPlayer init completed, play '{}' at rate {}", options_.file_path, rate_);
+}
+
+void ChannelPlayer::Start() {
+  std::lock_guard<std::mutex> lck(mutex_);
+  running_ = true;
+  SeekLocked(reader_.GetBeginNs() + options_.start_offset_ms * 1000000);
+
+  NXPILOT_INFO("ChannelPlayer start completed");
+}
+
+void ChannelPlayer::Shutdown() {
+  std::unique_lock<std::mutex> lck(mutex_);
+  if (!running_) return;
+  running_ = false;
+  ++generation_;
+  publish_cv_.wait(lck, [this]() { return publishing_num_ == 0; });
+
+  NXPILOT_INFO("ChannelPlayer shutdown, {} msgs published", published_num_.load());
+}
+
+void ChannelPlayer::Seek(uint64_t timestamp_ns) {
+  std::lock_guard<std::mutex> lck(mutex_);
+  if (!running_) return;
+  SeekLocked(timestamp_ns);
+}
+
+void ChannelPlayer::SetRate(double rate) {
+  NXPILOT_CHECK_ERROR(rate >= 0, "Player rate is negative");
+
+  std::lock_guard<std::mutex> lck(mutex_);
+  if (!running_ || rate == rate_) return;
+
+  // Keep the record time reached so far, and go on from there at the new rate.
+  const auto now = executor_ptr_->Now();
+  if (anchor_ns_ != 0 && rate_ > 0 && rate > 0) {
+    anchor_ns_ += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - anchor_tp_).count() * rate_);
+    anchor_tp_ = now;
+  } else {
+    anchor_ns_ = 0;
+  }
+  rate_ = rate;
+
+  ++generation_;
+  ScheduleStepLocked(now);
+}
+
+void ChannelPlayer::SeekLocked(uint64_t timestamp_ns) {
+  seek_ns_ = timestamp_ns;
+  next_chunk_idx_ = reader_.Seek(timestamp_ns);
+  record_vec_.clear();
+  record_idx_ = 0;
+  anchor_ns_ = 0;
+  finished_flag_ = false;
+
+  ++generation_;
+  ScheduleStepLocked(executor_ptr_->Now());
+}
+
+void ChannelPlayer::ScheduleStepLocked(std::chrono::system_clock::time_point tp) {
+  const uint64_t generation = generation_;
+  if (tp <= executor_ptr_->Now()) {
+    executor_ptr_->Execute([this, generation]() { Step(generation); });
+  } else {
+    executor_ptr_->ExecuteAt(tp, [this, generation]() { Step(generation); });
+  }
+}
+
+bool ChannelPlayer::NextRecordLocked() {
+  while (true) {
+    for (; record_idx_ < record_vec_.size(); ++record_idx_) {
+      const auto& record = record_vec_[record_idx_];
+      if (play_channel_vec_[record.channel_id] && record.timestamp_ns >= seek_ns_) return true;
+    }
+
+    // Chunks without any played channel are skipped through the channel index.
+    for (; next_chunk_idx_ < reader_.GetChunkNum(); ++next_chunk_idx_) {
+      bool played = false;
+      for (uint32_t ii = 0; ii < play_channel_vec_.size() && !played; ++ii) {
+        played = play_channel_vec_[ii] && reader_.GetChunkRecordNum(next_chunk_idx_, ii) > 0;
+      }
+      if (played) break;
+    }
+    if (next_chunk_idx_ >= reader_.GetChunkNum()) return false;
+
+    reader_.Prefetch(next_chunk_idx_ + 1, options_.readahead_chunk_num);
+    if (!reader_.ReadChunk(next_chunk_idx_, record_vec_, chunk_buffer_)) record_vec_.clear();
+    ++next_chunk_idx_;
+    record_idx_ = 0;
+  }
+}
+
+std::chrono::system_clock::time_point ChannelPlayer::GetDueTimeLocked(
+    uint64_t timestamp_ns) const {
+  // Records a little out of order are due right away.
+  if (timestamp_ns <= anchor_ns_) return anchor_tp_;
+  return anchor_tp_ + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                          std::chrono::duration<double, std::nano>(
+                              static_cast<double>(timestamp_ns - anchor_ns_) / rate_));
+}
+
+void ChannelPlayer::Step(uint64_t generation) {
+  std::unique_lock<std::mutex> lck(mutex_);
+  if (!running_ || generation != generation_) return;
+
+  // Subscribers run inline and may seek or change the rate, so publish without 'mutex_'. The
+  // payload is copied out, a seek meanwhile may load another chunk into the buffer.
+  std::string payload;
+  const auto now = executor_ptr_->Now();
+  for (size_t ii = 0;; ++ii) {
+    if (!NextRecordLocked()) {
+      if (!finished_flag_.exchange(true)) {
+        NXPILOT_INFO("Playback of '{}' finished, {} msgs published", options_.file_path,
+                     published_num_.load());
+      }
+      return;
+    }
+
+    const auto& record = record_vec_[record_idx_];
+    if (rate_ > 0) {
+      if (anchor_ns_ == 0) {
+        anchor_ns_ = record.timestamp_ns;
+        anchor_tp_ = now;
+      }
+      const auto due_tp = GetDueTimeLocked(record.timestamp_ns);
+      if (due_tp > now) {
+        ScheduleStepLocked(due_tp);
+        return;
+      }
+    }
+    // Let the executor run other tasks in between.
+    if (ii >= kBatchSize) {
+      ScheduleStepLocked(now);
+      return;
+    }
+
+    const auto& channel = reader_.GetChannels()[record.channel_id];
+    const uint64_t timestamp_ns = record.timestamp_ns;
+    payload.assign(record.payload);
+    ++record_idx_;
+    ++publishing_num_;
+    lck.unlock();
+
+    channel_manager_ptr_->PublishSerialized(channel, payload, timestamp_ns);
+    ++published_num_;
+
+    lck.lock();
+    if (--publishing_num_ == 0) publish_cv_.notify_all();
+    // A seek, rate change or shutdown meanwhile scheduled its own step.
+    if (!running_ || generation != generation_) return;
+  }
+}
+
+}  // namespace nxpilot::runtime::core::channel
@@ -0,0 +1,129 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "runtime/core/channel/channel_manager.h"
+#include "runtime/core/channel/record_reader.h"
+#include "runtime/core/executor/executor_base.h"
+#include "utils/common/log_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::channel {
+
+/**
+ * @brief Republish the messages of a record file into their channels, with their recorded
+ * timestamps.
+ *
+ * Driven by timers of a timer executor: each step publishes the records that are due and
+ * schedules the next step at the due time of the next record. At rate 0 the records are
+ * published as fast as possible, in batches, so the executor can interleave other tasks. The
+ * next chunks are read ahead while the current one plays. Messages are deserialized with the
+ * type of the typed subscribers of their channel, channels without any are skipped.
+ */
+class ChannelPlayer {
+ public:
+  struct Options {
+    bool enable = false;
+    std::string file_path;
+    // Recorded channels to play, empty means all.
+    std::vector<std::string> channels;
+    // Speed relative to the executor time, 0 means as fast as possible.
+    double rate = 1.0;
+    // Start at this offset from the begin of the record.
+    uint64_t start_offset_ms = 0;
+    std::string executor;
+    uint32_t readahead_chunk_num = 4;
+  };
+
+  using GetExecutorFunc =
+      std::function<nxpilot::runtime::core::executor::ExecutorBase*(std::string_view)>;
+
+  ChannelPlayer() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~ChannelPlayer() { Shutdown(); }
+
+  ChannelPlayer(const ChannelPlayer&) = delete;
+  ChannelPlayer& operator=(const ChannelPlayer&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  void RegisterGetExecutorFunc(GetExecutorFunc&& get_executor_func) {
+    get_executor_func_ = std::move(get_executor_func);
+  }
+
+  // Open the file. Publish into 'channel_manager_ptr' once started.
+  void Initialize(YAML::Node options_node, ChannelManager* channel_manager_ptr,
+                  const std::vector<RecordChunkCodec>& codec_vec);
+  void Start();
+  // Stop publishing, waits for the message being published. Not to be called from a subscriber of
+  // a played channel.
+  void Shutdown();
+
+  const RecordReader& GetReader() const { return reader_; }
+
+  // Continue playing from the first record at or after 'timestamp_ns'. Thread safe, also from a
+  // subscriber of a played channel.
+  void Seek(uint64_t timestamp_ns);
+  void SetRate(double rate);
+
+  bool IsFinished() const { return finished_flag_.load(); }
+  uint64_t GetPublishedNum() const { return published_num_.load(); }
+
+ private:
+  // The 'Locked' methods are called with 'mutex_' held.
+  void SeekLocked(uint64_t timestamp_ns);
+  void ScheduleStepLocked(std::chrono::system_clock::time_point tp);
+  // Move to the next record to play, loading chunks as needed. Return false at the end.
+  bool NextRecordLocked();
+  std::chrono::system_clock::time_point GetDueTimeLocked(uint64_t timestamp_ns) const;
+
+  void Step(uint64_t generation);
+
+ private:
+  static constexpr size_t kBatchSize = 256;
+
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  GetExecutorFunc get_executor_func_;
+  nxpilot::runtime::core::executor::ExecutorBase* executor_ptr_ = nullptr;
+  ChannelManager* channel_manager_ptr_ = nullptr;
+
+  RecordReader reader_;
+  std::vector<bool> play_channel_vec_;
+
+  std::mutex mutex_;
+  bool running_ = false;
+  // Bumped by every seek and rate change, so that steps scheduled before are ignored.
+  uint64_t generation_ = 0;
+  double rate_ = 1.0;
+  // The record at 'anchor_ns' is due at 'anchor_tp', 0 until the next step sets it.
+  uint64_t anchor_ns_ = 0;
+  std::chrono::system_clock::time_point anchor_tp_;
+
+  // Records before the last seek target are skipped.
+  uint64_t seek_ns_ = 0;
+  size_t next_chunk_idx_ = 0;
+  std::vector<RecordReader::Record> record_vec_;
+  std::string chunk_buffer_;
+  size_t record_idx_ = 0;
+
+  // Steps publishing a message without 'mutex_' held, see 'Step'.
+  uint32_t publishing_num_ = 0;
+  std::condition_variable publish_cv_;
+
+  std::atomic_bool finished_flag_ = false;
+  std::atomic_uint64_t published_num_ = 0;
+};
+
+}  // namespace nxpilot::runtime::core::channel
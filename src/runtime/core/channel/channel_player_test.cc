@@ -0,0 +1,256 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <future>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/channel/channel_player.h"
+#include "runtime/core/channel/channel_recorder.h"
+#include "runtime/core/executor/guard_thread_executor.h"
+#include "runtime/core/executor/sim_time_executor.h"
+
+namespace nxpilot::runtime::core::channel {
+
+namespace {
+
+constexpr uint64_t kMsgNum = 1000;
+constexpr uint64_t kBeginNs = 1000000000;
+constexpr uint64_t kIntervalNs = 10000000;
+
+class ChannelPlayerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    bg_executor_.Initialize("player_bg_test", YAML::Node(YAML::NodeType::Null));
+    bg_executor_.Start();
+    file_path_ = (std::filesystem::temp_directory_path() /
+                  ("nxpilot_player_test_" + std::to_string(getpid()) + ".rec"))
+                     .string();
+
+    // Msg 'ii' is on channel 'a' if even, 'b' if odd, at 'kBeginNs + ii * kIntervalNs'.
+    ChannelRecorder recorder;
+    recorder.RegisterGetExecutorFunc(
+        [this](std::string_view) -> executor::ExecutorBase* { return &bg_executor_; });
+    recorder.Initialize(YAML::Load(std::format(R"(
+file_path: {}
+channels: [a, b]
+chunk_size_kb: 4
+)",
+                                               file_path_)));
+    recorder.Start();
+    for (uint64_t ii = 0; ii < kMsgNum; ++ii) {
+      recorder.Record(ii % 2, ChannelMessage{.channel = (ii % 2) ? "b" : "a",
+                                             .timestamp_ns = kBeginNs + ii * kIntervalNs,
+                                             .type = typeid(uint64_t),
+                                             .type_support = GetChannelTypeSupport<uint64_t>(),
+                                             .data = std::make_shared<const uint64_t>(ii)});
+    }
+    recorder.Shutdown();
+  }
+
+  void TearDown() override {
+    bg_executor_.Shutdown();
+    std::filesystem::remove(file_path_);
+  }
+
+  executor::GuardThreadExecutor bg_executor_;
+  std::string file_path_;
+};
+
+}  // namespace
+
+TEST_F(ChannelPlayerTest, reader_seek) {
+  RecordReader reader;
+  reader.Open(file_path_);
+  EXPECT_EQ(reader.GetChannels(), (std::vector<std::string>{"a", "b"}));
+  EXPECT_EQ(reader.GetRecordNum(), kMsgNum);
+  EXPECT_EQ(reader.GetBeginNs(), kBeginNs);
+  EXPECT_EQ(reader.GetEndNs(), kBeginNs + (kMsgNum - 1) * kIntervalNs);
+  ASSERT_GT(reader.GetChunkNum(), 4);
+
+  std::vector<RecordReader::Record> record_vec;
+  std::string buffer;
+  for (uint64_t ii : {uint64_t(0), uint64_t(1), kMsgNum / 3, kMsgNum - 1}) {
+    const uint64_t timestamp_ns = kBeginNs + ii * kIntervalNs;
+    const size_t chunk_idx = reader.Seek(timestamp_ns);
+    ASSERT_LT(chunk_idx, reader.GetChunkNum());
+    if (chunk_idx > 0) {
+      EXPECT_LT(reader.GetChunkHeader(chunk_idx - 1).end_ns, timestamp_ns);
+    }
+
+    ASSERT_TRUE(reader.ReadChunk(chunk_idx, record_vec, buffer));
+    auto itr = std::ranges::find(record_vec, timestamp_ns, &RecordReader::Record::timestamp_ns);
+    ASSERT_NE(itr, record_vec.end());
+    EXPECT_EQ(itr->channel_id, ii % 2);
+    uint64_t value = 0;
+    ASSERT_TRUE(nxpilot::utils::common::SerializationTraits<uint64_t>::Deserialize(itr->payload,
+                                                                                  value));
+    EXPECT_EQ(value, ii);
+  }
+  EXPECT_EQ(reader.Seek(kBeginNs + kMsgNum * kIntervalNs), reader.GetChunkNum());
+}
+
+TEST_F(ChannelPlayerTest, reader_skips_chunks_out_of_file) {
+  size_t chunk_num = 0;
+  {
+    RecordReader reader;
+    reader.Open(file_path_);
+    chunk_num = reader.GetChunkNum();
+  }
+
+  // Move the data two chunks later, the last two would then overlap the index.
+  RecordFileHeader file_header;
+  {
+    std::fstream fs(file_path_, std::ios::in | std::ios::out | std::ios::binary);
+    fs.read(reinterpret_cast<char*>(&file_header), sizeof(file_header));
+    file_header.data_offset += 2 * file_header.chunk_size;
+    fs.seekp(0);
+    fs.write(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
+  }
+
+  RecordReader reader;
+  reader.Open(file_path_);
+  EXPECT_EQ(reader.GetChunkNum(), chunk_num - 2);
+  std::vector<RecordReader::Record> record_vec;
+  std::string buffer;
+  for (size_t ii = 0; ii < reader.GetChunkNum(); ++ii) reader.ReadChunk(ii, record_vec, buffer);
+}
+
+TEST_F(ChannelPlayerTest, play_on_virtual_time) {
+  executor::SimTimeExecutor sim_executor;
+  sim_executor.Initialize("player_sim_test", YAML::Load("start_time_us: 1000000"));
+  sim_executor.Start();
+
+  ChannelManager channel_manager;
+  channel_manager.RegisterGetExecutorFunc(
+      [&](std::string_view) -> executor::ExecutorBase* { return &sim_executor; });
+
+  std::vector<std::pair<uint64_t, std::chrono::system_clock::time_point>> received_vec;
+  std::promise<void> done_promise;
+  for (const auto* channel : {"a", "b"}) {
+    channel_manager.Subscribe<uint64_t>(
+        channel, [&](const std::shared_ptr<const uint64_t>& msg, uint64_t timestamp_ns) {
+          EXPECT_EQ(timestamp_ns, kBeginNs + *msg * kIntervalNs);
+          received_vec.emplace_back(*msg, sim_executor.Now());
+          if (*msg == kMsgNum - 1) done_promise.set_value();
+        });
+  }
+
+  channel_manager.Initialize(YAML::Load(std::format(R"(
+player:
+  enable: true
+  file_path: {}
+  rate: 2
+  executor: player_sim_test
+)",
+                                                    file_path_)));
+  const auto start_tp = sim_executor.Now();
+  channel_manager.Start();
+
+  ASSERT_EQ(done_promise.get_future().wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  channel_manager.Shutdown();
+  sim_executor.Shutdown();
+  EXPECT_EQ(channel_manager.GetPlayer()->GetPublishedNum(), kMsgNum);
+
+  // Twice as fast as recorded, on the virtual time of the executor.
+  ASSERT_EQ(received_vec.size(), kMsgNum);
+  for (uint64_t ii = 0; ii < kMsgNum; ++ii) {
+    EXPECT_EQ(received_vec[ii].first, ii);
+    EXPECT_EQ(received_vec[ii].second,
+              start_tp + std::chrono::nanoseconds(ii * kIntervalNs / 2));
+  }
+}
+
+TEST_F(ChannelPlayerTest, play_as_fast_as_possible) {
+  executor::SimTimeExecutor sim_executor;
+  sim_executor.Initialize("player_fast_test", YAML::Node(YAML::NodeType::Null));
+  sim_executor.Start();
+
+  ChannelManager channel_manager;
+  channel_manager.RegisterGetExecutorFunc(
+      [&](std::string_view) -> executor::ExecutorBase* { return &sim_executor; });
+
+  std::vector<uint64_t> received_vec;
+  std::promise<void> done_promise;
+  channel_manager.Subscribe<uint64_t>(
+      "b", [&](const std::shared_ptr<const uint64_t>& msg, uint64_t) {
+        received_vec.emplace_back(*msg);
+        if (*msg == kMsgNum - 1) done_promise.set_value();
+      });
+
+  // Only channel 'b', from the second half on.
+  channel_manager.Initialize(YAML::Load(std::format(R"(
+player:
+  enable: true
+  file_path: {}
+  channels: [b]
+  rate: 0
+  start_offset_ms: {}
+  executor: player_fast_test
+)",
+                                                    file_path_,
+                                                    kMsgNum / 2 * kIntervalNs / 1000000)));
+  const auto start_tp = sim_executor.Now();
+  channel_manager.Start();
+
+  ASSERT_EQ(done_promise.get_future().wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  EXPECT_EQ(sim_executor.Now(), start_tp);
+  channel_manager.Shutdown();
+  sim_executor.Shutdown();
+
+  ASSERT_EQ(received_vec.size(), kMsgNum / 4);
+  for (uint64_t ii = 0; ii < received_vec.size(); ++ii) {
+    EXPECT_EQ(received_vec[ii], kMsgNum / 2 + 1 + ii * 2);
+  }
+}
+
+TEST_F(ChannelPlayerTest, seek_from_subscriber) {
+  executor::SimTimeExecutor sim_executor;
+  sim_executor.Initialize("player_seek_test", YAML::Node(YAML::NodeType::Null));
+  sim_executor.Start();
+
+  ChannelManager channel_manager;
+  channel_manager.RegisterGetExecutorFunc(
+      [&](std::string_view) -> executor::ExecutorBase* { return &sim_executor; });
+
+  // The first msg seeks to the second half, from the inline subscriber.
+  std::vector<uint64_t> received_vec;
+  std::promise<void> done_promise;
+  channel_manager.Subscribe<uint64_t>(
+      "a", [&](const std::shared_ptr<const uint64_t>& msg, uint64_t) {
+        received_vec.emplace_back(*msg);
+        if (*msg == 0) channel_manager.GetPlayer()->Seek(kBeginNs + kMsgNum / 2 * kIntervalNs);
+        if (*msg == kMsgNum - 2) done_promise.set_value();
+      });
+
+  channel_manager.Initialize(YAML::Load(std::format(R"(
+player:
+  enable: true
+  file_path: {}
+  channels: [a]
+  rate: 0
+  executor: player_seek_test
+)",
+                                                    file_path_)));
+  channel_manager.Start();
+
+  ASSERT_EQ(done_promise.get_future().wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  channel_manager.Shutdown();
+  sim_executor.Shutdown();
+
+  ASSERT_EQ(received_vec.size(), kMsgNum / 4 + 1);
+  EXPECT_EQ(received_vec[0], 0);
+  for (uint64_t ii = 1; ii < received_vec.size(); ++ii) {
+    EXPECT_EQ(received_vec[ii], kMsgNum / 2 + (ii - 1) * 2);
+  }
+}
+
+}  // namespace nxpilot::runtime::core::channel
@@ -0,0 +1,543 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/channel/channel_recorder.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <set>
+
+#include "runtime/core/configurator/options_checker.h"
+#include "runtime/core/executor/task_drop_guard.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::channel::ChannelRecorder::Options> {
+  using Options = nxpilot::runtime::core::channel::ChannelRecorder::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["enable"] = rhs.enable;
+    node["file_path"] = rhs.file_path;
+    node["channels"] = rhs.channels;
+    node["chunk_size_kb"] = rhs.chunk_size_kb;
+    node["prepare_chunk_num"] = rhs.prepare_chunk_num;
+    node["compression"] = rhs.compression;
+    node["executor"] = rhs.executor;
+    node["shutdown_timeout_ms"] = rhs.shutdown_timeout_ms;
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["enable"]) rhs.enable = node["enable"].as<bool>();
+    if (node["file_path"]) rhs.file_path = node["file_path"].as<std::string>();
+    if (node["channels"]) rhs.channels = node["channels"].as<std::vector<std::string>>();
+    if (node["chunk_size_kb"]) rhs.chunk_size_kb = node["chunk_size_kb"].as<uint32_t>();
+    if (node["prepare_chunk_num"])
+      rhs.prepare_chunk_num = node["prepare_chunk_num"].as<uint32_t>();
+    if (node["compression"]) rhs.compression = node["compression"].as<std::string>();
+    if (node["executor"]) rhs.executor = node["executor"].as<std::string>();
+    if (node["shutdown_timeout_ms"])
+      rhs.shutdown_timeout_ms = node["shutdown_timeout_ms"].as<uint32_t>();
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::channel {
+
+namespace {
+
+uint64_t AlignUp(uint64_t size, uint64_t align) { return (size + align - 1) / align * align; }
+
+uint64_t GetPageSize() {
+  static const uint64_t kPageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  return kPageSize;
+}
+
+}  // namespace
+
+ChannelRecorder::~ChannelRecorder() {
+  try {
+    Shutdown();
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("ChannelRecorder destruct get exception, {}", e.what());
+  }
+
+  // After a shutdown timeout, the late seals still use the slots and the file.
+  WaitPendingTasks(std::chrono::steady_clock::time_point::max());
+  if (fd_ >= 0) close(fd_);
+  fd_ = -1;
+}
+
+void ChannelRecorder::Initialize(YAML::Node options_node) {
+  auto err = configurator::CheckOptionsKeys(
+      options_node, {"enable", "file_path", "channels", "chunk_size_kb", "prepare_chunk_num",
+                     "compression", "executor", "shutdown_timeout_ms"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid recorder options, {}", err);
+
+  if (options_node && !options_node.IsNull()) {
+    options_ = options_node.as<Options>();
+  }
+
+  NXPILOT_CHECK_ERROR(!options_.file_path.empty(), "Recorder requires a 'file_path'.");
+  NXPILOT_CHECK_ERROR(!options_.channels.empty(), "Recorder requires some 'channels'.");
+  NXPILOT_CHECK_ERROR(
+      std::set<std::string>(options_.channels.begin(), options_.channels.end()).size() ==
+          options_.channels.size(),
+      "Duplicate channel in recorder options");
+  NXPILOT_CHECK_ERROR(options_.chunk_size_kb > 0, "Recorder 'chunk_size_kb' must be positive.");
+
+  NXPILOT_CHECK_ERROR(get_executor_func_, "ChannelRecorder requires a get executor func.");
+  executor_ptr_ = get_executor_func_(options_.executor);
+  NXPILOT_CHECK_ERROR(executor_ptr_ != nullptr && executor_ptr_->ThreadSafe(),
+                      "Invalid recorder executor '{}'", options_.executor);
+
+  if (options_.compression != "none") {
+    auto itr = std::ranges::find(codec_vec_, options_.compression, &RecordChunkCodec::name);
+    NXPILOT_CHECK_ERROR(itr != codec_vec_.end(), "Unknown recorder compression '{}'",
+                        options_.compression);
+    codec_ptr_ = &(*itr);
+  }
+
+  const auto channel_num = static_cast<uint32_t>(options_.channels.size());
+  chunk_size_ = AlignUp(static_cast<uint64_t>(options_.chunk_size_kb) * 1024, GetPageSize());
+  chunk_header_size_ = GetRecordChunkHeaderSize(channel_num);
+  NXPILOT_CHECK_ERROR(chunk_header_size_ * 2 <= chunk_size_,
+                      "Recorder 'chunk_size_kb' is too small for {} channels", channel_num);
+
+  channel_table_.clear();
+  for (const auto& channel : options_.channels) {
+    const auto size = static_cast<uint32_t>(channel.size());
+    channel_table_.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    channel_table_.append(channel);
+  }
+  data_offset_ = AlignUp(sizeof(RecordFileHeader) + channel_table_.size(), GetPageSize());
+
+  std::filesystem::path file_path(options_.file_path);
+  if (file_path.has_parent_path()) std::filesystem::create_directories(file_path.parent_path());
+
+  fd_ = ::open(options_.file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  NXPILOT_CHECK_ERROR(fd_ >= 0, "Open record file '{}' get error, {}", options_.file_path,
+                      strerror(errno));
+  WriteFileHeader(0, 0, 0, 0);
+
+  NXPILOT_INFO("ChannelRecorder init completed, record {} channels to '{}'", channel_num,
+               options_.file_path);
+}
+
+void ChannelRecorder::Start() {
+  Slot* slot = nullptr;
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+    slot = AcquireSlot();
+  }
+  MapSlot(slot);
+  AddPendingTask();
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+    unsealed_chunk_set_.emplace(slot->chunk_idx);
+  }
+  active_slot_.store(slot, std::memory_order_release);
+
+  for (uint32_t ii = 0; ii < options_.prepare_chunk_num; ++ii) {
+    PostBackgroundTask([this]() { PrepareSlot(); });
+  }
+
+  NXPILOT_INFO("ChannelRecorder start completed");
+}
+
+void ChannelRecorder::Shutdown() {
+  if (fd_ < 0) return;
+
+  Slot* slot = nullptr;
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+    if (closed_flag_) return;
+    slot = active_slot_.exchange(nullptr);
+  }
+  // Sealed once the publishers still writing into it are done, which the wait below covers, as
+  // it covers the slots rotated out before.
+  if (slot) ReleaseSlot(slot);
+
+  const bool sealed_flag = WaitPendingTasks(
+      (options_.shutdown_timeout_ms == 0)
+          ? std::chrono::steady_clock::time_point::max()
+          : std::chrono::steady_clock::now() +
+                std::chrono::milliseconds(options_.shutdown_timeout_ms));
+
+  std::string index;
+  uint64_t chunk_num = 0;
+  uint64_t begin_ns = 0;
+  uint64_t end_ns = 0;
+  std::string unsealed_chunks;
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+    closed_flag_ = true;
+    for (auto* prepared_slot : prepared_slot_queue_) {
+      munmap(prepared_slot->base, chunk_size_);
+      prepared_slot->base = nullptr;
+      free_slot_vec_.emplace_back(prepared_slot);
+    }
+    prepared_slot_queue_.clear();
+
+    // Chunks that failed to map or were never used are left zeroed in the index. After a timeout,
+    // so are the chunks still being written, sealed or prepared, and the index goes after all of
+    // them, so it is never written over and the file is not truncated under them.
+    for (auto chunk_idx : unsealed_chunk_set_) {
+      if (!unsealed_chunks.empty()) unsealed_chunks += ", ";
+      unsealed_chunks += std::to_string(chunk_idx);
+    }
+    if (sealed_flag) {
+      chunk_num = chunk_header_map_.empty() ? 0 : chunk_header_map_.rbegin()->first + 1;
+    } else {
+      chunk_num = next_chunk_idx_;
+    }
+    index.resize(chunk_num * chunk_header_size_);
+    for (const auto& [chunk_idx, header] : chunk_header_map_) {
+      std::memcpy(index.data() + chunk_idx * chunk_header_size_, header.data(), header.size());
+
+      RecordChunkHeader chunk_header;
+      std::memcpy(&chunk_header, header.data(), sizeof(chunk_header));
+      begin_ns =
+          (begin_ns == 0) ? chunk_header.begin_ns : std::min(begin_ns, chunk_header.begin_ns);
+      end_ns = std::max(end_ns, chunk_header.end_ns);
+    }
+  }
+
+  const uint64_t index_offset = data_offset_ + chunk_num * chunk_size_;
+  if (pwrite(fd_, index.data(), index.size(), index_offset) !=
+      static_cast<ssize_t>(index.size())) {
+    NXPILOT_ERROR("Write record index get error, {}", strerror(errno));
+  }
+  if (ftruncate(fd_, index_offset + index.size()) != 0) {
+    NXPILOT_ERROR("Truncate record file get error, {}", strerror(errno));
+  }
+  WriteFileHeader(chunk_num, index_offset, begin_ns, end_ns);
+  fdatasync(fd_);
+
+  if (sealed_flag) {
+    close(fd_);
+    fd_ = -1;
+  } else {
+    NXPILOT_ERROR(
+        "ChannelRecorder shutdown timeout after {} ms, chunks [{}] are not sealed and left out "
+        "of the index",
+        options_.shutdown_timeout_ms, unsealed_chunks);
+  }
+
+  const auto stats = GetStats();
+  NXPILOT_INFO(
+      "ChannelRecorder shutdown, {} records in {} chunks, {} sync prepares, {} dropped",
+      stats.record_num, stats.chunk_num, stats.sync_prepare_num, stats.dropped_num);
+}
+
+ChannelRecorder::Stats ChannelRecorder::GetStats() const {
+  Stats stats{.record_num = record_num_.load(),
+              .record_bytes = record_bytes_.load(),
+              .sync_prepare_num = sync_prepare_num_.load(),
+              .dropped_num = dropped_num_.load()};
+  std::lock_guard<std::mutex> lck(mutex_);
+  stats.chunk_num = chunk_header_map_.size();
+  return stats;
+}
+
+void ChannelRecorder::Record(uint32_t channel_id, const ChannelMessage& msg) noexcept {
+  if (msg.type_support == nullptr || channel_id >= options_.channels.size()) [[unlikely]] {
+    ++dropped_num_;
+    return;
+  }
+
+  thread_local std::string buffer;
+  buffer.clear();
+  try {
+    msg.type_support->serialize(msg.data.get(), buffer);
+  } catch (const std::exception& e) {
+    ++dropped_num_;
+    NXPILOT_ERROR("Serialize msg of channel '{}' get exception, {}", msg.channel, e.what());
+    return;
+  }
+
+  const uint64_t record_size = AlignRecordSize(sizeof(RecordHeader) + buffer.size());
+  if (record_size > chunk_size_ - chunk_header_size_) [[unlikely]] {
+    ++dropped_num_;
+    NXPILOT_ERROR("Msg of channel '{}' is too large to record, {} bytes", msg.channel,
+                  buffer.size());
+    return;
+  }
+
+  while (true) {
+    Slot* slot = active_slot_.load(std::memory_order_acquire);
+    if (slot == nullptr) [[unlikely]] {
+      ++dropped_num_;
+      return;
+    }
+
+    // Pin the slot, unless it is already sealing, then the active slot has moved on.
+    uint32_t ref_num = slot->ref_num.load(std::memory_order_acquire);
+    do {
+      if (ref_num == 0) break;
+    } while (!slot->ref_num.compare_exchange_weak(ref_num, ref_num + 1, std::memory_order_acq_rel));
+    if (ref_num == 0) continue;
+    if (active_slot_.load(std::memory_order_acquire) != slot) {
+      ReleaseSlot(slot);
+      continue;
+    }
+
+    const uint64_t offset = slot->reserved_size.fetch_add(record_size, std::memory_order_relaxed);
+    if (offset + record_size <= chunk_size_) [[likely]] {
+      RecordHeader header{.timestamp_ns = msg.timestamp_ns,
+                          .channel_id = channel_id,
+                          .size = static_cast<uint32_t>(buffer.size())};
+      std::memcpy(slot->base + offset, &header, sizeof(header));
+      std::memcpy(slot->base + offset + sizeof(header), buffer.data(), buffer.size());
+      ReleaseSlot(slot);
+
+      record_num_.fetch_add(1, std::memory_order_relaxed);
+      record_bytes_.fetch_add(buffer.size(), std::memory_order_relaxed);
+      return;
+    }
+
+    // Records that fit were all reserved below the first one that did not.
+    uint64_t used_size = slot->used_size.load(std::memory_order_relaxed);
+    while (offset < used_size &&
+           !slot->used_size.compare_exchange_weak(used_size, offset, std::memory_order_relaxed)) {
+    }
+    RotateSlot(slot);
+    ReleaseSlot(slot);
+  }
+}
+
+ChannelRecorder::Slot* ChannelRecorder::AcquireSlot() {
+  Slot* slot = nullptr;
+  if (free_slot_vec_.empty()) {
+    slot = slot_vec_.emplace_back(std::make_unique<Slot>()).get();
+  } else {
+    slot = free_slot_vec_.back();
+    free_slot_vec_.pop_back();
+  }
+
+  slot->chunk_idx = next_chunk_idx_++;
+  slot->reserved_size.store(chunk_header_size_, std::memory_order_relaxed);
+  slot->used_size.store(chunk_size_, std::memory_order_relaxed);
+  slot->ref_num.store(1, std::memory_order_release);
+  return slot;
+}
+
+void ChannelRecorder::MapSlot(Slot* slot) {
+  const uint64_t offset = data_offset_ + slot->chunk_idx * chunk_size_;
+
+  // Allocate the blocks now, a full disk must not turn into a SIGBUS on the publisher thread.
+  int ret = posix_fallocate(fd_, offset, chunk_size_);
+  NXPILOT_CHECK_ERROR(ret == 0, "Allocate record chunk {} get error, {}", slot->chunk_idx,
+                      strerror(ret));
+
+  void* addr = mmap(nullptr, chunk_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                    offset);
+  NXPILOT_CHECK_ERROR(addr != MAP_FAILED, "Map record chunk {} get error, {}", slot->chunk_idx,
+                      strerror(errno));
+  slot->base = static_cast<uint8_t*>(addr);
+}
+
+void ChannelRecorder::PrepareSlot() noexcept {
+  Slot* slot = nullptr;
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+    if (closed_flag_) return;
+    slot = AcquireSlot();
+  }
+
+  try {
+    MapSlot(slot);
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("{}", e.what());
+    std::lock_guard<std::mutex> lck(mutex_);
+    free_slot_vec_.emplace_back(slot);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lck(mutex_);
+  if (closed_flag_) {
+    munmap(slot->base, chunk_size_);
+    slot->base = nullptr;
+    free_slot_vec_.emplace_back(slot);
+    return;
+  }
+  prepared_slot_queue_.emplace_back(slot);
+}
+
+void ChannelRecorder::ReleaseSlot(Slot* slot) noexcept {
+  if (slot->ref_num.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    PostBackgroundTask([this, slot]() { SealSlot(slot); });
+    FinishPendingTask();
+  }
+}
+
+void ChannelRecorder::RotateSlot(Slot* slot) noexcept {
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+    if (active_slot_.load(std::memory_order_relaxed) != slot) return;
+    // Counted under the lock, so a 'Shutdown' that finds the next slot active waits for the
+    // release and the prepare below.
+    AddPendingTask();
+
+    Slot* next_slot = nullptr;
+    if (!prepared_slot_queue_.empty()) {
+      next_slot = prepared_slot_queue_.front();
+      prepared_slot_queue_.pop_front();
+    } else {
+      // Block the other publishers rather than drop their messages.
+      ++sync_prepare_num_;
+      next_slot = AcquireSlot();
+      try {
+        MapSlot(next_slot);
+      } catch (const std::exception& e) {
+        NXPILOT_ERROR("{}, stop recording", e.what());
+        free_slot_vec_.emplace_back(next_slot);
+        next_slot = nullptr;
+      }
+    }
+    if (next_slot) {
+      AddPendingTask();
+      unsealed_chunk_set_.emplace(next_slot->chunk_idx);
+    }
+    active_slot_.store(next_slot, std::memory_order_release);
+  }
+
+  // Drop the reference of the active state.
+  ReleaseSlot(slot);
+  PostBackgroundTask([this]() { PrepareSlot(); });
+  FinishPendingTask();
+}
+
+void ChannelRecorder::SealSlot(Slot* slot) noexcept {
+  const uint32_t channel_num = static_cast<uint32_t>(options_.channels.size());
+  const uint64_t used_size = std::min(slot->used_size.load(std::memory_order_relaxed),
+                                      slot->reserved_size.load(std::memory_order_relaxed));
+
+  RecordChunkHeader chunk_header;
+  std::vector<uint32_t> channel_record_num_vec(channel_num, 0);
+  for (uint64_t pos = chunk_header_size_; pos + sizeof(RecordHeader) <= used_size;) {
+    RecordHeader header;
+    std::memcpy(&header, slot->base + pos, sizeof(header));
+    pos += AlignRecordSize(sizeof(RecordHeader) + header.size);
+
+    ++channel_record_num_vec[header.channel_id];
+    chunk_header.begin_ns = (chunk_header.record_num == 0)
+                                ? header.timestamp_ns
+                                : std::min(chunk_header.begin_ns, header.timestamp_ns);
+    chunk_header.end_ns = std::max(chunk_header.end_ns, header.timestamp_ns);
+    ++chunk_header.record_num;
+  }
+  chunk_header.raw_size = used_size - chunk_header_size_;
+  chunk_header.stored_size = chunk_header.raw_size;
+
+  if (codec_ptr_ && chunk_header.record_num > 0) {
+    std::string compressed;
+    bool ret = false;
+    try {
+      ret = codec_ptr_->compress(
+          std::string_view(reinterpret_cast<const char*>(slot->base + chunk_header_size_),
+                           chunk_header.raw_size),
+          compressed);
+    } catch (const std::exception& e) {
+      NXPILOT_ERROR("Compress record chunk {} get exception, {}", slot->chunk_idx, e.what());
+    }
+    if (ret && compressed.size() < chunk_header.raw_size) {
+      std::memcpy(slot->base + chunk_header_size_, compressed.data(), compressed.size());
+      chunk_header.compressed = 1;
+      chunk_header.stored_size = compressed.size();
+    }
+  }
+
+  std::string header_buf;
+  if (chunk_header.record_num > 0) {
+    chunk_header.magic = kRecordChunkMagic;
+    header_buf.resize(chunk_header_size_);
+    std::memcpy(header_buf.data(), &chunk_header, sizeof(chunk_header));
+    std::memcpy(header_buf.data() + sizeof(chunk_header), channel_record_num_vec.data(),
+                sizeof(uint32_t) * channel_num);
+    std::memcpy(slot->base, header_buf.data(), header_buf.size());
+  }
+
+  munmap(slot->base, chunk_size_);
+  slot->base = nullptr;
+
+  // Give the unused tail of the slot back to the file system.
+  const uint64_t offset = data_offset_ + slot->chunk_idx * chunk_size_;
+  const uint64_t stored_end =
+      (chunk_header.record_num > 0)
+          ? AlignUp(chunk_header_size_ + chunk_header.stored_size, GetPageSize())
+          : 0;
+  if (stored_end < chunk_size_ &&
+      fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset + stored_end,
+                chunk_size_ - stored_end) != 0) {
+    NXPILOT_DEBUG("Punch hole in record chunk {} get error, {}", slot->chunk_idx,
+                  strerror(errno));
+  }
+
+  std::lock_guard<std::mutex> lck(mutex_);
+  if (!header_buf.empty()) chunk_header_map_.emplace(slot->chunk_idx, std::move(header_buf));
+  unsealed_chunk_set_.erase(slot->chunk_idx);
+  free_slot_vec_.emplace_back(slot);
+}
+
+void ChannelRecorder::PostBackgroundTask(std::function<void()>&& task) noexcept {
+  AddPendingTask();
+  auto run_task = [this, task{std::move(task)}]() {
+    task();
+    FinishPendingTask();
+  };
+  // A task the executor drops, e.g. on a full queue, runs inline instead. A chunk must still be
+  // sealed, and 'Shutdown' must not wait for a task that never comes.
+  executor_ptr_->Execute(nxpilot::runtime::core::executor::GuardDroppedTask(run_task, run_task));
+}
+
+bool ChannelRecorder::WaitPendingTasks(std::chrono::steady_clock::time_point deadline) {
+  std::unique_lock<std::mutex> lck(bg_mutex_);
+  if (deadline == std::chrono::steady_clock::time_point::max()) {
+    bg_cond_.wait(lck, [this] { return bg_task_num_ == 0; });
+    return true;
+  }
+  return bg_cond_.wait_until(lck, deadline, [this] { return bg_task_num_ == 0; });
+}
+
+void ChannelRecorder::AddPendingTask() noexcept {
+  std::lock_guard<std::mutex> lck(bg_mutex_);
+  ++bg_task_num_;
+}
+
+void ChannelRecorder::FinishPendingTask() noexcept {
+  std::lock_guard<std::mutex> lck(bg_mutex_);
+  if (--bg_task_num_ == 0) bg_cond_.notify_all();
+}
+
+void ChannelRecorder::WriteFileHeader(uint64_t chunk_num, uint64_t index_offset,
+                                      uint64_t begin_ns, uint64_t end_ns) {
+  RecordFileHeader header{.data_offset = data_offset_,
+                          .chunk_size = chunk_size_,
+                          .chunk_num = chunk_num,
+                          .index_offset = index_offset,
+                          .begin_ns = begin_ns,
+                          .end_ns = end_ns,
+                          .channel_num = static_cast<uint32_t>(options_.channels.size())};
+  if (codec_ptr_) {
+    std::strncpy(header.codec_name, codec_ptr_->name.c_str(), kRecordCodecNameSize - 1);
+  }
+
+  std::string buffer(reinterpret_cast<const char*>(&header), sizeof(header));
+  buffer.append(channel_table_);
+  NXPILOT_CHECK_ERROR(pwrite(fd_, buffer.data(), buffer.size(), 0) ==
+                          static_cast<ssize_t>(buffer.size()),
+                      "Write record file header get error, {}", strerror(errno));
+}
+
+}  // namespace nxpilot::runtime::core::channel
@@ -0,0 +1,166 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "runtime/core/channel/channel_manager.h"
+#include "runtime/core/channel/record_format.h"
+#include "runtime/core/executor/executor_base.h"
+#include "utils/common/log_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::channel {
+
+/**
+ * @brief Write the messages of selected channels into a chunked record file, see
+ * 'record_format.h'.
+ *
+ * Publishers serialize into a thread local buffer and copy it into the active chunk, a
+ * preallocated and prefaulted mmap'd slot of the file, after reserving space with an atomic add.
+ * No lock and no syscall is taken unless the chunk is full. The full chunk is then swapped for
+ * one prepared ahead, or, if none is ready, one prepared on the spot, so messages are never
+ * dropped for lack of space. Once its last writer leaves, the chunk is sealed on the background
+ * executor: indexed, compressed if a codec is set, and unmapped. The background executor also
+ * prepares the next chunks.
+ */
+class ChannelRecorder {
+ public:
+  struct Options {
+    bool enable = false;
+    std::string file_path;
+    std::vector<std::string> channels;
+    uint32_t chunk_size_kb = 4096;
+    // Chunks prepared ahead of the active one.
+    uint32_t prepare_chunk_num = 2;
+    std::string compression = "none";
+    std::string executor;
+    // How long 'Shutdown' waits for the chunks still being written or sealed, 0 waits without bound.
+    uint32_t shutdown_timeout_ms = 3000;
+  };
+
+  struct Stats {
+    uint64_t record_num = 0;
+    uint64_t record_bytes = 0;
+    uint64_t chunk_num = 0;
+    // Times a publisher had to prepare a chunk itself, raise 'prepare_chunk_num' if frequent.
+    uint64_t sync_prepare_num = 0;
+    // Messages too large for a chunk, not serializable, or published after shutdown.
+    uint64_t dropped_num = 0;
+  };
+
+  using GetExecutorFunc =
+      std::function<nxpilot::runtime::core::executor::ExecutorBase*(std::string_view)>;
+
+  ChannelRecorder() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~ChannelRecorder();
+
+  ChannelRecorder(const ChannelRecorder&) = delete;
+  ChannelRecorder& operator=(const ChannelRecorder&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  void RegisterGetExecutorFunc(GetExecutorFunc&& get_executor_func) {
+    get_executor_func_ = std::move(get_executor_func);
+  }
+  void RegisterChunkCodec(const RecordChunkCodec& codec) { codec_vec_.emplace_back(codec); }
+
+  // Create the file. The channel ids are the indices in 'channels'.
+  void Initialize(YAML::Node options_node);
+  void Start();
+  // Seal the active chunk, write the index and close the file. Waits for the background tasks up
+  // to 'shutdown_timeout_ms', the chunks not sealed by then are left out of the index and the file
+  // is only closed with the recorder.
+  void Shutdown();
+
+  const Options& GetOptions() const { return options_; }
+  Stats GetStats() const;
+
+  // Called on the publisher thread.
+  void Record(uint32_t channel_id, const ChannelMessage& msg) noexcept;
+
+ private:
+  struct Slot {
+    uint64_t chunk_idx = 0;
+    uint8_t* base = nullptr;
+    std::atomic_uint64_t reserved_size = 0;
+    // Size of the written records, lowered by the first reservation that did not fit.
+    std::atomic_uint64_t used_size = 0;
+    // Writers in the slot, plus one while the slot is active. The slot is sealed at 0.
+    std::atomic_uint32_t ref_num = 1;
+  };
+
+  // Wait for 'bg_task_num_' to reach 0, return false on timeout.
+  bool WaitPendingTasks(std::chrono::steady_clock::time_point deadline);
+  // Take a free slot and the next chunk index, called with 'mutex_' held.
+  Slot* AcquireSlot();
+  // Preallocate and map the chunk of the slot, throw on failure. A chunk that failed to map is
+  // left as a hole in the file.
+  void MapSlot(Slot* slot);
+  void PrepareSlot() noexcept;
+  void ReleaseSlot(Slot* slot) noexcept;
+  void RotateSlot(Slot* slot) noexcept;
+  void SealSlot(Slot* slot) noexcept;
+  void PostBackgroundTask(std::function<void()>&& task) noexcept;
+  // Count work 'Shutdown' must wait for, e.g. the seal of an active slot, which is only posted
+  // once its last writer leaves.
+  void AddPendingTask() noexcept;
+  void FinishPendingTask() noexcept;
+  void WriteFileHeader(uint64_t chunk_num, uint64_t index_offset, uint64_t begin_ns,
+                       uint64_t end_ns);
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  GetExecutorFunc get_executor_func_;
+  nxpilot::runtime::core::executor::ExecutorBase* executor_ptr_ = nullptr;
+  std::vector<RecordChunkCodec> codec_vec_;
+  const RecordChunkCodec* codec_ptr_ = nullptr;
+
+  int fd_ = -1;
+  uint64_t data_offset_ = 0;
+  uint64_t chunk_size_ = 0;
+  uint64_t chunk_header_size_ = 0;
+  std::string channel_table_;
+
+  // Slots are only freed with the recorder, so a publisher holding a stale pointer can still
+  // safely try to pin it.
+  std::atomic<Slot*> active_slot_ = nullptr;
+
+  // Guards the rotation, the slots and the chunk headers.
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Slot>> slot_vec_;
+  std::vector<Slot*> free_slot_vec_;
+  std::deque<Slot*> prepared_slot_queue_;
+  uint64_t next_chunk_idx_ = 0;
+  std::map<uint64_t, std::string> chunk_header_map_;
+  // Chunks made active and not sealed yet.
+  std::set<uint64_t> unsealed_chunk_set_;
+  // Set once the index is written, no chunk is prepared afterwards.
+  bool closed_flag_ = false;
+
+  std::mutex bg_mutex_;
+  std::condition_variable bg_cond_;
+  // Background tasks, plus the seals of the slots not released by all their writers yet.
+  uint32_t bg_task_num_ = 0;
+
+  std::atomic_uint64_t record_num_ = 0;
+  std::atomic_uint64_t record_bytes_ = 0;
+  std::atomic_uint64_t sync_prepare_num_ = 0;
+  std::atomic_uint64_t dropped_num_ = 0;
+};
+
+}  // namespace nxpilot::runtime::core::channel
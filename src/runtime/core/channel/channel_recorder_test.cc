@@ -0,0 +1,309 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/channel/channel_recorder.h"
+#include "runtime/core/executor/guard_thread_executor.h"
+
+namespace nxpilot::runtime::core::channel {
+
+namespace {
+
+constexpr uint32_t kThreadNum = 4;
+constexpr uint64_t kMsgNum = 2000;
+
+// Byte-level run length encoding, shrinks the mostly zero payloads of the test.
+RecordChunkCodec GetRleCodec() {
+  return RecordChunkCodec{
+      .name = "rle",
+      .compress =
+          [](std::string_view src, std::string& dst) {
+            for (size_t ii = 0; ii < src.size();) {
+              size_t jj = ii;
+              while (jj < src.size() && jj - ii < 255 && src[jj] == src[ii]) ++jj;
+              dst.push_back(static_cast<char>(jj - ii));
+              dst.push_back(src[ii]);
+              ii = jj;
+            }
+            return true;
+          },
+      .decompress =
+          [](std::string_view src, uint64_t raw_size, std::string& dst) {
+            for (size_t ii = 0; ii + 1 < src.size(); ii += 2) {
+              dst.append(static_cast<uint8_t>(src[ii]), src[ii + 1]);
+            }
+            return dst.size() == raw_size;
+          }};
+}
+
+// Drops every task, like a guard thread with a full queue.
+class DropExecutor : public executor::ExecutorBase {
+ public:
+  void Initialize(std::string_view name, YAML::Node options_node) override {}
+  void Start() override {}
+  void Shutdown() override {}
+  std::string_view Type() const noexcept override { return "drop"; }
+  std::string_view Name() const noexcept override { return "drop"; }
+  bool ThreadSafe() const noexcept override { return true; }
+  void Execute(Task&& task) noexcept override {}
+  bool SupportTimerSchedule() const noexcept override { return false; }
+  std::chrono::system_clock::time_point Now() const noexcept override { return {}; }
+  void ExecuteAt(std::chrono::system_clock::time_point tp, Task&& task) noexcept override {}
+};
+
+// A msg of channel 'a' or 'b' like 'RecordFromThreads' publishes.
+ChannelMessage MakeMsg(uint64_t value) {
+  return ChannelMessage{.channel = ((value % kMsgNum) % 2) ? "b" : "a",
+                        .timestamp_ns = value + 1,
+                        .type = typeid(uint64_t),
+                        .type_support = GetChannelTypeSupport<uint64_t>(),
+                        .data = std::make_shared<const uint64_t>(value)};
+}
+
+struct RecordedMsg {
+  uint64_t timestamp_ns;
+  uint32_t channel_id;
+  uint64_t value;
+};
+
+std::string ReadFile(const std::string& file_path) {
+  std::string buffer(std::filesystem::file_size(file_path), '\0');
+  int fd = open(file_path.c_str(), O_RDONLY);
+  EXPECT_EQ(pread(fd, buffer.data(), buffer.size(), 0), static_cast<ssize_t>(buffer.size()));
+  close(fd);
+  return buffer;
+}
+
+class ChannelRecorderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executor_.Initialize("recorder_bg_test", YAML::Node(YAML::NodeType::Null));
+    executor_.Start();
+    file_path_ = (std::filesystem::temp_directory_path() /
+                  ("nxpilot_recorder_test_" + std::to_string(getpid()) + ".rec"))
+                     .string();
+  }
+
+  void TearDown() override {
+    executor_.Shutdown();
+    std::filesystem::remove(file_path_);
+  }
+
+  void InitChannelManager(ChannelManager& channel_manager, std::string_view compression) {
+    channel_manager.RegisterGetExecutorFunc(
+        [this](std::string_view) -> executor::ExecutorBase* { return &executor_; });
+    channel_manager.RegisterRecordChunkCodec(GetRleCodec());
+    channel_manager.Initialize(YAML::Load(std::format(R"(
+recorder:
+  enable: true
+  file_path: {}
+  channels: [a, b]
+  chunk_size_kb: 4
+  prepare_chunk_num: 1
+  compression: {}
+  executor: recorder_bg_test
+)",
+                                                      file_path_, compression)));
+  }
+
+  void InitRecorder(ChannelRecorder& recorder, executor::ExecutorBase* executor_ptr) {
+    recorder.RegisterGetExecutorFunc(
+        [executor_ptr](std::string_view) -> executor::ExecutorBase* { return executor_ptr; });
+    recorder.Initialize(YAML::Load(std::format(R"(
+file_path: {}
+channels: [a, b]
+chunk_size_kb: 4
+prepare_chunk_num: 1
+)",
+                                               file_path_)));
+  }
+
+  // Publish 'kMsgNum' msgs per thread, spread over the two channels.
+  void RecordFromThreads(std::string_view compression) {
+    ChannelManager channel_manager;
+    InitChannelManager(channel_manager, compression);
+    channel_manager.Start();
+
+    std::vector<std::thread> thread_vec;
+    for (uint32_t tt = 0; tt < kThreadNum; ++tt) {
+      thread_vec.emplace_back([&, tt]() {
+        for (uint64_t ii = 0; ii < kMsgNum; ++ii) {
+          const uint64_t value = tt * kMsgNum + ii;
+          channel_manager.Publish<uint64_t>((ii % 2) ? "b" : "a",
+                                            std::make_shared<const uint64_t>(value), value + 1);
+        }
+      });
+    }
+    for (auto& thread : thread_vec) thread.join();
+
+    channel_manager.Shutdown();
+    stats_ = channel_manager.GetRecorder()->GetStats();
+  }
+
+  // Parse the file through its index.
+  std::vector<RecordedMsg> ParseFile() {
+    const std::string file = ReadFile(file_path_);
+    RecordFileHeader& header = file_header_;
+    std::memcpy(&header, file.data(), sizeof(header));
+    EXPECT_EQ(header.magic, kRecordFileMagic);
+    EXPECT_EQ(header.channel_num, 2);
+    EXPECT_NE(header.index_offset, 0);
+
+    const auto codec = GetRleCodec();
+    const uint64_t chunk_header_size = GetRecordChunkHeaderSize(header.channel_num);
+    std::vector<RecordedMsg> msg_vec;
+    for (uint64_t ii = 0; ii < header.chunk_num; ++ii) {
+      RecordChunkHeader index_entry;
+      std::memcpy(&index_entry, file.data() + header.index_offset + ii * chunk_header_size,
+                  sizeof(index_entry));
+      if (index_entry.magic != kRecordChunkMagic) continue;
+
+      const char* chunk = file.data() + header.data_offset + ii * header.chunk_size;
+      EXPECT_EQ(std::memcmp(chunk, &index_entry, sizeof(index_entry)), 0);
+
+      std::string records(chunk + chunk_header_size, index_entry.stored_size);
+      if (index_entry.compressed) {
+        std::string raw;
+        EXPECT_TRUE(codec.decompress(records, index_entry.raw_size, raw));
+        records.swap(raw);
+      }
+
+      uint32_t channel_record_num[2];
+      std::memcpy(channel_record_num, chunk + sizeof(RecordChunkHeader),
+                  sizeof(channel_record_num));
+      uint32_t channel_num_sum[2] = {0, 0};
+      for (size_t pos = 0; pos < records.size();) {
+        RecordHeader record;
+        std::memcpy(&record, records.data() + pos, sizeof(record));
+        EXPECT_EQ(record.size, sizeof(uint64_t));
+        uint64_t value;
+        std::memcpy(&value, records.data() + pos + sizeof(record), sizeof(value));
+        EXPECT_GE(record.timestamp_ns, index_entry.begin_ns);
+        EXPECT_LE(record.timestamp_ns, index_entry.end_ns);
+        msg_vec.emplace_back(RecordedMsg{record.timestamp_ns, record.channel_id, value});
+        ++channel_num_sum[record.channel_id];
+        pos += AlignRecordSize(sizeof(record) + record.size);
+      }
+      EXPECT_EQ(channel_num_sum[0], channel_record_num[0]);
+      EXPECT_EQ(channel_num_sum[1], channel_record_num[1]);
+    }
+    return msg_vec;
+  }
+
+  void CheckAllRecorded(const std::vector<RecordedMsg>& msg_vec) {
+    EXPECT_EQ(file_header_.begin_ns, 1);
+    EXPECT_EQ(file_header_.end_ns, kThreadNum * kMsgNum);
+    ASSERT_EQ(msg_vec.size(), kThreadNum * kMsgNum);
+    std::vector<bool> seen_vec(kThreadNum * kMsgNum, false);
+    for (const auto& msg : msg_vec) {
+      ASSERT_LT(msg.value, seen_vec.size());
+      EXPECT_FALSE(seen_vec[msg.value]);
+      seen_vec[msg.value] = true;
+      EXPECT_EQ(msg.timestamp_ns, msg.value + 1);
+      EXPECT_EQ(msg.channel_id, (msg.value % kMsgNum) % 2);
+    }
+  }
+
+  executor::GuardThreadExecutor executor_;
+  std::string file_path_;
+  ChannelRecorder::Stats stats_;
+  RecordFileHeader file_header_;
+};
+
+}  // namespace
+
+TEST_F(ChannelRecorderTest, record_from_threads) {
+  RecordFromThreads("none");
+
+  EXPECT_EQ(stats_.record_num, kThreadNum * kMsgNum);
+  EXPECT_EQ(stats_.dropped_num, 0);
+  EXPECT_GT(stats_.chunk_num, 10);
+
+  CheckAllRecorded(ParseFile());
+}
+
+TEST_F(ChannelRecorderTest, compression) {
+  RecordFromThreads("rle");
+  EXPECT_EQ(stats_.dropped_num, 0);
+  CheckAllRecorded(ParseFile());
+}
+
+TEST_F(ChannelRecorderTest, shutdown_while_recording) {
+  ChannelRecorder recorder;
+  InitRecorder(recorder, &executor_);
+  recorder.Start();
+
+  std::vector<std::thread> thread_vec;
+  for (uint32_t tt = 0; tt < kThreadNum; ++tt) {
+    thread_vec.emplace_back([&, tt]() {
+      for (uint64_t ii = 0; ii < kMsgNum; ++ii) recorder.Record(ii % 2, MakeMsg(tt * kMsgNum + ii));
+    });
+  }
+
+  // Shut down with the publishers in the middle of their msgs.
+  while (recorder.GetStats().record_num < kMsgNum) std::this_thread::yield();
+  recorder.Shutdown();
+  for (auto& thread : thread_vec) thread.join();
+
+  // A msg is either dropped or in a chunk of the index.
+  const auto stats = recorder.GetStats();
+  EXPECT_EQ(stats.record_num + stats.dropped_num, kThreadNum * kMsgNum);
+
+  const auto msg_vec = ParseFile();
+  ASSERT_EQ(msg_vec.size(), stats.record_num);
+  std::vector<bool> seen_vec(kThreadNum * kMsgNum, false);
+  for (const auto& msg : msg_vec) {
+    ASSERT_LT(msg.value, seen_vec.size());
+    EXPECT_FALSE(seen_vec[msg.value]);
+    seen_vec[msg.value] = true;
+    EXPECT_EQ(msg.timestamp_ns, msg.value + 1);
+    EXPECT_LE(msg.timestamp_ns, file_header_.end_ns);
+  }
+}
+
+TEST_F(ChannelRecorderTest, dropped_background_tasks) {
+  // The seals and prepares run inline instead, and 'Shutdown' does not wait for them.
+  DropExecutor drop_executor;
+  ChannelRecorder recorder;
+  InitRecorder(recorder, &drop_executor);
+  recorder.Start();
+
+  std::vector<std::thread> thread_vec;
+  for (uint32_t tt = 0; tt < kThreadNum; ++tt) {
+    thread_vec.emplace_back([&, tt]() {
+      for (uint64_t ii = 0; ii < kMsgNum; ++ii) recorder.Record(ii % 2, MakeMsg(tt * kMsgNum + ii));
+    });
+  }
+  for (auto& thread : thread_vec) thread.join();
+  recorder.Shutdown();
+
+  const auto stats = recorder.GetStats();
+  EXPECT_EQ(stats.record_num, kThreadNum * kMsgNum);
+  EXPECT_EQ(stats.dropped_num, 0);
+  CheckAllRecorded(ParseFile());
+}
+
+TEST_F(ChannelRecorderTest, invalid_options) {
+  ChannelRecorder recorder;
+  recorder.RegisterGetExecutorFunc(
+      [this](std::string_view) -> executor::ExecutorBase* { return &executor_; });
+  EXPECT_THROW(recorder.Initialize(YAML::Load(std::format(R"(
+file_path: {}
+channels: [a]
+compression: zstd
+)",
+                                                          file_path_))),
+               std::exception);
+}
+
+}  // namespace nxpilot::runtime::core::channel
@@ -0,0 +1,90 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/channel/channel_synchronizer.h"
+
+#include <algorithm>
+
+namespace nxpilot::runtime::core::channel {
+
+ChannelSynchronizer::ChannelSynchronizer(size_t channel_num, const SyncOptions& options,
+                                         RawSyncCallback&& callback)
+    : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()),
+      options_(options),
+      callback_(std::move(callback)),
+      queue_vec_(channel_num) {
+  NXPILOT_CHECK_ERROR(channel_num >= 2, "Synchronizer requires at least 2 channels");
+  NXPILOT_CHECK_ERROR(options_.queue_size > 0, "Synchronizer 'queue_size' must be positive");
+  NXPILOT_CHECK_ERROR(options_.executor == nullptr || options_.executor->ThreadSafe(),
+                      "Synchronizer executor is not thread safe");
+
+  for (auto& queue : queue_vec_) queue.buffer.resize(options_.queue_size);
+}
+
+void ChannelSynchronizer::Add(size_t idx, const ChannelMessage& msg) {
+  std::vector<std::vector<ChannelMessage>> tuple_vec;
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+
+    auto& queue = queue_vec_[idx];
+    if (msg.timestamp_ns < queue.last_ns) [[unlikely]] {
+      ++dropped_num_;
+      return;
+    }
+    queue.last_ns = msg.timestamp_ns;
+
+    if (queue.size == queue.buffer.size()) {
+      queue.Pop();
+      ++dropped_num_;
+    }
+    queue.At(queue.size++) = msg;
+
+    std::vector<ChannelMessage> tuple;
+    while (MatchLocked(tuple)) tuple_vec.emplace_back(std::move(tuple));
+  }
+
+  for (auto& tuple : tuple_vec) Emit(std::move(tuple));
+}
+
+bool ChannelSynchronizer::MatchLocked(std::vector<ChannelMessage>& tuple) {
+  while (true) {
+    uint64_t pivot_ns = 0;
+    for (const auto& queue : queue_vec_) {
+      if (queue.size == 0) return false;
+      pivot_ns = std::max(pivot_ns, queue.buffer[queue.head].timestamp_ns);
+    }
+
+    // Later messages of the pivot channel are even later, so heads out of tolerance can not be
+    // matched anymore. A head followed by a message not later than the pivot is a worse match.
+    bool dropped = false;
+    for (auto& queue : queue_vec_) {
+      while (queue.size > 0 && (queue.At(0).timestamp_ns + options_.tolerance_ns < pivot_ns ||
+                                (queue.size > 1 && queue.At(1).timestamp_ns <= pivot_ns))) {
+        queue.Pop();
+        ++dropped_num_;
+        dropped = true;
+      }
+    }
+    if (!dropped) break;
+  }
+
+  tuple.clear();
+  tuple.reserve(queue_vec_.size());
+  for (auto& queue : queue_vec_) tuple.emplace_back(queue.Pop());
+  ++matched_num_;
+  return true;
+}
+
+void ChannelSynchronizer::Emit(std::vector<ChannelMessage>&& tuple) noexcept {
+  if (options_.executor) {
+    options_.executor->Execute([this, tuple{std::move(tuple)}]() { callback_(tuple); });
+    return;
+  }
+
+  try {
+    callback_(tuple);
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("Synchronizer callback get exception, {}", e.what());
+  }
+}
+
+}  // namespace nxpilot::runtime::core::channel
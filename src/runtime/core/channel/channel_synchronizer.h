@@ -0,0 +1,76 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "runtime/core/channel/channel_manager.h"
+#include "utils/common/log_tool.h"
+
+namespace nxpilot::runtime::core::channel {
+
+/**
+ * @brief Match messages of several channels by timestamp.
+ *
+ * Each channel has a ring buffer of 'queue_size' messages, the oldest message is dropped when it
+ * is full. Whenever all channels have a message, the latest of their oldest messages is the pivot:
+ * older messages that are out of tolerance of the pivot can not be matched anymore and are
+ * dropped, and of the messages not later than the pivot only the latest is kept. What remains at
+ * the heads is a tuple whose timestamps are within the tolerance, it is emitted and popped.
+ * Messages are shared, never copied. Messages of a channel must arrive in timestamp order, late
+ * ones are dropped.
+ */
+class ChannelSynchronizer {
+ public:
+  ChannelSynchronizer(size_t channel_num, const SyncOptions& options, RawSyncCallback&& callback);
+
+  ChannelSynchronizer(const ChannelSynchronizer&) = delete;
+  ChannelSynchronizer& operator=(const ChannelSynchronizer&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  // Add a message of the 'idx'th channel. Thread safe, matched tuples are emitted on the executor
+  // of the options, or inline after the internal lock is released.
+  void Add(size_t idx, const ChannelMessage& msg);
+
+  uint64_t GetMatchedNum() const { return matched_num_.load(); }
+  uint64_t GetDroppedNum() const { return dropped_num_.load(); }
+
+ private:
+  struct Queue {
+    std::vector<ChannelMessage> buffer;
+    size_t head = 0;
+    size_t size = 0;
+    uint64_t last_ns = 0;
+
+    ChannelMessage& At(size_t ii) { return buffer[(head + ii) % buffer.size()]; }
+    ChannelMessage Pop() {
+      ChannelMessage msg = std::move(At(0));
+      head = (head + 1) % buffer.size();
+      --size;
+      return msg;
+    }
+  };
+
+  bool MatchLocked(std::vector<ChannelMessage>& tuple);
+  void Emit(std::vector<ChannelMessage>&& tuple) noexcept;
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  SyncOptions options_;
+  RawSyncCallback callback_;
+
+  std::mutex mutex_;
+  std::vector<Queue> queue_vec_;
+
+  std::atomic_uint64_t matched_num_ = 0;
+  std::atomic_uint64_t dropped_num_ = 0;
+};
+
+}  // namespace nxpilot::runtime::core::channel
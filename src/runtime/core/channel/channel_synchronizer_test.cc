@@ -0,0 +1,113 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <future>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/channel/channel_synchronizer.h"
+#include "runtime/core/executor/guard_thread_executor.h"
+
+namespace nxpilot::runtime::core::channel {
+
+namespace {
+
+ChannelMessage MakeMsg(uint64_t timestamp_ns) {
+  return ChannelMessage{.timestamp_ns = timestamp_ns,
+                        .type = typeid(uint64_t),
+                        .data = std::make_shared<const uint64_t>(timestamp_ns)};
+}
+
+}  // namespace
+
+TEST(ChannelSynchronizerTest, approximate_match) {
+  std::vector<std::pair<uint64_t, uint64_t>> tuple_vec;
+  ChannelSynchronizer synchronizer(2, SyncOptions{.tolerance_ns = 10},
+                                   [&](const std::vector<ChannelMessage>& msg_vec) {
+                                     ASSERT_EQ(msg_vec.size(), 2);
+                                     tuple_vec.emplace_back(msg_vec[0].timestamp_ns,
+                                                            msg_vec[1].timestamp_ns);
+                                   });
+
+  synchronizer.Add(0, MakeMsg(100));
+  // Out of tolerance of 100, and later messages of channel 0 are even later.
+  synchronizer.Add(1, MakeMsg(85));
+  synchronizer.Add(1, MakeMsg(95));
+  synchronizer.Add(1, MakeMsg(105));
+  synchronizer.Add(1, MakeMsg(108));
+  // 108 is a better match than 105.
+  synchronizer.Add(0, MakeMsg(110));
+  // Out of order.
+  synchronizer.Add(0, MakeMsg(90));
+
+  EXPECT_EQ(tuple_vec, (std::vector<std::pair<uint64_t, uint64_t>>{{100, 95}, {110, 108}}));
+  EXPECT_EQ(synchronizer.GetMatchedNum(), 2);
+  EXPECT_EQ(synchronizer.GetDroppedNum(), 3);
+}
+
+TEST(ChannelSynchronizerTest, bounded_queue) {
+  std::vector<uint64_t> matched_vec;
+  ChannelSynchronizer synchronizer(
+      3, SyncOptions{.queue_size = 4}, [&](const std::vector<ChannelMessage>& msg_vec) {
+        ASSERT_EQ(msg_vec.size(), 3);
+        for (const auto& msg : msg_vec) EXPECT_EQ(msg.timestamp_ns, msg_vec[0].timestamp_ns);
+        matched_vec.emplace_back(msg_vec[0].timestamp_ns);
+      });
+
+  for (uint64_t ii = 0; ii < 10; ++ii) synchronizer.Add(0, MakeMsg(ii));
+  EXPECT_EQ(synchronizer.GetDroppedNum(), 6);
+
+  synchronizer.Add(1, MakeMsg(7));
+  synchronizer.Add(2, MakeMsg(5));
+  synchronizer.Add(2, MakeMsg(7));
+  EXPECT_EQ(matched_vec, (std::vector<uint64_t>{7}));
+
+  EXPECT_THROW(ChannelSynchronizer(1, SyncOptions{}, [](const auto&) {}), std::exception);
+}
+
+TEST(ChannelSynchronizerTest, subscribe_synced) {
+  executor::GuardThreadExecutor executor;
+  executor.Initialize("channel_sync_test", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+
+  ChannelManager channel_manager;
+  std::vector<std::pair<const int*, const double*>> tuple_vec;
+  std::promise<void> done_promise;
+  const auto* synchronizer_ptr = channel_manager.SubscribeSynced<int, double>(
+      {"a", "b"},
+      [&](const std::shared_ptr<const int>& a, const std::shared_ptr<const double>& b) {
+        tuple_vec.emplace_back(a.get(), b.get());
+        if (tuple_vec.size() == 2) done_promise.set_value();
+      },
+      SyncOptions{.executor = &executor});
+  // Channel 'b' is already of another type.
+  EXPECT_THROW(
+      (channel_manager.SubscribeSynced<int, int>({"a", "b"}, [](const auto&, const auto&) {})),
+      std::exception);
+
+  channel_manager.Initialize(YAML::Node());
+  channel_manager.Start();
+
+  auto a1 = std::make_shared<const int>(1);
+  auto a2 = std::make_shared<const int>(2);
+  auto b1 = std::make_shared<const double>(1.0);
+  auto b2 = std::make_shared<const double>(2.0);
+  channel_manager.Publish<int>("a", a1, 100);
+  channel_manager.Publish<double>("b", b1, 100);
+  channel_manager.Publish<int>("a", a2, 200);
+  channel_manager.Publish<double>("b", std::make_shared<const double>(0.0), 150);
+  channel_manager.Publish<double>("b", b2, 200);
+
+  // Tuples share the published messages.
+  done_promise.get_future().get();
+  EXPECT_EQ(tuple_vec, (std::vector<std::pair<const int*, const double*>>{{a1.get(), b1.get()},
+                                                                          {a2.get(), b2.get()}}));
+  EXPECT_EQ(synchronizer_ptr->GetMatchedNum(), 2);
+  EXPECT_EQ(synchronizer_ptr->GetDroppedNum(), 1);
+
+  channel_manager.Shutdown();
+  executor.Shutdown();
+}
+
+}  // namespace nxpilot::runtime::core::channel
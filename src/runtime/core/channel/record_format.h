@@ -0,0 +1,91 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace nxpilot::runtime::core::channel {
+
+/**
+ * @brief On-disk layout of a channel record file.
+ *
+ * | file header + channel table | chunk slot 0 | chunk slot 1 | ... | chunk index |
+ *
+ * The header region and every chunk slot are page aligned, slots all have the size
+ * 'chunk_size', so chunk 'i' starts at 'data_offset + i * chunk_size'. A slot starts with a chunk
+ * header followed by the per-channel record counts, then the records:
+ *
+ * | timestamp_ns u64 | channel_id u32 | size u32 | payload | padding to 8 bytes |
+ *
+ * Records are stored in the order they were written, which may differ slightly from timestamp
+ * order when several threads publish at once. If the file has a codec, the records of a chunk
+ * may be stored compressed. The chunk index is a copy of all chunk headers, written on close. A
+ * file whose 'index_offset' is 0 was not closed, its sealed chunks can still be found by their
+ * magic.
+ */
+constexpr uint32_t kRecordFileMagic = 0x4352584e;  // "NXRC"
+constexpr uint32_t kRecordFileVersion = 1;
+constexpr uint32_t kRecordChunkMagic = 0x4b4e4843;  // "CHNK"
+constexpr size_t kRecordCodecNameSize = 16;
+
+struct RecordFileHeader {
+  uint32_t magic = kRecordFileMagic;
+  uint32_t version = kRecordFileVersion;
+  uint64_t data_offset = 0;
+  uint64_t chunk_size = 0;
+  uint64_t chunk_num = 0;     // written on close
+  uint64_t index_offset = 0;  // written on close
+  uint64_t begin_ns = 0;
+  uint64_t end_ns = 0;
+  uint32_t channel_num = 0;
+  uint32_t reserved = 0;
+  char codec_name[kRecordCodecNameSize] = {};
+  // Followed by 'channel_num' entries of | name size u32 | name |.
+};
+
+struct RecordChunkHeader {
+  uint32_t magic = 0;  // 'kRecordChunkMagic' once the chunk is sealed
+  uint32_t compressed = 0;
+  uint64_t raw_size = 0;
+  uint64_t stored_size = 0;
+  uint64_t record_num = 0;
+  uint64_t begin_ns = 0;
+  uint64_t end_ns = 0;
+  // Followed by 'channel_num' record counts of u32.
+};
+
+struct RecordHeader {
+  uint64_t timestamp_ns;
+  uint32_t channel_id;
+  uint32_t size;
+};
+
+static_assert(sizeof(RecordFileHeader) == 80);
+static_assert(sizeof(RecordChunkHeader) == 48);
+static_assert(sizeof(RecordHeader) == 16);
+
+constexpr uint64_t AlignRecordSize(uint64_t size) { return (size + 7) & ~uint64_t(7); }
+
+// Size of the chunk header with its channel counts, the records start right after.
+constexpr uint64_t GetRecordChunkHeaderSize(uint32_t channel_num) {
+  return AlignRecordSize(sizeof(RecordChunkHeader) + sizeof(uint32_t) * channel_num);
+}
+
+/**
+ * @brief Compression of the records of a chunk.
+ *
+ * Codecs are registered by name, the name is stored in the file header so that the reader picks
+ * the same one. Chunks that do not shrink are stored uncompressed.
+ */
+struct RecordChunkCodec {
+  std::string name;
+  // Append the compressed 'src' to 'dst', return false on failure.
+  std::function<bool(std::string_view src, std::string& dst)> compress;
+  // Append the decompressed 'src' to 'dst', whose size is known to be 'raw_size'.
+  std::function<bool(std::string_view src, uint64_t raw_size, std::string& dst)> decompress;
+};
+
+}  // namespace nxpilot::runtime::core::channel
@@ -0,0 +1,198 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/channel/record_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace nxpilot::runtime::core::channel {
+
+void RecordReader::Open(const std::string& file_path,
+                        const std::vector<RecordChunkCodec>& codec_vec) {
+  Close();
+  file_path_ = file_path;
+
+  int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  NXPILOT_CHECK_ERROR(fd >= 0, "Open record file '{}' get error, {}", file_path, strerror(errno));
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || static_cast<uint64_t>(file_stat.st_size) <
+                                        sizeof(RecordFileHeader)) {
+    close(fd);
+    NXPILOT_CHECK_ERROR(false, "Invalid record file '{}'", file_path);
+  }
+  file_size_ = file_stat.st_size;
+
+  void* addr = mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  NXPILOT_CHECK_ERROR(addr != MAP_FAILED, "Map record file '{}' get error, {}", file_path,
+                      strerror(errno));
+  base_ = static_cast<uint8_t*>(addr);
+
+  std::memcpy(&file_header_, base_, sizeof(file_header_));
+  NXPILOT_CHECK_ERROR(file_header_.magic == kRecordFileMagic &&
+                          file_header_.version == kRecordFileVersion &&
+                          file_header_.data_offset <= file_size_ && file_header_.chunk_size > 0,
+                      "Invalid record file '{}'", file_path);
+  chunk_header_size_ = GetRecordChunkHeaderSize(file_header_.channel_num);
+
+  uint64_t pos = sizeof(RecordFileHeader);
+  for (uint32_t ii = 0; ii < file_header_.channel_num; ++ii) {
+    uint32_t size = 0;
+    NXPILOT_CHECK_ERROR(pos + sizeof(size) <= file_header_.data_offset,
+                        "Invalid channel table in record file '{}'", file_path);
+    std::memcpy(&size, base_ + pos, sizeof(size));
+    pos += sizeof(size);
+    NXPILOT_CHECK_ERROR(pos + size <= file_header_.data_offset,
+                        "Invalid channel table in record file '{}'", file_path);
+    channel_vec_.emplace_back(reinterpret_cast<const char*>(base_ + pos), size);
+    pos += size;
+  }
+
+  std::string codec_name(file_header_.codec_name,
+                         strnlen(file_header_.codec_name, kRecordCodecNameSize));
+  if (!codec_name.empty()) {
+    auto itr = std::ranges::find(codec_vec, codec_name, &RecordChunkCodec::name);
+    NXPILOT_CHECK_ERROR(itr != codec_vec.end(), "Record file '{}' requires codec '{}'", file_path,
+                        codec_name);
+    codec_ = *itr;
+  }
+
+  // The chunks of a closed file end where its index begins.
+  if (file_header_.index_offset >= file_header_.data_offset &&
+      file_header_.index_offset <= file_size_ &&
+      file_header_.chunk_num <= (file_size_ - file_header_.index_offset) / chunk_header_size_) {
+    for (uint64_t ii = 0; ii < file_header_.chunk_num; ++ii) {
+      AddChunk(file_header_.data_offset + ii * file_header_.chunk_size,
+               base_ + file_header_.index_offset + ii * chunk_header_size_,
+               file_header_.index_offset);
+    }
+  } else {
+    NXPILOT_WARN("Record file '{}' was not closed, scan its chunks", file_path);
+    for (uint64_t offset = file_header_.data_offset;
+         offset + file_header_.chunk_size <= file_size_; offset += file_header_.chunk_size) {
+      AddChunk(offset, base_ + offset, file_size_);
+    }
+  }
+
+  std::ranges::stable_sort(chunk_vec_, {}, [](const Chunk& chunk) {
+    return chunk.header.begin_ns;
+  });
+  uint64_t max_end_ns = 0;
+  for (auto& chunk : chunk_vec_) {
+    max_end_ns = std::max(max_end_ns, chunk.header.end_ns);
+    chunk.max_end_ns = max_end_ns;
+    record_num_ += chunk.header.record_num;
+  }
+  if (!chunk_vec_.empty()) {
+    begin_ns_ = chunk_vec_.front().header.begin_ns;
+    end_ns_ = max_end_ns;
+  }
+
+  // Playback reads the chunks mostly in order.
+  madvise(base_, file_size_, MADV_SEQUENTIAL);
+
+  NXPILOT_INFO("Record file '{}' opened, {} channels, {} chunks, {} records", file_path,
+               channel_vec_.size(), chunk_vec_.size(), record_num_);
+}
+
+void RecordReader::Close() {
+  if (base_ != nullptr) {
+    munmap(base_, file_size_);
+    base_ = nullptr;
+  }
+  file_size_ = 0;
+  codec_ = RecordChunkCodec();
+  channel_vec_.clear();
+  chunk_vec_.clear();
+  begin_ns_ = 0;
+  end_ns_ = 0;
+  record_num_ = 0;
+}
+
+void RecordReader::AddChunk(uint64_t offset, const uint8_t* header_ptr, uint64_t data_end) {
+  Chunk chunk{.offset = offset};
+  std::memcpy(&chunk.header, header_ptr, sizeof(chunk.header));
+  if (chunk.header.magic != kRecordChunkMagic || chunk.header.record_num == 0) return;
+  if (chunk_header_size_ + chunk.header.stored_size > file_header_.chunk_size ||
+      offset > data_end || data_end - offset < chunk_header_size_ + chunk.header.stored_size) {
+    NXPILOT_WARN("Skip corrupted chunk at offset {} of record file '{}'", offset, file_path_);
+    return;
+  }
+
+  chunk.channel_record_num = reinterpret_cast<const uint32_t*>(header_ptr + sizeof(chunk.header));
+  chunk_vec_.emplace_back(chunk);
+}
+
+uint32_t RecordReader::GetChunkRecordNum(size_t idx, uint32_t channel_id) const {
+  if (channel_id >= channel_vec_.size()) return 0;
+  return chunk_vec_[idx].channel_record_num[channel_id];
+}
+
+size_t RecordReader::Seek(uint64_t timestamp_ns) const {
+  auto itr = std::ranges::lower_bound(chunk_vec_, timestamp_ns, {}, &Chunk::max_end_ns);
+  return static_cast<size_t>(itr - chunk_vec_.begin());
+}
+
+bool RecordReader::ReadChunk(size_t idx, std::vector<Record>& record_vec,
+                             std::string& buffer) const {
+  record_vec.clear();
+  const auto& chunk = chunk_vec_[idx];
+  std::string_view records(reinterpret_cast<const char*>(base_ + chunk.offset + chunk_header_size_),
+                           chunk.header.stored_size);
+
+  if (chunk.header.compressed) {
+    buffer.clear();
+    bool ret = false;
+    if (codec_.decompress) {
+      try {
+        ret = codec_.decompress(records, chunk.header.raw_size, buffer);
+      } catch (const std::exception& e) {
+        NXPILOT_ERROR("Decompress record chunk get exception, {}", e.what());
+      }
+    }
+    if (!ret || buffer.size() != chunk.header.raw_size) {
+      NXPILOT_ERROR("Decompress chunk at offset {} of record file '{}' failed", chunk.offset,
+                    file_path_);
+      return false;
+    }
+    records = buffer;
+  }
+
+  record_vec.reserve(chunk.header.record_num);
+  for (size_t pos = 0; pos + sizeof(RecordHeader) <= records.size();) {
+    RecordHeader header;
+    std::memcpy(&header, records.data() + pos, sizeof(header));
+    if (pos + sizeof(header) + header.size > records.size() ||
+        header.channel_id >= channel_vec_.size()) {
+      NXPILOT_ERROR("Corrupted record in chunk at offset {} of record file '{}'", chunk.offset,
+                    file_path_);
+      return false;
+    }
+    record_vec.emplace_back(Record{.timestamp_ns = header.timestamp_ns,
+                                   .channel_id = header.channel_id,
+                                   .payload = records.substr(pos + sizeof(header), header.size)});
+    pos += AlignRecordSize(sizeof(header) + header.size);
+  }
+
+  // Concurrent publishers may have written the records slightly out of order.
+  std::ranges::stable_sort(record_vec, {}, &Record::timestamp_ns);
+  return true;
+}
+
+void RecordReader::Prefetch(size_t begin_idx, size_t num) const {
+  const uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  for (size_t ii = begin_idx; ii < std::min(begin_idx + num, chunk_vec_.size()); ++ii) {
+    const auto& chunk = chunk_vec_[ii];
+    const uint64_t size = chunk_header_size_ + chunk.header.stored_size;
+    // Chunks are page aligned.
+    madvise(base_ + chunk.offset, (size + page_size - 1) / page_size * page_size, MADV_WILLNEED);
+  }
+}
+
+}  // namespace nxpilot::runtime::core::channel
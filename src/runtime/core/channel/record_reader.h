@@ -0,0 +1,96 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "runtime/core/channel/record_format.h"
+#include "utils/common/log_tool.h"
+
+namespace nxpilot::runtime::core::channel {
+
+/**
+ * @brief Read a record file written by 'ChannelRecorder' through a read-only mapping of the whole
+ * file.
+ *
+ * The chunks are ordered by their begin time, which is the write order except around a chunk a
+ * publisher had to prepare itself. Files that were not closed have no index, their sealed chunks
+ * are found by scanning the chunk headers instead.
+ */
+class RecordReader {
+ public:
+  struct Record {
+    uint64_t timestamp_ns;
+    uint32_t channel_id;
+    std::string_view payload;
+  };
+
+  RecordReader() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~RecordReader() { Close(); }
+
+  RecordReader(const RecordReader&) = delete;
+  RecordReader& operator=(const RecordReader&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  // Throw if the file is not a valid record file, or its codec is not in 'codec_vec'.
+  void Open(const std::string& file_path, const std::vector<RecordChunkCodec>& codec_vec = {});
+  void Close();
+
+  // Channel names, indexed by channel id.
+  const std::vector<std::string>& GetChannels() const { return channel_vec_; }
+  uint64_t GetBeginNs() const { return begin_ns_; }
+  uint64_t GetEndNs() const { return end_ns_; }
+  uint64_t GetRecordNum() const { return record_num_; }
+
+  size_t GetChunkNum() const { return chunk_vec_.size(); }
+  const RecordChunkHeader& GetChunkHeader(size_t idx) const { return chunk_vec_[idx].header; }
+  uint32_t GetChunkRecordNum(size_t idx, uint32_t channel_id) const;
+
+  // Index of the first chunk that may hold records at or after 'timestamp_ns', 'GetChunkNum()' if
+  // there is none. O(log n) in the number of chunks.
+  size_t Seek(uint64_t timestamp_ns) const;
+
+  // Records of a chunk in timestamp order. Payloads point into the mapping, or into 'buffer' if
+  // the chunk is compressed. Return false if the chunk is corrupted.
+  bool ReadChunk(size_t idx, std::vector<Record>& record_vec, std::string& buffer) const;
+
+  // Let the kernel read the chunks '[begin_idx, begin_idx + num)' ahead, without waiting.
+  void Prefetch(size_t begin_idx, size_t num) const;
+
+ private:
+  struct Chunk {
+    uint64_t offset;
+    RecordChunkHeader header;
+    const uint32_t* channel_record_num;
+    // Max end time of this chunk and all chunks before it, the key of 'Seek'.
+    uint64_t max_end_ns;
+  };
+
+  // Skip the chunk if its data does not end before 'data_end'.
+  void AddChunk(uint64_t offset, const uint8_t* header_ptr, uint64_t data_end);
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  std::string file_path_;
+  RecordChunkCodec codec_;  // no name if the file is not compressed
+
+  uint8_t* base_ = nullptr;
+  uint64_t file_size_ = 0;
+  RecordFileHeader file_header_;
+  uint64_t chunk_header_size_ = 0;
+
+  std::vector<std::string> channel_vec_;
+  std::vector<Chunk> chunk_vec_;
+  uint64_t begin_ns_ = 0;
+  uint64_t end_ns_ = 0;
+  uint64_t record_num_ = 0;
+};
+
+}  // namespace nxpilot::runtime::core::channel
@@ -0,0 +1,125 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/configurator/config_loader.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "utils/common/exception.h"
+
+namespace nxpilot::runtime::core::configurator {
+
+namespace {
+
+constexpr std::string_view kIncludeKey = "include";
+
+bool IsNamedMapSequence(const YAML::Node& node) {
+  return node.IsSequence() && std::ranges::all_of(node, [](const YAML::Node& item) {
+           return item.IsMap() && item["name"] && item["name"].IsScalar();
+         });
+}
+
+YAML::Node LoadFileImpl(const std::filesystem::path& file_path,
+                        std::vector<std::filesystem::path>& include_stack,
+                        std::vector<std::filesystem::path>* source_file_vec) {
+  AIMRT_ASSERT(std::filesystem::exists(file_path), "Config file '{}' does not exist",
+               file_path.string());
+  auto canonical_path = std::filesystem::canonical(file_path);
+
+  AIMRT_ASSERT(std::ranges::find(include_stack, canonical_path) == include_stack.end(),
+               "Config file '{}' includes itself", canonical_path.string());
+
+  YAML::Node file_node = YAML::LoadFile(canonical_path.string());
+  if (source_file_vec) source_file_vec->emplace_back(canonical_path);
+
+  if (!file_node.IsMap() || !file_node[kIncludeKey]) return file_node;
+
+  YAML::Node include_node = file_node[kIncludeKey];
+  AIMRT_ASSERT(include_node.IsScalar() || include_node.IsSequence(),
+               "Invalid 'include' in config file '{}', should be a path or a list of paths",
+               canonical_path.string());
+
+  std::vector<std::string> include_path_vec;
+  if (include_node.IsScalar()) {
+    include_path_vec.emplace_back(include_node.as<std::string>());
+  } else {
+    include_path_vec = include_node.as<std::vector<std::string>>();
+  }
+  file_node.remove(kIncludeKey);
+
+  include_stack.emplace_back(canonical_path);
+  YAML::Node result_node(YAML::NodeType::Map);
+  for (const auto& include_path_str : include_path_vec) {
+    std::filesystem::path include_path = ConfigLoader::ExpandEnv(include_path_str);
+    if (include_path.is_relative()) include_path = canonical_path.parent_path() / include_path;
+    result_node = ConfigLoader::MergeConfigNode(
+        result_node, LoadFileImpl(include_path, include_stack, source_file_vec));
+  }
+  include_stack.pop_back();
+
+  return ConfigLoader::MergeConfigNode(result_node, file_node);
+}
+
+}  // namespace
+
+YAML::Node ConfigLoader::LoadFile(const std::filesystem::path& file_path,
+                                  std::vector<std::filesystem::path>* source_file_vec) {
+  std::vector<std::filesystem::path> include_stack;
+  return LoadFileImpl(std::filesystem::absolute(file_path), include_stack, source_file_vec);
+}
+
+YAML::Node ConfigLoader::MergeConfigNode(const YAML::Node& base, const YAML::Node& overlay) {
+  if (!overlay.IsDefined()) return YAML::Clone(base);
+  if (!base.IsDefined()) return YAML::Clone(overlay);
+
+  if (base.IsMap() && overlay.IsMap()) {
+    YAML::Node result_node = YAML::Clone(base);
+    for (const auto& itr : overlay) {
+      const auto key = itr.first.as<std::string>();
+      result_node[key] = MergeConfigNode(base[key], itr.second);
+    }
+    return result_node;
+  }
+
+  if (IsNamedMapSequence(base) && IsNamedMapSequence(overlay)) {
+    YAML::Node result_node = YAML::Clone(base);
+    for (const auto& overlay_item : overlay) {
+      const auto name = overlay_item["name"].as<std::string>();
+      bool found = false;
+      for (size_t ii = 0; ii < result_node.size(); ++ii) {
+        if (result_node[ii]["name"].as<std::string>() == name) {
+          result_node[ii] = MergeConfigNode(base[ii], overlay_item);
+          found = true;
+          break;
+        }
+      }
+      if (!found) result_node.push_back(YAML::Clone(overlay_item));
+    }
+    return result_node;
+  }
+
+  return YAML::Clone(overlay);
+}
+
+std::string ConfigLoader::ExpandEnv(std::string_view str) {
+  std::string result;
+  size_t pos = 0;
+  while (pos < str.size()) {
+    auto begin = str.find("${", pos);
+    if (begin == std::string_view::npos) break;
+    auto end = str.find('}', begin + 2);
+    AIMRT_ASSERT(end != std::string_view::npos, "Unterminated '${{' in '{}'", str);
+
+    result.append(str.substr(pos, begin - pos));
+    std::string env_name(str.substr(begin + 2, end - begin - 2));
+    const char* env_value = std::getenv(env_name.c_str());
+    AIMRT_ASSERT(env_value != nullptr, "Environment variable '{}' used in '{}' is not defined",
+                 env_name, str);
+    result.append(env_value);
+    pos = end + 1;
+  }
+  result.append(str.substr(std::min(pos, str.size())));
+  return result;
+}
+
+}  // namespace nxpilot::runtime::core::configurator
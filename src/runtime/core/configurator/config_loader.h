@@ -0,0 +1,36 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::configurator {
+
+/**
+ * @brief Load a config file together with the files it includes.
+ *
+ * A file may list other files under a top level 'include' key (a string or a sequence), paths are
+ * relative to the including file and may reference environment variables as '${NAME}', e.g.
+ * 'vehicles/${NXPILOT_VEHICLE_ID}.yaml'. Included files are merged in order, then the including
+ * file is merged on top, see 'MergeConfigNode'.
+ */
+class ConfigLoader {
+ public:
+  // Throw on missing files, undefined environment variables or include cycles. Every file read is
+  // appended to 'source_file_vec' if given.
+  static YAML::Node LoadFile(const std::filesystem::path& file_path,
+                             std::vector<std::filesystem::path>* source_file_vec = nullptr);
+
+  // Deep merge 'overlay' onto 'base' and return the result, inputs are not modified. Maps are
+  // merged key by key. Sequences whose items are all maps with a 'name' key are merged item by
+  // item on 'name', new items appended. Anything else in 'overlay' replaces the value in 'base'.
+  static YAML::Node MergeConfigNode(const YAML::Node& base, const YAML::Node& overlay);
+
+  // Replace '${NAME}' with the value of environment variable 'NAME'. Throw if it is not defined.
+  static std::string ExpandEnv(std::string_view str);
+};
+
+}  // namespace nxpilot::runtime::core::configurator
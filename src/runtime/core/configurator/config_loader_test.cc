@@ -0,0 +1,121 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <cstdlib>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/configurator/config_loader.h"
+
+namespace nxpilot::runtime::core::configurator {
+
+class ConfigLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override { std::filesystem::create_directories(dir_ / "vehicles"); }
+
+  void TearDown() override { std::filesystem::remove_all(dir_); }
+
+  void WriteFile(const std::filesystem::path& path, std::string_view content) {
+    std::ofstream ofs(dir_ / path, std::ios::trunc);
+    ofs << content;
+  }
+
+  const std::filesystem::path dir_ =
+      std::filesystem::temp_directory_path() / "config_loader_test";
+};
+
+TEST_F(ConfigLoaderTest, merge) {
+  YAML::Node base = YAML::Load(R"str(
+    a: 1
+    m: {x: 1, y: 2}
+    list: [1, 2]
+    executors:
+      - {name: work, type: time_wheel, options: {dt_us: 1000}}
+      - {name: io, type: guard_thread}
+  )str");
+  YAML::Node overlay = YAML::Load(R"str(
+    m: {y: 3, z: 4}
+    list: [5]
+    executors:
+      - {name: work, options: {wheel_size: [10, 20]}}
+      - {name: extra, type: time_wheel}
+  )str");
+
+  YAML::Node result = ConfigLoader::MergeConfigNode(base, overlay);
+  EXPECT_EQ(result["a"].as<int>(), 1);
+  EXPECT_EQ(result["m"]["x"].as<int>(), 1);
+  EXPECT_EQ(result["m"]["y"].as<int>(), 3);
+  EXPECT_EQ(result["m"]["z"].as<int>(), 4);
+  EXPECT_EQ(result["list"].as<std::vector<int>>(), std::vector<int>{5});
+
+  ASSERT_EQ(result["executors"].size(), 3);
+  EXPECT_EQ(result["executors"][0]["type"].as<std::string>(), "time_wheel");
+  EXPECT_EQ(result["executors"][0]["options"]["dt_us"].as<int>(), 1000);
+  EXPECT_EQ(result["executors"][0]["options"]["wheel_size"].as<std::vector<int>>(),
+            (std::vector<int>{10, 20}));
+  EXPECT_EQ(result["executors"][2]["name"].as<std::string>(), "extra");
+
+  // Inputs are untouched.
+  EXPECT_EQ(base["m"]["y"].as<int>(), 2);
+  EXPECT_FALSE(base["m"]["z"]);
+}
+
+TEST_F(ConfigLoaderTest, include) {
+  WriteFile("common.yaml", R"str(
+    nxpilot:
+      executor:
+        shutdown_timeout_ms: 100
+        executors:
+          - {name: work, type: time_wheel}
+  )str");
+  WriteFile("vehicles/v1.yaml", R"str(
+    nxpilot:
+      executor:
+        executors:
+          - {name: work, options: {dt_us: 500}}
+  )str");
+  WriteFile("main.yaml", R"str(
+    include: [common.yaml, "vehicles/${CONFIG_LOADER_TEST_VEHICLE}.yaml"]
+    nxpilot:
+      executor:
+        shutdown_timeout_ms: 200
+  )str");
+  setenv("CONFIG_LOADER_TEST_VEHICLE", "v1", 1);
+
+  std::vector<std::filesystem::path> source_file_vec;
+  YAML::Node root_node = ConfigLoader::LoadFile(dir_ / "main.yaml", &source_file_vec);
+
+  EXPECT_FALSE(root_node["include"]);
+  auto executor_node = root_node["nxpilot"]["executor"];
+  EXPECT_EQ(executor_node["shutdown_timeout_ms"].as<int>(), 200);
+  ASSERT_EQ(executor_node["executors"].size(), 1);
+  EXPECT_EQ(executor_node["executors"][0]["type"].as<std::string>(), "time_wheel");
+  EXPECT_EQ(executor_node["executors"][0]["options"]["dt_us"].as<int>(), 500);
+
+  ASSERT_EQ(source_file_vec.size(), 3);
+  EXPECT_EQ(source_file_vec[0].filename(), "main.yaml");
+  EXPECT_EQ(source_file_vec[2].filename(), "v1.yaml");
+
+  unsetenv("CONFIG_LOADER_TEST_VEHICLE");
+  EXPECT_ANY_THROW(ConfigLoader::LoadFile(dir_ / "main.yaml"));
+}
+
+TEST_F(ConfigLoaderTest, include_cycle) {
+  WriteFile("a.yaml", "include: b.yaml\nx: 1\n");
+  WriteFile("b.yaml", "include: a.yaml\ny: 1\n");
+  EXPECT_ANY_THROW(ConfigLoader::LoadFile(dir_ / "a.yaml"));
+
+  WriteFile("c.yaml", "include: missing.yaml\n");
+  EXPECT_ANY_THROW(ConfigLoader::LoadFile(dir_ / "c.yaml"));
+}
+
+TEST_F(ConfigLoaderTest, expand_env) {
+  setenv("CONFIG_LOADER_TEST_ENV", "abc", 1);
+  EXPECT_EQ(ConfigLoader::ExpandEnv("plain"), "plain");
+  EXPECT_EQ(ConfigLoader::ExpandEnv("x/${CONFIG_LOADER_TEST_ENV}/y"), "x/abc/y");
+  EXPECT_EQ(ConfigLoader::ExpandEnv("${CONFIG_LOADER_TEST_ENV}"), "abc");
+  EXPECT_ANY_THROW(ConfigLoader::ExpandEnv("${CONFIG_LOADER_TEST_UNDEFINED}"));
+  EXPECT_ANY_THROW(ConfigLoader::ExpandEnv("${CONFIG_LOADER_TEST_ENV"));
+}
+
+}  // namespace nxpilot::runtime::core::configurator
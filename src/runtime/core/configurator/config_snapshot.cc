@@ -0,0 +1,335 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/configurator/config_snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "utils/common/exception.h"
+#include "utils/common/hash_tool.h"
+
+namespace nxpilot::runtime::core::configurator {
+
+namespace {
+
+constexpr uint32_t kSnapshotMagic = 0x5343584e;  // "NXCS"
+constexpr uint32_t kSnapshotVersion = 3;
+
+// A source file modified this shortly before compiling may change again within the mtime
+// granularity, its mtime is not recorded so that loading always hashes it.
+constexpr int64_t kRacyMtimeWindowNs = 2000000000;
+
+// Layout: SnapshotHeader | SourceEntry[source_num] | NodeEntry[node_num] | string pool
+struct SnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t source_num;
+  uint32_t node_num;
+  uint32_t entry_offset;  // entry file paths joined by '\n', in the string pool
+  uint32_t entry_size;
+  uint64_t string_pool_size;
+  uint64_t payload_hash;  // hash of everything after the header
+};
+
+struct SourceEntry {
+  uint64_t size;
+  uint64_t hash;
+  int64_t mtime_ns;  // 0 if not recorded
+  uint32_t path_offset;
+  uint32_t path_size;
+};
+
+// Nodes in pre-order. A map node is followed by 'child_num' key/value pairs, a sequence node by
+// 'child_num' items.
+struct NodeEntry {
+  uint32_t type;
+  uint32_t child_num;
+  uint32_t str_offset;
+  uint32_t str_size;
+};
+
+std::string JoinEntryFiles(const std::vector<std::filesystem::path>& entry_file_vec) {
+  std::string result;
+  for (const auto& entry_file : entry_file_vec) {
+    if (!result.empty()) result += '\n';
+    result += std::filesystem::absolute(entry_file).lexically_normal().string();
+  }
+  return result;
+}
+
+int64_t GetMtimeNs(const struct stat& file_stat) {
+  return static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 + file_stat.st_mtim.tv_nsec;
+}
+
+std::optional<std::string> ReadFile(const std::filesystem::path& file_path) {
+  std::ifstream ifs(file_path, std::ios::binary);
+  if (!ifs.is_open()) return std::nullopt;
+  return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+class SnapshotWriter {
+ public:
+  uint32_t AddString(std::string_view str) {
+    auto offset = static_cast<uint32_t>(string_pool_.size());
+    string_pool_.append(str);
+    return offset;
+  }
+
+  void AddNode(const YAML::Node& node) {
+    NodeEntry entry{.type = static_cast<uint32_t>(node.Type()),
+                    .child_num = 0,
+                    .str_offset = 0,
+                    .str_size = 0};
+
+    switch (node.Type()) {
+      case YAML::NodeType::Scalar:
+        entry.str_offset = AddString(node.Scalar());
+        entry.str_size = static_cast<uint32_t>(node.Scalar().size());
+        node_vec_.emplace_back(entry);
+        break;
+      case YAML::NodeType::Sequence:
+      case YAML::NodeType::Map:
+        entry.child_num = static_cast<uint32_t>(node.size());
+        node_vec_.emplace_back(entry);
+        for (const auto& itr : node) {
+          if (node.IsMap()) {
+            AddNode(itr.first);
+            AddNode(itr.second);
+          } else {
+            AddNode(itr);
+          }
+        }
+        break;
+      default:
+        node_vec_.emplace_back(entry);
+    }
+  }
+
+  std::vector<SourceEntry> source_vec_;
+  std::vector<NodeEntry> node_vec_;
+  std::string string_pool_;
+};
+
+class SnapshotReader {
+ public:
+  SnapshotReader(const NodeEntry* node_array, uint32_t node_num, const char* string_pool,
+                 uint64_t string_pool_size)
+      : node_array_(node_array),
+        node_num_(node_num),
+        string_pool_(string_pool),
+        string_pool_size_(string_pool_size) {}
+
+  std::string_view GetString(uint32_t offset, uint32_t size) const {
+    AIMRT_ASSERT(static_cast<uint64_t>(offset) + size <= string_pool_size_,
+                 "String out of range in snapshot");
+    return std::string_view(string_pool_ + offset, size);
+  }
+
+  YAML::Node ReadNode() {
+    AIMRT_ASSERT(cur_idx_ < node_num_, "Node out of range in snapshot");
+    const auto& entry = node_array_[cur_idx_++];
+
+    switch (static_cast<YAML::NodeType::value>(entry.type)) {
+      case YAML::NodeType::Scalar:
+        return YAML::Node(std::string(GetString(entry.str_offset, entry.str_size)));
+      case YAML::NodeType::Sequence: {
+        YAML::Node node(YAML::NodeType::Sequence);
+        for (uint32_t ii = 0; ii < entry.child_num; ++ii) node.push_back(ReadNode());
+        return node;
+      }
+      case YAML::NodeType::Map: {
+        YAML::Node node(YAML::NodeType::Map);
+        for (uint32_t ii = 0; ii < entry.child_num; ++ii) {
+          YAML::Node key = ReadNode();
+          node.force_insert(key, ReadNode());
+        }
+        return node;
+      }
+      case YAML::NodeType::Null:
+        return YAML::Node(YAML::NodeType::Null);
+      default:
+        return YAML::Node();
+    }
+  }
+
+  bool AllRead() const { return cur_idx_ == node_num_; }
+
+ private:
+  const NodeEntry* node_array_;
+  uint32_t node_num_;
+  const char* string_pool_;
+  uint64_t string_pool_size_;
+  uint32_t cur_idx_ = 0;
+};
+
+}  // namespace
+
+void ConfigSnapshot::Compile(const YAML::Node& root_node,
+                             const std::vector<std::filesystem::path>& entry_file_vec,
+                             const std::vector<std::filesystem::path>& source_file_vec,
+                             const std::filesystem::path& snapshot_path) {
+  SnapshotWriter writer;
+
+  const auto entry_str = JoinEntryFiles(entry_file_vec);
+  const auto entry_offset = writer.AddString(entry_str);
+
+  const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+  for (const auto& source_file : source_file_vec) {
+    struct stat source_stat;
+    AIMRT_ASSERT(stat(source_file.c_str(), &source_stat) == 0,
+                 "Can not stat config source file '{}'", source_file.string());
+    auto content = ReadFile(source_file);
+    AIMRT_ASSERT(content, "Can not read config source file '{}'", source_file.string());
+
+    int64_t mtime_ns = GetMtimeNs(source_stat);
+    if (now_ns - mtime_ns < kRacyMtimeWindowNs ||
+        static_cast<size_t>(source_stat.st_size) != content->size()) {
+      mtime_ns = 0;
+    }
+
+    auto path_str = std::filesystem::absolute(source_file).string();
+    writer.source_vec_.emplace_back(
+        SourceEntry{.size = content->size(),
+                    .hash = nxpilot::utils::common::HashFnv1a64(content->data(), content->size()),
+                    .mtime_ns = mtime_ns,
+                    .path_offset = writer.AddString(path_str),
+                    .path_size = static_cast<uint32_t>(path_str.size())});
+  }
+
+  writer.AddNode(root_node);
+
+  SnapshotHeader header{.magic = kSnapshotMagic,
+                        .version = kSnapshotVersion,
+                        .source_num = static_cast<uint32_t>(writer.source_vec_.size()),
+                        .node_num = static_cast<uint32_t>(writer.node_vec_.size()),
+                        .entry_offset = entry_offset,
+                        .entry_size = static_cast<uint32_t>(entry_str.size()),
+                        .string_pool_size = writer.string_pool_.size(),
+                        .payload_hash = 0};
+
+  const size_t source_bytes = writer.source_vec_.size() * sizeof(SourceEntry);
+  const size_t node_bytes = writer.node_vec_.size() * sizeof(NodeEntry);
+  header.payload_hash =
+      nxpilot::utils::common::HashFnv1a64(writer.source_vec_.data(), source_bytes);
+  header.payload_hash = nxpilot::utils::common::HashFnv1a64(writer.node_vec_.data(), node_bytes,
+                                                            header.payload_hash);
+  header.payload_hash = nxpilot::utils::common::HashFnv1a64(
+      writer.string_pool_.data(), writer.string_pool_.size(), header.payload_hash);
+
+  // Write to a temporary file and rename, so a reader never sees a half written snapshot.
+  auto tmp_path = snapshot_path;
+  tmp_path += ".tmp";
+  {
+    std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+    AIMRT_ASSERT(ofs.is_open(), "Can not open snapshot file '{}'", tmp_path.string());
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(writer.source_vec_.data()), source_bytes);
+    ofs.write(reinterpret_cast<const char*>(writer.node_vec_.data()), node_bytes);
+    ofs.write(writer.string_pool_.data(), writer.string_pool_.size());
+    AIMRT_ASSERT(ofs.good(), "Write snapshot file '{}' failed", tmp_path.string());
+  }
+  std::filesystem::rename(tmp_path, snapshot_path);
+}
+
+std::optional<YAML::Node> ConfigSnapshot::Load(
+    const std::filesystem::path& snapshot_path,
+    const std::vector<std::filesystem::path>& entry_file_vec, std::string* reason,
+    std::vector<std::filesystem::path>* source_file_vec) {
+  auto fail = [reason](std::string msg) -> std::optional<YAML::Node> {
+    if (reason) *reason = std::move(msg);
+    return std::nullopt;
+  };
+
+  int fd = open(snapshot_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return fail("can not open snapshot file");
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) < sizeof(SnapshotHeader)) {
+    close(fd);
+    return fail("snapshot file is truncated");
+  }
+
+  const size_t file_size = file_stat.st_size;
+  void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) return fail("mmap snapshot file failed");
+
+  struct Unmapper {
+    void* addr;
+    size_t size;
+    ~Unmapper() { munmap(addr, size); }
+  } unmapper{addr, file_size};
+
+  const auto* data = static_cast<const char*>(addr);
+  SnapshotHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != kSnapshotMagic || header.version != kSnapshotVersion) {
+    return fail("snapshot magic or version mismatch");
+  }
+
+  const uint64_t source_bytes = static_cast<uint64_t>(header.source_num) * sizeof(SourceEntry);
+  const uint64_t node_bytes = static_cast<uint64_t>(header.node_num) * sizeof(NodeEntry);
+  if (sizeof(SnapshotHeader) + source_bytes + node_bytes + header.string_pool_size != file_size) {
+    return fail("snapshot size mismatch");
+  }
+
+  const char* payload = data + sizeof(SnapshotHeader);
+  if (nxpilot::utils::common::HashFnv1a64(payload, file_size - sizeof(SnapshotHeader)) !=
+      header.payload_hash) {
+    return fail("snapshot checksum mismatch");
+  }
+
+  const auto* source_array = reinterpret_cast<const SourceEntry*>(payload);
+  const auto* node_array = reinterpret_cast<const NodeEntry*>(payload + source_bytes);
+  const char* string_pool = payload + source_bytes + node_bytes;
+
+  try {
+    SnapshotReader reader(node_array, header.node_num, string_pool, header.string_pool_size);
+
+    if (reader.GetString(header.entry_offset, header.entry_size) !=
+        JoinEntryFiles(entry_file_vec)) {
+      return fail("snapshot was compiled from other config or overlay files");
+    }
+
+    std::vector<std::filesystem::path> snapshot_source_file_vec;
+    for (uint32_t ii = 0; ii < header.source_num; ++ii) {
+      const auto& source = source_array[ii];
+      std::string path(reader.GetString(source.path_offset, source.path_size));
+      struct stat source_stat;
+      if (stat(path.c_str(), &source_stat) != 0 ||
+          static_cast<uint64_t>(source_stat.st_size) != source.size) {
+        return fail("config source file '" + path + "' has changed");
+      }
+
+      // Same size and mtime means unchanged, only a file with another mtime is read and hashed.
+      if (source.mtime_ns == 0 || GetMtimeNs(source_stat) != source.mtime_ns) {
+        auto content = ReadFile(path);
+        if (!content || content->size() != source.size ||
+            nxpilot::utils::common::HashFnv1a64(content->data(), content->size()) !=
+                source.hash) {
+          return fail("config source file '" + path + "' has changed");
+        }
+      }
+      snapshot_source_file_vec.emplace_back(std::move(path));
+    }
+
+    YAML::Node root_node = reader.ReadNode();
+    if (!reader.AllRead()) return fail("snapshot has trailing nodes");
+    if (source_file_vec) *source_file_vec = std::move(snapshot_source_file_vec);
+    return root_node;
+  } catch (const std::exception& e) {
+    return fail(e.what());
+  }
+}
+
+}  // namespace nxpilot::runtime::core::configurator
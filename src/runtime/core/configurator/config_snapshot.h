@@ -0,0 +1,42 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::configurator {
+
+/**
+ * @brief Binary snapshot of a parsed config tree.
+ *
+ * The snapshot stores the node tree flattened in pre-order plus a string pool, so loading it is
+ * one mmap and a linear walk, without running the YAML scanner/parser. It also records the size,
+ * mtime and hash of every source file, a stale snapshot is rejected and the caller falls back to
+ * YAML. A source file is only read and hashed if its mtime has changed.
+ *
+ * 'entry_file_vec' are the files the config was loaded from (the config file and its overlays),
+ * 'source_file_vec' are all files read, includes too.
+ */
+class ConfigSnapshot {
+ public:
+  // Write 'root_node' into 'snapshot_path'. Throw on failure.
+  static void Compile(const YAML::Node& root_node,
+                      const std::vector<std::filesystem::path>& entry_file_vec,
+                      const std::vector<std::filesystem::path>& source_file_vec,
+                      const std::filesystem::path& snapshot_path);
+
+  // Return nullopt if the snapshot is missing, corrupted, was compiled from other entry files, or
+  // any source file has changed. The reason is written to 'reason' if given, the source files
+  // recorded in the snapshot to 'source_file_vec' if given.
+  static std::optional<YAML::Node> Load(
+      const std::filesystem::path& snapshot_path,
+      const std::vector<std::filesystem::path>& entry_file_vec, std::string* reason = nullptr,
+      std::vector<std::filesystem::path>* source_file_vec = nullptr);
+};
+
+}  // namespace nxpilot::runtime::core::configurator
@@ -0,0 +1,135 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <fstream>
+#include <iterator>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/configurator/config_snapshot.h"
+
+namespace nxpilot::runtime::core::configurator {
+
+// Compare content only, the snapshot does not keep styles such as flow sequences.
+bool NodeEqual(const YAML::Node& lhs, const YAML::Node& rhs) {
+  if (lhs.Type() != rhs.Type() || lhs.size() != rhs.size()) return false;
+  if (lhs.IsScalar()) return lhs.Scalar() == rhs.Scalar();
+  if (lhs.IsSequence()) {
+    for (size_t ii = 0; ii < lhs.size(); ++ii) {
+      if (!NodeEqual(lhs[ii], rhs[ii])) return false;
+    }
+  }
+  if (lhs.IsMap()) {
+    for (const auto& itr : lhs) {
+      if (!NodeEqual(itr.second, rhs[itr.first.Scalar()])) return false;
+    }
+  }
+  return true;
+}
+
+class ConfigSnapshotTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    WriteFile(cfg_path_, R"str(
+nxpilot:
+  executor:
+    executors:
+      - name: work
+        type: time_wheel
+        options:
+          dt_us: 500
+          wheel_size: [100, 60]
+  empty:
+  list: []
+  text: "a: b"
+)str");
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(cfg_path_);
+    std::filesystem::remove(snapshot_path_);
+  }
+
+  static void WriteFile(const std::filesystem::path& path, std::string_view content) {
+    std::ofstream ofs(path, std::ios::trunc);
+    ofs << content;
+  }
+
+  const std::filesystem::path cfg_path_ =
+      std::filesystem::temp_directory_path() / "config_snapshot_test.yaml";
+  const std::filesystem::path snapshot_path_ =
+      std::filesystem::temp_directory_path() / "config_snapshot_test.bin";
+};
+
+TEST_F(ConfigSnapshotTest, compile_and_load) {
+  YAML::Node root_node = YAML::LoadFile(cfg_path_.string());
+  ConfigSnapshot::Compile(root_node, {cfg_path_}, {cfg_path_}, snapshot_path_);
+
+  auto snapshot_node = ConfigSnapshot::Load(snapshot_path_, {cfg_path_});
+  ASSERT_TRUE(snapshot_node);
+  EXPECT_TRUE(NodeEqual(*snapshot_node, root_node));
+
+  auto executor_node = (*snapshot_node)["nxpilot"]["executor"]["executors"][0];
+  EXPECT_EQ(executor_node["name"].as<std::string>(), "work");
+  EXPECT_EQ(executor_node["options"]["dt_us"].as<uint32_t>(), 500);
+  EXPECT_EQ(executor_node["options"]["wheel_size"].as<std::vector<size_t>>(),
+            (std::vector<size_t>{100, 60}));
+  EXPECT_TRUE((*snapshot_node)["nxpilot"]["empty"].IsNull());
+  EXPECT_EQ((*snapshot_node)["nxpilot"]["text"].as<std::string>(), "a: b");
+}
+
+TEST_F(ConfigSnapshotTest, stale_or_corrupted) {
+  std::string reason;
+  EXPECT_FALSE(ConfigSnapshot::Load(snapshot_path_, {cfg_path_}, &reason));
+
+  ConfigSnapshot::Compile(YAML::LoadFile(cfg_path_.string()), {cfg_path_}, {cfg_path_},
+                          snapshot_path_);
+  ASSERT_TRUE(ConfigSnapshot::Load(snapshot_path_, {cfg_path_}));
+
+  // An overlay given at load time that the snapshot was not compiled with.
+  EXPECT_FALSE(ConfigSnapshot::Load(snapshot_path_, {cfg_path_, "/tmp/overlay.yaml"}, &reason));
+  EXPECT_NE(reason.find("other config"), std::string::npos);
+
+  // Flip one byte at the end of the string pool.
+  {
+    std::fstream fs(snapshot_path_, std::ios::in | std::ios::out | std::ios::binary);
+    fs.seekp(-1, std::ios::end);
+    fs.put('#');
+  }
+  EXPECT_FALSE(ConfigSnapshot::Load(snapshot_path_, {cfg_path_}, &reason));
+  EXPECT_NE(reason.find("checksum"), std::string::npos);
+
+  ConfigSnapshot::Compile(YAML::LoadFile(cfg_path_.string()), {cfg_path_}, {cfg_path_},
+                          snapshot_path_);
+  WriteFile(cfg_path_, "nxpilot: {}\n");
+  EXPECT_FALSE(ConfigSnapshot::Load(snapshot_path_, {cfg_path_}, &reason));
+  EXPECT_NE(reason.find("changed"), std::string::npos);
+}
+
+TEST_F(ConfigSnapshotTest, hash_only_on_mtime_change) {
+  // Compiled an hour after the last write, so the mtime is recorded.
+  const auto old_time = std::filesystem::last_write_time(cfg_path_) - std::chrono::hours(1);
+  std::filesystem::last_write_time(cfg_path_, old_time);
+  ConfigSnapshot::Compile(YAML::LoadFile(cfg_path_.string()), {cfg_path_}, {cfg_path_},
+                          snapshot_path_);
+
+  // Touched, but the same content.
+  std::filesystem::last_write_time(cfg_path_, old_time + std::chrono::minutes(1));
+  EXPECT_TRUE(ConfigSnapshot::Load(snapshot_path_, {cfg_path_}));
+
+  // Same size, other content.
+  {
+    std::fstream fs(cfg_path_, std::ios::in | std::ios::out | std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+    fs.seekp(text.find("dt_us: 500") + 7);
+    fs.put('6');
+  }
+  std::string reason;
+  EXPECT_FALSE(ConfigSnapshot::Load(snapshot_path_, {cfg_path_}, &reason));
+  EXPECT_NE(reason.find("changed"), std::string::npos);
+
+  // Same size and mtime is taken as unchanged without reading the file.
+  std::filesystem::last_write_time(cfg_path_, old_time);
+  EXPECT_TRUE(ConfigSnapshot::Load(snapshot_path_, {cfg_path_}));
+}
+
+}  // namespace nxpilot::runtime::core::configurator
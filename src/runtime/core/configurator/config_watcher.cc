@@ -0,0 +1,132 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/configurator/config_watcher.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace nxpilot::runtime::core::configurator {
+
+void ConfigWatcher::Start(const std::vector<std::filesystem::path>& file_vec,
+                          std::chrono::milliseconds debounce, ChangeCallback&& callback) {
+  NXPILOT_CHECK_ERROR(!thread_ptr_, "ConfigWatcher is already started.");
+
+  debounce_ = debounce;
+  callback_ = std::move(callback);
+
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  NXPILOT_CHECK_ERROR(inotify_fd_ >= 0, "Call 'inotify_init1' get error, {}", strerror(errno));
+  stop_event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  NXPILOT_CHECK_ERROR(stop_event_fd_ >= 0, "Call 'eventfd' get error, {}", strerror(errno));
+
+  UpdateFiles(file_vec);
+
+  thread_ptr_ = std::make_unique<std::thread>([this]() { WatchLoop(); });
+  NXPILOT_INFO("ConfigWatcher start watching {} files", file_vec.size());
+}
+
+void ConfigWatcher::Stop() {
+  if (thread_ptr_) {
+    uint64_t value = 1;
+    [[maybe_unused]] auto ret = write(stop_event_fd_, &value, sizeof(value));
+    if (thread_ptr_->joinable()) thread_ptr_->join();
+    thread_ptr_.reset();
+  }
+
+  if (inotify_fd_ >= 0) close(inotify_fd_);
+  if (stop_event_fd_ >= 0) close(stop_event_fd_);
+  inotify_fd_ = -1;
+  stop_event_fd_ = -1;
+}
+
+void ConfigWatcher::UpdateFiles(const std::vector<std::filesystem::path>& file_vec) {
+  std::lock_guard<std::mutex> lck(file_set_mutex_);
+  file_set_.clear();
+  std::set<std::filesystem::path> dir_set;
+  for (const auto& file : file_vec) {
+    auto abs_file = std::filesystem::absolute(file).lexically_normal();
+    file_set_.emplace(abs_file);
+    dir_set.emplace(abs_file.parent_path());
+  }
+
+  // Drop the watches on directories no longer holding a watched file, keep the others.
+  for (auto itr = watch_dir_map_.begin(); itr != watch_dir_map_.end();) {
+    if (dir_set.erase(itr->second) != 0) {
+      ++itr;
+      continue;
+    }
+    inotify_rm_watch(inotify_fd_, itr->first);
+    itr = watch_dir_map_.erase(itr);
+  }
+
+  for (const auto& dir : dir_set) {
+    int wd = inotify_add_watch(inotify_fd_, dir.c_str(),
+                               IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+    if (wd < 0) {
+      NXPILOT_WARN("Can not watch config directory '{}', {}", dir.string(), strerror(errno));
+      continue;
+    }
+    watch_dir_map_[wd] = dir;
+  }
+}
+
+void ConfigWatcher::WatchLoop() {
+  using Clock = std::chrono::steady_clock;
+  // 'time_point::max()' means no change is pending.
+  Clock::time_point fire_time_point = Clock::time_point::max();
+
+  alignas(struct inotify_event) char buf[4096];
+  pollfd poll_fd_array[2] = {{.fd = stop_event_fd_, .events = POLLIN, .revents = 0},
+                             {.fd = inotify_fd_, .events = POLLIN, .revents = 0}};
+
+  while (true) {
+    int timeout_ms = -1;
+    if (fire_time_point != Clock::time_point::max()) {
+      timeout_ms = std::max<int>(0, std::chrono::ceil<std::chrono::milliseconds>(
+                                        fire_time_point - Clock::now())
+                                        .count());
+    }
+
+    int ret = poll(poll_fd_array, 2, timeout_ms);
+    if (ret < 0 && errno != EINTR) {
+      NXPILOT_ERROR("ConfigWatcher poll get error, {}", strerror(errno));
+      return;
+    }
+    if (poll_fd_array[0].revents & POLLIN) return;
+
+    if (poll_fd_array[1].revents & POLLIN) {
+      ssize_t len;
+      while ((len = read(inotify_fd_, buf, sizeof(buf))) > 0) {
+        for (char* ptr = buf; ptr < buf + len;) {
+          const auto* event = reinterpret_cast<const struct inotify_event*>(ptr);
+          ptr += sizeof(struct inotify_event) + event->len;
+          if (event->len == 0) continue;
+
+          std::lock_guard<std::mutex> lck(file_set_mutex_);
+          auto dir_itr = watch_dir_map_.find(event->wd);
+          if (dir_itr != watch_dir_map_.end() &&
+              file_set_.contains(dir_itr->second / event->name)) {
+            fire_time_point = Clock::now() + debounce_;
+          }
+        }
+      }
+    }
+
+    if (Clock::now() >= fire_time_point) {
+      fire_time_point = Clock::time_point::max();
+      try {
+        callback_();
+      } catch (const std::exception& e) {
+        NXPILOT_ERROR("ConfigWatcher callback get exception, {}", e.what());
+      }
+    }
+  }
+}
+
+}  // namespace nxpilot::runtime::core::configurator
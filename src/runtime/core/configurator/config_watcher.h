@@ -0,0 +1,64 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "utils/common/log_tool.h"
+
+namespace nxpilot::runtime::core::configurator {
+
+/**
+ * @brief Watch config files with inotify and call back after they change.
+ *
+ * The parent directories are watched rather than the files, since editors and deploy tools often
+ * replace a file by renaming a new one over it. Changes are debounced, a burst of writes results
+ * in one callback, which runs on the watcher thread.
+ */
+class ConfigWatcher {
+ public:
+  using ChangeCallback = std::function<void()>;
+
+  ConfigWatcher() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~ConfigWatcher() { Stop(); }
+
+  ConfigWatcher(const ConfigWatcher&) = delete;
+  ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  void Start(const std::vector<std::filesystem::path>& file_vec,
+             std::chrono::milliseconds debounce, ChangeCallback&& callback);
+  void Stop();
+
+  // Replace the watched files, e.g. after a reload changed the includes. Thread safe.
+  void UpdateFiles(const std::vector<std::filesystem::path>& file_vec);
+
+ private:
+  void WatchLoop();
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  std::chrono::milliseconds debounce_;
+  ChangeCallback callback_;
+
+  int inotify_fd_ = -1;
+  int stop_event_fd_ = -1;
+  std::unique_ptr<std::thread> thread_ptr_;
+
+  std::mutex file_set_mutex_;
+  std::set<std::filesystem::path> file_set_;
+  std::map<int, std::filesystem::path> watch_dir_map_;  // watch descriptor -> directory
+};
+
+}  // namespace nxpilot::runtime::core::configurator
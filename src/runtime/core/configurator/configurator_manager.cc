@@ -1,6 +1,8 @@
 // Copyright (C) 2024. All rights reserved.
 
 #include "runtime/core/configurator/configurator_manager.h"
+#include "runtime/core/configurator/config_loader.h"
+#include "runtime/core/configurator/config_snapshot.h"
 
 namespace YAML {
 template <>
@@ -10,6 +12,9 @@ struct convert<nxpilot::runtime::core::configurator::ConfiguratorManager::Option
   static Node encode(const Options& rhs) {
     Node node;
     node["cfg_path"] = rhs.cfg_path.string();
+    for (const auto& overlay_path : rhs.cfg_overlay_path_vec) {
+      node["cfg_overlay_paths"].push_back(overlay_path.string());
+    }
     return node;
   }
 
@@ -23,22 +28,66 @@ struct convert<nxpilot::runtime::core::configurator::ConfiguratorManager::Option
     } else {
       return false;
     }
+
+    if (node["cfg_overlay_paths"]) {
+      for (const auto& overlay_path : node["cfg_overlay_paths"].as<std::vector<std::string>>()) {
+        rhs.cfg_overlay_path_vec.emplace_back(overlay_path);
+      }
+    }
+
+    return true;
   }
 };
 }  // namespace YAML
 
 namespace nxpilot::runtime::core::configurator {
 
-void ConfiguratorManager::Initialize(const std::filesystem::path& cfg_file_path) {
+void ConfiguratorManager::Initialize(
+    const std::filesystem::path& cfg_file_path,
+    const std::vector<std::filesystem::path>& cfg_overlay_path_vec,
+    const std::filesystem::path& cfg_snapshot_path) {
   NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
                       "Configurator manager can only be initialized once.");
   NXPILOT_CHECK_ERROR(!cfg_file_path.empty(), "Nxpilot start with no cfg file.");
 
   options_.cfg_path = std::filesystem::canonical(std::filesystem::absolute(cfg_file_path));
+  for (const auto& overlay_path : cfg_overlay_path_vec) {
+    NXPILOT_CHECK_ERROR(std::filesystem::exists(overlay_path), "Cfg overlay file '{}' not exist.",
+                        overlay_path.string());
+    options_.cfg_overlay_path_vec.emplace_back(
+        std::filesystem::canonical(std::filesystem::absolute(overlay_path)));
+  }
+
+  auto begin_time_point = std::chrono::steady_clock::now();
 
-  root_options_node_ = YAML::LoadFile(options_.cfg_path.string());
+  if (!cfg_snapshot_path.empty()) {
+    std::string reason;
+    auto snapshot_node =
+        ConfigSnapshot::Load(cfg_snapshot_path, EntryFiles(), &reason, &source_file_vec_);
+    if (snapshot_node) {
+      root_options_node_ = *snapshot_node;
+      NXPILOT_INFO("ConfiguratorManager init completed from snapshot '{}' in {} us",
+                   cfg_snapshot_path.string(),
+                   std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - begin_time_point)
+                       .count());
+      return;
+    }
+    NXPILOT_WARN("Can not use config snapshot '{}', {}. Fall back to parse '{}'.",
+                 cfg_snapshot_path.string(), reason, options_.cfg_path.string());
+  }
 
-  NXPILOT_INFO("ConfiguratorManager init completed");
+  try {
+    root_options_node_ = LoadConfigFiles(source_file_vec_);
+  } catch (const std::exception& e) {
+    NXPILOT_CHECK_ERROR(false, "Load cfg file '{}' failed, {}", options_.cfg_path.string(),
+                        e.what());
+  }
+
+  NXPILOT_INFO("ConfiguratorManager init completed from {} files in {} us", source_file_vec_.size(),
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - begin_time_point)
+                   .count());
 }
 
 void ConfiguratorManager::Start() {
@@ -54,10 +103,73 @@ void ConfiguratorManager::Shutdown() {
   NXPILOT_INFO("ConfiguratorManager shutdown");
 }
 
+YAML::Node ConfiguratorManager::GetRootOptionsNode() {
+  std::lock_guard<std::mutex> lck(root_options_node_mutex_);
+  return root_options_node_;
+}
+
 YAML::Node ConfiguratorManager::GetNodeOptionsByKey(std::string_view key) {
-  NXPILOT_CHECK_ERROR(state_.load() == State::kInit,
-                      "Method can only be called when state is 'Init'.");
+  auto cur_state = state_.load();
+  NXPILOT_CHECK_ERROR(cur_state == State::kInit || cur_state == State::kStart,
+                      "Method can only be called when state is 'Init' or 'Start'.");
+  std::lock_guard<std::mutex> lck(root_options_node_mutex_);
   return root_options_node_["nxpilot"][key];
 }
 
+ConfiguratorManager::LoadedConfig ConfiguratorManager::Load() const {
+  NXPILOT_CHECK_ERROR(state_.load() == State::kStart,
+                      "Method can only be called when state is 'Start'.");
+
+  // Parse outside the lock, a reload must not stall readers of the current config.
+  LoadedConfig loaded_config;
+  try {
+    loaded_config.root_options_node = LoadConfigFiles(loaded_config.source_file_vec);
+  } catch (const std::exception& e) {
+    NXPILOT_CHECK_ERROR(false, "Reload cfg file '{}' failed, {}", options_.cfg_path.string(),
+                        e.what());
+  }
+  return loaded_config;
+}
+
+void ConfiguratorManager::Reload(LoadedConfig&& loaded_config) {
+  NXPILOT_CHECK_ERROR(state_.load() == State::kStart,
+                      "Method can only be called when state is 'Start'.");
+
+  // 'reset' rebinds the handle, assignment would overwrite the tree that readers still hold.
+  std::lock_guard<std::mutex> lck(root_options_node_mutex_);
+  root_options_node_.reset(loaded_config.root_options_node);
+  source_file_vec_ = std::move(loaded_config.source_file_vec);
+  NXPILOT_INFO("ConfiguratorManager reloaded {} files", source_file_vec_.size());
+}
+
+std::vector<std::filesystem::path> ConfiguratorManager::GetSourceFiles() {
+  std::lock_guard<std::mutex> lck(root_options_node_mutex_);
+  return source_file_vec_;
+}
+
+YAML::Node ConfiguratorManager::LoadConfigFiles(
+    std::vector<std::filesystem::path>& source_file_vec) const {
+  source_file_vec.clear();
+  YAML::Node root_options_node = ConfigLoader::LoadFile(options_.cfg_path, &source_file_vec);
+  for (const auto& overlay_path : options_.cfg_overlay_path_vec) {
+    root_options_node = ConfigLoader::MergeConfigNode(
+        root_options_node, ConfigLoader::LoadFile(overlay_path, &source_file_vec));
+  }
+  return root_options_node;
+}
+
+void ConfiguratorManager::CompileSnapshot(const std::filesystem::path& cfg_snapshot_path) const {
+  NXPILOT_CHECK_ERROR(state_.load() != State::kPreInit,
+                      "Method can not be called when state is 'PreInit'.");
+  ConfigSnapshot::Compile(root_options_node_, EntryFiles(), source_file_vec_, cfg_snapshot_path);
+  NXPILOT_INFO("Config snapshot compiled to '{}'", cfg_snapshot_path.string());
+}
+
+std::vector<std::filesystem::path> ConfiguratorManager::EntryFiles() const {
+  std::vector<std::filesystem::path> entry_file_vec{options_.cfg_path};
+  entry_file_vec.insert(entry_file_vec.end(), options_.cfg_overlay_path_vec.begin(),
+                        options_.cfg_overlay_path_vec.end());
+  return entry_file_vec;
+}
+
 }  // namespace nxpilot::runtime::core::configurator
\ No newline at end of file
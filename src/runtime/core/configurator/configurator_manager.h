@@ -4,6 +4,8 @@
 
 #include <atomic>
 #include <filesystem>
+#include <mutex>
+#include <vector>
 
 #include "utils/common/log_tool.h"
 #include "yaml-cpp/yaml.h"
@@ -20,6 +22,14 @@ class ConfiguratorManager {
 
   struct Options {
     std::filesystem::path cfg_path;
+    // Merged onto 'cfg_path' in order, e.g. per-vehicle settings. See 'ConfigLoader'.
+    std::vector<std::filesystem::path> cfg_overlay_path_vec;
+  };
+
+  // The config files parsed again for a reload, not applied yet.
+  struct LoadedConfig {
+    YAML::Node root_options_node;
+    std::vector<std::filesystem::path> source_file_vec;
   };
 
   enum class State : uint32_t {
@@ -34,20 +44,43 @@ class ConfiguratorManager {
     logger_ptr_ = logger_ptr;
   }
 
-  void Initialize(const std::filesystem::path& cfg_file_path);
+  // Load 'cfg_file_path' with its includes, then merge 'cfg_overlay_path_vec' on top in order.
+  // If 'cfg_snapshot_path' is given and the snapshot is up to date with the config files, the
+  // config is loaded from it instead of parsing YAML.
+  void Initialize(const std::filesystem::path& cfg_file_path,
+                  const std::vector<std::filesystem::path>& cfg_overlay_path_vec = {},
+                  const std::filesystem::path& cfg_snapshot_path = {});
   void Start();
   void Shutdown();
 
   State GetState() const { return state_.load(); }
 
-  YAML::Node GetRootOptionsNode() const { return root_options_node_; }
+  YAML::Node GetRootOptionsNode();
+  // Thread safe, managers are initialized in parallel and look up their options concurrently.
   YAML::Node GetNodeOptionsByKey(std::string_view key);
 
+  // Load the config files again without replacing the current config, for hot reload. Throw if
+  // they can not be parsed.
+  LoadedConfig Load() const;
+  // Replace the current config with one from 'Load', once the reload has been applied.
+  void Reload(LoadedConfig&& loaded_config);
+
+  // Write the loaded config into a binary snapshot, see 'ConfigSnapshot'.
+  void CompileSnapshot(const std::filesystem::path& cfg_snapshot_path) const;
+
+  // All files the config was loaded from, includes and overlays too.
+  std::vector<std::filesystem::path> GetSourceFiles();
+
  private:
   std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
   Options options_;
   std::atomic<State> state_ = State::kPreInit;
+  std::mutex root_options_node_mutex_;
   YAML::Node root_options_node_;
+  std::vector<std::filesystem::path> source_file_vec_;
+
+  std::vector<std::filesystem::path> EntryFiles() const;
+  YAML::Node LoadConfigFiles(std::vector<std::filesystem::path>& source_file_vec) const;
 };
 
 }  // namespace nxpilot::runtime::core::configurator
\ No newline at end of file
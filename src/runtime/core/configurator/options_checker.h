@@ -0,0 +1,115 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utils/common/thread_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::configurator {
+
+/**
+ * @brief Up-front checks of options sections, so a misconfiguration fails at init instead of
+ * being silently ignored or surfacing later on a worker thread. Each check returns an empty
+ * string if passed, or a description of the problem.
+ */
+
+inline size_t EditDistance(std::string_view lhs, std::string_view rhs) {
+  std::vector<size_t> dist(rhs.size() + 1);
+  for (size_t jj = 0; jj <= rhs.size(); ++jj) dist[jj] = jj;
+
+  for (size_t ii = 1; ii <= lhs.size(); ++ii) {
+    size_t prev = dist[0];
+    dist[0] = ii;
+    for (size_t jj = 1; jj <= rhs.size(); ++jj) {
+      size_t cur = dist[jj];
+      dist[jj] = std::min({dist[jj] + 1, dist[jj - 1] + 1,
+                           prev + (lhs[ii - 1] == rhs[jj - 1] ? 0 : 1)});
+      prev = cur;
+    }
+  }
+  return dist[rhs.size()];
+}
+
+// Every key of map 'node' should be one of 'known_keys'. A null or undefined node passes.
+inline std::string CheckOptionsKeys(const YAML::Node& node,
+                                    std::initializer_list<std::string_view> known_keys) {
+  if (!node || node.IsNull()) return {};
+  if (!node.IsMap()) return "options should be a map";
+
+  for (const auto& itr : node) {
+    const auto key = itr.first.as<std::string>();
+    if (std::ranges::find(known_keys, key) != known_keys.end()) continue;
+
+    std::string err = "unknown option '" + key + "'";
+    auto nearest_itr = std::ranges::min_element(known_keys, {}, [&key](std::string_view known) {
+      return EditDistance(key, known);
+    });
+    if (nearest_itr != known_keys.end() && EditDistance(key, *nearest_itr) <= 2) {
+      err += ", did you mean '" + std::string(*nearest_itr) + "'?";
+    }
+    return err;
+  }
+  return {};
+}
+
+inline std::string CheckCpuSet(const std::vector<uint32_t>& cpu_set) {
+  const uint32_t cpu_num = std::thread::hardware_concurrency();
+  for (auto cpu_idx : cpu_set) {
+    if (cpu_idx >= cpu_num) {
+      return "cpu index " + std::to_string(cpu_idx) + " out of range, this machine has " +
+             std::to_string(cpu_num) + " cpus";
+    }
+  }
+  return {};
+}
+
+// Accept '', 'SCHED_OTHER', 'SCHED_FIFO:<priority>' and 'SCHED_RR:<priority>' with priority in
+// 1~99, and 'SCHED_DEADLINE:<runtime_us>/<deadline_us>/<period_us>', the formats understood by
+// 'SetCpuSchedForCurrentThread'.
+inline std::string CheckSchedPolicy(std::string_view sched) {
+  if (sched.empty() || sched == "SCHED_OTHER") return {};
+
+  if (sched.starts_with("SCHED_DEADLINE")) {
+    try {
+      nxpilot::utils::common::ParseSchedDeadline(sched);
+    } catch (const std::exception& e) {
+      return e.what();
+    }
+    return {};
+  }
+
+  const std::string err = "invalid sched policy '" + std::string(sched) + "'";
+  auto pos = sched.find(':');
+  if (pos == std::string_view::npos) return err;
+
+  auto policy = sched.substr(0, pos);
+  auto priority = sched.substr(pos + 1);
+  if (policy != "SCHED_FIFO" && policy != "SCHED_RR") return err;
+  if (priority.empty() || priority.size() > 2 ||
+      !std::ranges::all_of(priority, [](char c) { return c >= '0' && c <= '9'; })) {
+    return err;
+  }
+  int priority_value = std::stoi(std::string(priority));
+  if (priority_value < 1 || priority_value > 99) return err + ", priority should be in 1~99";
+  return {};
+}
+
+inline std::string CheckThreadOptions(std::string_view sched,
+                                      const std::vector<uint32_t>& cpu_set) {
+  auto err = CheckSchedPolicy(sched);
+  if (!err.empty()) return err;
+  if (sched.starts_with("SCHED_DEADLINE") && !cpu_set.empty()) {
+    return "SCHED_DEADLINE threads can not be bound to cpus, use an exclusive cpuset instead";
+  }
+  return CheckCpuSet(cpu_set);
+}
+
+}  // namespace nxpilot::runtime::core::configurator
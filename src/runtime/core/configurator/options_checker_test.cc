@@ -0,0 +1,46 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/configurator/options_checker.h"
+
+namespace nxpilot::runtime::core::configurator {
+
+TEST(OptionsCheckerTest, CheckOptionsKeys) {
+  EXPECT_EQ(CheckOptionsKeys(YAML::Node(), {"a"}), "");
+  EXPECT_EQ(CheckOptionsKeys(YAML::Load("~"), {"a"}), "");
+  EXPECT_EQ(CheckOptionsKeys(YAML::Load("{dt_us: 1, wheel_size: [1]}"), {"dt_us", "wheel_size"}),
+            "");
+  EXPECT_EQ(CheckOptionsKeys(YAML::Load("[1]"), {"a"}), "options should be a map");
+
+  EXPECT_EQ(CheckOptionsKeys(YAML::Load("{wheel_sizes: [1]}"), {"dt_us", "wheel_size"}),
+            "unknown option 'wheel_sizes', did you mean 'wheel_size'?");
+  EXPECT_EQ(CheckOptionsKeys(YAML::Load("{foo: 1}"), {"dt_us", "wheel_size"}),
+            "unknown option 'foo'");
+}
+
+TEST(OptionsCheckerTest, CheckThreadOptions) {
+  EXPECT_EQ(CheckThreadOptions("", {0}), "");
+  EXPECT_EQ(CheckThreadOptions("SCHED_OTHER", {}), "");
+  EXPECT_EQ(CheckThreadOptions("SCHED_FIFO:50", {}), "");
+  EXPECT_EQ(CheckThreadOptions("SCHED_RR:1", {}), "");
+
+  EXPECT_NE(CheckThreadOptions("SCHED_FIFO", {}), "");
+  EXPECT_NE(CheckThreadOptions("SCHED_FIFO:", {}), "");
+  EXPECT_NE(CheckThreadOptions("SCHED_FIFO:0", {}), "");
+  EXPECT_NE(CheckThreadOptions("SCHED_FIFO:100", {}), "");
+  EXPECT_NE(CheckThreadOptions("SCHED_BATCH:10", {}), "");
+
+  EXPECT_EQ(CheckThreadOptions("SCHED_DEADLINE:500/1000/1000", {}), "");
+  EXPECT_NE(CheckThreadOptions("SCHED_DEADLINE:500/1000", {}), "");
+  EXPECT_NE(CheckThreadOptions("SCHED_DEADLINE:500/1000/1000/", {}), "");
+  EXPECT_NE(CheckThreadOptions("SCHED_DEADLINE:2000/1000/1000", {}), "");
+  EXPECT_NE(CheckThreadOptions("SCHED_DEADLINE:0/1000/1000", {}), "");
+  EXPECT_NE(CheckThreadOptions("SCHED_DEADLINE:500/1000/1000", {0}).find("exclusive cpuset"),
+            std::string::npos);
+
+  EXPECT_NE(CheckThreadOptions("", {std::thread::hardware_concurrency()}).find("out of range"),
+            std::string::npos);
+}
+
+}  // namespace nxpilot::runtime::core::configurator
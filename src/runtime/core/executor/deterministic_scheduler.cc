@@ -0,0 +1,204 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/executor/deterministic_scheduler.h"
+
+#include <algorithm>
+
+#include "utils/common/hash_tool.h"
+#include "utils/common/thread_tool.h"
+#include "utils/common/time_tool.h"
+
+namespace nxpilot::runtime::core::executor {
+
+void DeterministicScheduler::Initialize(const Options& options) {
+  options_ = options;
+  rng_.seed(options_.seed);
+  digest_ = nxpilot::utils::common::kFnv1a64Offset;
+
+  start_tp_ =
+      (options_.start_time_us == 0)
+          ? std::chrono::system_clock::now()
+          : nxpilot::utils::common::GetTimePointFromTimestampNs(options_.start_time_us * 1000);
+  time_source_.Reset(start_tp_, 0);
+}
+
+void DeterministicScheduler::Start() {
+  NXPILOT_CHECK_ERROR(!running_.exchange(true), "DeterministicScheduler is already started.");
+  thread_ptr_ = std::make_unique<std::thread>([this]() { Loop(); });
+
+  NXPILOT_INFO("Deterministic scheduler started with seed {}, {} executors", options_.seed,
+               queue_vec_.size());
+}
+
+void DeterministicScheduler::Stop(std::chrono::steady_clock::time_point deadline) {
+  if (!running_.exchange(false)) return;
+
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+    stop_flag_ = true;
+    stop_deadline_ = deadline;
+  }
+  cond_.notify_one();
+
+  if (thread_ptr_ && thread_ptr_->joinable()) thread_ptr_->join();
+  thread_ptr_.reset();
+
+  std::lock_guard<std::mutex> lck(mutex_);
+  stopped_ = true;
+  for (auto& queue : queue_vec_) {
+    queue.shutdown_report.deadline_exceeded = !queue.task_queue.empty();
+    queue.shutdown_report.dropped_task_num += queue.task_queue.size() + queue.timer_num;
+    queue.task_queue.clear();
+    queue.timer_num = 0;
+  }
+  ready_task_num_ = 0;
+  timer_map_.clear();
+
+  NXPILOT_INFO("Deterministic scheduler stopped after {} steps, schedule digest {:016x}",
+               step_num_, digest_);
+}
+
+uint32_t DeterministicScheduler::AddQueue(std::string_view name) {
+  std::lock_guard<std::mutex> lck(mutex_);
+  NXPILOT_CHECK_ERROR(!running_.load(), "Executor '{}' is added after the scheduler started.",
+                      name);
+
+  const auto queue_idx = static_cast<uint32_t>(queue_vec_.size());
+  queue_vec_.emplace_back(Queue{.name = std::string(name)});
+
+  auto itr = std::ranges::upper_bound(sorted_queue_idx_vec_, name, {},
+                                      [this](uint32_t idx) -> std::string_view {
+                                        return queue_vec_[idx].name;
+                                      });
+  sorted_queue_idx_vec_.insert(itr, queue_idx);
+  return queue_idx;
+}
+
+void DeterministicScheduler::Post(uint32_t queue_idx, ExecutorBase::Task&& task) noexcept {
+  try {
+    std::lock_guard<std::mutex> lck(mutex_);
+    auto& queue = queue_vec_[queue_idx];
+    if (stopped_) [[unlikely]] {
+      ++queue.shutdown_report.dropped_task_num;
+      return;
+    }
+    queue.task_queue.emplace_back(std::move(task));
+    ++ready_task_num_;
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("{}", e.what());
+    return;
+  }
+  cond_.notify_one();
+}
+
+void DeterministicScheduler::PostAt(uint32_t queue_idx, std::chrono::system_clock::time_point tp,
+                                    ExecutorBase::Task&& task) noexcept {
+  try {
+    std::lock_guard<std::mutex> lck(mutex_);
+    auto& queue = queue_vec_[queue_idx];
+    if (stop_flag_) [[unlikely]] {
+      ++queue.shutdown_report.dropped_task_num;
+      return;
+    }
+    timer_map_.emplace(tp, Timer{.queue_idx = queue_idx, .task = std::move(task)});
+    ++queue.timer_num;
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("{}", e.what());
+    return;
+  }
+  cond_.notify_one();
+}
+
+size_t DeterministicScheduler::GetTaskNum(uint32_t queue_idx) const {
+  std::lock_guard<std::mutex> lck(mutex_);
+  const auto& queue = queue_vec_[queue_idx];
+  return queue.task_queue.size() + queue.timer_num;
+}
+
+ExecutorBase::ShutdownReport DeterministicScheduler::GetShutdownReport(uint32_t queue_idx) const {
+  std::lock_guard<std::mutex> lck(mutex_);
+  return queue_vec_[queue_idx].shutdown_report;
+}
+
+uint64_t DeterministicScheduler::GetStepNum() const {
+  std::lock_guard<std::mutex> lck(mutex_);
+  return step_num_;
+}
+
+uint64_t DeterministicScheduler::GetScheduleDigest() const {
+  std::lock_guard<std::mutex> lck(mutex_);
+  return digest_;
+}
+
+bool DeterministicScheduler::PickTask(uint32_t& queue_idx, ExecutorBase::Task& task) {
+  if (ready_task_num_ == 0) return false;
+
+  candidate_vec_.clear();
+  for (uint32_t rank = 0; rank < sorted_queue_idx_vec_.size(); ++rank) {
+    if (!queue_vec_[sorted_queue_idx_vec_[rank]].task_queue.empty()) {
+      candidate_vec_.emplace_back(rank);
+    }
+  }
+
+  const uint32_t rank = candidate_vec_[rng_() % candidate_vec_.size()];
+  queue_idx = sorted_queue_idx_vec_[rank];
+  auto& task_queue = queue_vec_[queue_idx].task_queue;
+  task = std::move(task_queue.front());
+  task_queue.pop_front();
+  --ready_task_num_;
+
+  // The digest covers which executor ran at which virtual time since start, in step order.
+  const int64_t elapsed_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(time_source_.Now() - start_tp_).count();
+  digest_ = nxpilot::utils::common::HashFnv1a64(&rank, sizeof(rank), digest_);
+  digest_ = nxpilot::utils::common::HashFnv1a64(&elapsed_ns, sizeof(elapsed_ns), digest_);
+  ++step_num_;
+  return true;
+}
+
+void DeterministicScheduler::RunTask(ExecutorBase::Task& task) noexcept {
+  try {
+    task();
+  } catch (const std::exception& e) {
+    NXPILOT_FATAL("DeterministicScheduler run task get exception, {}", e.what());
+  }
+}
+
+void DeterministicScheduler::Loop() {
+  nxpilot::utils::common::SetNameForCurrentThread("nxpilot_det");
+
+  std::unique_lock<std::mutex> lck(mutex_);
+  while (true) {
+    // On stop, run the queued tasks until the deadline, without advancing the time.
+    if (stop_flag_ && std::chrono::steady_clock::now() >= stop_deadline_) break;
+
+    uint32_t queue_idx = 0;
+    ExecutorBase::Task task;
+    if (PickTask(queue_idx, task)) {
+      lck.unlock();
+      RunTask(task);
+      task = nullptr;
+      lck.lock();
+      if (stop_flag_) ++queue_vec_[queue_idx].shutdown_report.executed_task_num;
+      continue;
+    }
+    if (stop_flag_) break;
+
+    if (!timer_map_.empty()) {
+      const auto tp = timer_map_.begin()->first;
+      time_source_.AdvanceTo(tp);
+      while (!timer_map_.empty() && timer_map_.begin()->first == tp) {
+        auto node = timer_map_.extract(timer_map_.begin());
+        auto& queue = queue_vec_[node.mapped().queue_idx];
+        queue.task_queue.emplace_back(std::move(node.mapped().task));
+        --queue.timer_num;
+        ++ready_task_num_;
+      }
+      continue;
+    }
+
+    cond_.wait(lck, [this] { return stop_flag_ || ready_task_num_ > 0 || !timer_map_.empty(); });
+  }
+}
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,171 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "runtime/core/executor/executor_base.h"
+#include "runtime/core/executor/time_source.h"
+#include "utils/common/log_tool.h"
+
+namespace nxpilot::runtime::core::executor {
+
+/**
+ * @brief Run the tasks of many executors one at a time on a single thread, in an order that only
+ * depends on a seed, and on virtual time.
+ *
+ * Every executor has a FIFO queue. Each step picks one of the non-empty queues with a seeded
+ * random generator and runs its head task. Once all queues are empty, the virtual time jumps to
+ * the earliest timer and the timers due then are queued. A run is repeatable as long as all tasks
+ * are posted before 'Start' or by other tasks. Tasks posted by foreign threads, e.g. io threads of
+ * rpc backends, arrive at nondeterministic points.
+ */
+class DeterministicScheduler {
+ public:
+  struct Options {
+    bool enable = false;
+    uint64_t seed = 0;
+    // Virtual time at start in us since epoch, 0 starts from the real time.
+    uint64_t start_time_us = 0;
+  };
+
+  DeterministicScheduler() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~DeterministicScheduler() { Stop(std::chrono::steady_clock::time_point::max()); }
+
+  DeterministicScheduler(const DeterministicScheduler&) = delete;
+  DeterministicScheduler& operator=(const DeterministicScheduler&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  void Initialize(const Options& options);
+  void Start();
+  // Run the queued tasks until 'deadline', drop the pending timers. The reports per queue are
+  // kept for 'GetShutdownReport'.
+  void Stop(std::chrono::steady_clock::time_point deadline);
+
+  bool IsRunning() const { return running_.load(); }
+
+  // Add the queue of an executor, before 'Start'. Return the queue index. Queue names are unique.
+  uint32_t AddQueue(std::string_view name);
+
+  // Tasks posted after 'Stop' are dropped.
+  void Post(uint32_t queue_idx, ExecutorBase::Task&& task) noexcept;
+  void PostAt(uint32_t queue_idx, std::chrono::system_clock::time_point tp,
+              ExecutorBase::Task&& task) noexcept;
+
+  const SimTimeSource& GetTimeSource() const { return time_source_; }
+
+  size_t GetTaskNum(uint32_t queue_idx) const;
+  ExecutorBase::ShutdownReport GetShutdownReport(uint32_t queue_idx) const;
+
+  // Runs with the same seed and the same input take the same steps, compare the digests to check.
+  uint64_t GetStepNum() const;
+  uint64_t GetScheduleDigest() const;
+
+ private:
+  struct Queue {
+    std::string name;
+    std::deque<ExecutorBase::Task> task_queue;
+    size_t timer_num = 0;
+    ExecutorBase::ShutdownReport shutdown_report;
+  };
+
+  struct Timer {
+    uint32_t queue_idx;
+    ExecutorBase::Task task;
+  };
+
+  void Loop();
+  // Pop the next task to run, or return false if there is none. Called with 'mutex_' held.
+  bool PickTask(uint32_t& queue_idx, ExecutorBase::Task& task);
+  void RunTask(ExecutorBase::Task& task) noexcept;
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  std::atomic_bool running_ = false;
+
+  SimTimeSource time_source_;
+  std::chrono::system_clock::time_point start_tp_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stop_flag_ = false;
+  std::chrono::steady_clock::time_point stop_deadline_ =
+      std::chrono::steady_clock::time_point::max();
+  bool stopped_ = false;  // the thread is gone, posted tasks would never run
+  std::vector<Queue> queue_vec_;
+  // Queue indices sorted by name. Executors are initialized in parallel, so the indices differ
+  // between runs, the names do not.
+  std::vector<uint32_t> sorted_queue_idx_vec_;
+  size_t ready_task_num_ = 0;
+  // Equal keys keep the insertion order, so timers due at the same time are queued in schedule
+  // order.
+  std::multimap<std::chrono::system_clock::time_point, Timer> timer_map_;
+  std::mt19937_64 rng_;
+  std::vector<uint32_t> candidate_vec_;
+  uint64_t step_num_ = 0;
+  uint64_t digest_ = 0;
+
+  std::unique_ptr<std::thread> thread_ptr_;
+};
+
+// Executor of any configured type, whose tasks run on a 'DeterministicScheduler'. The options of
+// the original type are ignored.
+class DeterministicExecutor : public ExecutorBase {
+ public:
+  DeterministicExecutor(std::string_view type, DeterministicScheduler* scheduler_ptr)
+      : type_(type), scheduler_ptr_(scheduler_ptr) {}
+  ~DeterministicExecutor() = default;
+
+  void Initialize(std::string_view name, YAML::Node options_node) override {
+    name_ = std::string(name);
+    queue_idx_ = scheduler_ptr_->AddQueue(name);
+  }
+  void Start() override {}
+  void Shutdown() override {}
+  // The scheduler is stopped before its executors, report what it did with this queue.
+  ShutdownReport ShutdownUntil(std::chrono::steady_clock::time_point deadline) override {
+    return scheduler_ptr_->GetShutdownReport(queue_idx_);
+  }
+  std::string UpdateOptions(YAML::Node options_node) override { return ""; }
+
+  std::string_view Type() const noexcept override { return type_; }
+  std::string_view Name() const noexcept override { return name_; }
+
+  bool ThreadSafe() const noexcept override { return true; }
+
+  void Execute(Task&& task) noexcept override {
+    scheduler_ptr_->Post(queue_idx_, std::move(task));
+  }
+
+  bool SupportTimerSchedule() const noexcept override { return true; }
+  std::chrono::system_clock::time_point Now() const noexcept override {
+    return scheduler_ptr_->GetTimeSource().Now();
+  }
+  void ExecuteAt(std::chrono::system_clock::time_point tp, Task&& task) noexcept override {
+    scheduler_ptr_->PostAt(queue_idx_, tp, std::move(task));
+  }
+
+  size_t CurrentTaskNum() noexcept override { return scheduler_ptr_->GetTaskNum(queue_idx_); }
+
+ private:
+  std::string type_;
+  std::string name_;
+  DeterministicScheduler* scheduler_ptr_;
+  uint32_t queue_idx_ = 0;
+};
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,144 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/executor/deterministic_scheduler.h"
+#include "runtime/core/executor/executor_manager.h"
+
+namespace nxpilot::runtime::core::executor {
+
+namespace {
+
+struct RunResult {
+  std::vector<std::string> step_vec;
+  uint64_t digest = 0;
+};
+
+// Post a few tasks on each queue, some of them post more tasks.
+RunResult RunOnce(uint64_t seed, const std::vector<std::string>& queue_name_vec) {
+  DeterministicScheduler scheduler;
+  scheduler.Initialize(DeterministicScheduler::Options{.enable = true, .seed = seed});
+
+  std::vector<uint32_t> queue_idx_vec;
+  for (const auto& name : queue_name_vec) queue_idx_vec.emplace_back(scheduler.AddQueue(name));
+
+  RunResult result;
+  std::promise<void> done_promise;
+  const size_t total_num = queue_name_vec.size() * 10 * 2;
+  auto record = [&](const std::string& step) {
+    result.step_vec.emplace_back(step);
+    if (result.step_vec.size() == total_num) done_promise.set_value();
+  };
+
+  for (size_t ii = 0; ii < queue_name_vec.size(); ++ii) {
+    const auto queue_idx = queue_idx_vec[ii];
+    const auto& name = queue_name_vec[ii];
+    for (int jj = 0; jj < 10; ++jj) {
+      scheduler.Post(queue_idx, [&, queue_idx, name, jj]() {
+        record(name + std::to_string(jj));
+        scheduler.Post(queue_idx, [&, name, jj]() { record(name + "+" + std::to_string(jj)); });
+      });
+    }
+  }
+
+  scheduler.Start();
+  done_promise.get_future().wait();
+  scheduler.Stop(std::chrono::steady_clock::time_point::max());
+  result.digest = scheduler.GetScheduleDigest();
+  return result;
+}
+
+}  // namespace
+
+TEST(DeterministicSchedulerTest, same_seed_same_order) {
+  auto result_1 = RunOnce(42, {"a", "b", "c"});
+  auto result_2 = RunOnce(42, {"a", "b", "c"});
+  // Queue indices depend on the init order of the executors, the schedule must not.
+  auto result_3 = RunOnce(42, {"c", "a", "b"});
+
+  EXPECT_EQ(result_1.step_vec, result_2.step_vec);
+  EXPECT_EQ(result_1.step_vec, result_3.step_vec);
+  EXPECT_EQ(result_1.digest, result_2.digest);
+  EXPECT_EQ(result_1.digest, result_3.digest);
+
+  auto result_4 = RunOnce(43, {"a", "b", "c"});
+  EXPECT_NE(result_1.step_vec, result_4.step_vec);
+  EXPECT_NE(result_1.digest, result_4.digest);
+}
+
+TEST(DeterministicSchedulerTest, fifo_per_queue) {
+  auto result = RunOnce(7, {"a", "b"});
+
+  for (const std::string name : {"a", "b"}) {
+    std::vector<std::string> queue_step_vec;
+    for (const auto& step : result.step_vec) {
+      if (step.starts_with(name) && step.find('+') == std::string::npos) {
+        queue_step_vec.emplace_back(step);
+      }
+    }
+    ASSERT_EQ(queue_step_vec.size(), 10);
+    for (int ii = 0; ii < 10; ++ii) EXPECT_EQ(queue_step_vec[ii], name + std::to_string(ii));
+  }
+}
+
+TEST(DeterministicSchedulerTest, timers_on_virtual_time) {
+  DeterministicScheduler scheduler;
+  scheduler.Initialize(DeterministicScheduler::Options{.enable = true, .start_time_us = 1000000});
+  const auto start_tp = scheduler.GetTimeSource().Now();
+  auto queue_idx = scheduler.AddQueue("timer");
+
+  std::vector<std::chrono::system_clock::time_point> fired_vec;
+  std::promise<void> done_promise;
+  scheduler.Post(queue_idx, [&]() {
+    scheduler.PostAt(queue_idx, start_tp + std::chrono::hours(1), [&]() {
+      fired_vec.emplace_back(scheduler.GetTimeSource().Now());
+      done_promise.set_value();
+    });
+    scheduler.PostAt(queue_idx, start_tp + std::chrono::seconds(1),
+                     [&]() { fired_vec.emplace_back(scheduler.GetTimeSource().Now()); });
+  });
+
+  scheduler.Start();
+  ASSERT_EQ(done_promise.get_future().wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  scheduler.Stop(std::chrono::steady_clock::time_point::max());
+
+  ASSERT_EQ(fired_vec.size(), 2);
+  EXPECT_EQ(fired_vec[0], start_tp + std::chrono::seconds(1));
+  EXPECT_EQ(fired_vec[1], start_tp + std::chrono::hours(1));
+}
+
+TEST(DeterministicSchedulerTest, executor_manager) {
+  ExecutorManager executor_manager;
+  executor_manager.Initialize(YAML::Load(R"(
+deterministic:
+  enable: true
+  seed: 3
+  start_time_us: 1000000
+executors:
+  - name: work
+    type: guard_thread
+  - name: timer
+    type: time_wheel
+)"));
+  executor_manager.Start();
+
+  auto* timer_executor = executor_manager.GetExecutor("timer");
+  ASSERT_NE(timer_executor, nullptr);
+  EXPECT_EQ(timer_executor->Type(), "time_wheel");
+  EXPECT_EQ(executor_manager.GetTimeSource().Now(), timer_executor->Now());
+
+  std::promise<std::chrono::system_clock::time_point> fired_promise;
+  const auto due_tp = timer_executor->Now() + std::chrono::minutes(10);
+  timer_executor->ExecuteAt(due_tp, [&]() { fired_promise.set_value(timer_executor->Now()); });
+  EXPECT_EQ(fired_promise.get_future().get(), due_tp);
+
+  executor_manager.Shutdown();
+  EXPECT_GT(executor_manager.GetDeterministicScheduler().GetStepNum(), 0);
+}
+
+}  // namespace nxpilot::runtime::core::executor
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <string>
 
 #include "yaml-cpp/yaml.h"
@@ -17,10 +18,33 @@ class ExecutorBase {
   ExecutorBase(const ExecutorBase&) = delete;
   ExecutorBase& operator=(const ExecutorBase&) = delete;
 
+  struct ShutdownReport {
+    size_t executed_task_num = 0;  // tasks still run during shutdown
+    size_t dropped_task_num = 0;   // tasks discarded by policy or because of the deadline
+    bool deadline_exceeded = false;
+  };
+
   virtual void Initialize(std::string_view name, YAML::Node options_node) = 0;
   virtual void Start() = 0;
   virtual void Shutdown() = 0;
 
+  // Shutdown, but stop running queued tasks once 'deadline' has passed. A task already running
+  // can not be interrupted, so this may still return late. Executors without a task queue just
+  // call 'Shutdown'.
+  virtual ShutdownReport ShutdownUntil(std::chrono::steady_clock::time_point deadline) {
+    Shutdown();
+    return ShutdownReport{};
+  }
+
+  // Apply changed options while running. Return an empty string if every change took effect,
+  // otherwise a description of the changes that need a restart. Throw if the options are invalid.
+  virtual std::string UpdateOptions(YAML::Node options_node) {
+    return "executor type does not support live option updates";
+  }
+  // Throw if 'UpdateOptions' would reject 'options_node', without applying anything, so a reload
+  // can check every executor before it updates any.
+  virtual void CheckOptions(YAML::Node options_node) const {}
+
   virtual std::string_view Type() const noexcept = 0;
   virtual std::string_view Name() const noexcept = 0;
 
@@ -1,11 +1,16 @@
 // Copyright (C) 2024. All rights reserved.
 
-#include <ranges>
+#include <algorithm>
 
 #include "runtime/core/executor/executor_manager.h"
+#include "runtime/core/configurator/options_checker.h"
+#include "runtime/core/executor/executor_util.h"
 #include "runtime/core/executor/guard_thread_executor.h"
 #include "runtime/core/executor/main_thread_executor.h"
+#include "runtime/core/executor/sim_time_executor.h"
 #include "runtime/core/executor/time_wheel_executor.h"
+#include "runtime/core/metrics/metrics_registry.h"
+#include "utils/common/dependency_graph.h"
 
 namespace YAML {
 template <>
@@ -22,6 +27,25 @@ struct convert<nxpilot::runtime::core::executor::ExecutorManager::Options> {
       executor_node["options"] = executor.options;
       node["executors"].push_back(executor_node);
     }
+    node["shutdown_timeout_ms"] = rhs.shutdown_timeout_ms;
+    node["thread_placement"]["auto_assign"] = rhs.thread_placement.auto_assign;
+    node["thread_placement"]["strict"] = rhs.thread_placement.strict;
+    node["task_trace"]["enable"] = rhs.task_trace.enable;
+    node["task_trace"]["file_path"] = rhs.task_trace.file_path;
+    node["task_trace"]["ring_capacity"] = rhs.task_trace.ring_capacity;
+    node["watchdog"]["enable"] = rhs.watchdog.enable;
+    node["watchdog"]["task_budget_ms"] = rhs.watchdog.task_budget_ms;
+    node["watchdog"]["check_interval_ms"] = rhs.watchdog.check_interval_ms;
+    node["watchdog"]["action"] = rhs.watchdog.action;
+    node["watchdog"]["capture_stack"] = rhs.watchdog.capture_stack;
+    for (const auto& [name, budget_ms] : rhs.watchdog.executor_task_budget_ms) {
+      node["watchdog"]["executor_task_budget_ms"][name] = budget_ms;
+    }
+    node["latency_trace"]["enable"] = rhs.latency_trace.enable;
+    node["time_source"] = rhs.time_source;
+    node["deterministic"]["enable"] = rhs.deterministic.enable;
+    node["deterministic"]["seed"] = rhs.deterministic.seed;
+    node["deterministic"]["start_time_us"] = rhs.deterministic.start_time_us;
 
     return node;
   }
@@ -47,6 +71,72 @@ struct convert<nxpilot::runtime::core::executor::ExecutorManager::Options> {
       }
     }
 
+    if (node["shutdown_timeout_ms"]) {
+      rhs.shutdown_timeout_ms = node["shutdown_timeout_ms"].as<uint32_t>();
+    }
+
+    if (node["thread_placement"]) {
+      const auto& placement_node = node["thread_placement"];
+      if (placement_node["auto_assign"]) {
+        rhs.thread_placement.auto_assign = placement_node["auto_assign"].as<bool>();
+      }
+      if (placement_node["strict"]) {
+        rhs.thread_placement.strict = placement_node["strict"].as<bool>();
+      }
+    }
+
+    if (node["task_trace"]) {
+      const auto& trace_node = node["task_trace"];
+      if (trace_node["enable"]) rhs.task_trace.enable = trace_node["enable"].as<bool>();
+      if (trace_node["file_path"]) {
+        rhs.task_trace.file_path = trace_node["file_path"].as<std::string>();
+      }
+      if (trace_node["ring_capacity"]) {
+        rhs.task_trace.ring_capacity = trace_node["ring_capacity"].as<uint32_t>();
+      }
+    }
+
+    if (node["watchdog"]) {
+      const auto& watchdog_node = node["watchdog"];
+      if (watchdog_node["enable"]) rhs.watchdog.enable = watchdog_node["enable"].as<bool>();
+      if (watchdog_node["task_budget_ms"]) {
+        rhs.watchdog.task_budget_ms = watchdog_node["task_budget_ms"].as<uint32_t>();
+      }
+      if (watchdog_node["check_interval_ms"]) {
+        rhs.watchdog.check_interval_ms = watchdog_node["check_interval_ms"].as<uint32_t>();
+      }
+      if (watchdog_node["action"]) {
+        rhs.watchdog.action = watchdog_node["action"].as<std::string>();
+      }
+      if (watchdog_node["capture_stack"]) {
+        rhs.watchdog.capture_stack = watchdog_node["capture_stack"].as<bool>();
+      }
+      if (watchdog_node["executor_task_budget_ms"]) {
+        rhs.watchdog.executor_task_budget_ms =
+            watchdog_node["executor_task_budget_ms"]
+                .as<std::unordered_map<std::string, uint32_t>>();
+      }
+    }
+
+    if (node["latency_trace"] && node["latency_trace"]["enable"]) {
+      rhs.latency_trace.enable = node["latency_trace"]["enable"].as<bool>();
+    }
+
+    if (node["time_source"]) rhs.time_source = node["time_source"].as<std::string>();
+
+    if (node["deterministic"]) {
+      const auto& deterministic_node = node["deterministic"];
+      if (deterministic_node["enable"]) {
+        rhs.deterministic.enable = deterministic_node["enable"].as<bool>();
+      }
+      if (deterministic_node["seed"]) {
+        rhs.deterministic.seed = deterministic_node["seed"].as<uint64_t>();
+      }
+      if (deterministic_node["start_time_us"]) {
+        rhs.deterministic.start_time_us = deterministic_node["start_time_us"].as<uint64_t>();
+      }
+    }
+
     return true;
   }
 };
@@ -54,13 +144,74 @@ struct convert<nxpilot::runtime::core::executor::ExecutorManager::Options> {
 
 namespace nxpilot::runtime::core::executor {
 
+void ExecutorManager::RegisterExecutorGenFunc(std::string_view type,
+                                              ExecutorGenFunc&& executor_gen_func) {
+  NXPILOT_CHECK_ERROR(state_.load() == State::kPreInit,
+                      "Executor type can only be registered when state is 'PreInit'.");
+  NXPILOT_CHECK_ERROR(type != "main_thread" && type != "guard_thread" && type != "time_wheel" &&
+                          type != "sim_time",
+                      "Can not override builtin executor type '{}'", type);
+
+  std::lock_guard<std::mutex> lck(executor_gen_func_map_mutex_);
+  auto emplace_ret = executor_gen_func_map_.emplace(type, std::move(executor_gen_func));
+  NXPILOT_CHECK_ERROR(emplace_ret.second, "Duplicate executor type '{}'", type);
+}
+
+ExecutorManager::Options ExecutorManager::ParseOptions(YAML::Node options_node) const {
+  auto err = configurator::CheckOptionsKeys(
+      options_node,
+      {"executors", "shutdown_timeout_ms", "thread_placement", "task_trace", "watchdog",
+       "latency_trace", "time_source", "deterministic"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid executor options, {}", err);
+  if (options_node && options_node["thread_placement"]) {
+    err = configurator::CheckOptionsKeys(options_node["thread_placement"],
+                                         {"auto_assign", "strict"});
+    NXPILOT_CHECK_ERROR(err.empty(), "Invalid executor thread_placement options, {}", err);
+  }
+  if (options_node && options_node["task_trace"]) {
+    err = configurator::CheckOptionsKeys(options_node["task_trace"],
+                                         {"enable", "file_path", "ring_capacity"});
+    NXPILOT_CHECK_ERROR(err.empty(), "Invalid executor task_trace options, {}", err);
+  }
+  if (options_node && options_node["watchdog"]) {
+    err = configurator::CheckOptionsKeys(
+        options_node["watchdog"], {"enable", "task_budget_ms", "check_interval_ms", "action",
+                                   "capture_stack", "executor_task_budget_ms"});
+    NXPILOT_CHECK_ERROR(err.empty(), "Invalid executor watchdog options, {}", err);
+  }
+  if (options_node && options_node["latency_trace"]) {
+    err = configurator::CheckOptionsKeys(options_node["latency_trace"], {"enable"});
+    NXPILOT_CHECK_ERROR(err.empty(), "Invalid executor latency_trace options, {}", err);
+  }
+  if (options_node && options_node["deterministic"]) {
+    err = configurator::CheckOptionsKeys(options_node["deterministic"],
+                                         {"enable", "seed", "start_time_us"});
+    NXPILOT_CHECK_ERROR(err.empty(), "Invalid executor deterministic options, {}", err);
+  }
+  if (options_node && options_node["executors"]) {
+    NXPILOT_CHECK_ERROR(options_node["executors"].IsSequence(),
+                        "Invalid executor options, 'executors' should be a list");
+    for (const auto& executor_node : options_node["executors"]) {
+      err = configurator::CheckOptionsKeys(executor_node, {"name", "type", "options"});
+      NXPILOT_CHECK_ERROR(err.empty() && executor_node["name"] && executor_node["type"],
+                          "Invalid executor options, every executor needs 'name' and 'type'{}",
+                          err.empty() ? "" : ", " + err);
+    }
+  }
+
+  Options options;
+  if (options_node && !options_node.IsNull()) {
+    options = options_node.as<Options>();
+  }
+  return options;
+}
+
 void ExecutorManager::Initialize(YAML::Node options_node) {
   NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
                       "ExecutorManager can only be initialized once.");
 
-  if (options_node && !options_node.IsNull()) {
-    options_ = options_node.as<Options>();
-  }
+  options_ = ParseOptions(options_node);
+  PlanPlacement();
 
   std::string default_main_thread_name = "nxpilot_main";
   YAML::Node default_main_thread_options = YAML::Node(YAML::NodeType::Null);
@@ -87,9 +238,52 @@ void ExecutorManager::Initialize(YAML::Node options_node) {
     ++idx;
   }
 
+  if (options_.watchdog.enable) {
+    watchdog_.RegisterOverrunCallback([](const ExecutorWatchdog::OverrunReport& report) {
+      nxpilot::runtime::core::metrics::GetMetricsRegistry()
+          .GetCounter("nxpilot_executor_watchdog_overruns_total",
+                      "Tasks that ran over their watchdog budget.",
+                      {{"executor", report.executor_name}})
+          .Inc();
+    });
+    watchdog_.SetLogger(logger_ptr_);
+    watchdog_.Start(options_.watchdog);
+  }
+
+  const bool deterministic = options_.deterministic.enable;
+  if (deterministic) {
+    deterministic_scheduler_.SetLogger(logger_ptr_);
+    deterministic_scheduler_.Initialize(options_.deterministic);
+    time_source_ptr_ = &deterministic_scheduler_.GetTimeSource();
+    if (!options_.time_source.empty()) {
+      NXPILOT_WARN("Executor time_source '{}' is ignored in deterministic mode",
+                   options_.time_source);
+    }
+  }
+
+  if (options_.latency_trace.enable) {
+    nxpilot::runtime::core::trace::GetLatencyTracker().SetEnabled(true);
+  }
+
+  // With task tracing, the watchdog or latency tracing, every executor is wrapped to record,
+  // watch or trace its tasks. Only the enabled decorators are stacked, each wraps the task once on
+  // submission. The latency hop of a task is taken first when it runs.
+  auto wrap = [this](std::unique_ptr<ExecutorBase> executor_ptr) {
+    if (options_.task_trace.enable) {
+      executor_ptr = std::make_unique<TracedExecutor>(std::move(executor_ptr), &task_tracer_);
+    }
+    if (options_.watchdog.enable) {
+      executor_ptr = std::make_unique<WatchedExecutor>(std::move(executor_ptr), &watchdog_);
+    }
+    if (options_.latency_trace.enable) {
+      executor_ptr = std::make_unique<LatencyTracedExecutor>(std::move(executor_ptr));
+    }
+    return executor_ptr;
+  };
+
   // First MainThreadExecutor
   {
-    std::unique_ptr<ExecutorBase> executor_ptr = GetMainThreadExecutor();
+    std::unique_ptr<ExecutorBase> executor_ptr = wrap(GetMainThreadExecutor());
     executor_ptr->Initialize(default_main_thread_name, default_main_thread_options);
     used_executor_names_.push_back(default_main_thread_name);
     executor_map_.emplace(default_main_thread_name, std::move(executor_ptr));
@@ -97,12 +291,23 @@ void ExecutorManager::Initialize(YAML::Node options_node) {
 
   // Second GetGuardThreadExecutor
   {
-    std::unique_ptr<ExecutorBase> executor_ptr = GetGuardThreadExecutor();
+    std::unique_ptr<ExecutorBase> raw_executor_ptr =
+        deterministic ? GetDeterministicExecutor("guard_thread") : GetGuardThreadExecutor();
+    ExecutorBase* guard_executor_ptr = raw_executor_ptr.get();
+    std::unique_ptr<ExecutorBase> executor_ptr = wrap(std::move(raw_executor_ptr));
     executor_ptr->Initialize(default_guard_thread_name, default_guard_thread_options);
     used_executor_names_.push_back(default_guard_thread_name);
     executor_map_.emplace(default_guard_thread_name, std::move(executor_ptr));
+
+    // The trace is flushed on the guard thread, unwrapped so flushes are not traced.
+    if (options_.task_trace.enable) {
+      task_tracer_.SetLogger(logger_ptr_);
+      task_tracer_.Start(options_.task_trace, guard_executor_ptr);
+    }
   }
 
+  // The other executors are independent of each other, initialize them in parallel.
+  nxpilot::utils::common::DependencyGraph init_graph;
   for (auto& executor_options : options_.executors_options) {
     std::unique_ptr<ExecutorBase> executor_ptr;
 
@@ -113,17 +318,43 @@ void ExecutorManager::Initialize(YAML::Node options_node) {
     } else {
       NXPILOT_CHECK_ERROR(executor_map_.find(executor_options.name) == executor_map_.end(),
                           "Duplicate executor name '{}'", executor_options.name);
-      if (executor_options.type == "time_wheel") {
+      if (deterministic) {
+        NXPILOT_CHECK_ERROR(executor_options.type == "time_wheel" ||
+                                executor_options.type == "sim_time" ||
+                                executor_gen_func_map_.contains(executor_options.type),
+                            "Invalid executor type '{}'", executor_options.type);
+        executor_ptr = GetDeterministicExecutor(executor_options.type);
+      } else if (executor_options.type == "time_wheel") {
         executor_ptr = GetTimeWheelExecutor();
+      } else if (executor_options.type == "sim_time") {
+        executor_ptr = GetSimTimeExecutor();
+        if (executor_options.name == options_.time_source) {
+          time_source_ptr_ = &static_cast<SimTimeExecutor*>(executor_ptr.get())->GetTimeSource();
+        }
       } else {
-        NXPILOT_CHECK_ERROR(false, "Invalid executor type '{}'", executor_options.type);
+        auto gen_iter = executor_gen_func_map_.find(executor_options.type);
+        NXPILOT_CHECK_ERROR(gen_iter != executor_gen_func_map_.end(),
+                            "Invalid executor type '{}'", executor_options.type);
+        executor_ptr = gen_iter->second();
+        NXPILOT_CHECK_ERROR(executor_ptr != nullptr, "Executor type '{}' generate a null executor",
+                            executor_options.type);
       }
+      executor_ptr = wrap(std::move(executor_ptr));
     }
 
-    executor_ptr->Initialize(executor_options.name, executor_options.options);
+    init_graph.AddNode(executor_options.name,
+                       [executor_raw_ptr = executor_ptr.get(), &executor_options]() {
+                         executor_raw_ptr->Initialize(executor_options.name,
+                                                      executor_options.options);
+                       });
     used_executor_names_.push_back(executor_options.name);
     executor_map_.emplace(executor_options.name, std::move(executor_ptr));
   }
+  init_graph.Run();
+
+  NXPILOT_CHECK_ERROR(options_.time_source.empty() || time_source_ptr_ != &GetSystemTimeSource(),
+                      "Invalid time_source '{}', should be the name of a 'sim_time' executor",
+                      options_.time_source);
 
   NXPILOT_INFO("ExecutorManager init completed");
 }
@@ -131,12 +362,24 @@ void ExecutorManager::Initialize(YAML::Node options_node) {
 void ExecutorManager::Start() {
   NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
                       "Method can only be called when state is 'kInit'.");
+
+  // Executors do not depend on each other, spawn their threads in parallel.
+  nxpilot::utils::common::DependencyGraph start_graph;
   for (auto& executor_name : used_executor_names_) {
     auto iter = executor_map_.find(executor_name);
     NXPILOT_CHECK_ERROR(iter != executor_map_.end(), "Missing '{}' in executor_map_",
                         executor_name);
-    iter->second->Start();
+    start_graph.AddNode(executor_name,
+                        [executor_raw_ptr = iter->second.get()]() { executor_raw_ptr->Start(); });
   }
+  start_graph.Run();
+
+  // Tasks posted while the executors started are queued, and run from here on.
+  if (options_.deterministic.enable) deterministic_scheduler_.Start();
+
+  RegisterMetricsCollector();
+
+  NXPILOT_INFO("ExecutorManager start completed");
 }
 
 void ExecutorManager::Shutdown() {
@@ -144,14 +387,299 @@ void ExecutorManager::Shutdown() {
     return;
   }
 
-  for (auto executor_name : std::views::reverse(used_executor_names_)) {
+  const auto begin_time_point = std::chrono::steady_clock::now();
+  const auto deadline = (options_.shutdown_timeout_ms == 0)
+                            ? std::chrono::steady_clock::time_point::max()
+                            : begin_time_point +
+                                  std::chrono::milliseconds(options_.shutdown_timeout_ms);
+
+  // Scrapes read the executors, stop collecting them first.
+  if (metrics_collector_id_ != 0) {
+    nxpilot::runtime::core::metrics::GetMetricsRegistry().UnregisterCollector(
+        metrics_collector_id_);
+    metrics_collector_id_ = 0;
+  }
+
+  shutdown_report_vec_.clear();
+  shutdown_report_vec_.resize(used_executor_names_.size());
+
+  // All queued tasks run on the scheduler, the executors then only collect its reports.
+  deterministic_scheduler_.Stop(deadline);
+
+  auto shutdown_func = [this, deadline](size_t idx) {
+    const auto& executor_name = used_executor_names_[idx];
     auto iter = executor_map_.find(executor_name);
     NXPILOT_CHECK_ERROR(iter != executor_map_.end(), "Missing '{}' in executor_map_",
                         executor_name);
-    iter->second->Shutdown();
+
+    auto shutdown_begin_time_point = std::chrono::steady_clock::now();
+    auto& report = shutdown_report_vec_[idx];
+    report.name = executor_name;
+    report.report = iter->second->ShutdownUntil(deadline);
+    report.cost = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - shutdown_begin_time_point);
+  };
+
+  // The first two are the main and guard thread executors. Others may still post to them while
+  // draining, so they stop last, and all the others drain in parallel.
+  constexpr size_t kDefaultExecutorNum = 2;
+  nxpilot::utils::common::DependencyGraph shutdown_graph;
+  for (size_t ii = kDefaultExecutorNum; ii < used_executor_names_.size(); ++ii) {
+    shutdown_graph.AddNode(used_executor_names_[ii], [&shutdown_func, ii]() { shutdown_func(ii); });
+  }
+  shutdown_graph.Run(std::max<uint32_t>(shutdown_graph.Size(), 1));
+
+  for (size_t ii = std::min(kDefaultExecutorNum, used_executor_names_.size()); ii > 0; --ii) {
+    shutdown_func(ii - 1);
+  }
+
+  task_tracer_.Stop();
+  watchdog_.Stop();
+  if (options_.latency_trace.enable) {
+    auto& latency_tracker = nxpilot::runtime::core::trace::GetLatencyTracker();
+    latency_tracker.SetEnabled(false);
+    NXPILOT_INFO("Latency trace report:\n{}", latency_tracker.Report());
+  }
+
+  size_t executed_task_num = 0, dropped_task_num = 0;
+  for (const auto& report : shutdown_report_vec_) {
+    executed_task_num += report.report.executed_task_num;
+    dropped_task_num += report.report.dropped_task_num;
+    if (report.report.dropped_task_num != 0 || report.report.deadline_exceeded) {
+      NXPILOT_WARN("Executor '{}' shutdown in {} us, {} left tasks executed, {} dropped{}",
+                   report.name, report.cost.count(), report.report.executed_task_num,
+                   report.report.dropped_task_num,
+                   report.report.deadline_exceeded ? ", deadline exceeded" : "");
+    }
   }
 
-  NXPILOT_INFO("ExecutorManager shutdown");
+  NXPILOT_INFO("ExecutorManager shutdown in {} us, {} left tasks executed, {} dropped",
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - begin_time_point)
+                   .count(),
+               executed_task_num, dropped_task_num);
+}
+
+std::vector<std::string> ExecutorManager::UpdateOptions(YAML::Node options_node) {
+  CheckOptions(options_node);
+
+  Options new_options = ParseOptions(options_node);
+  ApplyAutoAssignedCpus(new_options);
+  std::vector<std::string> restart_reason_vec;
+
+  for (const auto& new_executor_options : new_options.executors_options) {
+    const auto& name = new_executor_options.name;
+    auto old_itr = std::ranges::find(options_.executors_options, name,
+                                     &Options::ExecutorOptions::name);
+    if (old_itr == options_.executors_options.end()) {
+      restart_reason_vec.emplace_back("executor '" + name + "' is added");
+      continue;
+    }
+    if (old_itr->type != new_executor_options.type) {
+      restart_reason_vec.emplace_back("type of executor '" + name + "' is changed");
+      continue;
+    }
+    if (YAML::Dump(old_itr->options) == YAML::Dump(new_executor_options.options)) continue;
+
+    // The options were checked, a failure to apply them must not leave the later executors
+    // behind.
+    std::string reason;
+    try {
+      reason = executor_map_.find(name)->second->UpdateOptions(new_executor_options.options);
+    } catch (const std::exception& e) {
+      reason = std::string("update get exception, ") + e.what();
+    }
+    if (!reason.empty()) {
+      restart_reason_vec.emplace_back("executor '" + name + "', " + reason);
+    }
+    old_itr->options = new_executor_options.options;
+  }
+
+  for (const auto& old_executor_options : options_.executors_options) {
+    if (std::ranges::none_of(new_options.executors_options, [&](const auto& new_executor_options) {
+          return new_executor_options.name == old_executor_options.name;
+        })) {
+      restart_reason_vec.emplace_back("executor '" + old_executor_options.name + "' is removed");
+    }
+  }
+
+  if (options_.thread_placement.auto_assign != new_options.thread_placement.auto_assign ||
+      options_.thread_placement.strict != new_options.thread_placement.strict) {
+    restart_reason_vec.emplace_back("thread_placement is changed");
+  }
+
+  const auto& old_trace = options_.task_trace;
+  const auto& new_trace = new_options.task_trace;
+  if (old_trace.enable != new_trace.enable || old_trace.file_path != new_trace.file_path ||
+      old_trace.ring_capacity != new_trace.ring_capacity) {
+    restart_reason_vec.emplace_back("task_trace is changed");
+  }
+
+  const auto& old_watchdog = options_.watchdog;
+  const auto& new_watchdog = new_options.watchdog;
+  if (old_watchdog.enable != new_watchdog.enable ||
+      old_watchdog.task_budget_ms != new_watchdog.task_budget_ms ||
+      old_watchdog.check_interval_ms != new_watchdog.check_interval_ms ||
+      old_watchdog.action != new_watchdog.action ||
+      old_watchdog.capture_stack != new_watchdog.capture_stack ||
+      old_watchdog.executor_task_budget_ms != new_watchdog.executor_task_budget_ms) {
+    restart_reason_vec.emplace_back("watchdog is changed");
+  }
+
+  if (options_.latency_trace.enable != new_options.latency_trace.enable) {
+    restart_reason_vec.emplace_back("latency_trace is changed");
+  }
+
+  const auto& old_deterministic = options_.deterministic;
+  const auto& new_deterministic = new_options.deterministic;
+  if (old_deterministic.enable != new_deterministic.enable ||
+      old_deterministic.seed != new_deterministic.seed ||
+      old_deterministic.start_time_us != new_deterministic.start_time_us) {
+    restart_reason_vec.emplace_back("deterministic is changed");
+  }
+
+  if (options_.time_source != new_options.time_source) {
+    restart_reason_vec.emplace_back("time_source is changed");
+  }
+
+  if (options_.shutdown_timeout_ms != new_options.shutdown_timeout_ms) {
+    options_.shutdown_timeout_ms = new_options.shutdown_timeout_ms;
+    NXPILOT_INFO("Executor shutdown timeout updated to {} ms", options_.shutdown_timeout_ms);
+  }
+
+  return restart_reason_vec;
+}
+
+void ExecutorManager::RegisterMetricsCollector() {
+  auto& registry = nxpilot::runtime::core::metrics::GetMetricsRegistry();
+  metrics_collector_id_ =
+      registry.RegisterCollector([this](nxpilot::runtime::core::metrics::MetricWriter& writer) {
+        for (const auto& executor_name : used_executor_names_) {
+          writer.AddGauge("nxpilot_executor_queued_tasks", "Tasks queued on the executor.",
+                          {{"executor", executor_name}},
+                          static_cast<double>(
+                              executor_map_.find(executor_name)->second->CurrentTaskNum()));
+        }
+
+        if (!options_.latency_trace.enable) return;
+        // Latencies are recorded in ns, exported in seconds.
+        constexpr double kUnitScale = 1e-9;
+        nxpilot::runtime::core::trace::GetLatencyTracker().Visit(
+            [&writer](std::string_view pipeline, const nxpilot::utils::common::Histogram& histogram,
+                      const auto& stage_histogram_vec) {
+              writer.AddSummary("nxpilot_pipeline_latency_seconds",
+                                "End-to-end latency of the pipeline.",
+                                {{"pipeline", std::string(pipeline)}}, histogram, kUnitScale);
+              for (const auto& stage_histogram_ptr : stage_histogram_vec) {
+                writer.AddSummary("nxpilot_stage_latency_seconds",
+                                  "Latency of a stage of the pipeline.",
+                                  {{"pipeline", std::string(pipeline)},
+                                   {"stage", stage_histogram_ptr->stage}},
+                                  stage_histogram_ptr->histogram, kUnitScale);
+              }
+            });
+      });
+}
+
+void ExecutorManager::PlanPlacement() {
+  std::vector<ThreadPlacementRequest> request_vec;
+  for (const auto& executor_options : options_.executors_options) {
+    const auto& node = executor_options.options;
+    if (!node.IsMap()) continue;
+
+    // Malformed values are reported by the executor itself during its init.
+    ThreadPlacementRequest request{.name = executor_options.name};
+    try {
+      if (node["thread_sched_policy"]) {
+        request.sched_policy = node["thread_sched_policy"].as<std::string>();
+      }
+      if (node["thread_bind_cpu"]) {
+        request.cpu_set = node["thread_bind_cpu"].as<std::vector<uint32_t>>();
+      }
+    } catch (const YAML::Exception&) {
+      continue;
+    }
+    request_vec.emplace_back(std::move(request));
+  }
+
+  auto topology = nxpilot::utils::common::LoadCpuTopology();
+  // Before any executor thread is bound, so it is also what clearing 'thread_bind_cpu' restores.
+  const auto& affinity_cpu_vec = GetStartupProcessAffinity();
+  std::erase_if(topology.allowed_cpus, [&affinity_cpu_vec](uint32_t cpu) {
+    return !std::ranges::binary_search(affinity_cpu_vec, cpu);
+  });
+
+  placement_plan_ =
+      PlanThreadPlacement(topology, request_vec, options_.thread_placement.auto_assign);
+
+  for (const auto& placement : placement_plan_.placement_vec) {
+    if (!placement.auto_assigned) continue;
+    auto itr = std::ranges::find(options_.executors_options, placement.name,
+                                 &Options::ExecutorOptions::name);
+    itr->options.reset(YAML::Clone(itr->options));
+    itr->options["thread_bind_cpu"] = placement.cpu_set;
+    auto_assigned_cpu_map_.emplace(placement.name, placement.cpu_set);
+    NXPILOT_INFO("Real-time executor '{}' is auto assigned to cpu {}", placement.name,
+                 nxpilot::utils::common::FormatCpuList(placement.cpu_set));
+  }
+
+  for (const auto& warning : placement_plan_.warning_vec) {
+    NXPILOT_WARN("Thread placement: {}", warning);
+  }
+  if (placement_plan_.error_vec.empty()) return;
+
+  std::string err_str;
+  for (const auto& err : placement_plan_.error_vec) {
+    err_str += (err_str.empty() ? "" : "; ") + err;
+  }
+  NXPILOT_CHECK_ERROR(!options_.thread_placement.strict, "Invalid thread placement, {}", err_str);
+  NXPILOT_ERROR("Invalid thread placement, {}", err_str);
+}
+
+void ExecutorManager::CheckOptions(YAML::Node options_node) const {
+  NXPILOT_CHECK_ERROR(state_.load() == State::kStart,
+                      "Method can only be called when state is 'Start'.");
+
+  Options new_options = ParseOptions(options_node);
+  ApplyAutoAssignedCpus(new_options);
+  for (const auto& new_executor_options : new_options.executors_options) {
+    auto old_itr = std::ranges::find(options_.executors_options, new_executor_options.name,
+                                     &Options::ExecutorOptions::name);
+    if (old_itr == options_.executors_options.end() ||
+        old_itr->type != new_executor_options.type ||
+        YAML::Dump(old_itr->options) == YAML::Dump(new_executor_options.options)) {
+      continue;
+    }
+    executor_map_.find(new_executor_options.name)->second->CheckOptions(
+        new_executor_options.options);
+  }
+}
+
+// Keep the cpus picked at init for executors that are still real-time and unpinned, otherwise a
+// reload would unpin them.
+void ExecutorManager::ApplyAutoAssignedCpus(Options& options) const {
+  for (auto& executor_options : options.executors_options) {
+    auto itr = auto_assigned_cpu_map_.find(executor_options.name);
+    if (itr == auto_assigned_cpu_map_.end()) continue;
+
+    auto& node = executor_options.options;
+    if (!node.IsMap() || node["thread_bind_cpu"] || !node["thread_sched_policy"].IsScalar() ||
+        !IsFixedPriorityRealTimeSchedPolicy(node["thread_sched_policy"].as<std::string>())) {
+      continue;
+    }
+    node.reset(YAML::Clone(node));
+    node["thread_bind_cpu"] = itr->second;
+  }
+}
+
+ExecutorBase* ExecutorManager::GetExecutor(std::string_view executor_name) const {
+  NXPILOT_CHECK_ERROR(state_.load() != State::kPreInit,
+                      "Method can not be called when state is 'kPreInit'.");
+  auto iter = executor_map_.find(executor_name);
+  if (iter == executor_map_.end()) {
+    return nullptr;
+  }
+  return iter->second.get();
 }
 
 std::unique_ptr<ExecutorBase> ExecutorManager::GetMainThreadExecutor() {
@@ -178,4 +706,18 @@ std::unique_ptr<ExecutorBase> ExecutorManager::GetTimeWheelExecutor() {
   return ptr;
 }
 
+std::unique_ptr<ExecutorBase> ExecutorManager::GetSimTimeExecutor() {
+  NXPILOT_CHECK_ERROR(state_.load() == State::kInit,
+                      "Method can only be called when state is 'kInit'.");
+  auto ptr = std::make_unique<SimTimeExecutor>();
+  ptr->SetLogger(logger_ptr_);
+  return ptr;
+}
+
+std::unique_ptr<ExecutorBase> ExecutorManager::GetDeterministicExecutor(std::string_view type) {
+  NXPILOT_CHECK_ERROR(state_.load() == State::kInit,
+                      "Method can only be called when state is 'kInit'.");
+  return std::make_unique<DeterministicExecutor>(type, &deterministic_scheduler_);
+}
+
 }  // namespace nxpilot::runtime::core::executor
\ No newline at end of file
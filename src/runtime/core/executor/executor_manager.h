@@ -5,11 +5,18 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "runtime/core/executor/deterministic_scheduler.h"
 #include "runtime/core/executor/executor_base.h"
+#include "runtime/core/executor/executor_watchdog.h"
+#include "runtime/core/executor/latency_traced_executor.h"
+#include "runtime/core/executor/task_tracer.h"
+#include "runtime/core/executor/thread_placement_planner.h"
+#include "runtime/core/executor/time_source.h"
 #include "utils/common/log_tool.h"
 #include "utils/common/string_tool.h"
 #include "yaml-cpp/yaml.h"
@@ -31,6 +38,33 @@ class ExecutorManager {
       YAML::Node options;
     };
     std::vector<ExecutorOptions> executors_options;
+    // Deadline for all executors to stop, 0 means waiting for every queued task.
+    uint32_t shutdown_timeout_ms = 0;
+    struct ThreadPlacementOptions {
+      // Pin unpinned real-time executors to free isolated physical cores.
+      bool auto_assign = false;
+      // Fail init on placement errors instead of logging them.
+      bool strict = false;
+    };
+    ThreadPlacementOptions thread_placement;
+    TaskTracer::Options task_trace;
+    ExecutorWatchdog::Options watchdog;
+    struct LatencyTraceOptions {
+      // Carry latency traces through the executors and aggregate them, see 'LatencyTracker'.
+      bool enable = false;
+    };
+    LatencyTraceOptions latency_trace;
+    // Name of a 'sim_time' executor whose virtual time the runtime runs on, empty for real time.
+    std::string time_source;
+    // Run the tasks of all executors but the main thread one on a single deterministic scheduler,
+    // on its virtual time. 'time_source' is ignored then.
+    DeterministicScheduler::Options deterministic;
+  };
+
+  struct ExecutorShutdownReport {
+    std::string name;
+    ExecutorBase::ShutdownReport report;
+    std::chrono::microseconds cost = std::chrono::microseconds(0);
   };
 
   enum class State : uint32_t {
@@ -45,29 +79,90 @@ class ExecutorManager {
     logger_ptr_ = logger_ptr;
   }
 
+  using ExecutorGenFunc = std::function<std::unique_ptr<ExecutorBase>()>;
+
+  // Register an extra executor type, mainly used by plugins. Can be called from multiple threads,
+  // but only before 'Initialize'.
+  void RegisterExecutorGenFunc(std::string_view type, ExecutorGenFunc&& executor_gen_func);
+
   void Initialize(YAML::Node options_node);
   void Start();
   void Shutdown();
 
   State GetState() const { return state_.load(); }
 
-  std::unique_ptr<ExecutorBase> GetExecutor(std::string_view executor_name);
+  // Apply changed options to the running executors, see 'ExecutorBase::UpdateOptions'. Return the
+  // changes that need a restart, e.g. an added or removed executor. Throw if the options are
+  // invalid, no executor is updated then.
+  std::vector<std::string> UpdateOptions(YAML::Node options_node);
+  // Throw if 'UpdateOptions' would reject 'options_node', without applying anything.
+  void CheckOptions(YAML::Node options_node) const;
+
+  ExecutorBase* GetExecutor(std::string_view executor_name) const;
+  // Of the guard thread executor, which runs the background tasks of the runtime by default.
+  std::string_view GetGuardThreadName() const { return used_executor_names_[1]; }
   const std::vector<std::unique_ptr<ExecutorBase>>& GetAllExecutors() const;
 
+  // The clock of the runtime, the virtual time of the 'time_source' executor or of the
+  // deterministic scheduler if configured.
+  const TimeSource& GetTimeSource() const { return *time_source_ptr_; }
+
+  // E.g. to register overrun callbacks before 'Initialize'.
+  ExecutorWatchdog& GetWatchdog() { return watchdog_; }
+
+  // E.g. to compare the schedule digests of two runs.
+  const DeterministicScheduler& GetDeterministicScheduler() const {
+    return deterministic_scheduler_;
+  }
+
+  // The thread placement checked at init, see 'PlanThreadPlacement'.
+  const ThreadPlacementPlan& GetPlacementPlan() const { return placement_plan_; }
+
+  // What each executor did with its left tasks in the last 'Shutdown'.
+  const std::vector<ExecutorShutdownReport>& GetShutdownReports() const {
+    return shutdown_report_vec_;
+  }
+
  private:
+  Options ParseOptions(YAML::Node options_node) const;
+  void PlanPlacement();
+  void ApplyAutoAssignedCpus(Options& options) const;
+  // Of the queued tasks and the pipeline latencies, scraped by the 'MetricsExporter' if enabled.
+  void RegisterMetricsCollector();
+
   std::unique_ptr<ExecutorBase> GetMainThreadExecutor();
   std::unique_ptr<ExecutorBase> GetGuardThreadExecutor();
   std::unique_ptr<ExecutorBase> GetTimeWheelExecutor();
+  std::unique_ptr<ExecutorBase> GetSimTimeExecutor();
+  std::unique_ptr<ExecutorBase> GetDeterministicExecutor(std::string_view type);
 
  private:
   std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
   Options options_;
   std::atomic<State> state_ = State::kPreInit;
 
+  std::mutex executor_gen_func_map_mutex_;
+  std::unordered_map<std::string, ExecutorGenFunc, nxpilot::utils::common::StringHash,
+                     std::equal_to<>>
+      executor_gen_func_map_;
+
+  // Declared before the executors, so they are destroyed after them.
+  TaskTracer task_tracer_;
+  ExecutorWatchdog watchdog_;
+  DeterministicScheduler deterministic_scheduler_;
+  uint64_t metrics_collector_id_ = 0;
+
   std::vector<std::string> used_executor_names_;
   std::unordered_map<std::string, std::unique_ptr<ExecutorBase>, nxpilot::utils::common::StringHash,
                      std::equal_to<>>
       executor_map_;
+
+  const TimeSource* time_source_ptr_ = &GetSystemTimeSource();
+
+  ThreadPlacementPlan placement_plan_;
+  std::unordered_map<std::string, std::vector<uint32_t>> auto_assigned_cpu_map_;
+
+  std::vector<ExecutorShutdownReport> shutdown_report_vec_;
 };
 
 }  // namespace nxpilot::runtime::core::executor
\ No newline at end of file
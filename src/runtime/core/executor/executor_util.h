@@ -0,0 +1,109 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <pthread.h>
+
+#include <exception>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "runtime/core/configurator/options_checker.h"
+#include "utils/common/cpu_topology_tool.h"
+#include "utils/common/thread_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::utils::common::ThreadHardeningOptions> {
+  using Options = nxpilot::utils::common::ThreadHardeningOptions;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["lock_memory"] = rhs.lock_memory;
+    node["prefault_stack_kb"] = rhs.prefault_stack_kb;
+    node["timer_slack_ns"] = rhs.timer_slack_ns;
+    node["cpu_dma_latency_us"] = rhs.cpu_dma_latency_us;
+
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["lock_memory"]) rhs.lock_memory = node["lock_memory"].as<bool>();
+    if (node["prefault_stack_kb"]) rhs.prefault_stack_kb = node["prefault_stack_kb"].as<uint32_t>();
+    if (node["timer_slack_ns"]) rhs.timer_slack_ns = node["timer_slack_ns"].as<uint64_t>();
+    if (node["cpu_dma_latency_us"])
+      rhs.cpu_dma_latency_us = node["cpu_dma_latency_us"].as<int32_t>();
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::executor {
+
+// Keys of the 'thread_hardening' option shared by the executors that own a thread, and a
+// 'prefault_stack_kb' that fits the thread stack.
+inline std::string CheckThreadHardeningOptions(const YAML::Node& node) {
+  auto err = configurator::CheckOptionsKeys(
+      node, {"lock_memory", "prefault_stack_kb", "timer_slack_ns", "cpu_dma_latency_us"});
+  if (!err.empty() || !node.IsMap() || !node["prefault_stack_kb"]) return err;
+
+  const uint64_t max_kb = nxpilot::utils::common::GetMaxStackPrefaultSize() / 1024;
+  if (node["prefault_stack_kb"].as<uint64_t>() > max_kb) {
+    return "prefault_stack_kb should not exceed " + std::to_string(max_kb) +
+           ", the thread stack size minus a margin";
+  }
+  return {};
+}
+
+// Affinity of the process before any executor thread is bound, e.g. a 'taskset' or cpuset
+// restriction. Captured by 'ExecutorManager' when it plans the thread placement.
+inline const std::vector<uint32_t>& GetStartupProcessAffinity() {
+  static const std::vector<uint32_t> kCpuVec = nxpilot::utils::common::GetCurrentProcessAffinity();
+  return kCpuVec;
+}
+
+// Apply changed 'thread_sched_policy'/'thread_bind_cpu' options to a running executor thread.
+// Clearing an option restores the default, SCHED_OTHER and the startup affinity. Return the
+// changes that need a restart: SCHED_DEADLINE can only be set by the thread itself when it starts,
+// and a change the thread is not permitted to make, e.g. a real-time policy without
+// CAP_SYS_NICE, is left to the restart rather than failing a reload halfway.
+inline std::string UpdateThreadOptions(pthread_t thread, std::string_view old_sched,
+                                       std::string_view new_sched,
+                                       const std::vector<uint32_t>& old_cpu_set,
+                                       const std::vector<uint32_t>& new_cpu_set) {
+  std::string restart_reason;
+  auto add_reason = [&restart_reason](std::string_view reason) {
+    if (!restart_reason.empty()) restart_reason += ", ";
+    restart_reason += reason;
+  };
+
+  if (old_sched != new_sched) {
+    if (old_sched.starts_with("SCHED_DEADLINE") || new_sched.starts_with("SCHED_DEADLINE")) {
+      add_reason("SCHED_DEADLINE policy changes only take effect after restart");
+    } else {
+      try {
+        nxpilot::utils::common::SetCpuSchedForThread(
+            thread, new_sched.empty() ? "SCHED_OTHER" : new_sched);
+      } catch (const std::exception& e) {
+        add_reason(std::string("'thread_sched_policy' can not be applied live, ") + e.what());
+      }
+    }
+  }
+
+  if (old_cpu_set != new_cpu_set) {
+    try {
+      nxpilot::utils::common::BindCpuForThread(
+          thread, new_cpu_set.empty() ? GetStartupProcessAffinity() : new_cpu_set);
+    } catch (const std::exception& e) {
+      add_reason(std::string("'thread_bind_cpu' can not be applied live, ") + e.what());
+    }
+  }
+  return restart_reason;
+}
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,250 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/executor/executor_watchdog.h"
+
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#include "runtime/core/executor/task_tracer.h"
+
+namespace nxpilot::runtime::core::executor {
+
+namespace {
+
+// Sent to a worker to take a snapshot of its stack.
+int StackSignal() { return SIGRTMIN + 6; }
+
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+void ExecutorWatchdog::RegisterOverrunCallback(OverrunCallback&& callback) {
+  NXPILOT_CHECK_ERROR(!running_.load(), "Overrun callback can only be registered before start.");
+  overrun_callback_vec_.emplace_back(std::move(callback));
+}
+
+void ExecutorWatchdog::Start(const Options& options) {
+  NXPILOT_CHECK_ERROR(!running_.load(), "ExecutorWatchdog is already started.");
+  NXPILOT_CHECK_ERROR(options.check_interval_ms > 0,
+                      "Invalid watchdog options, check_interval_ms is 0");
+  NXPILOT_CHECK_ERROR(options.action == "log" || options.action == "abort",
+                      "Invalid watchdog action '{}', should be 'log' or 'abort'", options.action);
+  options_ = options;
+
+  if (options_.capture_stack) {
+    static std::once_flag install_flag;
+    std::call_once(install_flag, []() {
+      // The first call of 'backtrace' may load libgcc and allocate, not in the signal handler.
+      void* frame = nullptr;
+      backtrace(&frame, 1);
+
+      struct sigaction action {};
+      action.sa_handler = &ExecutorWatchdog::StackSignalHandler;
+      action.sa_flags = SA_RESTART;
+      sigemptyset(&action.sa_mask);
+      sigaction(StackSignal(), &action, nullptr);
+    });
+  }
+
+  running_.store(true);
+  thread_ptr_ = std::make_unique<std::thread>([this]() { WatchLoop(); });
+
+  NXPILOT_INFO("Executor watchdog started, task budget {} ms, action '{}'",
+               options_.task_budget_ms, options_.action);
+}
+
+void ExecutorWatchdog::Stop() {
+  {
+    std::lock_guard<std::mutex> lck(stop_mutex_);
+    if (!running_.exchange(false)) return;
+  }
+  stop_cond_.notify_all();
+
+  if (thread_ptr_ && thread_ptr_->joinable()) thread_ptr_->join();
+  thread_ptr_.reset();
+}
+
+std::chrono::nanoseconds ExecutorWatchdog::GetTaskBudget(std::string_view executor_name) const {
+  auto itr = options_.executor_task_budget_ms.find(std::string(executor_name));
+  uint32_t budget_ms =
+      (itr == options_.executor_task_budget_ms.end()) ? options_.task_budget_ms : itr->second;
+  return std::chrono::milliseconds(budget_ms);
+}
+
+ExecutorWatchdog::Slot* ExecutorWatchdog::GetThreadSlot() {
+  // Watchdog ids are never reused, so an entry of a destroyed watchdog is never looked up again.
+  thread_local std::vector<std::pair<uint64_t, Slot*>> thread_slot_vec;
+
+  auto itr = std::ranges::find(thread_slot_vec, watchdog_id_, &std::pair<uint64_t, Slot*>::first);
+  if (itr != thread_slot_vec.end()) [[likely]] {
+    return itr->second;
+  }
+
+  auto slot_ptr = std::make_shared<Slot>();
+  slot_ptr->tid = static_cast<uint64_t>(syscall(SYS_gettid));
+  slot_ptr->thread_handle = pthread_self();
+  {
+    std::lock_guard<std::mutex> lck(slot_vec_mutex_);
+    slot_vec_.emplace_back(slot_ptr);
+  }
+  thread_slot_vec.emplace_back(watchdog_id_, slot_ptr.get());
+  return slot_ptr.get();
+}
+
+void ExecutorWatchdog::TaskBegin(const char* executor_name, const char* tag,
+                                 std::chrono::nanoseconds budget) noexcept {
+  Slot* slot = nullptr;
+  try {
+    slot = GetThreadSlot();
+  } catch (...) {
+    return;
+  }
+
+  if (slot->depth++ != 0) return;
+  slot->executor_name.store(executor_name, std::memory_order_relaxed);
+  slot->tag.store(tag, std::memory_order_relaxed);
+  slot->budget_ns.store(budget.count(), std::memory_order_relaxed);
+  slot->begin_ns.store(NowNs(), std::memory_order_release);
+}
+
+void ExecutorWatchdog::TaskEnd() noexcept {
+  Slot* slot = nullptr;
+  try {
+    slot = GetThreadSlot();
+  } catch (...) {
+    return;
+  }
+
+  if (slot->depth == 0 || --slot->depth != 0) return;
+  slot->begin_ns.store(0, std::memory_order_release);
+}
+
+void ExecutorWatchdog::WatchLoop() {
+  const auto interval = std::chrono::milliseconds(options_.check_interval_ms);
+
+  std::unique_lock<std::mutex> lck(stop_mutex_);
+  while (running_.load()) {
+    stop_cond_.wait_for(lck, interval, [this]() { return !running_.load(); });
+    if (!running_.load()) break;
+
+    lck.unlock();
+    try {
+      CheckSlots();
+    } catch (const std::exception& e) {
+      NXPILOT_ERROR("Executor watchdog check get exception, {}", e.what());
+    }
+    lck.lock();
+  }
+}
+
+void ExecutorWatchdog::CheckSlots() {
+  std::vector<std::shared_ptr<Slot>> slot_vec;
+  {
+    std::lock_guard<std::mutex> lck(slot_vec_mutex_);
+    slot_vec = slot_vec_;
+  }
+
+  for (const auto& slot : slot_vec) {
+    const uint64_t begin_ns = slot->begin_ns.load(std::memory_order_acquire);
+    if (begin_ns == 0 || begin_ns == slot->reported_begin_ns) continue;
+
+    const uint64_t budget_ns = slot->budget_ns.load(std::memory_order_relaxed);
+    const uint64_t now_ns = NowNs();
+    if (now_ns < begin_ns + budget_ns) continue;
+
+    const char* executor_name = slot->executor_name.load(std::memory_order_relaxed);
+    const char* tag = slot->tag.load(std::memory_order_relaxed);
+    // The task may have finished while reading, then the fields may belong to the next one.
+    if (slot->begin_ns.load(std::memory_order_acquire) != begin_ns) continue;
+    slot->reported_begin_ns = begin_ns;
+    ++overrun_num_;
+
+    OverrunReport report{.executor_name = executor_name ? executor_name : "",
+                         .tag = tag ? tag : "task",
+                         .tid = slot->tid,
+                         .budget = std::chrono::nanoseconds(budget_ns),
+                         .elapsed = std::chrono::nanoseconds(now_ns - begin_ns)};
+    if (options_.capture_stack) report.stack = CaptureStack(*slot);
+
+    std::string stack_str;
+    for (const auto& frame : report.stack) stack_str += "\n  " + frame;
+    NXPILOT_ERROR("Task '{}' of executor '{}' on thread {} has run for {} ms, over its budget "
+                  "of {} ms{}",
+                  report.tag, report.executor_name, report.tid,
+                  std::chrono::duration_cast<std::chrono::milliseconds>(report.elapsed).count(),
+                  std::chrono::duration_cast<std::chrono::milliseconds>(report.budget).count(),
+                  stack_str);
+
+    for (const auto& callback : overrun_callback_vec_) callback(report);
+
+    if (options_.action == "abort") {
+      NXPILOT_FATAL("Executor watchdog aborts the process as configured");
+      std::abort();
+    }
+  }
+}
+
+std::vector<std::string> ExecutorWatchdog::CaptureStack(Slot& slot) {
+  // One capture at a time, the signal handler finds its target through 'stack_target_slot_'.
+  static std::mutex capture_mutex;
+  std::lock_guard<std::mutex> lck(capture_mutex);
+
+  slot.stack_depth.store(-1);
+  stack_target_slot_.store(&slot);
+  if (pthread_kill(slot.thread_handle, StackSignal()) != 0) {
+    stack_target_slot_.store(nullptr);
+    return {};
+  }
+
+  constexpr auto kCaptureTimeout = std::chrono::milliseconds(100);
+  const auto deadline = std::chrono::steady_clock::now() + kCaptureTimeout;
+  while (slot.stack_depth.load() < 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  stack_target_slot_.store(nullptr);
+
+  const int depth = slot.stack_depth.load();
+  if (depth <= 0) return {"<stack capture timed out>"};
+
+  std::vector<std::string> stack;
+  char** symbol_array = backtrace_symbols(slot.stack_frames, depth);
+  if (symbol_array == nullptr) return {};
+  for (int ii = 0; ii < depth; ++ii) stack.emplace_back(symbol_array[ii]);
+  free(symbol_array);
+  return stack;
+}
+
+void ExecutorWatchdog::StackSignalHandler(int sig) {
+  Slot* slot = stack_target_slot_.load();
+  if (slot == nullptr || !pthread_equal(slot->thread_handle, pthread_self())) return;
+
+  slot->stack_depth.store(backtrace(slot->stack_frames, kMaxStackDepth));
+}
+
+ExecutorBase::Task WatchedExecutor::Wrap(Task&& task) noexcept {
+  if (!watchdog_ptr_->IsRunning() || budget_.count() == 0) return std::move(task);
+
+  const char* tag = ScopedTaskTag::Current();
+  return [this, tag, task{std::move(task)}]() {
+    watchdog_ptr_->TaskBegin(name_.c_str(), tag, budget_);
+    try {
+      task();
+    } catch (...) {
+      watchdog_ptr_->TaskEnd();
+      throw;
+    }
+    watchdog_ptr_->TaskEnd();
+  };
+}
+
+}  // namespace nxpilot::runtime::core::executor
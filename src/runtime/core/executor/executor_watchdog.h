@@ -0,0 +1,151 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <pthread.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "runtime/core/executor/executor_base.h"
+#include "runtime/core/executor/forwarding_executor.h"
+#include "utils/common/log_tool.h"
+
+namespace nxpilot::runtime::core::executor {
+
+/**
+ * @brief Flag tasks that run longer than their budget.
+ *
+ * Every worker thread publishes the start time of the task it is running, a watchdog thread scans
+ * them periodically. An overrunning task is reported once, with its executor, tag and a stack
+ * snapshot of the worker, taken by interrupting it with a signal.
+ */
+class ExecutorWatchdog {
+ public:
+  struct Options {
+    bool enable = false;
+    uint32_t task_budget_ms = 100;
+    uint32_t check_interval_ms = 10;
+    // 'log' only reports, 'abort' aborts the process after reporting, e.g. to get a core dump.
+    std::string action = "log";
+    bool capture_stack = true;
+    // Per executor budgets overriding 'task_budget_ms'.
+    std::unordered_map<std::string, uint32_t> executor_task_budget_ms;
+  };
+
+  struct OverrunReport {
+    std::string executor_name;
+    std::string tag;
+    uint64_t tid = 0;
+    std::chrono::nanoseconds budget = std::chrono::nanoseconds(0);
+    std::chrono::nanoseconds elapsed = std::chrono::nanoseconds(0);
+    std::vector<std::string> stack;  // empty if not captured
+  };
+
+  using OverrunCallback = std::function<void(const OverrunReport&)>;
+
+  ExecutorWatchdog() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~ExecutorWatchdog() { Stop(); }
+
+  ExecutorWatchdog(const ExecutorWatchdog&) = delete;
+  ExecutorWatchdog& operator=(const ExecutorWatchdog&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  // Called on the watchdog thread after an overrun is logged, e.g. to count it in a metric.
+  // Only before 'Start'.
+  void RegisterOverrunCallback(OverrunCallback&& callback);
+
+  void Start(const Options& options);
+  void Stop();
+
+  bool IsRunning() const { return running_.load(); }
+
+  std::chrono::nanoseconds GetTaskBudget(std::string_view executor_name) const;
+
+  // Called on the worker thread around each task. Tasks do not nest on one thread, except for
+  // executors running tasks inline, then only the outermost task is watched.
+  void TaskBegin(const char* executor_name, const char* tag,
+                 std::chrono::nanoseconds budget) noexcept;
+  void TaskEnd() noexcept;
+
+  uint64_t GetOverrunNum() const { return overrun_num_.load(); }
+
+ private:
+  static constexpr size_t kMaxStackDepth = 64;
+
+  struct Slot {
+    std::atomic_uint64_t begin_ns = 0;  // 0 when idle
+    std::atomic<const char*> executor_name = nullptr;
+    std::atomic<const char*> tag = nullptr;
+    std::atomic_uint64_t budget_ns = 0;
+    uint64_t reported_begin_ns = 0;  // only used by the watchdog thread
+    uint32_t depth = 0;              // only used by the worker thread
+    uint64_t tid = 0;
+    pthread_t thread_handle;
+
+    void* stack_frames[kMaxStackDepth];
+    std::atomic_int stack_depth = -1;  // set by the signal handler
+  };
+
+  Slot* GetThreadSlot();
+  void WatchLoop();
+  void CheckSlots();
+  std::vector<std::string> CaptureStack(Slot& slot);
+
+  static void StackSignalHandler(int sig);
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  std::vector<OverrunCallback> overrun_callback_vec_;
+  const uint64_t watchdog_id_ = next_watchdog_id_.fetch_add(1);
+  std::atomic_bool running_ = false;
+
+  std::mutex slot_vec_mutex_;
+  std::vector<std::shared_ptr<Slot>> slot_vec_;
+
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cond_;
+  std::unique_ptr<std::thread> thread_ptr_;
+
+  std::atomic_uint64_t overrun_num_ = 0;
+
+  static inline std::atomic_uint64_t next_watchdog_id_ = 1;
+  static inline std::atomic<Slot*> stack_target_slot_ = nullptr;
+};
+
+// Forward every call to the wrapped executor, and watch the run of each task with 'watchdog_ptr'.
+class WatchedExecutor : public ForwardingExecutor {
+ public:
+  WatchedExecutor(std::unique_ptr<ExecutorBase> executor_ptr, ExecutorWatchdog* watchdog_ptr)
+      : ForwardingExecutor(std::move(executor_ptr)), watchdog_ptr_(watchdog_ptr) {}
+  ~WatchedExecutor() override = default;
+
+  void Initialize(std::string_view name, YAML::Node options_node) override {
+    name_ = std::string(name);
+    budget_ = watchdog_ptr_->GetTaskBudget(name);
+    ForwardingExecutor::Initialize(name, options_node);
+  }
+
+ protected:
+  Task Wrap(Task&& task) noexcept override;
+
+ private:
+  ExecutorWatchdog* watchdog_ptr_;
+  std::string name_;
+  std::chrono::nanoseconds budget_ = std::chrono::nanoseconds(0);
+};
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,56 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <atomic>
+#include <future>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/executor/executor_watchdog.h"
+#include "runtime/core/executor/guard_thread_executor.h"
+#include "runtime/core/executor/task_tracer.h"
+
+namespace nxpilot::runtime::core::executor {
+
+TEST(ExecutorWatchdogTest, overrun) {
+  ExecutorWatchdog watchdog;
+  std::promise<ExecutorWatchdog::OverrunReport> report_promise;
+  watchdog.RegisterOverrunCallback(
+      [&report_promise](const auto& report) { report_promise.set_value(report); });
+  watchdog.Start(ExecutorWatchdog::Options{.enable = true,
+                                           .task_budget_ms = 1000,
+                                           .check_interval_ms = 5,
+                                           .executor_task_budget_ms = {{"watched_guard", 20}}});
+
+  WatchedExecutor executor(std::make_unique<GuardThreadExecutor>(), &watchdog);
+  executor.Initialize("watched_guard", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+
+  // A fast task is not reported.
+  std::promise<void> fast_promise;
+  executor.Execute([&fast_promise]() { fast_promise.set_value(); });
+  fast_promise.get_future().wait();
+
+  std::promise<void> release_promise;
+  {
+    ScopedTaskTag tag("stuck_task");
+    executor.Execute([future = release_promise.get_future().share()]() { future.wait(); });
+  }
+
+  auto report_future = report_promise.get_future();
+  ASSERT_EQ(report_future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  release_promise.set_value();
+
+  auto report = report_future.get();
+  EXPECT_EQ(report.executor_name, "watched_guard");
+  EXPECT_EQ(report.tag, "stuck_task");
+  EXPECT_EQ(report.budget, std::chrono::milliseconds(20));
+  EXPECT_GE(report.elapsed, std::chrono::milliseconds(20));
+  EXPECT_FALSE(report.stack.empty());
+
+  executor.Shutdown();
+  watchdog.Stop();
+  // Reported once per task.
+  EXPECT_EQ(watchdog.GetOverrunNum(), 1);
+}
+
+}  // namespace nxpilot::runtime::core::executor
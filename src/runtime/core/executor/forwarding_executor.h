@@ -0,0 +1,64 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "runtime/core/executor/executor_base.h"
+
+namespace nxpilot::runtime::core::executor {
+
+/**
+ * @brief Base of the executor decorators: forward every call to the wrapped executor, and pass each
+ * task through 'Wrap' on the way.
+ */
+class ForwardingExecutor : public ExecutorBase {
+ public:
+  explicit ForwardingExecutor(std::unique_ptr<ExecutorBase> executor_ptr)
+      : executor_ptr_(std::move(executor_ptr)) {}
+  ~ForwardingExecutor() override = default;
+
+  void Initialize(std::string_view name, YAML::Node options_node) override {
+    executor_ptr_->Initialize(name, options_node);
+  }
+  void Start() override { executor_ptr_->Start(); }
+  void Shutdown() override { executor_ptr_->Shutdown(); }
+  ShutdownReport ShutdownUntil(std::chrono::steady_clock::time_point deadline) override {
+    return executor_ptr_->ShutdownUntil(deadline);
+  }
+  std::string UpdateOptions(YAML::Node options_node) override {
+    return executor_ptr_->UpdateOptions(options_node);
+  }
+  void CheckOptions(YAML::Node options_node) const override {
+    executor_ptr_->CheckOptions(options_node);
+  }
+
+  std::string_view Type() const noexcept override { return executor_ptr_->Type(); }
+  std::string_view Name() const noexcept override { return executor_ptr_->Name(); }
+
+  bool ThreadSafe() const noexcept override { return executor_ptr_->ThreadSafe(); }
+
+  void Execute(Task&& task) noexcept override { executor_ptr_->Execute(Wrap(std::move(task))); }
+
+  bool SupportTimerSchedule() const noexcept override {
+    return executor_ptr_->SupportTimerSchedule();
+  }
+  std::chrono::system_clock::time_point Now() const noexcept override {
+    return executor_ptr_->Now();
+  }
+  void ExecuteAt(std::chrono::system_clock::time_point tp, Task&& task) noexcept override {
+    executor_ptr_->ExecuteAt(tp, Wrap(std::move(task)));
+  }
+
+  size_t CurrentTaskNum() noexcept override { return executor_ptr_->CurrentTaskNum(); }
+
+ protected:
+  // The task handed to the wrapped executor in place of 'task'.
+  virtual Task Wrap(Task&& task) noexcept = 0;
+
+ protected:
+  std::unique_ptr<ExecutorBase> executor_ptr_;
+};
+
+}  // namespace nxpilot::runtime::core::executor
@@ -1,6 +1,8 @@
 // Copyright (C) 2024. All rights reserved.
 
 #include "runtime/core/executor/guard_thread_executor.h"
+#include "runtime/core/configurator/options_checker.h"
+#include "runtime/core/executor/executor_util.h"
 #include "utils/common/thread_tool.h"
 
 namespace YAML {
@@ -12,7 +14,10 @@ struct convert<nxpilot::runtime::core::executor::GuardThreadExecutor::Options> {
     Node node;
     node["thread_sched_policy"] = rhs.thread_sched_policy;
     node["thread_bind_cpu"] = rhs.thread_bind_cpu;
+    node["thread_hardening"] = rhs.thread_hardening;
     node["queue_threshold"] = rhs.queue_threshold;
+    node["queue_warn_ratio"] = rhs.queue_warn_ratio;
+    node["shutdown_policy"] = rhs.shutdown_policy;
 
     return node;
   }
@@ -30,10 +35,23 @@ struct convert<nxpilot::runtime::core::executor::GuardThreadExecutor::Options> {
       rhs.thread_bind_cpu = node["thread_bind_cpu"].as<std::vector<uint32_t>>();
     }
 
+    if (node["thread_hardening"]) {
+      rhs.thread_hardening =
+          node["thread_hardening"].as<nxpilot::utils::common::ThreadHardeningOptions>();
+    }
+
     if (node["queue_threshold"]) {
       rhs.queue_threshold = node["queue_threshold"].as<uint32_t>();
     }
 
+    if (node["queue_warn_ratio"]) {
+      rhs.queue_warn_ratio = node["queue_warn_ratio"].as<double>();
+    }
+
+    if (node["shutdown_policy"]) {
+      rhs.shutdown_policy = node["shutdown_policy"].as<std::string>();
+    }
+
     return true;
   }
 };
@@ -46,11 +64,9 @@ void GuardThreadExecutor::Initialize(std::string_view name, YAML::Node options_n
                       "GuardThreadExecutor can only be initialized once.");
   name_ = std::string(name);
 
-  if (options_node && !options_node.IsNull()) {
-    options_ = options_node.as<Options>();
-  }
-
-  queue_warn_threshold_ = options_.queue_threshold * 0.95;
+  options_ = ParseOptions(options_node);
+  queue_threshold_ = options_.queue_threshold;
+  queue_warn_threshold_ = options_.queue_threshold * options_.queue_warn_ratio;
 
   thread_ptr_ = std::make_unique<std::thread>([this]() {
     thread_id_ = std::this_thread::get_id();
@@ -59,47 +75,97 @@ void GuardThreadExecutor::Initialize(std::string_view name, YAML::Node options_n
       nxpilot::utils::common::SetNameForCurrentThread(name_);
       nxpilot::utils::common::BindCpuForCurrentThread(options_.thread_bind_cpu);
       nxpilot::utils::common::SetCpuSchedForCurrentThread(options_.thread_sched_policy);
+      nxpilot::utils::common::ApplyHardeningForCurrentThread(options_.thread_hardening);
     } catch (const std::exception& e) {
       NXPILOT_ERROR("Set thread policy for GuardThreadExecutor get exception, {}", e.what());
     }
 
+    std::queue<Task> tmp_queue;
     while (state_.load() != State::kShutdown) {
-      std::queue<Task> tmp_queue;
       {
         std::unique_lock<std::mutex> lck(mutex_);
         cond_.wait(lck, [this] { return !queue_.empty() || state_.load() == State::kShutdown; });
         queue_.swap(tmp_queue);
       }
 
-      while (!tmp_queue.empty()) {
-        auto& task = tmp_queue.front();
-        try {
-          task();
-          --queue_task_num_;
-        } catch (const std::exception& e) {
-          NXPILOT_FATAL("GuardThreadExecutor run task get exception, {}", e.what());
-        }
-
+      // Stop in the middle of a batch on shutdown, the rest is handled by the shutdown policy.
+      while (!tmp_queue.empty() && state_.load() != State::kShutdown) {
+        RunTask(tmp_queue.front());
         tmp_queue.pop();
       }
     }
 
-    // After Shutdown, Run all the left task without lock.
-    while (!queue_.empty()) {
-      auto& task = queue_.front();
-      try {
-        task();
-        --queue_task_num_;
-      } catch (const std::exception& e) {
-        NXPILOT_FATAL("GuardThreadExecutor run task get exception, {}", e.what());
+    std::chrono::steady_clock::time_point deadline;
+    {
+      std::unique_lock<std::mutex> lck(mutex_);
+      while (!queue_.empty()) {
+        tmp_queue.emplace(std::move(queue_.front()));
+        queue_.pop();
       }
-      queue_.pop();
+      deadline = shutdown_deadline_;
     }
+    HandleLeftTasksOnShutdown(tmp_queue, deadline);
   });
 
   NXPILOT_INFO("GuardThreadExecutor init completed");
 }
 
+GuardThreadExecutor::Options GuardThreadExecutor::ParseOptions(YAML::Node options_node) const {
+  auto err = configurator::CheckOptionsKeys(
+      options_node, {"thread_sched_policy", "thread_bind_cpu", "thread_hardening",
+                     "queue_threshold", "queue_warn_ratio", "shutdown_policy"});
+  if (err.empty() && options_node && options_node["thread_hardening"]) {
+    err = CheckThreadHardeningOptions(options_node["thread_hardening"]);
+  }
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid options for GuardThreadExecutor '{}', {}", name_, err);
+
+  Options options;
+  if (options_node && !options_node.IsNull()) {
+    options = options_node.as<Options>();
+  }
+
+  err = configurator::CheckThreadOptions(options.thread_sched_policy, options.thread_bind_cpu);
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid options for GuardThreadExecutor '{}', {}", name_, err);
+  NXPILOT_CHECK_ERROR(options.queue_threshold > 0,
+                      "Invalid options for GuardThreadExecutor '{}', queue_threshold is 0", name_);
+  NXPILOT_CHECK_ERROR(options.queue_warn_ratio > 0 && options.queue_warn_ratio <= 1,
+                      "Invalid options for GuardThreadExecutor '{}', queue_warn_ratio should be "
+                      "in (0, 1]",
+                      name_);
+  NXPILOT_CHECK_ERROR(
+      options.shutdown_policy == "drain" || options.shutdown_policy == "discard",
+      "Invalid shutdown policy '{}' for GuardThreadExecutor, should be 'drain' or 'discard'",
+      options.shutdown_policy);
+
+  return options;
+}
+
+std::string GuardThreadExecutor::UpdateOptions(YAML::Node options_node) {
+  auto cur_state = state_.load();
+  NXPILOT_CHECK_ERROR(cur_state == State::kInit || cur_state == State::kStart,
+                      "GuardThreadExecutor can only update options when state is 'Init' or "
+                      "'Start'.");
+
+  Options new_options = ParseOptions(options_node);
+
+  auto restart_reason = UpdateThreadOptions(
+      thread_ptr_->native_handle(), options_.thread_sched_policy, new_options.thread_sched_policy,
+      options_.thread_bind_cpu, new_options.thread_bind_cpu);
+  if (new_options.thread_hardening != options_.thread_hardening) {
+    if (!restart_reason.empty()) restart_reason += ", ";
+    restart_reason += "'thread_hardening' only takes effect after restart";
+  }
+
+  queue_threshold_ = new_options.queue_threshold;
+  queue_warn_threshold_ = new_options.queue_threshold * new_options.queue_warn_ratio;
+
+  // Read by the executor thread on shutdown only, which can not overlap with an update.
+  options_ = std::move(new_options);
+
+  NXPILOT_INFO("GuardThreadExecutor '{}' options updated", name_);
+  return restart_reason;
+}
+
 void GuardThreadExecutor::Start() {
   NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
                       "GuardThreadExecutor can only run when state is 'Init'.");
@@ -107,12 +173,19 @@ void GuardThreadExecutor::Start() {
 }
 
 void GuardThreadExecutor::Shutdown() {
-  if (std::atomic_exchange(&state_, State::kShutdown) == State::kShutdown) {
-    return;
-  }
+  ShutdownUntil(std::chrono::steady_clock::time_point::max());
+}
 
+ExecutorBase::ShutdownReport GuardThreadExecutor::ShutdownUntil(
+    std::chrono::steady_clock::time_point deadline) {
   {
+    // The executor thread reads the deadline under the lock after it sees the new state, so only
+    // the caller that switches the state writes it, in the same critical section.
     std::unique_lock<std::mutex> lck(mutex_);
+    if (std::atomic_exchange(&state_, State::kShutdown) == State::kShutdown) {
+      return ShutdownReport{};
+    }
+    shutdown_deadline_ = deadline;
     cond_.notify_one();
   }
 
@@ -122,7 +195,9 @@ void GuardThreadExecutor::Shutdown() {
 
   thread_ptr_.reset();
 
-  NXPILOT_INFO("GuardThreadExecutor shutdown");
+  NXPILOT_INFO("GuardThreadExecutor shutdown, {} left tasks executed, {} dropped",
+               shutdown_report_.executed_task_num, shutdown_report_.dropped_task_num);
+  return shutdown_report_;
 }
 
 void GuardThreadExecutor::Execute(Task&& task) noexcept {
@@ -132,18 +207,19 @@ void GuardThreadExecutor::Execute(Task&& task) noexcept {
 
   uint32_t cur_queue_task_num = ++queue_task_num_;
 
-  if (cur_queue_task_num > options_.queue_threshold) [[unlikely]] {
+  const uint32_t queue_threshold = queue_threshold_.load(std::memory_order_relaxed);
+  if (cur_queue_task_num > queue_threshold) [[unlikely]] {
     NXPILOT_ERROR(
         "The number of tasks in the GuardThreadExecutor has reached the threshold {}, the task will not be delivered.",
-        options_.queue_threshold);
+        queue_threshold);
     --queue_task_num_;
     return;
   }
 
-  if (cur_queue_task_num > queue_warn_threshold_) [[unlikely]] {
+  if (cur_queue_task_num > queue_warn_threshold_.load(std::memory_order_relaxed)) [[unlikely]] {
     NXPILOT_WARN(
         "The number of tasks in the GuardThreadExecutor is about to reached the threshold {}/{}",
-        cur_queue_task_num, options_.queue_threshold);
+        cur_queue_task_num, queue_threshold);
   }
 
   std::unique_lock<std::mutex> lck(mutex_);
@@ -151,6 +227,31 @@ void GuardThreadExecutor::Execute(Task&& task) noexcept {
   cond_.notify_one();
 }
 
+void GuardThreadExecutor::RunTask(Task& task) noexcept {
+  try {
+    task();
+  } catch (const std::exception& e) {
+    NXPILOT_FATAL("GuardThreadExecutor run task get exception, {}", e.what());
+  }
+  --queue_task_num_;
+}
+
+void GuardThreadExecutor::HandleLeftTasksOnShutdown(
+    std::queue<Task>& task_queue, std::chrono::steady_clock::time_point deadline) noexcept {
+  const bool drain = (options_.shutdown_policy == "drain");
+  while (!task_queue.empty()) {
+    if (drain && std::chrono::steady_clock::now() < deadline) {
+      RunTask(task_queue.front());
+      ++shutdown_report_.executed_task_num;
+    } else {
+      shutdown_report_.deadline_exceeded |= drain;
+      ++shutdown_report_.dropped_task_num;
+      --queue_task_num_;
+    }
+    task_queue.pop();
+  }
+}
+
 std::chrono::system_clock::time_point GuardThreadExecutor::Now() const noexcept {
   NXPILOT_ERROR("GuardThreadExecutor does not support timer schedule");
   return std::chrono::system_clock::time_point();
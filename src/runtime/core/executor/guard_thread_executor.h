@@ -11,6 +11,7 @@
 
 #include "runtime/core/executor/executor_base.h"
 #include "utils/common/log_tool.h"
+#include "utils/common/thread_tool.h"
 #include "yaml-cpp/yaml.h"
 
 namespace nxpilot::runtime::core::executor {
@@ -23,7 +24,13 @@ class GuardThreadExecutor : public ExecutorBase {
   struct Options {
     std::string thread_sched_policy;
     std::vector<uint32_t> thread_bind_cpu;
+    nxpilot::utils::common::ThreadHardeningOptions thread_hardening;
     uint32_t queue_threshold = 10000;
+    // Warn once the queue is longer than 'queue_threshold * queue_warn_ratio'.
+    double queue_warn_ratio = 0.95;
+    // What to do with tasks still queued on shutdown: 'drain' runs them until the shutdown
+    // deadline, 'discard' drops them right away.
+    std::string shutdown_policy = "drain";
   };
 
   enum class State : uint32_t {
@@ -41,6 +48,9 @@ class GuardThreadExecutor : public ExecutorBase {
   void Initialize(std::string_view name, YAML::Node options_node) override;
   void Start() override;
   void Shutdown() override;
+  ShutdownReport ShutdownUntil(std::chrono::steady_clock::time_point deadline) override;
+  std::string UpdateOptions(YAML::Node options_node) override;
+  void CheckOptions(YAML::Node options_node) const override { ParseOptions(options_node); }
 
   State GetState() const { return state_.load(); }
 
@@ -57,6 +67,12 @@ class GuardThreadExecutor : public ExecutorBase {
 
   size_t CurrentTaskNum() noexcept override { return queue_task_num_.load(); }
 
+ private:
+  Options ParseOptions(YAML::Node options_node) const;
+  void RunTask(Task& task) noexcept;
+  void HandleLeftTasksOnShutdown(std::queue<Task>& task_queue,
+                                 std::chrono::steady_clock::time_point deadline) noexcept;
+
  private:
   std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
   Options options_;
@@ -66,12 +82,19 @@ class GuardThreadExecutor : public ExecutorBase {
   std::thread::id thread_id_;
   std::string_view type_ = "guard_thread";
 
-  uint32_t queue_warn_threshold_;
+  // Copies of the options read by 'Execute', they can be updated while running.
+  std::atomic_uint32_t queue_threshold_;
+  std::atomic_uint32_t queue_warn_threshold_;
   std::atomic_uint32_t queue_task_num_ = 0;
   std::mutex mutex_;
   std::condition_variable cond_;
   std::queue<Task> queue_;
   std::unique_ptr<std::thread> thread_ptr_;
+
+  // Guarded by 'mutex_', written together with the switch to 'Shutdown'.
+  std::chrono::steady_clock::time_point shutdown_deadline_ =
+      std::chrono::steady_clock::time_point::max();
+  ShutdownReport shutdown_report_;
 };
 
 }  // namespace nxpilot::runtime::core::executor
\ No newline at end of file
@@ -0,0 +1,146 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <atomic>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/executor/guard_thread_executor.h"
+
+namespace nxpilot::runtime::core::executor {
+
+class GuardThreadExecutorTest : public ::testing::Test {
+ protected:
+  // Block the executor thread, then queue 'task_num' tasks behind it.
+  void FillQueue(GuardThreadExecutor& executor, size_t task_num) {
+    std::atomic_bool blocked = false;
+    executor.Execute([this, &blocked]() {
+      blocked = true;
+      release_future_.wait();
+    });
+    while (!blocked) std::this_thread::yield();
+    for (size_t ii = 0; ii < task_num; ++ii) {
+      executor.Execute([this]() { ++executed_num_; });
+    }
+  }
+
+  std::promise<void> release_promise_;
+  std::shared_future<void> release_future_ = release_promise_.get_future().share();
+  std::atomic_uint32_t executed_num_ = 0;
+};
+
+TEST_F(GuardThreadExecutorTest, shutdown_drain) {
+  GuardThreadExecutor executor;
+  executor.Initialize("guard_drain_test", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+  FillQueue(executor, 10);
+
+  auto shutdown_future = std::async(std::launch::async, [&]() {
+    return executor.ShutdownUntil(std::chrono::steady_clock::time_point::max());
+  });
+  release_promise_.set_value();
+
+  auto report = shutdown_future.get();
+  EXPECT_EQ(executed_num_.load(), 10);
+  EXPECT_EQ(report.dropped_task_num, 0);
+  EXPECT_FALSE(report.deadline_exceeded);
+  EXPECT_EQ(executor.CurrentTaskNum(), 0);
+}
+
+TEST_F(GuardThreadExecutorTest, shutdown_discard) {
+  GuardThreadExecutor executor;
+  executor.Initialize("guard_discard_test", YAML::Load("shutdown_policy: discard"));
+  executor.Start();
+  FillQueue(executor, 10);
+
+  auto shutdown_future = std::async(std::launch::async, [&]() {
+    return executor.ShutdownUntil(std::chrono::steady_clock::time_point::max());
+  });
+  // Wait for the shutdown flag before releasing the blocking task.
+  while (executor.GetState() != GuardThreadExecutor::State::kShutdown) std::this_thread::yield();
+  release_promise_.set_value();
+
+  auto report = shutdown_future.get();
+  EXPECT_EQ(executed_num_.load(), 0);
+  EXPECT_EQ(report.dropped_task_num, 10);
+  EXPECT_EQ(executor.CurrentTaskNum(), 0);
+}
+
+TEST_F(GuardThreadExecutorTest, shutdown_deadline) {
+  GuardThreadExecutor executor;
+  executor.Initialize("guard_deadline_test", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+  FillQueue(executor, 10);
+
+  // The deadline has passed by the time the blocking task returns.
+  auto shutdown_future = std::async(std::launch::async, [&]() {
+    return executor.ShutdownUntil(std::chrono::steady_clock::now());
+  });
+  while (executor.GetState() != GuardThreadExecutor::State::kShutdown) std::this_thread::yield();
+  release_promise_.set_value();
+
+  auto report = shutdown_future.get();
+  EXPECT_EQ(executed_num_.load(), 0);
+  EXPECT_EQ(report.dropped_task_num, 10);
+  EXPECT_TRUE(report.deadline_exceeded);
+}
+
+TEST_F(GuardThreadExecutorTest, invalid_shutdown_policy) {
+  GuardThreadExecutor executor;
+  EXPECT_ANY_THROW(executor.Initialize("guard_invalid_test", YAML::Load("shutdown_policy: x")));
+}
+
+TEST_F(GuardThreadExecutorTest, invalid_options) {
+  GuardThreadExecutor misspelled_executor;
+  EXPECT_ANY_THROW(
+      misspelled_executor.Initialize("guard_invalid_test", YAML::Load("{queue_treshold: 10}")));
+
+  GuardThreadExecutor bad_cpu_executor;
+  EXPECT_ANY_THROW(bad_cpu_executor.Initialize("guard_invalid_test",
+                                               YAML::Load("{thread_bind_cpu: [100000]}")));
+
+  // 'alloca' of more than the thread stack would overflow it.
+  GuardThreadExecutor huge_prefault_executor;
+  EXPECT_ANY_THROW(huge_prefault_executor.Initialize(
+      "guard_invalid_test", YAML::Load("{thread_hardening: {prefault_stack_kb: 1048576}}")));
+}
+
+TEST_F(GuardThreadExecutorTest, update_options) {
+  GuardThreadExecutor executor;
+  executor.Initialize("guard_update_test", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+
+  EXPECT_ANY_THROW(executor.UpdateOptions(YAML::Load("{queue_threshold: 0}")));
+  EXPECT_EQ(executor.UpdateOptions(YAML::Load("{queue_threshold: 2, queue_warn_ratio: 0.5}")),
+            "");
+
+  // The blocking task and one more fit in the queue, the rest are rejected.
+  FillQueue(executor, 5);
+  release_promise_.set_value();
+  executor.Shutdown();
+  EXPECT_EQ(executed_num_.load(), 1);
+}
+
+TEST_F(GuardThreadExecutorTest, update_thread_options) {
+  GuardThreadExecutor executor;
+  executor.Initialize("guard_update_test", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+
+  // Without CAP_SYS_NICE the policy is left to a restart instead of failing the update, the
+  // other options still apply.
+  std::string restart_reason;
+  EXPECT_NO_THROW(restart_reason = executor.UpdateOptions(
+                      YAML::Load("{thread_sched_policy: 'SCHED_FIFO:10', queue_threshold: 2}")));
+  EXPECT_TRUE(restart_reason.empty() ||
+              restart_reason.find("thread_sched_policy") != std::string::npos);
+  EXPECT_EQ(executor.UpdateOptions(YAML::Load("{queue_threshold: 2}")), "");
+
+  FillQueue(executor, 5);
+  release_promise_.set_value();
+  executor.Shutdown();
+  EXPECT_EQ(executed_num_.load(), 1);
+}
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,18 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/executor/latency_traced_executor.h"
+
+namespace nxpilot::runtime::core::executor {
+
+ExecutorBase::Task LatencyTracedExecutor::Wrap(Task&& task) noexcept {
+  const auto* ctx_ptr = nxpilot::runtime::core::trace::ScopedLatencyTrace::Current();
+  if (ctx_ptr == nullptr) return std::move(task);
+
+  return [this, ctx = *ctx_ptr, task{std::move(task)}]() mutable {
+    ctx.AddHop(stage_.c_str(), nxpilot::runtime::core::trace::GetLatencyTraceNowNs());
+    nxpilot::runtime::core::trace::ScopedLatencyTrace scoped_trace(&ctx);
+    task();
+  };
+}
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,41 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "runtime/core/executor/forwarding_executor.h"
+#include "runtime/core/trace/latency_trace.h"
+
+namespace nxpilot::runtime::core::executor {
+
+// Forward every call to the wrapped executor, and carry the latency trace current at submission
+// on to the task, with a hop for the run on this executor. Timer tasks start without a trace, a
+// timer is a new cause rather than a step of the pipeline that armed it.
+class LatencyTracedExecutor : public ForwardingExecutor {
+ public:
+  explicit LatencyTracedExecutor(std::unique_ptr<ExecutorBase> executor_ptr)
+      : ForwardingExecutor(std::move(executor_ptr)) {}
+  ~LatencyTracedExecutor() override = default;
+
+  void Initialize(std::string_view name, YAML::Node options_node) override {
+    stage_ = "executor:" + std::string(name);
+    ForwardingExecutor::Initialize(name, options_node);
+  }
+
+  void ExecuteAt(std::chrono::system_clock::time_point tp, Task&& task) noexcept override {
+    executor_ptr_->ExecuteAt(tp, [task{std::move(task)}]() {
+      nxpilot::runtime::core::trace::ScopedLatencyTrace scoped_trace(nullptr);
+      task();
+    });
+  }
+
+ protected:
+  Task Wrap(Task&& task) noexcept override;
+
+ private:
+  std::string stage_;
+};
+
+}  // namespace nxpilot::runtime::core::executor
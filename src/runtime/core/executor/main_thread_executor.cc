@@ -1,6 +1,8 @@
 // Copyright (C) 2024. All rights reserved.
 
 #include "runtime/core/executor/main_thread_executor.h"
+#include "runtime/core/configurator/options_checker.h"
+#include "runtime/core/executor/executor_util.h"
 #include "utils/common/thread_tool.h"
 
 namespace YAML {
@@ -12,6 +14,7 @@ struct convert<nxpilot::runtime::core::executor::MainThreadExecutor::Options> {
     Node node;
     node["thread_sched_policy"] = rhs.thread_sched_policy;
     node["thread_bind_cpu"] = rhs.thread_bind_cpu;
+    node["thread_hardening"] = rhs.thread_hardening;
 
     return node;
   }
@@ -29,6 +32,11 @@ struct convert<nxpilot::runtime::core::executor::MainThreadExecutor::Options> {
       rhs.thread_bind_cpu = node["thread_bind_cpu"].as<std::vector<uint32_t>>();
     }
 
+    if (node["thread_hardening"]) {
+      rhs.thread_hardening =
+          node["thread_hardening"].as<nxpilot::utils::common::ThreadHardeningOptions>();
+    }
+
     return true;
   }
 };
@@ -41,23 +49,62 @@ void MainThreadExecutor::Initialize(std::string_view name, YAML::Node options_no
                       "MainThreadExecutor can only be initialized once.");
   name_ = std::string(name);
 
-  if (options_node && !options_node.IsNull()) {
-    options_ = options_node.as<Options>();
-  }
+  options_ = ParseOptions(options_node);
 
   try {
     nxpilot::utils::common::SetNameForCurrentThread(name_);
     nxpilot::utils::common::BindCpuForCurrentThread(options_.thread_bind_cpu);
     nxpilot::utils::common::SetCpuSchedForCurrentThread(options_.thread_sched_policy);
+    nxpilot::utils::common::ApplyHardeningForCurrentThread(options_.thread_hardening);
   } catch (const std::exception& e) {
     NXPILOT_ERROR("Set thread policy for MainThreadExecutor get exception, {}", e.what());
   }
 
   main_thread_id_ = std::this_thread::get_id();
+  main_thread_handle_ = pthread_self();
 
   NXPILOT_INFO("MainThreadExecutor init completed");
 }
 
+MainThreadExecutor::Options MainThreadExecutor::ParseOptions(YAML::Node options_node) const {
+  auto err = configurator::CheckOptionsKeys(
+      options_node, {"thread_sched_policy", "thread_bind_cpu", "thread_hardening"});
+  if (err.empty() && options_node && options_node["thread_hardening"]) {
+    err = CheckThreadHardeningOptions(options_node["thread_hardening"]);
+  }
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid options for MainThreadExecutor '{}', {}", name_, err);
+
+  Options options;
+  if (options_node && !options_node.IsNull()) {
+    options = options_node.as<Options>();
+  }
+
+  err = configurator::CheckThreadOptions(options.thread_sched_policy, options.thread_bind_cpu);
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid options for MainThreadExecutor '{}', {}", name_, err);
+
+  return options;
+}
+
+std::string MainThreadExecutor::UpdateOptions(YAML::Node options_node) {
+  auto cur_state = state_.load();
+  NXPILOT_CHECK_ERROR(cur_state == State::kInit || cur_state == State::kStart,
+                      "MainThreadExecutor can only update options when state is 'Init' or "
+                      "'Start'.");
+
+  Options new_options = ParseOptions(options_node);
+  auto restart_reason = UpdateThreadOptions(main_thread_handle_, options_.thread_sched_policy,
+                                            new_options.thread_sched_policy,
+                                            options_.thread_bind_cpu, new_options.thread_bind_cpu);
+  if (new_options.thread_hardening != options_.thread_hardening) {
+    if (!restart_reason.empty()) restart_reason += ", ";
+    restart_reason += "'thread_hardening' only takes effect after restart";
+  }
+  options_ = std::move(new_options);
+
+  NXPILOT_INFO("MainThreadExecutor '{}' options updated", name_);
+  return restart_reason;
+}
+
 void MainThreadExecutor::Start() {
   NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
                       "MainThreadExecutor can only run when state is 'Init'.");
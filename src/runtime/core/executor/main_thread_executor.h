@@ -8,6 +8,7 @@
 
 #include "runtime/core/executor/executor_base.h"
 #include "utils/common/log_tool.h"
+#include "utils/common/thread_tool.h"
 #include "yaml-cpp/yaml.h"
 
 namespace nxpilot::runtime::core::executor {
@@ -21,6 +22,7 @@ class MainThreadExecutor : public ExecutorBase {
     std::string name = "nxpilot_main";
     std::string thread_sched_policy;
     std::vector<uint32_t> thread_bind_cpu;
+    nxpilot::utils::common::ThreadHardeningOptions thread_hardening;
   };
 
   enum class State : uint32_t {
@@ -38,6 +40,8 @@ class MainThreadExecutor : public ExecutorBase {
   void Initialize(std::string_view name, YAML::Node options_node) override;
   void Start() override;
   void Shutdown() override;
+  std::string UpdateOptions(YAML::Node options_node) override;
+  void CheckOptions(YAML::Node options_node) const override { ParseOptions(options_node); }
 
   State GetState() const { return state_.load(); }
 
@@ -54,6 +58,9 @@ class MainThreadExecutor : public ExecutorBase {
 
   size_t CurrentTaskNum() noexcept override { return 1; }
 
+ private:
+  Options ParseOptions(YAML::Node options_node) const;
+
  private:
   std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
   Options options_;
@@ -61,6 +68,7 @@ class MainThreadExecutor : public ExecutorBase {
 
   std::string name_;
   std::thread::id main_thread_id_;
+  pthread_t main_thread_handle_;
   std::string_view type_ = "main_thread";
 };
 
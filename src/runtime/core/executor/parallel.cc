@@ -0,0 +1,126 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/executor/parallel.h"
+
+#include <atomic>
+
+namespace nxpilot::runtime::core::executor {
+
+namespace {
+
+// Shared by the caller and the helper tasks, which may only run after the caller has returned.
+// They only touch 'ctx' for the chunks they claimed, which the caller waits for.
+struct ParallelJob {
+  ParallelJob(size_t chunk_num, void (*chunk_func)(void*, size_t), void* ctx)
+      : chunk_num(chunk_num), chunk_func(chunk_func), ctx(ctx) {}
+
+  void RunChunks() noexcept {
+    while (true) {
+      const size_t chunk_idx = next_chunk_idx.fetch_add(1, std::memory_order_relaxed);
+      if (chunk_idx >= chunk_num) return;
+
+      if (!failed_flag.load(std::memory_order_relaxed)) {
+        try {
+          chunk_func(ctx, chunk_idx);
+        } catch (...) {
+          if (!failed_flag.exchange(true)) exception_ptr = std::current_exception();
+        }
+      }
+
+      if (done_chunk_num.fetch_add(1, std::memory_order_acq_rel) + 1 == chunk_num) {
+        done_chunk_num.notify_all();
+      }
+    }
+  }
+
+  const size_t chunk_num;
+  void (*const chunk_func)(void*, size_t);
+  void* const ctx;
+
+  std::atomic_size_t next_chunk_idx = 0;
+  std::atomic_size_t done_chunk_num = 0;
+  std::atomic_bool failed_flag = false;
+  std::exception_ptr exception_ptr;
+};
+
+}  // namespace
+
+void RunParallelChunks(ExecutorBase& executor, uint32_t helper_num, size_t chunk_num,
+                       void (*chunk_func)(void*, size_t), void* ctx) {
+  auto job_ptr = std::make_shared<ParallelJob>(chunk_num, chunk_func, ctx);
+
+  // More helpers than the chunks left to the caller would only find nothing to do.
+  const size_t post_num = std::min<size_t>(helper_num, chunk_num - 1);
+  for (size_t ii = 0; ii < post_num; ++ii) {
+    executor.Execute([job_ptr]() { job_ptr->RunChunks(); });
+  }
+
+  job_ptr->RunChunks();
+
+  size_t done_chunk_num;
+  while ((done_chunk_num = job_ptr->done_chunk_num.load(std::memory_order_acquire)) != chunk_num) {
+    job_ptr->done_chunk_num.wait(done_chunk_num, std::memory_order_acquire);
+  }
+
+  if (job_ptr->exception_ptr) std::rethrow_exception(job_ptr->exception_ptr);
+}
+
+TaskGroup::~TaskGroup() {
+  try {
+    Wait();
+  } catch (...) {
+  }
+}
+
+void TaskGroup::Run(ExecutorBase::Task&& task) {
+  {
+    std::lock_guard<std::mutex> lck(state_ptr_->mutex);
+    state_ptr_->task_queue.emplace_back(std::move(task));
+  }
+  executor_.Execute([state_ptr = state_ptr_]() { RunOne(*state_ptr); });
+}
+
+void TaskGroup::Wait() {
+  auto& state = *state_ptr_;
+  while (true) {
+    if (RunOne(state)) continue;
+
+    std::unique_lock<std::mutex> lck(state.mutex);
+    state.cond.wait(lck,
+                    [&state]() { return state.running_num == 0 || !state.task_queue.empty(); });
+    if (state.running_num == 0 && state.task_queue.empty()) break;
+  }
+
+  std::exception_ptr exception_ptr;
+  {
+    std::lock_guard<std::mutex> lck(state.mutex);
+    std::swap(exception_ptr, state.exception_ptr);
+  }
+  if (exception_ptr) std::rethrow_exception(exception_ptr);
+}
+
+bool TaskGroup::RunOne(State& state) {
+  ExecutorBase::Task task;
+  {
+    std::lock_guard<std::mutex> lck(state.mutex);
+    if (state.task_queue.empty()) return false;
+    task = std::move(state.task_queue.front());
+    state.task_queue.pop_front();
+    ++state.running_num;
+  }
+
+  std::exception_ptr exception_ptr;
+  try {
+    task();
+  } catch (...) {
+    exception_ptr = std::current_exception();
+  }
+
+  std::lock_guard<std::mutex> lck(state.mutex);
+  if (exception_ptr && !state.exception_ptr) state.exception_ptr = exception_ptr;
+  --state.running_num;
+  state.cond.notify_all();
+  return true;
+}
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,146 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "runtime/core/executor/executor_base.h"
+
+namespace nxpilot::runtime::core::executor {
+
+struct ParallelOptions {
+  // Tasks posted to the executor to work along with the caller, e.g. its thread number. 0 runs
+  // everything on the caller.
+  uint32_t helper_num = 1;
+  // Indexes per chunk, 0 picks about 4 chunks per participant.
+  size_t grain_size = 0;
+};
+
+// Split 'index_num' indexes into chunks of at most the returned size.
+inline size_t GetParallelGrainSize(size_t index_num, const ParallelOptions& options) {
+  if (options.grain_size != 0) return options.grain_size;
+  const size_t target_chunk_num = (static_cast<size_t>(options.helper_num) + 1) * 4;
+  return std::max<size_t>(1, (index_num + target_chunk_num - 1) / target_chunk_num);
+}
+
+// Run 'chunk_func(ctx, chunk_idx)' for every chunk in [0, chunk_num), on the caller and on up to
+// 'helper_num' tasks posted to 'executor'. The participants claim chunks from a shared counter
+// until none is left, so nothing is allocated per chunk, and a busy executor only means the caller
+// does more of the work. Return once every chunk is done, rethrow the first exception of a chunk,
+// the chunks not started yet are skipped then.
+void RunParallelChunks(ExecutorBase& executor, uint32_t helper_num, size_t chunk_num,
+                       void (*chunk_func)(void*, size_t), void* ctx);
+
+/**
+ * @brief Call 'func(chunk_begin, chunk_end)' over the chunks of [begin, end), in parallel.
+ *
+ * Chunks have 'grain_size' indexes, the last one may be shorter. The caller takes part in the
+ * work, see 'RunParallelChunks'. 'func' must be safe to call from several threads at once.
+ *
+ * @code
+ * ParallelFor(executor, 0, points.size(), {.helper_num = 3, .grain_size = 1024},
+ *             [&](size_t begin, size_t end) {
+ *               for (size_t ii = begin; ii < end; ++ii) Transform(points[ii]);
+ *             });
+ * @endcode
+ */
+template <typename Func>
+void ParallelFor(ExecutorBase& executor, size_t begin, size_t end, const ParallelOptions& options,
+                 Func&& func) {
+  if (begin >= end) return;
+
+  const size_t grain_size = GetParallelGrainSize(end - begin, options);
+  const size_t chunk_num = (end - begin + grain_size - 1) / grain_size;
+  auto run_chunk = [&](size_t chunk_idx) {
+    const size_t chunk_begin = begin + chunk_idx * grain_size;
+    func(chunk_begin, std::min(end, chunk_begin + grain_size));
+  };
+
+  if (options.helper_num == 0 || chunk_num == 1) {
+    for (size_t ii = 0; ii < chunk_num; ++ii) run_chunk(ii);
+    return;
+  }
+
+  RunParallelChunks(
+      executor, options.helper_num, chunk_num,
+      [](void* ctx, size_t chunk_idx) { (*static_cast<decltype(run_chunk)*>(ctx))(chunk_idx); },
+      &run_chunk);
+}
+
+/**
+ * @brief Reduce [begin, end) in parallel, 'func(chunk_begin, chunk_end)' returns the partial
+ * result of a chunk, 'reduce_func(T, T)' combines two results.
+ *
+ * The partial results are combined on the caller in chunk order, starting from 'init', so the
+ * result does not depend on which thread ran which chunk, even for floating point sums.
+ */
+template <typename T, typename Func, typename ReduceFunc>
+T ParallelReduce(ExecutorBase& executor, size_t begin, size_t end, const ParallelOptions& options,
+                 T init, Func&& func, ReduceFunc&& reduce_func) {
+  if (begin >= end) return init;
+
+  const size_t grain_size = GetParallelGrainSize(end - begin, options);
+  const size_t chunk_num = (end - begin + grain_size - 1) / grain_size;
+  std::vector<std::optional<T>> partial_vec(chunk_num);
+
+  ParallelFor(executor, begin, end, ParallelOptions{options.helper_num, grain_size},
+              [&](size_t chunk_begin, size_t chunk_end) {
+                partial_vec[(chunk_begin - begin) / grain_size].emplace(
+                    func(chunk_begin, chunk_end));
+              });
+
+  T result = std::move(init);
+  for (auto& partial : partial_vec) result = reduce_func(std::move(result), std::move(*partial));
+  return result;
+}
+
+/**
+ * @brief Run a group of tasks on an executor and wait for all of them, like a latch.
+ *
+ * 'Wait' runs the tasks the executor has not started yet on the calling thread, so it never waits
+ * for the executor to get through its queue. 'Run' is thread safe, so tasks may add more tasks to
+ * the group, 'Wait' is called by one thread at a time.
+ */
+class TaskGroup {
+ public:
+  explicit TaskGroup(ExecutorBase& executor)
+      : executor_(executor), state_ptr_(std::make_shared<State>()) {}
+  // Wait for the tasks, call 'Wait' before to get their exceptions.
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  void Run(ExecutorBase::Task&& task);
+
+  // Return once all tasks are done, rethrow the first exception of a task.
+  void Wait();
+
+ private:
+  // Shared with the posted tasks, which may run after the group is gone.
+  struct State {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<ExecutorBase::Task> task_queue;
+    size_t running_num = 0;
+    std::exception_ptr exception_ptr;
+  };
+
+  // Pop a task and run it. Return false if there was none.
+  static bool RunOne(State& state);
+
+ private:
+  ExecutorBase& executor_;
+  std::shared_ptr<State> state_ptr_;
+};
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,130 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/executor/parallel.h"
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/executor/guard_thread_executor.h"
+
+namespace nxpilot::runtime::core::executor {
+
+class ParallelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executor_.Initialize("parallel_test", YAML::Node(YAML::NodeType::Null));
+    executor_.Start();
+  }
+
+  void TearDown() override { executor_.Shutdown(); }
+
+  // Keep the executor busy until the returned promise is set.
+  std::promise<void> BlockExecutor() {
+    std::promise<void> release_promise;
+    executor_.Execute([future = release_promise.get_future().share()]() { future.wait(); });
+    return release_promise;
+  }
+
+  GuardThreadExecutor executor_;
+};
+
+TEST_F(ParallelTest, parallel_for) {
+  std::vector<std::atomic_uint32_t> visit_vec(1000);
+  std::atomic_size_t max_chunk_size = 0;
+  ParallelFor(executor_, 5, visit_vec.size(), {.helper_num = 3, .grain_size = 7},
+              [&](size_t begin, size_t end) {
+                for (size_t ii = begin; ii < end; ++ii) ++visit_vec[ii];
+                size_t cur = max_chunk_size.load();
+                while (cur < end - begin &&
+                       !max_chunk_size.compare_exchange_weak(cur, end - begin)) {
+                }
+              });
+
+  for (size_t ii = 0; ii < visit_vec.size(); ++ii) EXPECT_EQ(visit_vec[ii].load(), ii >= 5);
+  EXPECT_EQ(max_chunk_size.load(), 7);
+
+  size_t call_num = 0;
+  ParallelFor(executor_, 3, 3, {}, [&](size_t, size_t) { ++call_num; });
+  ParallelFor(executor_, 0, 10, {.helper_num = 0, .grain_size = 4},
+              [&](size_t, size_t) { ++call_num; });
+  EXPECT_EQ(call_num, 3);
+}
+
+TEST_F(ParallelTest, caller_runs_when_executor_is_busy) {
+  auto release_promise = BlockExecutor();
+
+  // The helpers stay queued behind the blocking task, the caller does all the work.
+  const auto caller_id = std::this_thread::get_id();
+  std::atomic_size_t caller_chunk_num = 0;
+  ParallelFor(executor_, 0, 100, {.helper_num = 2, .grain_size = 10}, [&](size_t, size_t) {
+    if (std::this_thread::get_id() == caller_id) ++caller_chunk_num;
+  });
+  EXPECT_EQ(caller_chunk_num.load(), 10);
+
+  std::atomic_uint32_t run_num = 0;
+  TaskGroup task_group(executor_);
+  for (size_t ii = 0; ii < 5; ++ii) task_group.Run([&]() { ++run_num; });
+  task_group.Wait();
+  EXPECT_EQ(run_num.load(), 5);
+
+  release_promise.set_value();
+}
+
+TEST_F(ParallelTest, parallel_reduce) {
+  std::vector<double> value_vec(10000);
+  for (size_t ii = 0; ii < value_vec.size(); ++ii) value_vec[ii] = 1.0 / (ii + 1);
+
+  auto sum = [&](uint32_t helper_num) {
+    return ParallelReduce(
+        executor_, 0, value_vec.size(), {.helper_num = helper_num, .grain_size = 100}, 0.0,
+        [&](size_t begin, size_t end) {
+          double partial = 0;
+          for (size_t ii = begin; ii < end; ++ii) partial += value_vec[ii];
+          return partial;
+        },
+        [](double lhs, double rhs) { return lhs + rhs; });
+  };
+
+  // Bit identical whatever the scheduling.
+  const double expected = sum(0);
+  for (uint32_t helper_num = 1; helper_num <= 4; ++helper_num) {
+    EXPECT_EQ(sum(helper_num), expected);
+  }
+  EXPECT_NEAR(expected, 9.7876, 1e-4);
+}
+
+TEST_F(ParallelTest, exception) {
+  EXPECT_THROW(ParallelFor(executor_, 0, 100, {.helper_num = 2, .grain_size = 1},
+                           [&](size_t begin, size_t) {
+                             if (begin == 3) throw std::runtime_error("chunk 3");
+                           }),
+               std::runtime_error);
+
+  TaskGroup task_group(executor_);
+  task_group.Run([]() { throw std::runtime_error("task"); });
+  task_group.Run([]() {});
+  EXPECT_THROW(task_group.Wait(), std::runtime_error);
+  EXPECT_NO_THROW(task_group.Wait());
+}
+
+TEST_F(ParallelTest, nested_task_group) {
+  std::atomic_uint32_t run_num = 0;
+  TaskGroup task_group(executor_);
+  for (size_t ii = 0; ii < 4; ++ii) {
+    task_group.Run([&]() {
+      // A nested parallel loop on the same single thread executor does not deadlock.
+      ParallelFor(executor_, 0, 8, {.helper_num = 1, .grain_size = 1},
+                  [&](size_t, size_t) { ++run_num; });
+      task_group.Run([&]() { ++run_num; });
+    });
+  }
+  task_group.Wait();
+  EXPECT_EQ(run_num.load(), 4 * 8 + 4);
+}
+
+}  // namespace nxpilot::runtime::core::executor
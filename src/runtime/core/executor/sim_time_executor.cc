@@ -0,0 +1,300 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/executor/sim_time_executor.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+#include "runtime/core/configurator/options_checker.h"
+#include "runtime/core/executor/executor_util.h"
+#include "utils/common/thread_tool.h"
+#include "utils/common/time_tool.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::executor::SimTimeExecutor::Options> {
+  using Options = nxpilot::runtime::core::executor::SimTimeExecutor::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["thread_sched_policy"] = rhs.thread_sched_policy;
+    node["thread_bind_cpu"] = rhs.thread_bind_cpu;
+    node["thread_hardening"] = rhs.thread_hardening;
+    node["rate_factor"] = rhs.rate_factor;
+    node["start_time_us"] = rhs.start_time_us;
+
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) {
+      return false;
+    }
+
+    if (node["thread_sched_policy"]) {
+      rhs.thread_sched_policy = node["thread_sched_policy"].as<std::string>();
+    }
+
+    if (node["thread_bind_cpu"]) {
+      rhs.thread_bind_cpu = node["thread_bind_cpu"].as<std::vector<uint32_t>>();
+    }
+
+    if (node["thread_hardening"]) {
+      rhs.thread_hardening =
+          node["thread_hardening"].as<nxpilot::utils::common::ThreadHardeningOptions>();
+    }
+
+    if (node["rate_factor"]) {
+      rhs.rate_factor = node["rate_factor"].as<double>();
+    }
+
+    if (node["start_time_us"]) {
+      rhs.start_time_us = node["start_time_us"].as<uint64_t>();
+    }
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::executor {
+
+void SimTimeExecutor::Initialize(std::string_view name, YAML::Node options_node) {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
+                      "SimTimeExecutor can only be initialized once.");
+  name_ = std::string(name);
+
+  options_ = ParseOptions(options_node);
+
+  // The time stands still until start.
+  const auto start_tp =
+      (options_.start_time_us == 0)
+          ? std::chrono::system_clock::now()
+          : nxpilot::utils::common::GetTimePointFromTimestampNs(options_.start_time_us * 1000);
+  time_source_.Reset(start_tp, 0);
+
+  NXPILOT_INFO("SimTimeExecutor init completed");
+}
+
+SimTimeExecutor::Options SimTimeExecutor::ParseOptions(YAML::Node options_node) const {
+  auto err = configurator::CheckOptionsKeys(
+      options_node, {"thread_sched_policy", "thread_bind_cpu", "thread_hardening", "rate_factor",
+                     "start_time_us"});
+  if (err.empty() && options_node && options_node["thread_hardening"]) {
+    err = CheckThreadHardeningOptions(options_node["thread_hardening"]);
+  }
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid options for SimTimeExecutor '{}', {}", name_, err);
+
+  Options options;
+  if (options_node && !options_node.IsNull()) {
+    options = options_node.as<Options>();
+  }
+
+  err = configurator::CheckThreadOptions(options.thread_sched_policy, options.thread_bind_cpu);
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid options for SimTimeExecutor '{}', {}", name_, err);
+  NXPILOT_CHECK_ERROR(options.rate_factor >= 0,
+                      "Invalid options for SimTimeExecutor '{}', rate_factor is negative", name_);
+
+  return options;
+}
+
+std::string SimTimeExecutor::UpdateOptions(YAML::Node options_node) {
+  auto cur_state = state_.load();
+  NXPILOT_CHECK_ERROR(cur_state == State::kInit || cur_state == State::kStart,
+                      "SimTimeExecutor can only update options when state is 'Init' or 'Start'.");
+
+  Options new_options = ParseOptions(options_node);
+
+  // The executor thread only reads the thread options when it starts.
+  std::string restart_reason;
+  if (thread_ptr_) {
+    restart_reason = UpdateThreadOptions(
+        thread_ptr_->native_handle(), options_.thread_sched_policy,
+        new_options.thread_sched_policy, options_.thread_bind_cpu, new_options.thread_bind_cpu);
+  }
+  options_.thread_sched_policy = new_options.thread_sched_policy;
+  options_.thread_bind_cpu = new_options.thread_bind_cpu;
+
+  if (new_options.rate_factor != options_.rate_factor) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    options_.rate_factor = new_options.rate_factor;
+    if (cur_state == State::kStart) time_source_.SetRateFactor(options_.rate_factor);
+    rate_changed_ = true;
+    cond_.notify_one();
+  }
+
+  if (new_options.start_time_us != options_.start_time_us ||
+      new_options.thread_hardening != options_.thread_hardening) {
+    if (!restart_reason.empty()) restart_reason += ", ";
+    restart_reason += "'start_time_us' and 'thread_hardening' only take effect after restart";
+  }
+
+  NXPILOT_INFO("SimTimeExecutor '{}' options updated", name_);
+  return restart_reason;
+}
+
+void SimTimeExecutor::Start() {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
+                      "SimTimeExecutor can only run when state is 'Init'.");
+
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+    time_source_.SetRateFactor(options_.rate_factor);
+  }
+  thread_ptr_ = std::make_unique<std::thread>(std::bind(&SimTimeExecutor::Loop, this));
+
+  NXPILOT_INFO("SimTimeExecutor start completed");
+}
+
+void SimTimeExecutor::Shutdown() { ShutdownUntil(std::chrono::steady_clock::time_point::max()); }
+
+ExecutorBase::ShutdownReport SimTimeExecutor::ShutdownUntil(
+    std::chrono::steady_clock::time_point deadline) {
+  if (std::atomic_exchange(&state_, State::kShutdown) == State::kShutdown) {
+    return ShutdownReport{};
+  }
+
+  {
+    std::unique_lock<std::mutex> lck(mutex_);
+    cond_.notify_one();
+  }
+
+  if (thread_ptr_ && thread_ptr_->joinable()) {
+    thread_ptr_->join();
+  }
+
+  thread_ptr_.reset();
+
+  // The executor thread is gone, or never started, handle the left tasks here. Tasks posted by
+  // them are dropped with the pending timers.
+  std::deque<Task> left_queue;
+  {
+    std::unique_lock<std::mutex> lck(mutex_);
+    left_queue.swap(queue_);
+  }
+  for (auto& task : left_queue) {
+    if (std::chrono::steady_clock::now() < deadline) {
+      RunTask(task);
+      ++shutdown_report_.executed_task_num;
+    } else {
+      shutdown_report_.deadline_exceeded = true;
+      ++shutdown_report_.dropped_task_num;
+      --task_num_;
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> lck(mutex_);
+    const size_t dropped_task_num = queue_.size() + timer_map_.size();
+    shutdown_report_.dropped_task_num += dropped_task_num;
+    task_num_ -= dropped_task_num;
+    queue_.clear();
+    timer_map_.clear();
+  }
+
+  NXPILOT_INFO("SimTimeExecutor shutdown, {} left tasks executed, {} dropped",
+               shutdown_report_.executed_task_num, shutdown_report_.dropped_task_num);
+  return shutdown_report_;
+}
+
+void SimTimeExecutor::Execute(Task&& task) noexcept {
+  if (state_.load() != State::kStart) [[unlikely]] {
+    NXPILOT_ERROR("SimTimeExecutor can only execute task when state is 'Start'.");
+  }
+
+  ++task_num_;
+  std::unique_lock<std::mutex> lck(mutex_);
+  queue_.emplace_back(std::move(task));
+  cond_.notify_one();
+}
+
+std::chrono::system_clock::time_point SimTimeExecutor::Now() const noexcept {
+  return time_source_.Now();
+}
+
+void SimTimeExecutor::ExecuteAt(std::chrono::system_clock::time_point tp, Task&& task) noexcept {
+  if (state_.load() != State::kStart) [[unlikely]] {
+    NXPILOT_ERROR("SimTimeExecutor can only execute task when state is 'Start'.");
+  }
+
+  try {
+    ++task_num_;
+    std::unique_lock<std::mutex> lck(mutex_);
+    timer_map_.emplace(tp, std::move(task));
+    cond_.notify_one();
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("{}", e.what());
+  }
+}
+
+void SimTimeExecutor::RunTask(Task& task) noexcept {
+  try {
+    task();
+  } catch (const std::exception& e) {
+    NXPILOT_FATAL("SimTimeExecutor run task get exception, {}", e.what());
+  }
+  --task_num_;
+}
+
+void SimTimeExecutor::Loop() {
+  try {
+    nxpilot::utils::common::SetNameForCurrentThread(name_);
+    nxpilot::utils::common::BindCpuForCurrentThread(options_.thread_bind_cpu);
+    nxpilot::utils::common::SetCpuSchedForCurrentThread(options_.thread_sched_policy);
+    nxpilot::utils::common::ApplyHardeningForCurrentThread(options_.thread_hardening);
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("Set thread policy for SimTimeExecutor get exception, {}", e.what());
+  }
+
+  std::deque<Task> tmp_queue;
+  std::unique_lock<std::mutex> lck(mutex_);
+  while (state_.load() != State::kShutdown) {
+    if (!queue_.empty()) {
+      queue_.swap(tmp_queue);
+      lck.unlock();
+      while (!tmp_queue.empty() && state_.load() != State::kShutdown) {
+        RunTask(tmp_queue.front());
+        tmp_queue.pop_front();
+      }
+      lck.lock();
+
+      // Stopped in the middle of a batch, keep the rest in order for the shutdown.
+      if (!tmp_queue.empty()) {
+        std::move(queue_.begin(), queue_.end(), std::back_inserter(tmp_queue));
+        queue_.swap(tmp_queue);
+        tmp_queue.clear();
+      }
+      continue;
+    }
+
+    if (timer_map_.empty()) {
+      cond_.wait(lck, [this] {
+        return !queue_.empty() || !timer_map_.empty() || state_.load() == State::kShutdown;
+      });
+      continue;
+    }
+
+    const auto tp = timer_map_.begin()->first;
+    if (time_source_.GetRateFactor() > 0) {
+      // Wake up early for new tasks, an earlier timer or a new rate factor.
+      rate_changed_ = false;
+      bool woken = cond_.wait_until(lck, time_source_.RealTimeOf(tp), [this, tp] {
+        return !queue_.empty() || timer_map_.begin()->first < tp || rate_changed_ ||
+               state_.load() == State::kShutdown;
+      });
+      if (woken) continue;
+    }
+
+    auto itr = timer_map_.begin();
+    Task task = std::move(itr->second);
+    timer_map_.erase(itr);
+    time_source_.AdvanceTo(tp);
+
+    lck.unlock();
+    RunTask(task);
+    lck.lock();
+  }
+}
+
+}  // namespace nxpilot::runtime::core::executor
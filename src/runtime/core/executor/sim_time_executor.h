@@ -0,0 +1,112 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "runtime/core/executor/executor_base.h"
+#include "runtime/core/executor/time_source.h"
+#include "utils/common/log_tool.h"
+#include "utils/common/thread_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::executor {
+
+/**
+ * @brief Single thread executor running on virtual time, e.g. to replay recorded data faster than
+ * real time.
+ *
+ * Queued tasks always run first. Once the queue is empty, the virtual time jumps to the earliest
+ * timer and runs it, so time advances as fast as the work allows. Timers fire in due order,
+ * timers due at the same time in the order they were scheduled. With a positive 'rate_factor',
+ * the virtual time instead runs at that multiple of real time, and timers wait for it.
+ */
+class SimTimeExecutor : public ExecutorBase {
+ public:
+  SimTimeExecutor() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~SimTimeExecutor() = default;
+
+  struct Options {
+    std::string thread_sched_policy;
+    std::vector<uint32_t> thread_bind_cpu;
+    nxpilot::utils::common::ThreadHardeningOptions thread_hardening;
+    // 0 runs as fast as possible, otherwise the speed of the virtual time relative to real time.
+    double rate_factor = 0;
+    // Virtual time at start in us since epoch, 0 starts from the real time.
+    uint64_t start_time_us = 0;
+  };
+
+  enum class State : uint32_t {
+    kPreInit,
+    kInit,
+    kStart,
+    kShutdown,
+  };
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  void Initialize(std::string_view name, YAML::Node options_node) override;
+  void Start() override;
+  void Shutdown() override;
+  // Queued tasks are run until the deadline, pending timers are dropped.
+  ShutdownReport ShutdownUntil(std::chrono::steady_clock::time_point deadline) override;
+  // Thread placement and 'rate_factor' apply live, 'start_time_us' and 'thread_hardening' need a
+  // restart.
+  std::string UpdateOptions(YAML::Node options_node) override;
+  void CheckOptions(YAML::Node options_node) const override { ParseOptions(options_node); }
+
+  State GetState() const { return state_.load(); }
+
+  std::string_view Type() const noexcept override { return type_; }
+  std::string_view Name() const noexcept override { return name_; }
+
+  bool ThreadSafe() const noexcept override { return true; }
+
+  void Execute(Task&& task) noexcept override;
+
+  bool SupportTimerSchedule() const noexcept override { return true; }
+  std::chrono::system_clock::time_point Now() const noexcept override;
+  void ExecuteAt(std::chrono::system_clock::time_point tp, Task&& task) noexcept override;
+
+  size_t CurrentTaskNum() noexcept override { return task_num_.load(); }
+
+  const SimTimeSource& GetTimeSource() const { return time_source_; }
+
+ private:
+  Options ParseOptions(YAML::Node options_node) const;
+  void Loop();
+  void RunTask(Task& task) noexcept;
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  std::atomic<State> state_ = State::kPreInit;
+
+  std::string name_;
+  std::string_view type_ = "sim_time";
+
+  SimTimeSource time_source_;
+
+  std::atomic_uint32_t task_num_ = 0;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<Task> queue_;
+  // Equal keys keep the insertion order, so timers due at the same time run in schedule order.
+  std::multimap<std::chrono::system_clock::time_point, Task> timer_map_;
+  // Set when the rate factor changes, to recompute the wait for the next timer.
+  bool rate_changed_ = false;
+  std::unique_ptr<std::thread> thread_ptr_;
+
+  ShutdownReport shutdown_report_;
+};
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,127 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/executor/sim_time_executor.h"
+
+namespace nxpilot::runtime::core::executor {
+
+namespace {
+
+constexpr uint64_t kStartTimeUs = 1700000000000000;
+
+std::chrono::system_clock::time_point StartTime() {
+  return std::chrono::system_clock::time_point(std::chrono::microseconds(kStartTimeUs));
+}
+
+YAML::Node StartTimeOptions() {
+  return YAML::Load("start_time_us: " + std::to_string(kStartTimeUs));
+}
+
+}  // namespace
+
+TEST(SimTimeExecutorTest, timers_fire_in_order) {
+  SimTimeExecutor executor;
+  executor.Initialize("sim_order_test", StartTimeOptions());
+  executor.Start();
+  EXPECT_EQ(executor.Now(), StartTime());
+
+  std::mutex mutex;
+  std::vector<std::pair<int, std::chrono::system_clock::time_point>> fired_vec;
+  std::promise<void> done_promise;
+  auto record = [&](int idx) {
+    return [&, idx]() {
+      std::lock_guard<std::mutex> lck(mutex);
+      fired_vec.emplace_back(idx, executor.Now());
+    };
+  };
+
+  // Scheduled out of order, two of them due at the same time. From the executor thread, so time
+  // does not advance before all are scheduled.
+  executor.Execute([&]() {
+    executor.ExecuteAt(StartTime() + std::chrono::hours(2), record(3));
+    executor.ExecuteAt(StartTime() + std::chrono::seconds(1), record(0));
+    executor.ExecuteAt(StartTime() + std::chrono::minutes(30), record(1));
+    executor.ExecuteAt(StartTime() + std::chrono::minutes(30), record(2));
+    executor.ExecuteAt(StartTime() + std::chrono::hours(3), [&]() { done_promise.set_value(); });
+  });
+
+  // Hours of virtual time pass at once.
+  ASSERT_EQ(done_promise.get_future().wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  executor.Shutdown();
+
+  ASSERT_EQ(fired_vec.size(), 4);
+  for (int ii = 0; ii < 4; ++ii) EXPECT_EQ(fired_vec[ii].first, ii);
+  EXPECT_EQ(fired_vec[0].second, StartTime() + std::chrono::seconds(1));
+  EXPECT_EQ(fired_vec[1].second, StartTime() + std::chrono::minutes(30));
+  EXPECT_EQ(fired_vec[2].second, StartTime() + std::chrono::minutes(30));
+  EXPECT_EQ(fired_vec[3].second, StartTime() + std::chrono::hours(2));
+}
+
+TEST(SimTimeExecutorTest, queued_tasks_run_before_time_advances) {
+  SimTimeExecutor executor;
+  executor.Initialize("sim_queue_test", StartTimeOptions());
+  executor.Start();
+
+  std::vector<int> order_vec;
+  std::promise<void> done_promise;
+  executor.Execute([&]() {
+    // Periodic timer rescheduling itself, the queued task still runs at the start time.
+    executor.ExecuteAt(executor.Now() + std::chrono::seconds(1), [&]() {
+      order_vec.emplace_back(1);
+      done_promise.set_value();
+    });
+    executor.Execute([&]() {
+      EXPECT_EQ(executor.Now(), StartTime());
+      order_vec.emplace_back(0);
+    });
+  });
+
+  done_promise.get_future().wait();
+  executor.Shutdown();
+  EXPECT_EQ(order_vec, (std::vector<int>{0, 1}));
+}
+
+TEST(SimTimeExecutorTest, rate_factor) {
+  SimTimeExecutor executor;
+  executor.Initialize("sim_rate_test", YAML::Load("rate_factor: 100"));
+  executor.Start();
+
+  // 2 s of virtual time at 100x take about 20 ms.
+  std::promise<std::chrono::system_clock::time_point> fired_promise;
+  const auto begin_tp = std::chrono::steady_clock::now();
+  const auto due_tp = executor.Now() + std::chrono::seconds(2);
+  executor.ExecuteAt(due_tp, [&]() { fired_promise.set_value(executor.Now()); });
+
+  auto fired_tp = fired_promise.get_future().get();
+  const auto cost = std::chrono::steady_clock::now() - begin_tp;
+  executor.Shutdown();
+
+  EXPECT_GE(fired_tp, due_tp);
+  EXPECT_GE(cost, std::chrono::milliseconds(15));
+  EXPECT_LT(cost, std::chrono::seconds(1));
+}
+
+TEST(SimTimeExecutorTest, shutdown_drops_timers) {
+  SimTimeExecutor executor;
+  executor.Initialize("sim_shutdown_test", YAML::Load("rate_factor: 1"));
+  executor.Start();
+
+  executor.ExecuteAt(executor.Now() + std::chrono::hours(1), []() {});
+  auto report = executor.ShutdownUntil(std::chrono::steady_clock::time_point::max());
+  EXPECT_EQ(report.dropped_task_num, 1);
+  EXPECT_EQ(executor.CurrentTaskNum(), 0);
+}
+
+TEST(SimTimeExecutorTest, invalid_options) {
+  SimTimeExecutor executor;
+  EXPECT_THROW(executor.Initialize("sim_invalid_test", YAML::Load("rate_factor: -1")),
+               std::exception);
+}
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,52 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "runtime/core/executor/executor_base.h"
+
+namespace nxpilot::runtime::core::executor {
+
+/**
+ * @brief Call 'on_drop' if the task holding the guard is destroyed without having run.
+ *
+ * 'Execute' returns nothing, an executor drops a task, e.g. on a full queue or on shutdown, by
+ * destroying it. A task whose submitter waits for it captures a guard to learn about that. Copies
+ * share the guard, 'on_drop' is called with the last one, on the thread destroying it, and must not
+ * throw.
+ */
+class TaskDropGuard {
+ public:
+  explicit TaskDropGuard(std::function<void()>&& on_drop)
+      : state_ptr_(std::make_shared<State>(std::move(on_drop))) {}
+
+  // Called by the task when it runs.
+  void Disarm() const noexcept { state_ptr_->armed_flag = false; }
+
+ private:
+  struct State {
+    explicit State(std::function<void()>&& on_drop) : on_drop(std::move(on_drop)) {}
+    ~State() {
+      if (armed_flag) on_drop();
+    }
+
+    std::function<void()> on_drop;
+    bool armed_flag = true;
+  };
+
+  std::shared_ptr<State> state_ptr_;
+};
+
+// Wrap 'task' so that 'on_drop' is called instead if the executor drops it.
+inline ExecutorBase::Task GuardDroppedTask(ExecutorBase::Task&& task,
+                                           std::function<void()>&& on_drop) {
+  return [guard = TaskDropGuard(std::move(on_drop)), task = std::move(task)]() {
+    guard.Disarm();
+    task();
+  };
+}
+
+}  // namespace nxpilot::runtime::core::executor
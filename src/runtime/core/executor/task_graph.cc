@@ -0,0 +1,248 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/executor/task_graph.h"
+
+#include <algorithm>
+#include <format>
+#include <unordered_map>
+
+#include "runtime/core/executor/task_drop_guard.h"
+
+namespace nxpilot::runtime::core::executor {
+
+namespace {
+
+uint64_t GetNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+TaskGraph::~TaskGraph() {
+  try {
+    Wait();
+  } catch (...) {
+  }
+}
+
+void TaskGraph::AddNode(std::string_view name, ExecutorBase* executor_ptr, Task&& task,
+                        std::vector<std::string> depends_on) {
+  NXPILOT_CHECK_ERROR(!built_flag_, "Can not add node '{}' to a built TaskGraph", name);
+  NXPILOT_CHECK_ERROR(executor_ptr == nullptr || executor_ptr->ThreadSafe(),
+                      "Executor '{}' of task graph node '{}' is not thread safe",
+                      executor_ptr->Name(), name);
+  NXPILOT_CHECK_ERROR(std::ranges::none_of(
+                          node_vec_,
+                          [name](const auto& node_ptr) { return node_ptr->name == name; }),
+                      "Duplicate task graph node '{}'", name);
+
+  auto node_ptr = std::make_unique<Node>();
+  node_ptr->graph_ptr = this;
+  node_ptr->idx = node_vec_.size();
+  node_ptr->name = std::string(name);
+  node_ptr->executor_ptr = executor_ptr;
+  node_ptr->task = std::move(task);
+  node_ptr->depends_on = std::move(depends_on);
+  node_vec_.emplace_back(std::move(node_ptr));
+}
+
+void TaskGraph::Build() {
+  NXPILOT_CHECK_ERROR(!built_flag_, "TaskGraph is already built.");
+
+  std::unordered_map<std::string_view, size_t> idx_map;
+  for (const auto& node_ptr : node_vec_) idx_map.emplace(node_ptr->name, node_ptr->idx);
+
+  std::vector<uint32_t> in_degree_vec(node_vec_.size(), 0);
+  for (auto& node_ptr : node_vec_) {
+    for (const auto& dep_name : node_ptr->depends_on) {
+      auto iter = idx_map.find(dep_name);
+      NXPILOT_CHECK_ERROR(iter != idx_map.end(),
+                          "Task graph node '{}' depends on unknown node '{}'", node_ptr->name,
+                          dep_name);
+      node_ptr->dep_idx_vec.push_back(iter->second);
+      node_vec_[iter->second]->successor_idx_vec.push_back(node_ptr->idx);
+      ++in_degree_vec[node_ptr->idx];
+    }
+    if (node_ptr->dep_idx_vec.empty()) root_idx_vec_.push_back(node_ptr->idx);
+  }
+
+  order_vec_ = root_idx_vec_;
+  for (size_t head = 0; head < order_vec_.size(); ++head) {
+    for (auto successor_idx : node_vec_[order_vec_[head]]->successor_idx_vec) {
+      if (--in_degree_vec[successor_idx] == 0) order_vec_.push_back(successor_idx);
+    }
+  }
+  NXPILOT_CHECK_ERROR(order_vec_.size() == node_vec_.size(),
+                      "Circular dependency detected in task graph.");
+
+  timing_vec_.resize(node_vec_.size());
+  for (size_t ii = 0; ii < node_vec_.size(); ++ii) timing_vec_[ii].name = node_vec_[ii]->name;
+  critical_path_vec_.reserve(node_vec_.size());
+
+  built_flag_ = true;
+}
+
+bool TaskGraph::Launch() {
+  NXPILOT_CHECK_ERROR(built_flag_, "TaskGraph should be built before launched.");
+
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+    if (running_flag_) return false;
+    running_flag_ = true;
+  }
+
+  for (auto& node_ptr : node_vec_) {
+    node_ptr->left_dep_num.store(node_ptr->dep_idx_vec.size(), std::memory_order_relaxed);
+    node_ptr->last_dep_idx = SIZE_MAX;
+    node_ptr->skipped = false;
+  }
+  failed_flag_.store(false, std::memory_order_relaxed);
+  launch_ns_ = GetNowNs();
+  left_node_num_.store(node_vec_.size(), std::memory_order_release);
+
+  if (node_vec_.empty()) {
+    FinishRun();
+    return true;
+  }
+
+  for (auto root_idx : root_idx_vec_) Dispatch(*node_vec_[root_idx], launch_ns_);
+  return true;
+}
+
+void TaskGraph::Wait() {
+  std::exception_ptr exception_ptr;
+  {
+    std::unique_lock<std::mutex> lck(mutex_);
+    cond_.wait(lck, [this]() { return !running_flag_; });
+    std::swap(exception_ptr, exception_ptr_);
+  }
+  if (exception_ptr) std::rethrow_exception(exception_ptr);
+}
+
+bool TaskGraph::IsRunning() const {
+  std::lock_guard<std::mutex> lck(mutex_);
+  return running_flag_;
+}
+
+void TaskGraph::Dispatch(Node& node, uint64_t ready_ns) noexcept {
+  node.ready_ns = ready_ns;
+
+  ExecutorBase* executor_ptr = node.executor_ptr;
+  if (executor_ptr == nullptr || failed_flag_.load(std::memory_order_relaxed)) {
+    RunNode(node);
+    return;
+  }
+
+  // A task the executor drops, e.g. on a full queue, runs inline instead, or the run never ends.
+  auto run_node = [node_ptr = &node]() { node_ptr->graph_ptr->RunNode(*node_ptr); };
+  auto task = GuardDroppedTask(run_node, run_node);
+  if (executor_ptr->SupportTimerSchedule()) {
+    // Timer executors only run timed tasks.
+    executor_ptr->ExecuteAt(executor_ptr->Now(), std::move(task));
+  } else {
+    executor_ptr->Execute(std::move(task));
+  }
+}
+
+void TaskGraph::RunNode(Node& node) noexcept {
+  node.begin_ns = GetNowNs();
+  if (failed_flag_.load(std::memory_order_relaxed)) {
+    node.skipped = true;
+    node.end_ns = node.begin_ns;
+  } else {
+    try {
+      node.task();
+    } catch (...) {
+      std::lock_guard<std::mutex> lck(mutex_);
+      if (!exception_ptr_) exception_ptr_ = std::current_exception();
+      failed_flag_.store(true, std::memory_order_relaxed);
+    }
+    node.end_ns = GetNowNs();
+  }
+  FinishNode(node);
+}
+
+void TaskGraph::FinishNode(Node& node) noexcept {
+  for (auto successor_idx : node.successor_idx_vec) {
+    auto& successor = *node_vec_[successor_idx];
+    if (successor.left_dep_num.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      successor.last_dep_idx = node.idx;
+      Dispatch(successor, node.end_ns);
+    }
+  }
+
+  if (left_node_num_.fetch_sub(1, std::memory_order_acq_rel) == 1) FinishRun();
+}
+
+void TaskGraph::FinishRun() noexcept {
+  uint64_t run_end_ns = launch_ns_;
+  size_t last_idx = SIZE_MAX;
+  for (const auto& node_ptr : node_vec_) {
+    if (last_idx == SIZE_MAX || node_ptr->end_ns > run_end_ns) {
+      run_end_ns = std::max(run_end_ns, node_ptr->end_ns);
+      last_idx = node_ptr->idx;
+    }
+  }
+
+  critical_path_vec_.clear();
+  for (size_t idx = last_idx; idx != SIZE_MAX; idx = node_vec_[idx]->last_dep_idx) {
+    critical_path_vec_.push_back(idx);
+  }
+  std::reverse(critical_path_vec_.begin(), critical_path_vec_.end());
+
+  // Backwards from the sinks, which could end as late as the run: a node could end later by the
+  // slack of a successor, plus the time the successor became ready after the node ended.
+  auto to_ns = [this](uint64_t ns) { return std::chrono::nanoseconds(ns - launch_ns_); };
+  for (auto iter = order_vec_.rbegin(); iter != order_vec_.rend(); ++iter) {
+    const auto& node = *node_vec_[*iter];
+    auto& timing = timing_vec_[node.idx];
+    int64_t slack_ns = static_cast<int64_t>(run_end_ns - node.end_ns);
+    for (auto successor_idx : node.successor_idx_vec) {
+      const auto& successor = *node_vec_[successor_idx];
+      slack_ns = std::min(slack_ns, timing_vec_[successor_idx].slack.count() +
+                                        static_cast<int64_t>(successor.ready_ns - node.end_ns));
+    }
+    timing.ready = to_ns(node.ready_ns);
+    timing.begin = to_ns(node.begin_ns);
+    timing.end = to_ns(node.end_ns);
+    timing.slack = std::chrono::nanoseconds(std::max<int64_t>(slack_ns, 0));
+    timing.critical = false;
+    timing.skipped = node.skipped;
+  }
+  for (auto idx : critical_path_vec_) {
+    timing_vec_[idx].critical = true;
+    node_vec_[idx]->critical_run_num.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  last_run_time_ = to_ns(run_end_ns);
+
+  // Notified under the lock, the graph may be destroyed as soon as a waiter returns.
+  std::lock_guard<std::mutex> lck(mutex_);
+  // Recorded under the lock 'Report' reads them with.
+  for (const auto& node_ptr : node_vec_) {
+    if (!node_ptr->skipped) {
+      node_ptr->run_time_histogram.Record(node_ptr->end_ns - node_ptr->begin_ns);
+    }
+  }
+  ++run_num_;
+  running_flag_ = false;
+  cond_.notify_all();
+}
+
+std::string TaskGraph::Report() const {
+  std::lock_guard<std::mutex> lck(mutex_);
+  std::string report;
+  for (const auto& node_ptr : node_vec_) {
+    const auto& histogram = node_ptr->run_time_histogram;
+    report += std::format(
+        "node '{}': count {}, p50 {}us, p99 {}us, max {}us, critical in {}/{} runs\n",
+        node_ptr->name, histogram.GetCount(), histogram.GetPercentile(50) / 1000,
+        histogram.GetPercentile(99) / 1000, histogram.GetMax() / 1000,
+        node_ptr->critical_run_num.load(), run_num_);
+  }
+  return report;
+}
+
+}  // namespace nxpilot::runtime::core::executor
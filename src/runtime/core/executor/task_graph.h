@@ -0,0 +1,153 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "runtime/core/executor/executor_base.h"
+#include "utils/common/histogram_tool.h"
+#include "utils/common/log_tool.h"
+
+namespace nxpilot::runtime::core::executor {
+
+/**
+ * @brief A fixed DAG of tasks bound to executors, built once and launched every cycle, e.g. every
+ * frame of a perception pipeline.
+ *
+ * Each node has an atomic counter of the dependencies left in the current run, the one finishing
+ * a node posts the successors it made ready to their executors. Everything a run needs is
+ * allocated in 'Build', a run itself only allocates the drop guard of each task posted to an
+ * executor, as long as the executors allocate nothing: a node whose task the executor drops, e.g.
+ * on a full queue, runs inline instead, so that the run still ends. If a task throws, the nodes
+ * after it are skipped and 'Wait' rethrows the first exception.
+ *
+ * Each run records when every node became ready, started and ended. The critical path is the
+ * chain of nodes that made each other ready last, ending with the last node to end; the slack of
+ * a node is how much later it could have ended without delaying the run.
+ */
+class TaskGraph {
+ public:
+  using Task = std::function<void()>;
+
+  // Times of the last run, relative to its launch.
+  struct NodeTiming {
+    std::string_view name;
+    std::chrono::nanoseconds ready = std::chrono::nanoseconds(0);
+    std::chrono::nanoseconds begin = std::chrono::nanoseconds(0);
+    std::chrono::nanoseconds end = std::chrono::nanoseconds(0);
+    std::chrono::nanoseconds slack = std::chrono::nanoseconds(0);
+    bool critical = false;
+    bool skipped = false;
+  };
+
+  TaskGraph() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~TaskGraph();
+
+  TaskGraph(const TaskGraph&) = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  // 'executor_ptr' must be thread safe and outlive the graph. A null one runs the task on the
+  // thread that made it ready, e.g. for cheap glue nodes. Dependencies are referenced by name and
+  // may be added later.
+  void AddNode(std::string_view name, ExecutorBase* executor_ptr, Task&& task,
+               std::vector<std::string> depends_on = {});
+
+  // Resolve the dependencies and allocate the run state. Throw on unknown dependency or cycle.
+  void Build();
+
+  // Start a run and return. Return false if the previous run has not finished, e.g. on a frame
+  // overrun, the cycle is skipped then.
+  bool Launch();
+  // Wait for the current run, rethrow the first exception of its tasks.
+  void Wait();
+  // Launch a run and wait for it. Return false without waiting if the previous run has not
+  // finished, the timings then still describe that run.
+  bool Run() {
+    if (!Launch()) return false;
+    Wait();
+    return true;
+  }
+
+  bool IsRunning() const;
+
+  // Of the last finished run, in the order the nodes were added.
+  const std::vector<NodeTiming>& GetNodeTimings() const { return timing_vec_; }
+  // Indexes of the critical path of the last finished run, from its first node to its last.
+  const std::vector<size_t>& GetCriticalPath() const { return critical_path_vec_; }
+  std::chrono::nanoseconds GetLastRunTime() const { return last_run_time_; }
+
+  // Run time and critical path share of every node over all runs, e.g. for the shutdown log.
+  std::string Report() const;
+
+ private:
+  struct Node {
+    TaskGraph* graph_ptr = nullptr;
+    size_t idx = 0;
+    std::string name;
+    ExecutorBase* executor_ptr = nullptr;
+    Task task;
+    std::vector<std::string> depends_on;
+    std::vector<size_t> dep_idx_vec;
+    std::vector<size_t> successor_idx_vec;
+
+    // State of the current run.
+    std::atomic_uint32_t left_dep_num = 0;
+    // The dependency that made it ready, written by the thread that did.
+    size_t last_dep_idx = SIZE_MAX;
+    uint64_t ready_ns = 0;
+    uint64_t begin_ns = 0;
+    uint64_t end_ns = 0;
+    bool skipped = false;
+
+    // Over all runs, recorded under 'mutex_' at the end of each run.
+    nxpilot::utils::common::Histogram run_time_histogram;
+    std::atomic_uint64_t critical_run_num = 0;
+  };
+
+  // Make 'node' run, on its executor or inline, 'ready_ns' is when its last dependency ended.
+  void Dispatch(Node& node, uint64_t ready_ns) noexcept;
+  void RunNode(Node& node) noexcept;
+  // Release the successors of 'node', and end the run after the last node.
+  void FinishNode(Node& node) noexcept;
+  void FinishRun() noexcept;
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  bool built_flag_ = false;
+
+  std::vector<std::unique_ptr<Node>> node_vec_;
+  std::vector<size_t> root_idx_vec_;
+  // A topological order, to compute the slacks backwards.
+  std::vector<size_t> order_vec_;
+
+  uint64_t launch_ns_ = 0;
+  std::atomic_size_t left_node_num_ = 0;
+  std::atomic_bool failed_flag_ = false;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+  bool running_flag_ = false;
+  std::exception_ptr exception_ptr_;
+
+  uint64_t run_num_ = 0;
+  std::chrono::nanoseconds last_run_time_ = std::chrono::nanoseconds(0);
+  std::vector<NodeTiming> timing_vec_;
+  std::vector<size_t> critical_path_vec_;
+};
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,221 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/executor/task_graph.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <future>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/executor/guard_thread_executor.h"
+#include "runtime/core/executor/time_wheel_executor.h"
+
+namespace {
+
+// Allocations of the current thread, counted while enabled.
+thread_local bool count_alloc_flag = false;
+thread_local size_t alloc_num = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  if (count_alloc_flag) ++alloc_num;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace nxpilot::runtime::core::executor {
+
+namespace {
+
+// Runs the tasks right away on the posting thread.
+class InlineExecutor : public ExecutorBase {
+ public:
+  void Initialize(std::string_view name, YAML::Node options_node) override {}
+  void Start() override {}
+  void Shutdown() override {}
+  std::string_view Type() const noexcept override { return "inline"; }
+  std::string_view Name() const noexcept override { return "inline"; }
+  bool ThreadSafe() const noexcept override { return true; }
+  void Execute(Task&& task) noexcept override { task(); }
+  bool SupportTimerSchedule() const noexcept override { return false; }
+  std::chrono::system_clock::time_point Now() const noexcept override { return {}; }
+  void ExecuteAt(std::chrono::system_clock::time_point tp, Task&& task) noexcept override {}
+};
+
+// Drops every task, like a guard thread with a full queue.
+class DropExecutor : public InlineExecutor {
+ public:
+  void Execute(Task&& task) noexcept override {}
+};
+
+class TaskGraphTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (auto* executor_ptr : {&executor_a_, &executor_b_, &executor_c_}) {
+      executor_ptr->Initialize("task_graph_test", YAML::Node(YAML::NodeType::Null));
+      executor_ptr->Start();
+    }
+  }
+
+  void TearDown() override {
+    for (auto* executor_ptr : {&executor_a_, &executor_b_, &executor_c_}) executor_ptr->Shutdown();
+  }
+
+  GuardThreadExecutor executor_a_;
+  GuardThreadExecutor executor_b_;
+  GuardThreadExecutor executor_c_;
+};
+
+}  // namespace
+
+TEST_F(TaskGraphTest, critical_path) {
+  std::atomic_uint32_t fusion_num = 0;
+  auto sleep_ms = [](uint32_t ms) {
+    return [ms]() { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); };
+  };
+
+  TaskGraph graph;
+  graph.AddNode("plan", nullptr, [&]() { EXPECT_EQ(fusion_num.load(), 1); }, {"fusion"});
+  graph.AddNode("preprocess", &executor_a_, sleep_ms(1));
+  graph.AddNode("slow_detector", &executor_b_, sleep_ms(30), {"preprocess"});
+  graph.AddNode("fast_detector", &executor_c_, sleep_ms(1), {"preprocess"});
+  graph.AddNode("fusion", &executor_a_, [&]() { ++fusion_num; },
+                {"slow_detector", "fast_detector"});
+  graph.Build();
+
+  for (uint32_t ii = 0; ii < 3; ++ii) {
+    fusion_num = 0;
+    graph.Run();
+    EXPECT_EQ(fusion_num.load(), 1);
+  }
+
+  // Indexes in the order the nodes were added.
+  EXPECT_EQ(graph.GetCriticalPath(), (std::vector<size_t>{1, 2, 4, 0}));
+  const auto& timing_vec = graph.GetNodeTimings();
+  EXPECT_EQ(timing_vec[3].name, "fast_detector");
+  EXPECT_FALSE(timing_vec[3].critical);
+  EXPECT_GT(timing_vec[3].slack, std::chrono::milliseconds(20));
+  for (auto idx : graph.GetCriticalPath()) {
+    EXPECT_TRUE(timing_vec[idx].critical);
+    EXPECT_EQ(timing_vec[idx].slack.count(), 0);
+  }
+  EXPECT_GE(timing_vec[2].end - timing_vec[2].begin, std::chrono::milliseconds(30));
+  EXPECT_GE(timing_vec[4].ready, timing_vec[2].end);
+  EXPECT_GE(graph.GetLastRunTime(), timing_vec[0].end);
+
+  const std::string report = graph.Report();
+  EXPECT_NE(report.find("node 'slow_detector': count 3"), std::string::npos);
+  EXPECT_NE(report.find("critical in 3/3 runs"), std::string::npos);
+  EXPECT_NE(report.find("node 'fast_detector': count 3, "), std::string::npos);
+  EXPECT_NE(report.find("critical in 0/3 runs"), std::string::npos);
+}
+
+TEST_F(TaskGraphTest, overrun_and_timer_executor) {
+  TimeWheelExecutor timer_executor;
+  timer_executor.Initialize("task_graph_test_timer", YAML::Load("dt_us: 1000"));
+  timer_executor.Start();
+
+  std::promise<void> release_promise;
+  auto release_future = release_promise.get_future().share();
+  std::atomic_uint32_t run_num = 0;
+
+  TaskGraph graph;
+  graph.AddNode("wait", &executor_a_, [&]() { release_future.wait(); });
+  graph.AddNode("timer", &timer_executor, [&]() { ++run_num; }, {"wait"});
+  graph.Build();
+
+  EXPECT_TRUE(graph.Launch());
+  EXPECT_TRUE(graph.IsRunning());
+  // The previous cycle is still running, this one is skipped.
+  EXPECT_FALSE(graph.Launch());
+  // Nor does 'Run' wait for a run it did not launch.
+  EXPECT_FALSE(graph.Run());
+  release_promise.set_value();
+  graph.Wait();
+  EXPECT_FALSE(graph.IsRunning());
+  EXPECT_EQ(run_num.load(), 1);
+
+  EXPECT_TRUE(graph.Run());
+  EXPECT_EQ(run_num.load(), 2);
+  timer_executor.Shutdown();
+}
+
+TEST_F(TaskGraphTest, exception_skips_successors) {
+  std::atomic_uint32_t run_num = 0;
+  TaskGraph graph;
+  graph.AddNode("throw", &executor_a_, []() { throw std::runtime_error("node"); });
+  graph.AddNode("after", &executor_b_, [&]() { ++run_num; }, {"throw"});
+  graph.AddNode("independent", &executor_c_, [&]() { ++run_num; });
+  graph.Build();
+
+  EXPECT_THROW(graph.Run(), std::runtime_error);
+  EXPECT_TRUE(graph.GetNodeTimings()[1].skipped);
+  EXPECT_LE(run_num.load(), 1);
+
+  // The next run starts clean.
+  EXPECT_THROW(graph.Run(), std::runtime_error);
+  EXPECT_NO_THROW(graph.Wait());
+}
+
+TEST_F(TaskGraphTest, dropped_node_runs_inline) {
+  DropExecutor drop_executor;
+  std::atomic_uint32_t run_num = 0;
+  TaskGraph graph;
+  graph.AddNode("dropped", &drop_executor, [&]() { ++run_num; });
+  graph.AddNode("after", &executor_a_, [&]() { ++run_num; }, {"dropped"});
+  graph.AddNode("dropped_after", &drop_executor, [&]() { ++run_num; }, {"after"});
+  graph.Build();
+
+  for (size_t ii = 0; ii < 3; ++ii) EXPECT_TRUE(graph.Run());
+  EXPECT_EQ(run_num.load(), 9);
+  EXPECT_NE(graph.Report().find("node 'dropped': count 3, "), std::string::npos);
+}
+
+TEST(TaskGraphBuildTest, invalid_graph) {
+  TaskGraph cycle_graph;
+  cycle_graph.AddNode("a", nullptr, []() {}, {"b"});
+  cycle_graph.AddNode("b", nullptr, []() {}, {"a"});
+  EXPECT_THROW(cycle_graph.Build(), std::exception);
+
+  TaskGraph graph;
+  graph.AddNode("a", nullptr, []() {}, {"unknown"});
+  EXPECT_THROW(graph.AddNode("a", nullptr, []() {}), std::exception);
+  EXPECT_THROW(graph.Launch(), std::exception);
+  EXPECT_THROW(graph.Build(), std::exception);
+}
+
+TEST(TaskGraphBuildTest, run_allocates_only_drop_guards) {
+  InlineExecutor executor;
+  size_t sum = 0;
+  TaskGraph graph;
+  graph.AddNode("a", &executor, [&sum]() { sum += 1; });
+  graph.AddNode("b", &executor, [&sum]() { sum += 2; }, {"a"});
+  graph.AddNode("c", nullptr, [&sum]() { sum += 3; }, {"a"});
+  graph.AddNode("d", &executor, [&sum]() { sum += 4; }, {"b", "c"});
+  graph.Build();
+  graph.Run();
+
+  // At most a guard state and a task for each of the three posted nodes, nothing for 'c'.
+  count_alloc_flag = true;
+  graph.Run();
+  count_alloc_flag = false;
+  const size_t run_alloc_num = alloc_num;
+  EXPECT_LE(run_alloc_num, 3 * 2);
+
+  count_alloc_flag = true;
+  for (size_t ii = 0; ii < 99; ++ii) graph.Run();
+  count_alloc_flag = false;
+  EXPECT_EQ(alloc_num, 100 * run_alloc_num);
+  EXPECT_EQ(sum, 101 * 10);
+  EXPECT_EQ(graph.GetCriticalPath().front(), 0);
+  EXPECT_EQ(graph.GetCriticalPath().back(), 3);
+}
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,203 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/executor/task_tracer.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "runtime/core/executor/task_drop_guard.h"
+#include "utils/common/trace_event_tool.h"
+
+namespace nxpilot::runtime::core::executor {
+
+namespace {
+
+thread_local const char* current_task_tag = nullptr;
+
+}  // namespace
+
+ScopedTaskTag::ScopedTaskTag(const char* tag) : prev_tag_(current_task_tag) {
+  current_task_tag = tag;
+}
+
+ScopedTaskTag::~ScopedTaskTag() { current_task_tag = prev_tag_; }
+
+const char* ScopedTaskTag::Current() { return current_task_tag; }
+
+void TaskTracer::Start(const Options& options, ExecutorBase* flush_executor) {
+  NXPILOT_CHECK_ERROR(!running_.load(), "TaskTracer is already started.");
+  NXPILOT_CHECK_ERROR(options.ring_capacity >= 2, "Task trace ring_capacity should be at least 2");
+
+  options_ = options;
+  flush_executor_ = flush_executor;
+
+  {
+    std::lock_guard<std::mutex> lck(file_mutex_);
+    ofs_.open(options_.file_path, std::ios::trunc);
+    NXPILOT_CHECK_ERROR(ofs_.is_open(), "Can not open task trace file '{}'", options_.file_path);
+    ofs_ << R"({"traceEvents":[)";
+    first_event_ = true;
+    event_num_ = 0;
+  }
+
+  running_.store(true);
+  NXPILOT_INFO("Task trace is written to '{}'", options_.file_path);
+}
+
+void TaskTracer::Stop() {
+  if (!running_.exchange(false)) return;
+
+  std::lock_guard<std::mutex> lck(file_mutex_);
+  FlushImpl();
+  ofs_ << R"(],"displayTimeUnit":"ms"})";
+  ofs_.close();
+
+  NXPILOT_INFO("Task trace written to '{}', {} events, {} dropped", options_.file_path,
+               event_num_, dropped_num_.load());
+}
+
+const char* TaskTracer::InternName(std::string_view name) {
+  std::lock_guard<std::mutex> lck(name_mutex_);
+  auto itr = std::ranges::find(name_deque_, name);
+  if (itr == name_deque_.end()) itr = name_deque_.emplace(name_deque_.end(), name);
+  return itr->c_str();
+}
+
+void TaskTracer::RecordSubmit(const char* executor_name, const char* tag) noexcept {
+  auto now_ns = NowNs();
+  Push(Record{.begin_ns = now_ns,
+              .end_ns = now_ns,
+              .executor_name = executor_name,
+              .tag = tag,
+              .is_submit = true});
+}
+
+void TaskTracer::RecordRun(const char* executor_name, const char* tag, uint64_t begin_ns,
+                           uint64_t end_ns) noexcept {
+  Push(Record{.begin_ns = begin_ns, .end_ns = end_ns, .executor_name = executor_name, .tag = tag});
+}
+
+TaskTracer::Ring* TaskTracer::GetThreadRing() {
+  // Tracer ids are never reused, so an entry of a destroyed tracer is never looked up again.
+  thread_local std::vector<std::pair<uint64_t, Ring*>> thread_ring_vec;
+
+  auto itr = std::ranges::find(thread_ring_vec, tracer_id_, &std::pair<uint64_t, Ring*>::first);
+  if (itr != thread_ring_vec.end()) [[likely]] {
+    return itr->second;
+  }
+
+  auto ring_ptr =
+      std::make_shared<Ring>(options_.ring_capacity, static_cast<uint64_t>(syscall(SYS_gettid)));
+  {
+    std::lock_guard<std::mutex> lck(ring_vec_mutex_);
+    ring_vec_.emplace_back(ring_ptr);
+  }
+  thread_ring_vec.emplace_back(tracer_id_, ring_ptr.get());
+  return ring_ptr.get();
+}
+
+void TaskTracer::Push(const Record& record) noexcept {
+  if (!running_.load(std::memory_order_relaxed)) return;
+
+  Ring* ring = nullptr;
+  try {
+    ring = GetThreadRing();
+  } catch (...) {
+    ++dropped_num_;
+    return;
+  }
+
+  const uint64_t capacity = ring->record_vec.size();
+  const uint64_t head = ring->head.load(std::memory_order_relaxed);
+  const uint64_t tail = ring->tail.load(std::memory_order_acquire);
+  if (head - tail >= capacity) [[unlikely]] {
+    dropped_num_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  ring->record_vec[head % capacity] = record;
+  ring->head.store(head + 1, std::memory_order_release);
+
+  if (head + 1 - tail >= capacity / 2 && flush_executor_ != nullptr &&
+      !flush_pending_.exchange(true)) {
+    // A flush the executor drops clears the flag, so that the next push posts another one.
+    try {
+      flush_executor_->Execute(GuardDroppedTask(
+          [this]() {
+            flush_pending_.store(false);
+            Flush();
+          },
+          [this]() { flush_pending_.store(false); }));
+    } catch (...) {
+      flush_pending_.store(false);
+    }
+  }
+}
+
+void TaskTracer::Flush() {
+  std::lock_guard<std::mutex> lck(file_mutex_);
+  if (!ofs_.is_open()) return;
+  FlushImpl();
+  ofs_.flush();
+}
+
+void TaskTracer::FlushImpl() {
+  std::vector<std::shared_ptr<Ring>> ring_vec;
+  {
+    std::lock_guard<std::mutex> lck(ring_vec_mutex_);
+    ring_vec = ring_vec_;
+  }
+
+  const uint32_t pid = static_cast<uint32_t>(getpid());
+  std::string out;
+  for (const auto& ring : ring_vec) {
+    const uint64_t capacity = ring->record_vec.size();
+    const uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+
+    for (; tail != head; ++tail) {
+      const auto& record = ring->record_vec[tail % capacity];
+      const std::string tag = (record.tag == nullptr) ? "task" : record.tag;
+
+      nxpilot::utils::common::TraceEvent event{
+          .name = record.is_submit ? "submit " + tag : tag,
+          .category = record.executor_name,
+          .ts_us = record.begin_ns / 1000,
+          .dur_us = (record.end_ns - record.begin_ns) / 1000,
+          .tid = ring->tid,
+          .phase = record.is_submit ? 'i' : 'X'};
+
+      if (!first_event_) out += ",\n";
+      first_event_ = false;
+      nxpilot::utils::common::AppendTraceEventJson(event, pid, out);
+      ++event_num_;
+    }
+    ring->tail.store(tail, std::memory_order_release);
+  }
+
+  ofs_ << out;
+}
+
+ExecutorBase::Task TracedExecutor::Wrap(Task&& task) noexcept {
+  if (!tracer_ptr_->IsRunning()) return std::move(task);
+
+  const char* tag = ScopedTaskTag::Current();
+  tracer_ptr_->RecordSubmit(name_, tag);
+
+  return [this, tag, task{std::move(task)}]() {
+    ScopedTaskTag scoped_tag(tag);
+    const uint64_t begin_ns = TaskTracer::NowNs();
+    try {
+      task();
+    } catch (...) {
+      tracer_ptr_->RecordRun(name_, tag, begin_ns, TaskTracer::NowNs());
+      throw;
+    }
+    tracer_ptr_->RecordRun(name_, tag, begin_ns, TaskTracer::NowNs());
+  };
+}
+
+}  // namespace nxpilot::runtime::core::executor
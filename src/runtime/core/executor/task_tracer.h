@@ -0,0 +1,159 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "runtime/core/executor/executor_base.h"
+#include "runtime/core/executor/forwarding_executor.h"
+#include "utils/common/log_tool.h"
+
+namespace nxpilot::runtime::core::executor {
+
+/**
+ * @brief Tag the tasks submitted by the current thread while in scope, the tag is the event name
+ * in the task trace. Tasks inherit the tag of the task that submitted them.
+ *
+ * The tag is kept by pointer until the trace is written, use a string literal.
+ */
+class ScopedTaskTag {
+ public:
+  explicit ScopedTaskTag(const char* tag);
+  ~ScopedTaskTag();
+
+  ScopedTaskTag(const ScopedTaskTag&) = delete;
+  ScopedTaskTag& operator=(const ScopedTaskTag&) = delete;
+
+  static const char* Current();
+
+ private:
+  const char* prev_tag_;
+};
+
+/**
+ * @brief Record task submissions and runs of the executors into a Chrome trace file.
+ *
+ * Every thread writes into a ring buffer of its own, recording takes no lock. Once a ring is half
+ * full, a flush is posted to 'flush_executor', which drains all rings and appends the events to
+ * the file. Events are dropped and counted when a ring is full.
+ */
+class TaskTracer {
+ public:
+  struct Options {
+    bool enable = false;
+    std::string file_path = "./nxpilot_task_trace.json";
+    uint32_t ring_capacity = 16384;  // events per thread
+  };
+
+  struct Record {
+    uint64_t begin_ns = 0;  // steady clock
+    uint64_t end_ns = 0;
+    const char* executor_name = nullptr;
+    const char* tag = nullptr;
+    bool is_submit = false;
+  };
+
+  TaskTracer() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~TaskTracer() { Stop(); }
+
+  TaskTracer(const TaskTracer&) = delete;
+  TaskTracer& operator=(const TaskTracer&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  // 'flush_executor' may be null, then events are only written by 'Flush' and 'Stop'.
+  void Start(const Options& options, ExecutorBase* flush_executor);
+  // Write the remaining events and close the file.
+  void Stop();
+
+  bool IsRunning() const { return running_.load(); }
+
+  // A copy of 'name' that lives as long as the tracer, so the records of an executor destroyed
+  // before the tracer is stopped do not point into it.
+  const char* InternName(std::string_view name);
+
+  void RecordSubmit(const char* executor_name, const char* tag) noexcept;
+  void RecordRun(const char* executor_name, const char* tag, uint64_t begin_ns,
+                 uint64_t end_ns) noexcept;
+
+  void Flush();
+
+  uint64_t GetDroppedNum() const { return dropped_num_.load(); }
+
+  static uint64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+ private:
+  struct Ring {
+    explicit Ring(uint32_t capacity, uint64_t tid) : record_vec(capacity), tid(tid) {}
+
+    std::vector<Record> record_vec;
+    std::atomic_uint64_t head = 0;  // written by the owner thread
+    std::atomic_uint64_t tail = 0;  // written by the flushing thread
+    uint64_t tid;
+  };
+
+  Ring* GetThreadRing();
+  void Push(const Record& record) noexcept;
+  void FlushImpl();
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  ExecutorBase* flush_executor_ = nullptr;
+  const uint64_t tracer_id_ = next_tracer_id_.fetch_add(1);
+  std::atomic_bool running_ = false;
+
+  std::mutex ring_vec_mutex_;
+  std::vector<std::shared_ptr<Ring>> ring_vec_;
+
+  std::atomic_bool flush_pending_ = false;
+  std::atomic_uint64_t dropped_num_ = 0;
+
+  std::mutex name_mutex_;
+  std::deque<std::string> name_deque_;
+
+  std::mutex file_mutex_;
+  std::ofstream ofs_;
+  bool first_event_ = true;
+  uint64_t event_num_ = 0;
+
+  static inline std::atomic_uint64_t next_tracer_id_ = 1;
+};
+
+// Forward every call to the wrapped executor, and record the submission and the run of each task
+// into 'tracer_ptr'.
+class TracedExecutor : public ForwardingExecutor {
+ public:
+  TracedExecutor(std::unique_ptr<ExecutorBase> executor_ptr, TaskTracer* tracer_ptr)
+      : ForwardingExecutor(std::move(executor_ptr)), tracer_ptr_(tracer_ptr) {}
+  ~TracedExecutor() override = default;
+
+  void Initialize(std::string_view name, YAML::Node options_node) override {
+    name_ = tracer_ptr_->InternName(name);
+    ForwardingExecutor::Initialize(name, options_node);
+  }
+
+ protected:
+  Task Wrap(Task&& task) noexcept override;
+
+ private:
+  TaskTracer* tracer_ptr_;
+  const char* name_ = "";
+};
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,163 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/executor/guard_thread_executor.h"
+#include "runtime/core/executor/task_tracer.h"
+
+namespace nxpilot::runtime::core::executor {
+
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream ifs(path);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  return ss.str();
+}
+
+size_t CountOf(const std::string& str, std::string_view sub_str) {
+  size_t num = 0;
+  for (auto pos = str.find(sub_str); pos != std::string::npos; pos = str.find(sub_str, pos + 1)) {
+    ++num;
+  }
+  return num;
+}
+
+// Drops the first task, runs the later ones inline.
+class DropFirstExecutor : public ExecutorBase {
+ public:
+  void Initialize(std::string_view name, YAML::Node options_node) override {}
+  void Start() override {}
+  void Shutdown() override {}
+  std::string_view Type() const noexcept override { return "drop_first"; }
+  std::string_view Name() const noexcept override { return "drop_first"; }
+  bool ThreadSafe() const noexcept override { return true; }
+  void Execute(Task&& task) noexcept override {
+    if (execute_num++ > 0) task();
+  }
+  bool SupportTimerSchedule() const noexcept override { return false; }
+  std::chrono::system_clock::time_point Now() const noexcept override { return {}; }
+  void ExecuteAt(std::chrono::system_clock::time_point tp, Task&& task) noexcept override {}
+
+  uint32_t execute_num = 0;
+};
+
+TEST(TaskTracerTest, trace_tasks) {
+  const auto file_path = std::filesystem::temp_directory_path() / "nxpilot_task_trace_test.json";
+
+  TaskTracer tracer;
+  auto flush_executor = std::make_unique<GuardThreadExecutor>();
+  flush_executor->Initialize("trace_flush", YAML::Node(YAML::NodeType::Null));
+  flush_executor->Start();
+  // A small ring makes the tracer flush on the flush executor while tasks are running. The test
+  // also flushes itself, so no ring fills up however late the flush executor runs.
+  tracer.Start(TaskTracer::Options{.enable = true, .file_path = file_path, .ring_capacity = 32},
+               flush_executor.get());
+
+  TracedExecutor executor(std::make_unique<GuardThreadExecutor>(), &tracer);
+  executor.Initialize("traced_guard", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+
+  constexpr size_t kTaskNum = 20;
+  for (size_t ii = 0; ii < kTaskNum; ++ii) {
+    std::promise<void> done_promise;
+    {
+      ScopedTaskTag tag("control_loop");
+      executor.Execute([&done_promise]() { done_promise.set_value(); });
+    }
+    done_promise.get_future().wait();
+  }
+  // At most 'kTaskNum' events per ring so far, less than 'ring_capacity'.
+  tracer.Flush();
+
+  // Nested submissions inherit the tag of the running task.
+  std::promise<void> nested_promise;
+  {
+    ScopedTaskTag tag("planner");
+    executor.Execute([&executor, &nested_promise]() {
+      executor.Execute([&nested_promise]() { nested_promise.set_value(); });
+    });
+  }
+  nested_promise.get_future().wait();
+
+  executor.Shutdown();
+  flush_executor->Shutdown();
+  tracer.Stop();
+
+  auto json = ReadFile(file_path);
+  EXPECT_TRUE(json.starts_with(R"({"traceEvents":[)"));
+  EXPECT_TRUE(json.ends_with(R"(],"displayTimeUnit":"ms"})"));
+  EXPECT_EQ(tracer.GetDroppedNum(), 0);
+  EXPECT_EQ(CountOf(json, R"("name":"submit control_loop","cat":"traced_guard","ph":"i")"),
+            kTaskNum);
+  EXPECT_EQ(CountOf(json, R"("name":"control_loop","cat":"traced_guard","ph":"X")"), kTaskNum);
+  EXPECT_EQ(CountOf(json, R"("name":"planner","cat":"traced_guard","ph":"X")"), 2);
+
+  std::filesystem::remove(file_path);
+}
+
+TEST(TaskTracerTest, executor_destroyed_before_stop) {
+  const auto file_path = std::filesystem::temp_directory_path() / "nxpilot_task_trace_order.json";
+
+  TaskTracer tracer;
+  tracer.Start(TaskTracer::Options{.enable = true, .file_path = file_path}, nullptr);
+  {
+    auto executor_ptr =
+        std::make_unique<TracedExecutor>(std::make_unique<GuardThreadExecutor>(), &tracer);
+    executor_ptr->Initialize("short_lived", YAML::Node(YAML::NodeType::Null));
+    executor_ptr->Start();
+    std::promise<void> done_promise;
+    executor_ptr->Execute([&done_promise]() { done_promise.set_value(); });
+    done_promise.get_future().wait();
+    executor_ptr->Shutdown();
+  }
+
+  // The records still name the destroyed executor.
+  tracer.Stop();
+  EXPECT_EQ(CountOf(ReadFile(file_path), R"("cat":"short_lived")"), 2);
+
+  std::filesystem::remove(file_path);
+}
+
+TEST(TaskTracerTest, drop_when_full) {
+  const auto file_path = std::filesystem::temp_directory_path() / "nxpilot_task_trace_drop.json";
+
+  TaskTracer tracer;
+  tracer.Start(TaskTracer::Options{.enable = true, .file_path = file_path, .ring_capacity = 4},
+               nullptr);
+  for (size_t ii = 0; ii < 10; ++ii) tracer.RecordSubmit("executor", "tag");
+  EXPECT_EQ(tracer.GetDroppedNum(), 6);
+
+  // A flush frees the ring again.
+  tracer.Flush();
+  tracer.RecordSubmit("executor", "tag");
+  tracer.Stop();
+  EXPECT_EQ(tracer.GetDroppedNum(), 6);
+  EXPECT_EQ(CountOf(ReadFile(file_path), R"("ph":"i")"), 5);
+
+  std::filesystem::remove(file_path);
+}
+
+TEST(TaskTracerTest, flush_dropped_by_executor) {
+  const auto file_path = std::filesystem::temp_directory_path() / "nxpilot_task_trace_redo.json";
+
+  TaskTracer tracer;
+  DropFirstExecutor flush_executor;
+  tracer.Start(TaskTracer::Options{.enable = true, .file_path = file_path, .ring_capacity = 4},
+               &flush_executor);
+  // The first flush is dropped, the next half full ring posts another one.
+  for (size_t ii = 0; ii < 10; ++ii) tracer.RecordSubmit("executor", "tag");
+  EXPECT_GE(flush_executor.execute_num, 2);
+  EXPECT_EQ(tracer.GetDroppedNum(), 0);
+
+  tracer.Stop();
+  EXPECT_EQ(CountOf(ReadFile(file_path), R"("ph":"i")"), 10);
+
+  std::filesystem::remove(file_path);
+}
+
+}  // namespace nxpilot::runtime::core::executor
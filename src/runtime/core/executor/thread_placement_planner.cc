@@ -0,0 +1,143 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/executor/thread_placement_planner.h"
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+namespace nxpilot::runtime::core::executor {
+
+namespace {
+
+std::vector<uint32_t> Intersect(const std::vector<uint32_t>& lhs,
+                                const std::vector<uint32_t>& rhs) {
+  std::vector<uint32_t> result;
+  std::ranges::set_intersection(lhs, rhs, std::back_inserter(result));
+  return result;
+}
+
+std::string Describe(const std::string& prefix, const std::vector<uint32_t>& cpu_vec) {
+  return prefix + (cpu_vec.size() == 1 ? " " : "s ") +
+         nxpilot::utils::common::FormatCpuList(cpu_vec);
+}
+
+}  // namespace
+
+ThreadPlacementPlan PlanThreadPlacement(const nxpilot::utils::common::CpuTopology& topology,
+                                        const std::vector<ThreadPlacementRequest>& request_vec,
+                                        bool auto_assign) {
+  ThreadPlacementPlan plan;
+
+  for (const auto& request : request_vec) {
+    ThreadPlacement placement{.name = request.name,
+                              .cpu_set = request.cpu_set,
+                              .real_time = IsRealTimeSchedPolicy(request.sched_policy)};
+    std::ranges::sort(placement.cpu_set);
+    auto unique_ret = std::ranges::unique(placement.cpu_set);
+    placement.cpu_set.erase(unique_ret.begin(), unique_ret.end());
+
+    std::vector<uint32_t> offline_cpu_vec, forbidden_cpu_vec;
+    for (auto cpu : placement.cpu_set) {
+      if (!topology.IsOnline(cpu)) {
+        offline_cpu_vec.emplace_back(cpu);
+      } else if (!topology.IsAllowed(cpu)) {
+        forbidden_cpu_vec.emplace_back(cpu);
+      }
+    }
+    if (!offline_cpu_vec.empty()) {
+      plan.error_vec.emplace_back("executor '" + request.name + "' is pinned to offline " +
+                                  Describe("cpu", offline_cpu_vec));
+    }
+    if (!forbidden_cpu_vec.empty()) {
+      plan.error_vec.emplace_back("executor '" + request.name + "' is pinned to " +
+                                  Describe("cpu", forbidden_cpu_vec) +
+                                  " outside the process cpuset " +
+                                  nxpilot::utils::common::FormatCpuList(topology.allowed_cpus));
+    }
+
+    plan.placement_vec.emplace_back(std::move(placement));
+  }
+
+  if (auto_assign) {
+    // A physical core is taken once any thread is pinned to one of its cpus.
+    std::set<uint32_t> used_core_set;
+    for (const auto& placement : plan.placement_vec) {
+      for (auto cpu : placement.cpu_set) used_core_set.emplace(topology.PhysicalCore(cpu));
+    }
+
+    auto free_cpu_vec = Intersect(topology.isolated_cpus, topology.allowed_cpus);
+    for (size_t ii = 0; ii < plan.placement_vec.size(); ++ii) {
+      auto& placement = plan.placement_vec[ii];
+      if (!IsFixedPriorityRealTimeSchedPolicy(request_vec[ii].sched_policy) ||
+          !placement.cpu_set.empty()) {
+        continue;
+      }
+
+      auto itr = std::ranges::find_if(free_cpu_vec, [&](uint32_t cpu) {
+        return !used_core_set.contains(topology.PhysicalCore(cpu));
+      });
+      if (itr == free_cpu_vec.end()) {
+        plan.warning_vec.emplace_back("no free isolated core left for real-time executor '" +
+                                      placement.name + "'");
+        continue;
+      }
+
+      placement.cpu_set = {*itr};
+      placement.auto_assigned = true;
+      used_core_set.emplace(topology.PhysicalCore(*itr));
+    }
+  }
+
+  for (size_t ii = 0; ii < plan.placement_vec.size(); ++ii) {
+    const auto& lhs = plan.placement_vec[ii];
+    if (lhs.cpu_set.empty()) continue;
+
+    if (lhs.real_time && !topology.isolated_cpus.empty()) {
+      std::vector<uint32_t> shared_cpu_vec;
+      std::ranges::set_difference(lhs.cpu_set, topology.isolated_cpus,
+                                  std::back_inserter(shared_cpu_vec));
+      if (!shared_cpu_vec.empty()) {
+        plan.warning_vec.emplace_back("real-time executor '" + lhs.name + "' is pinned to " +
+                                      Describe("non-isolated cpu", shared_cpu_vec) +
+                                      ", isolated cpus are " +
+                                      nxpilot::utils::common::FormatCpuList(
+                                          topology.isolated_cpus));
+      }
+    }
+
+    for (size_t jj = ii + 1; jj < plan.placement_vec.size(); ++jj) {
+      const auto& rhs = plan.placement_vec[jj];
+      if (rhs.cpu_set.empty() || (!lhs.real_time && !rhs.real_time)) continue;
+
+      const std::string pair_str = "executors '" + lhs.name + "' and '" + rhs.name + "'";
+      auto common_cpu_vec = Intersect(lhs.cpu_set, rhs.cpu_set);
+      if (!common_cpu_vec.empty()) {
+        // A real-time thread that can not move elsewhere starves the other one.
+        if (lhs.real_time && rhs.real_time &&
+            (lhs.cpu_set.size() == 1 || rhs.cpu_set.size() == 1)) {
+          plan.error_vec.emplace_back("real-time " + pair_str + " are both pinned to " +
+                                      Describe("cpu", common_cpu_vec));
+        } else {
+          plan.warning_vec.emplace_back(pair_str + " share " + Describe("cpu", common_cpu_vec) +
+                                        ", at least one is real-time");
+        }
+        continue;
+      }
+
+      if (!lhs.real_time || !rhs.real_time) continue;
+      std::set<uint32_t> lhs_core_set;
+      for (auto cpu : lhs.cpu_set) lhs_core_set.emplace(topology.PhysicalCore(cpu));
+      if (std::ranges::any_of(rhs.cpu_set, [&](uint32_t cpu) {
+            return lhs_core_set.contains(topology.PhysicalCore(cpu));
+          })) {
+        plan.warning_vec.emplace_back("real-time " + pair_str +
+                                      " run on SMT siblings of the same physical core");
+      }
+    }
+  }
+
+  return plan;
+}
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,56 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/common/cpu_topology_tool.h"
+
+namespace nxpilot::runtime::core::executor {
+
+struct ThreadPlacementRequest {
+  std::string name;
+  std::string sched_policy;       // same format as the 'thread_sched_policy' option
+  std::vector<uint32_t> cpu_set;  // empty means not pinned
+};
+
+struct ThreadPlacement {
+  std::string name;
+  std::vector<uint32_t> cpu_set;
+  bool real_time = false;
+  bool auto_assigned = false;
+};
+
+struct ThreadPlacementPlan {
+  std::vector<ThreadPlacement> placement_vec;  // same order as the requests
+  // Placements that can not work, e.g. a cpu outside the process cpuset or two real-time
+  // threads pinned onto one cpu.
+  std::vector<std::string> error_vec;
+  // Placements that work but lose latency, e.g. real-time threads on SMT siblings.
+  std::vector<std::string> warning_vec;
+};
+
+inline bool IsFixedPriorityRealTimeSchedPolicy(std::string_view sched_policy) {
+  return sched_policy.starts_with("SCHED_FIFO") || sched_policy.starts_with("SCHED_RR");
+}
+
+inline bool IsRealTimeSchedPolicy(std::string_view sched_policy) {
+  return IsFixedPriorityRealTimeSchedPolicy(sched_policy) ||
+         sched_policy.starts_with("SCHED_DEADLINE");
+}
+
+/**
+ * @brief Check the thread placement of all executors against each other and the cpu topology.
+ *
+ * With 'auto_assign', every unpinned SCHED_FIFO/SCHED_RR thread gets a cpu of its own on an
+ * isolated physical core that no other thread is pinned to, as long as there are free ones.
+ * SCHED_DEADLINE threads can not be pinned and are left alone.
+ */
+ThreadPlacementPlan PlanThreadPlacement(const nxpilot::utils::common::CpuTopology& topology,
+                                        const std::vector<ThreadPlacementRequest>& request_vec,
+                                        bool auto_assign);
+
+}  // namespace nxpilot::runtime::core::executor
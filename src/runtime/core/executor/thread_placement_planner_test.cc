@@ -0,0 +1,86 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/executor/thread_placement_planner.h"
+
+namespace nxpilot::runtime::core::executor {
+
+class ThreadPlacementPlannerTest : public ::testing::Test {
+ protected:
+  // 4 physical cores with 2 SMT siblings each (n and n+4), cpu 2,3,6,7 isolated, cpu 7 outside
+  // the cpuset.
+  void SetUp() override {
+    topology_.online_cpus = {0, 1, 2, 3, 4, 5, 6, 7};
+    topology_.isolated_cpus = {2, 3, 6, 7};
+    topology_.allowed_cpus = {0, 1, 2, 3, 4, 5, 6};
+    topology_.physical_core_of_cpu = {0, 1, 2, 3, 0, 1, 2, 3};
+  }
+
+  nxpilot::utils::common::CpuTopology topology_;
+};
+
+TEST_F(ThreadPlacementPlannerTest, no_conflict) {
+  auto plan = PlanThreadPlacement(topology_,
+                                  {{"rt_a", "SCHED_FIFO:80", {2}},
+                                   {"rt_b", "SCHED_RR:50", {3}},
+                                   {"normal", "", {0, 1}},
+                                   {"floating", "", {}}},
+                                  false);
+  EXPECT_TRUE(plan.error_vec.empty());
+  EXPECT_TRUE(plan.warning_vec.empty());
+  ASSERT_EQ(plan.placement_vec.size(), 4);
+  EXPECT_TRUE(plan.placement_vec[0].real_time);
+  EXPECT_FALSE(plan.placement_vec[2].real_time);
+}
+
+TEST_F(ThreadPlacementPlannerTest, errors) {
+  auto plan = PlanThreadPlacement(topology_,
+                                  {{"rt_a", "SCHED_FIFO:80", {2}},
+                                   {"rt_b", "SCHED_FIFO:70", {2, 3}},
+                                   {"offline", "", {8}},
+                                   {"outside", "", {7}}},
+                                  false);
+  ASSERT_EQ(plan.error_vec.size(), 3);
+  EXPECT_NE(plan.error_vec[0].find("offline cpu 8"), std::string::npos);
+  EXPECT_NE(plan.error_vec[1].find("cpu 7 outside the process cpuset 0-6"), std::string::npos);
+  EXPECT_NE(plan.error_vec[2].find("'rt_a' and 'rt_b' are both pinned to cpu 2"),
+            std::string::npos);
+}
+
+TEST_F(ThreadPlacementPlannerTest, warnings) {
+  auto plan = PlanThreadPlacement(topology_,
+                                  {{"rt_a", "SCHED_FIFO:80", {2}},
+                                   {"rt_sibling", "SCHED_FIFO:80", {6}},
+                                   {"rt_shared", "SCHED_RR:10", {0}},
+                                   {"normal", "SCHED_OTHER", {0, 1}}},
+                                  false);
+  EXPECT_TRUE(plan.error_vec.empty());
+  ASSERT_EQ(plan.warning_vec.size(), 3);
+  EXPECT_NE(plan.warning_vec[0].find("'rt_a' and 'rt_sibling' run on SMT siblings"),
+            std::string::npos);
+  EXPECT_NE(plan.warning_vec[1].find("'rt_shared' is pinned to non-isolated cpu 0"),
+            std::string::npos);
+  EXPECT_NE(plan.warning_vec[2].find("'rt_shared' and 'normal' share cpu 0"), std::string::npos);
+}
+
+TEST_F(ThreadPlacementPlannerTest, auto_assign) {
+  auto plan = PlanThreadPlacement(topology_,
+                                  {{"rt_pinned", "SCHED_FIFO:80", {6}},
+                                   {"rt_a", "SCHED_FIFO:80", {}},
+                                   {"normal", "", {}},
+                                   {"rt_b", "SCHED_RR:50", {}}},
+                                  true);
+  EXPECT_TRUE(plan.error_vec.empty());
+  // Core 2 is taken by 'rt_pinned' and cpu 7 is outside the cpuset, only cpu 3 is left.
+  EXPECT_EQ(plan.placement_vec[1].cpu_set, std::vector<uint32_t>{3});
+  EXPECT_TRUE(plan.placement_vec[1].auto_assigned);
+  EXPECT_TRUE(plan.placement_vec[2].cpu_set.empty());
+  EXPECT_TRUE(plan.placement_vec[3].cpu_set.empty());
+  EXPECT_FALSE(plan.placement_vec[3].auto_assigned);
+  ASSERT_EQ(plan.warning_vec.size(), 1);
+  EXPECT_NE(plan.warning_vec[0].find("no free isolated core left for real-time executor 'rt_b'"),
+            std::string::npos);
+}
+
+}  // namespace nxpilot::runtime::core::executor
@@ -0,0 +1,102 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+namespace nxpilot::runtime::core::executor {
+
+// The clock the runtime runs on. Modules and executors read the time from here instead of the
+// system clock, so a run can be driven by virtual time.
+class TimeSource {
+ public:
+  TimeSource() = default;
+  virtual ~TimeSource() = default;
+  TimeSource(const TimeSource&) = delete;
+  TimeSource& operator=(const TimeSource&) = delete;
+
+  virtual std::chrono::system_clock::time_point Now() const noexcept = 0;
+};
+
+class SystemTimeSource : public TimeSource {
+ public:
+  std::chrono::system_clock::time_point Now() const noexcept override {
+    return std::chrono::system_clock::now();
+  }
+};
+
+// The process wide real time source, used unless a simulated one is configured.
+inline const TimeSource& GetSystemTimeSource() {
+  static const SystemTimeSource kSystemTimeSource;
+  return kSystemTimeSource;
+}
+
+/**
+ * @brief Virtual time, moved forward by its owner with 'AdvanceTo'.
+ *
+ * With a rate factor of 0 the time only moves on 'AdvanceTo'. With a positive rate factor it also
+ * runs between two moves, at 'rate_factor' times the speed of real time. The time never goes back.
+ */
+class SimTimeSource : public TimeSource {
+ public:
+  std::chrono::system_clock::time_point Now() const noexcept override {
+    std::lock_guard<std::mutex> lck(mutex_);
+    return NowImpl(std::chrono::steady_clock::now());
+  }
+
+  void Reset(std::chrono::system_clock::time_point tp, double rate_factor) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    sim_anchor_ = tp;
+    real_anchor_ = std::chrono::steady_clock::now();
+    rate_factor_ = rate_factor;
+  }
+
+  void AdvanceTo(std::chrono::system_clock::time_point tp) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    const auto real_now = std::chrono::steady_clock::now();
+    sim_anchor_ = std::max(tp, NowImpl(real_now));
+    real_anchor_ = real_now;
+  }
+
+  double GetRateFactor() const {
+    std::lock_guard<std::mutex> lck(mutex_);
+    return rate_factor_;
+  }
+
+  void SetRateFactor(double rate_factor) {
+    std::lock_guard<std::mutex> lck(mutex_);
+    const auto real_now = std::chrono::steady_clock::now();
+    sim_anchor_ = NowImpl(real_now);
+    real_anchor_ = real_now;
+    rate_factor_ = rate_factor;
+  }
+
+  // The real time at which the virtual time reaches 'tp', only meaningful with a positive rate
+  // factor.
+  std::chrono::steady_clock::time_point RealTimeOf(std::chrono::system_clock::time_point tp) const {
+    std::lock_guard<std::mutex> lck(mutex_);
+    if (tp <= sim_anchor_ || rate_factor_ <= 0) return real_anchor_;
+    return real_anchor_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                              std::chrono::duration<double, std::nano>(tp - sim_anchor_) /
+                              rate_factor_);
+  }
+
+ private:
+  std::chrono::system_clock::time_point NowImpl(
+      std::chrono::steady_clock::time_point real_now) const {
+    if (rate_factor_ <= 0) return sim_anchor_;
+    return sim_anchor_ + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                             std::chrono::duration<double, std::nano>(real_now - real_anchor_) *
+                             rate_factor_);
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::chrono::system_clock::time_point sim_anchor_;
+  std::chrono::steady_clock::time_point real_anchor_ = std::chrono::steady_clock::now();
+  double rate_factor_ = 0;
+};
+
+}  // namespace nxpilot::runtime::core::executor
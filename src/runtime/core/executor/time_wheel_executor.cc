@@ -1,6 +1,11 @@
 // Copyright (C) 2024. All rights reserved.
 
 #include "runtime/core/executor/time_wheel_executor.h"
+
+#include <algorithm>
+
+#include "runtime/core/configurator/options_checker.h"
+#include "runtime/core/executor/executor_util.h"
 #include "utils/common/thread_tool.h"
 
 namespace YAML {
@@ -14,9 +19,11 @@ struct convert<nxpilot::runtime::core::executor::TimeWheelExecutor::Options> {
     node["bind_executor"] = rhs.bind_executor;
     node["thread_sched_policy"] = rhs.thread_sched_policy;
     node["thread_bind_cpu"] = rhs.thread_bind_cpu;
+    node["thread_hardening"] = rhs.thread_hardening;
     node["dt_us"] = static_cast<uint64_t>(
         std::chrono::duration_cast<std::chrono::microseconds>(rhs.dt).count());
     node["wheel_size"] = rhs.wheel_size;
+    node["shutdown_flush_timers"] = rhs.shutdown_flush_timers;
 
     return node;
   }
@@ -29,8 +36,13 @@ struct convert<nxpilot::runtime::core::executor::TimeWheelExecutor::Options> {
       rhs.thread_sched_policy = node["thread_sched_policy"].as<std::string>();
     if (node["thread_bind_cpu"])
       rhs.thread_bind_cpu = node["thread_bind_cpu"].as<std::vector<uint32_t>>();
+    if (node["thread_hardening"])
+      rhs.thread_hardening =
+          node["thread_hardening"].as<nxpilot::utils::common::ThreadHardeningOptions>();
     if (node["dt_us"]) rhs.dt = std::chrono::microseconds(node["dt_us"].as<uint64_t>());
     if (node["wheel_size"]) rhs.wheel_size = node["wheel_size"].as<std::vector<size_t>>();
+    if (node["shutdown_flush_timers"])
+      rhs.shutdown_flush_timers = node["shutdown_flush_timers"].as<bool>();
 
     return true;
   }
@@ -43,9 +55,8 @@ void TimeWheelExecutor::Initialize(std::string_view name, YAML::Node options_nod
   NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
                       "TimeWheelExecutor can only be initialized once.");
   name_ = std::string(name);
-  if (options_node && !options_node.IsNull()) {
-    options_ = options_node.as<Options>();
-  }
+
+  options_ = ParseOptions(options_node);
 
   dt_count_ = static_cast<uint64_t>(
       std::chrono::duration_cast<std::chrono::nanoseconds>(options_.dt).count());
@@ -84,6 +95,66 @@ void TimeWheelExecutor::Initialize(std::string_view name, YAML::Node options_nod
   NXPILOT_INFO("TimeWheelExecutor init completed");
 }
 
+TimeWheelExecutor::Options TimeWheelExecutor::ParseOptions(YAML::Node options_node) const {
+  auto err = configurator::CheckOptionsKeys(
+      options_node, {"bind_executor", "thread_sched_policy", "thread_bind_cpu",
+                     "thread_hardening", "dt_us", "wheel_size", "shutdown_flush_timers"});
+  if (err.empty() && options_node && options_node["thread_hardening"]) {
+    err = CheckThreadHardeningOptions(options_node["thread_hardening"]);
+  }
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid options for TimeWheelExecutor '{}', {}", name_, err);
+
+  Options options;
+  if (options_node && !options_node.IsNull()) {
+    options = options_node.as<Options>();
+  }
+
+  err = configurator::CheckThreadOptions(options.thread_sched_policy, options.thread_bind_cpu);
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid options for TimeWheelExecutor '{}', {}", name_, err);
+  NXPILOT_CHECK_ERROR(options.dt.count() > 0,
+                      "Invalid options for TimeWheelExecutor '{}', dt_us is 0", name_);
+  NXPILOT_CHECK_ERROR(
+      !options.wheel_size.empty() &&
+          std::ranges::none_of(options.wheel_size, [](size_t size) { return size < 2; }),
+      "Invalid options for TimeWheelExecutor '{}', wheel_size should be a non-empty list of "
+      "sizes not less than 2",
+      name_);
+
+  return options;
+}
+
+std::string TimeWheelExecutor::UpdateOptions(YAML::Node options_node) {
+  auto cur_state = state_.load();
+  NXPILOT_CHECK_ERROR(cur_state == State::kInit || cur_state == State::kStart,
+                      "TimeWheelExecutor can only update options when state is 'Init' or "
+                      "'Start'.");
+
+  Options new_options = ParseOptions(options_node);
+
+  // The timer thread only reads the thread options when it starts.
+  std::string restart_reason;
+  if (timer_thread_ptr_) {
+    restart_reason = UpdateThreadOptions(
+        timer_thread_ptr_->native_handle(), options_.thread_sched_policy,
+        new_options.thread_sched_policy, options_.thread_bind_cpu, new_options.thread_bind_cpu);
+  }
+  options_.thread_sched_policy = new_options.thread_sched_policy;
+  options_.thread_bind_cpu = new_options.thread_bind_cpu;
+  options_.shutdown_flush_timers = new_options.shutdown_flush_timers;
+
+  if (new_options.dt != options_.dt || new_options.wheel_size != options_.wheel_size ||
+      new_options.bind_executor != options_.bind_executor ||
+      new_options.thread_hardening != options_.thread_hardening) {
+    if (!restart_reason.empty()) restart_reason += ", ";
+    restart_reason +=
+        "'dt_us', 'wheel_size', 'bind_executor' and 'thread_hardening' only take effect after "
+        "restart";
+  }
+
+  NXPILOT_INFO("TimeWheelExecutor '{}' options updated", name_);
+  return restart_reason;
+}
+
 void TimeWheelExecutor::Start() {
   NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
                       "TimeWheelExecutor can only run when state is 'Init'.");
@@ -95,8 +166,13 @@ void TimeWheelExecutor::Start() {
 }
 
 void TimeWheelExecutor::Shutdown() {
+  ShutdownUntil(std::chrono::steady_clock::time_point::max());
+}
+
+ExecutorBase::ShutdownReport TimeWheelExecutor::ShutdownUntil(
+    std::chrono::steady_clock::time_point deadline) {
   if (std::atomic_exchange(&state_, State::kShutdown) == State::kShutdown) {
-    return;
+    return ShutdownReport{};
   }
 
   if (timer_thread_ptr_ && timer_thread_ptr_->joinable()) {
@@ -104,10 +180,55 @@ void TimeWheelExecutor::Shutdown() {
   }
 
   timer_thread_ptr_.reset();
-  timing_task_map_.clear();
-  timing_wheel_vec_.clear();
 
-  NXPILOT_INFO("TimeWheelExecutor shutdown");
+  // 'ExecuteAt' rejects new timers from here on, but may still be running on other threads.
+  std::vector<TaskWithTimestamp> left_task_vec;
+  {
+    std::unique_lock<std::shared_mutex> lck(tick_mutex_);
+    auto collect = [&left_task_vec](TaskList& task_list) {
+      for (auto& task_with_timestamp : task_list) {
+        left_task_vec.emplace_back(std::move(task_with_timestamp));
+      }
+    };
+    for (auto& timing_wheel : timing_wheel_vec_) {
+      for (auto& task_list : timing_wheel.wheel) collect(task_list);
+    }
+    for (auto& itr : timing_task_map_) collect(itr.second);
+
+    timing_task_map_.clear();
+    timing_wheel_vec_.clear();
+  }
+
+  ShutdownReport report;
+  if (options_.shutdown_flush_timers) {
+    std::ranges::stable_sort(left_task_vec, {}, &TaskWithTimestamp::tick_count);
+    for (auto& task_with_timestamp : left_task_vec) {
+      if (std::chrono::steady_clock::now() >= deadline) {
+        report.deadline_exceeded = true;
+        ++report.dropped_task_num;
+        continue;
+      }
+      try {
+        task_with_timestamp.task();
+      } catch (const std::exception& e) {
+        NXPILOT_FATAL("TimeWheelExecutor run task get exception, {}", e.what());
+      }
+      ++report.executed_task_num;
+    }
+  } else {
+    report.dropped_task_num = left_task_vec.size();
+  }
+  left_task_vec.clear();
+
+  // Including the timers the flushed ones re-armed.
+  {
+    std::unique_lock<std::shared_mutex> lck(tick_mutex_);
+    report.dropped_task_num += rejected_task_num_;
+  }
+
+  NXPILOT_INFO("TimeWheelExecutor shutdown, {} pending timers executed, {} dropped",
+               report.executed_task_num, report.dropped_task_num);
+  return report;
 }
 
 void TimeWheelExecutor::Execute(Task&& task) noexcept {
@@ -127,6 +248,13 @@ void TimeWheelExecutor::ExecuteAt(std::chrono::system_clock::time_point tp, Task
 
     std::unique_lock<std::shared_mutex> lck(tick_mutex_);
 
+    // Checked under the lock 'ShutdownUntil' collects the timers with, a timer armed later would
+    // never run.
+    if (state_.load() == State::kShutdown) [[unlikely]] {
+      ++rejected_task_num_;
+      return;
+    }
+
     if (virtual_tp < current_tick_count_ * dt_count_) {
       lck.unlock();
       Execute(std::move(task));
@@ -162,6 +290,7 @@ void TimeWheelExecutor::TimerLoop() {
     nxpilot::utils::common::SetNameForCurrentThread(name_);
     nxpilot::utils::common::BindCpuForCurrentThread(options_.thread_bind_cpu);
     nxpilot::utils::common::SetCpuSchedForCurrentThread(options_.thread_sched_policy);
+    nxpilot::utils::common::ApplyHardeningForCurrentThread(options_.thread_hardening);
   } catch (const std::exception& e) {
     NXPILOT_ERROR("Set thread policy for TimeWheelExecutor get exception, {}", e.what());
   }
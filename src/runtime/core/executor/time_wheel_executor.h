@@ -4,6 +4,8 @@
 
 #include <atomic>
 #include <functional>
+#include <list>
+#include <map>
 #include <shared_mutex>
 #include <thread>
 #include <memory>
@@ -11,6 +13,7 @@
 
 #include "runtime/core/executor/executor_base.h"
 #include "utils/common/log_tool.h"
+#include "utils/common/thread_tool.h"
 #include "yaml-cpp/yaml.h"
 
 namespace nxpilot::runtime::core::executor {
@@ -24,8 +27,12 @@ class TimeWheelExecutor : public ExecutorBase {
     std::string bind_executor;
     std::string thread_sched_policy;
     std::vector<uint32_t> thread_bind_cpu;
+    nxpilot::utils::common::ThreadHardeningOptions thread_hardening;
     std::chrono::nanoseconds dt = std::chrono::microseconds(1000);
     std::vector<size_t> wheel_size = {1000, 600};
+    // Run the timers still pending on shutdown (in due order, until the shutdown deadline)
+    // instead of dropping them.
+    bool shutdown_flush_timers = false;
   };
 
   enum class State : uint32_t {
@@ -43,6 +50,11 @@ class TimeWheelExecutor : public ExecutorBase {
   void Initialize(std::string_view name, YAML::Node options_node) override;
   void Start() override;
   void Shutdown() override;
+  ShutdownReport ShutdownUntil(std::chrono::steady_clock::time_point deadline) override;
+  // Thread placement and 'shutdown_flush_timers' apply live. 'dt_us', 'wheel_size' and
+  // 'bind_executor' shape the wheel and the scheduled timers, they need a restart.
+  std::string UpdateOptions(YAML::Node options_node) override;
+  void CheckOptions(YAML::Node options_node) const override { ParseOptions(options_node); }
 
   State GetState() const { return state_.load(); }
 
@@ -60,6 +72,7 @@ class TimeWheelExecutor : public ExecutorBase {
   size_t CurrentTaskNum() noexcept override { return 1; }
 
  private:
+  Options ParseOptions(YAML::Node options_node) const;
   void TimerLoop();
   struct TaskWithTimestamp {
     uint64_t tick_count;  // 距离start_time的时间tick
@@ -108,6 +121,8 @@ class TimeWheelExecutor : public ExecutorBase {
 
   mutable std::shared_mutex tick_mutex_;
   uint64_t current_tick_count_ = 0;
+  // Timers armed after shutdown began, e.g. re-armed by a flushed one, guarded by 'tick_mutex_'.
+  uint64_t rejected_task_num_ = 0;
 };
 
 }  // namespace nxpilot::runtime::core::executor
\ No newline at end of file
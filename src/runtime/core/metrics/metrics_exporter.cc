@@ -0,0 +1,349 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/metrics/metrics_exporter.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <string_view>
+
+#include "runtime/core/configurator/options_checker.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::metrics::MetricsExporter::Options> {
+  using Options = nxpilot::runtime::core::metrics::MetricsExporter::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["enable"] = rhs.enable;
+    node["listen_path"] = rhs.listen_path;
+    node["listen_port"] = rhs.listen_port;
+    node["executor"] = rhs.executor;
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["enable"]) rhs.enable = node["enable"].as<bool>();
+    if (node["listen_path"]) rhs.listen_path = node["listen_path"].as<std::string>();
+    if (node["listen_port"]) rhs.listen_port = node["listen_port"].as<uint16_t>();
+    if (node["executor"]) rhs.executor = node["executor"].as<std::string>();
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::metrics {
+
+namespace {
+
+// A client has this long to send its request, it gets the bare text afterwards.
+constexpr std::chrono::milliseconds kRequestTimeout(200);
+// And this long to take the rest of a response the executor could not send right away.
+constexpr std::chrono::milliseconds kResponseTimeout(1000);
+constexpr size_t kMaxRequestSize = 8192;
+// Connections accepted beyond this many open ones are closed right away.
+constexpr size_t kMaxConnectionNum = 64;
+
+enum class IoResult { kDone, kPending, kError };
+
+// Read what has arrived of the request, done once it is complete, e.g. the headers for HTTP, so
+// closing does not reset the connection with unread data.
+IoResult ReadRequest(int fd, std::string& request) {
+  char buf[1024];
+  while (request.size() < kMaxRequestSize) {
+    ssize_t ret = recv(fd, buf, sizeof(buf), 0);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return IoResult::kPending;
+    if (ret <= 0) return IoResult::kDone;
+    request.append(buf, static_cast<size_t>(ret));
+
+    const bool http_flag = request.starts_with("GET");
+    if (http_flag ? request.find("\r\n\r\n") != std::string::npos
+                  : request.find('\n') != std::string::npos) {
+      return IoResult::kDone;
+    }
+  }
+  return IoResult::kDone;
+}
+
+// Send as much of the rest of 'data' as the socket takes without blocking.
+IoResult SendSome(int fd, std::string_view data, size_t& sent_size) {
+  while (sent_size < data.size()) {
+    ssize_t ret = send(fd, data.data() + sent_size, data.size() - sent_size, MSG_NOSIGNAL);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return IoResult::kPending;
+    if (ret <= 0) return IoResult::kError;
+    sent_size += static_cast<size_t>(ret);
+  }
+  return IoResult::kDone;
+}
+
+}  // namespace
+
+MetricsExporter::Connection::~Connection() {
+  shutdown(fd, SHUT_WR);
+  close(fd);
+}
+
+void MetricsExporter::Initialize(YAML::Node options_node) {
+  auto err = nxpilot::runtime::core::configurator::CheckOptionsKeys(
+      options_node, {"enable", "listen_path", "listen_port", "executor"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid metrics options, {}", err);
+
+  options_ = Options();
+  if (options_node && !options_node.IsNull()) options_ = options_node.as<Options>();
+}
+
+void MetricsExporter::Start(const Options& options,
+                            nxpilot::runtime::core::executor::ExecutorBase* executor_ptr,
+                            const MetricsRegistry* registry_ptr) {
+  NXPILOT_CHECK_ERROR(!thread_ptr_, "MetricsExporter is already started.");
+  NXPILOT_CHECK_ERROR(executor_ptr != nullptr && registry_ptr != nullptr,
+                      "MetricsExporter needs an executor and a registry.");
+  NXPILOT_CHECK_ERROR(!options.listen_path.empty() || options.listen_port != 0,
+                      "MetricsExporter needs a 'listen_path' or a 'listen_port'.");
+
+  options_ = options;
+  executor_ptr_ = executor_ptr;
+  serve_context_ptr_->logger_ptr = logger_ptr_;
+  serve_context_ptr_->registry_ptr = registry_ptr;
+
+  stop_event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  NXPILOT_CHECK_ERROR(stop_event_fd_ >= 0, "Call 'eventfd' get error, {}", strerror(errno));
+  const int wake_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  NXPILOT_CHECK_ERROR(wake_event_fd >= 0, "Call 'eventfd' get error, {}", strerror(errno));
+  {
+    std::lock_guard<std::mutex> lck(serve_context_ptr_->mutex);
+    serve_context_ptr_->stopped_flag = false;
+    serve_context_ptr_->wake_event_fd = wake_event_fd;
+  }
+
+  if (!options_.listen_path.empty()) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    NXPILOT_CHECK_ERROR(options_.listen_path.size() < sizeof(addr.sun_path),
+                        "Invalid metrics listen path '{}'", options_.listen_path);
+    std::memcpy(addr.sun_path, options_.listen_path.data(), options_.listen_path.size());
+    unlink(options_.listen_path.c_str());
+    uds_fd_ = Listen(AF_UNIX, &addr, sizeof(addr));
+  }
+
+  if (options_.listen_port != 0) {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options_.listen_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    tcp_fd_ = Listen(AF_INET, &addr, sizeof(addr));
+  }
+
+  thread_ptr_ = std::make_unique<std::thread>([this]() { IoLoop(); });
+  NXPILOT_INFO("MetricsExporter start listening on '{}', port {}", options_.listen_path,
+               options_.listen_port);
+}
+
+void MetricsExporter::Stop() {
+  if (thread_ptr_) {
+    uint64_t value = 1;
+    [[maybe_unused]] auto ret = write(stop_event_fd_, &value, sizeof(value));
+    if (thread_ptr_->joinable()) thread_ptr_->join();
+    thread_ptr_.reset();
+  }
+
+  {
+    // Scrapes still queued on the executor send what fits and close, there is no one to hand the
+    // rest to.
+    std::lock_guard<std::mutex> lck(serve_context_ptr_->mutex);
+    serve_context_ptr_->stopped_flag = true;
+    serve_context_ptr_->sending_vec.clear();
+    if (serve_context_ptr_->wake_event_fd >= 0) close(serve_context_ptr_->wake_event_fd);
+    serve_context_ptr_->wake_event_fd = -1;
+  }
+
+  if (uds_fd_ >= 0) {
+    close(uds_fd_);
+    unlink(options_.listen_path.c_str());
+  }
+  if (tcp_fd_ >= 0) close(tcp_fd_);
+  if (stop_event_fd_ >= 0) close(stop_event_fd_);
+  uds_fd_ = -1;
+  tcp_fd_ = -1;
+  stop_event_fd_ = -1;
+}
+
+int MetricsExporter::Listen(int domain, const void* addr, size_t addr_size) {
+  int fd = socket(domain, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  NXPILOT_CHECK_ERROR(fd >= 0, "Call 'socket' get error, {}", strerror(errno));
+
+  if (domain == AF_INET) {
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  }
+
+  if (bind(fd, static_cast<const sockaddr*>(addr), addr_size) != 0 || listen(fd, SOMAXCONN) != 0) {
+    const int err = errno;
+    close(fd);
+    NXPILOT_CHECK_ERROR(false, "MetricsExporter listen on '{}', port {} get error, {}",
+                        options_.listen_path, options_.listen_port, strerror(err));
+  }
+  return fd;
+}
+
+void MetricsExporter::IoLoop() {
+  // Connections reading their request, and connections sending the rest of their response.
+  std::vector<std::shared_ptr<Connection>> reading_vec;
+  std::vector<std::shared_ptr<Connection>> sending_vec;
+  std::vector<pollfd> poll_fd_vec;
+  const int wake_event_fd = serve_context_ptr_->wake_event_fd;
+
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lck(serve_context_ptr_->mutex);
+      for (auto& connection_ptr : serve_context_ptr_->sending_vec) {
+        sending_vec.emplace_back(std::move(connection_ptr));
+      }
+      serve_context_ptr_->sending_vec.clear();
+    }
+
+    // A request cut short by its deadline is still answered, a response is dropped.
+    const auto now = std::chrono::steady_clock::now();
+    std::erase_if(reading_vec, [this, now](const auto& connection_ptr) {
+      if (now < connection_ptr->deadline) return false;
+      Post(connection_ptr);
+      return true;
+    });
+    std::erase_if(sending_vec, [this, now](const auto& connection_ptr) {
+      if (now < connection_ptr->deadline) return false;
+      NXPILOT_WARN("MetricsExporter send timeout, {} of {} bytes sent", connection_ptr->sent_size,
+                   connection_ptr->response.size());
+      return true;
+    });
+
+    auto next_deadline = std::chrono::steady_clock::time_point::max();
+    poll_fd_vec = {{.fd = stop_event_fd_, .events = POLLIN, .revents = 0},
+                   {.fd = wake_event_fd, .events = POLLIN, .revents = 0},
+                   {.fd = uds_fd_, .events = POLLIN, .revents = 0},
+                   {.fd = tcp_fd_, .events = POLLIN, .revents = 0}};
+    for (const auto& connection_ptr : reading_vec) {
+      poll_fd_vec.emplace_back(pollfd{.fd = connection_ptr->fd, .events = POLLIN, .revents = 0});
+      next_deadline = std::min(next_deadline, connection_ptr->deadline);
+    }
+    for (const auto& connection_ptr : sending_vec) {
+      poll_fd_vec.emplace_back(pollfd{.fd = connection_ptr->fd, .events = POLLOUT, .revents = 0});
+      next_deadline = std::min(next_deadline, connection_ptr->deadline);
+    }
+    const int timeout_ms =
+        (next_deadline == std::chrono::steady_clock::time_point::max())
+            ? -1
+            : static_cast<int>(
+                  std::chrono::ceil<std::chrono::milliseconds>(next_deadline - now).count());
+
+    // Negative fds are ignored by 'poll'.
+    int ret = poll(poll_fd_vec.data(), poll_fd_vec.size(), timeout_ms);
+    if (ret < 0 && errno != EINTR) {
+      NXPILOT_ERROR("MetricsExporter poll get error, {}", strerror(errno));
+      return;
+    }
+    if (ret <= 0) continue;
+    if (poll_fd_vec[0].revents & POLLIN) return;
+    if (poll_fd_vec[1].revents & POLLIN) {
+      uint64_t value;
+      [[maybe_unused]] auto read_ret = read(wake_event_fd, &value, sizeof(value));
+    }
+
+    size_t poll_idx = 4;
+    std::erase_if(reading_vec, [&](const auto& connection_ptr) {
+      if (poll_fd_vec[poll_idx++].revents == 0 ||
+          ReadRequest(connection_ptr->fd, connection_ptr->request) == IoResult::kPending) {
+        return false;
+      }
+      Post(connection_ptr);
+      return true;
+    });
+    std::erase_if(sending_vec, [&](const auto& connection_ptr) {
+      if (poll_fd_vec[poll_idx++].revents == 0) return false;
+      return SendSome(connection_ptr->fd, connection_ptr->response, connection_ptr->sent_size) !=
+             IoResult::kPending;
+    });
+
+    for (size_t ii = 2; ii < 4; ++ii) {
+      if (!(poll_fd_vec[ii].revents & POLLIN)) continue;
+
+      int fd;
+      while ((fd = accept4(poll_fd_vec[ii].fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >=
+             0) {
+        if (reading_vec.size() + sending_vec.size() >= kMaxConnectionNum) {
+          NXPILOT_WARN("MetricsExporter has {} open connections, refuse a new one",
+                       kMaxConnectionNum);
+          close(fd);
+          continue;
+        }
+        reading_vec.emplace_back(std::make_shared<Connection>(
+            fd, std::chrono::steady_clock::now() + kRequestTimeout));
+      }
+    }
+  }
+}
+
+void MetricsExporter::Post(std::shared_ptr<Connection> connection_ptr) {
+  // A discarded task closes the connection with its last reference.
+  executor_ptr_->Execute([serve_context_ptr = serve_context_ptr_,
+                          connection_ptr = std::move(connection_ptr)]() mutable {
+    serve_context_ptr->Serve(std::move(connection_ptr));
+  });
+}
+
+void MetricsExporter::ServeContext::Serve(std::shared_ptr<Connection> connection_ptr) {
+  std::string body;
+  try {
+    body = registry_ptr->Render();
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("MetricsExporter render get exception, {}", e.what());
+  }
+  scrape_num.fetch_add(1);
+
+  auto& connection = *connection_ptr;
+  if (connection.request.starts_with("GET")) {
+    connection.response = std::format(
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: {}\r\n"
+        "Connection: close\r\n\r\n",
+        body.size());
+    connection.response += body;
+  } else {
+    connection.response = std::move(body);
+  }
+
+  switch (SendSome(connection.fd, connection.response, connection.sent_size)) {
+    case IoResult::kDone:
+      return;
+    case IoResult::kError:
+      NXPILOT_WARN("MetricsExporter send get error, {}", strerror(errno));
+      return;
+    case IoResult::kPending:
+      break;
+  }
+
+  std::lock_guard<std::mutex> lck(mutex);
+  if (stopped_flag) return;
+  connection.deadline = std::chrono::steady_clock::now() + kResponseTimeout;
+  sending_vec.emplace_back(std::move(connection_ptr));
+  uint64_t value = 1;
+  [[maybe_unused]] auto ret = write(wake_event_fd, &value, sizeof(value));
+}
+
+}  // namespace nxpilot::runtime::core::metrics
@@ -0,0 +1,121 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "runtime/core/executor/executor_base.h"
+#include "runtime/core/metrics/metrics_registry.h"
+#include "utils/common/log_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::metrics {
+
+/**
+ * @brief Serve scrapes of a 'MetricsRegistry' on a unix domain socket and/or a localhost TCP port.
+ *
+ * A thread accepts the connections and reads the requests, the scrapes are rendered on the given
+ * executor, e.g. the guard thread, so the executors running the modules are not disturbed. The
+ * executor only sends what fits in the socket buffer, the thread sends the rest, so a slow or
+ * silent client never blocks the executor. A request starting with 'GET' is answered as
+ * HTTP/1.0, so Prometheus can scrape the TCP port, anything else, e.g.
+ * 'echo | socat - UNIX:<path>', gets the bare text exposition.
+ */
+class MetricsExporter {
+ public:
+  struct Options {
+    bool enable = false;
+    // Unix domain socket path, empty for none.
+    std::string listen_path;
+    // Port on 127.0.0.1, 0 for none.
+    uint16_t listen_port = 0;
+    // The executor rendering the scrapes, empty for the guard thread one.
+    std::string executor;
+  };
+
+  MetricsExporter() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~MetricsExporter() { Stop(); }
+
+  MetricsExporter(const MetricsExporter&) = delete;
+  MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  // Take the 'metrics' options of the config file, throw if they are invalid.
+  void Initialize(YAML::Node options_node);
+  const Options& GetOptions() const { return options_; }
+
+  // 'executor_ptr' must support 'Execute', 'registry_ptr' must outlive its queued tasks.
+  void Start(const Options& options, nxpilot::runtime::core::executor::ExecutorBase* executor_ptr,
+             const MetricsRegistry* registry_ptr = &GetMetricsRegistry());
+  // With the options of 'Initialize'.
+  void Start(nxpilot::runtime::core::executor::ExecutorBase* executor_ptr) {
+    Start(options_, executor_ptr);
+  }
+  void Stop();
+
+  uint64_t GetScrapeNum() const { return serve_context_ptr_->scrape_num.load(); }
+
+ private:
+  // A scrape connection, closed with its last owner, e.g. a scrape task the executor discards on
+  // shutdown.
+  struct Connection {
+    Connection(int fd, std::chrono::steady_clock::time_point deadline)
+        : fd(fd), deadline(deadline) {}
+    ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    int fd;
+    // Of reading the request, then of sending the response.
+    std::chrono::steady_clock::time_point deadline;
+    std::string request;
+    std::string response;
+    size_t sent_size = 0;
+  };
+
+  // Shared with the posted scrapes, which may still be queued on the executor after 'Stop'.
+  struct ServeContext {
+    const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr; }
+    // Render the scrape and send what fits, hand the rest of the response to the IO thread.
+    void Serve(std::shared_ptr<Connection> connection_ptr);
+
+    std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr;
+    const MetricsRegistry* registry_ptr = nullptr;
+    std::atomic_uint64_t scrape_num = 0;
+
+    std::mutex mutex;
+    // Set by 'Stop', the IO thread is gone and 'wake_event_fd' closed then.
+    bool stopped_flag = false;
+    int wake_event_fd = -1;
+    std::vector<std::shared_ptr<Connection>> sending_vec;
+  };
+
+  void IoLoop();
+  void Post(std::shared_ptr<Connection> connection_ptr);
+  int Listen(int domain, const void* addr, size_t addr_size);
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  nxpilot::runtime::core::executor::ExecutorBase* executor_ptr_ = nullptr;
+  std::shared_ptr<ServeContext> serve_context_ptr_ = std::make_shared<ServeContext>();
+
+  int uds_fd_ = -1;
+  int tcp_fd_ = -1;
+  int stop_event_fd_ = -1;
+  std::unique_ptr<std::thread> thread_ptr_;
+};
+
+}  // namespace nxpilot::runtime::core::metrics
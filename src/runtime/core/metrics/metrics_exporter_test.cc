@@ -0,0 +1,203 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/metrics/metrics_exporter.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/executor/executor_manager.h"
+#include "runtime/core/executor/guard_thread_executor.h"
+
+namespace nxpilot::runtime::core::metrics {
+
+namespace {
+
+// Runs nothing, like an executor that discards its queue on shutdown.
+class DiscardExecutor : public executor::ExecutorBase {
+ public:
+  void Initialize(std::string_view name, YAML::Node options_node) override {}
+  void Start() override {}
+  void Shutdown() override {}
+  std::string_view Type() const noexcept override { return "discard"; }
+  std::string_view Name() const noexcept override { return "discard"; }
+  bool ThreadSafe() const noexcept override { return true; }
+  void Execute(Task&& task) noexcept override {}
+  bool SupportTimerSchedule() const noexcept override { return false; }
+  std::chrono::system_clock::time_point Now() const noexcept override { return {}; }
+  void ExecuteAt(std::chrono::system_clock::time_point tp, Task&& task) noexcept override {}
+};
+
+// Send 'request' and read until the server closes.
+std::string Scrape(int fd, const sockaddr* addr, socklen_t addr_size, std::string_view request) {
+  // Fail instead of hanging if the server never closes.
+  constexpr timeval kTimeout{.tv_sec = 5, .tv_usec = 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &kTimeout, sizeof(kTimeout));
+
+  std::string response;
+  if (connect(fd, addr, addr_size) == 0 &&
+      send(fd, request.data(), request.size(), MSG_NOSIGNAL) == ssize_t(request.size())) {
+    char buf[1024];
+    ssize_t ret;
+    while ((ret = recv(fd, buf, sizeof(buf), 0)) > 0) response.append(buf, ret);
+  }
+  close(fd);
+  return response;
+}
+
+std::string ScrapeUds(const std::string& path) {
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.data(), path.size());
+  return Scrape(socket(AF_UNIX, SOCK_STREAM, 0), reinterpret_cast<sockaddr*>(&addr), sizeof(addr),
+                "\n");
+}
+
+std::string GetSocketPath() {
+  return (std::filesystem::temp_directory_path() / std::format("metrics_test_{}.sock", getpid()))
+      .string();
+}
+
+uint16_t GetFreePort() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{.sin_family = AF_INET, .sin_port = 0, .sin_addr = {htonl(INADDR_LOOPBACK)}};
+  socklen_t addr_size = sizeof(addr);
+  bind(fd, reinterpret_cast<sockaddr*>(&addr), addr_size);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addr_size);
+  close(fd);
+  return ntohs(addr.sin_port);
+}
+
+}  // namespace
+
+TEST(MetricsExporterTest, scrape) {
+  executor::GuardThreadExecutor executor;
+  executor.Initialize("metrics_test", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+
+  MetricsRegistry registry;
+  registry.GetCounter("test_scrape_total", "").Inc(7);
+
+  MetricsExporter::Options options;
+  options.enable = true;
+  options.listen_path = GetSocketPath();
+  options.listen_port = GetFreePort();
+
+  MetricsExporter exporter;
+  EXPECT_THROW(exporter.Start(MetricsExporter::Options{}, &executor, &registry), std::exception);
+  exporter.Start(options, &executor, &registry);
+
+  const std::string uds_response = ScrapeUds(options.listen_path);
+  EXPECT_TRUE(uds_response.starts_with("# TYPE test_scrape_total counter\n"));
+  EXPECT_NE(uds_response.find("test_scrape_total 7\n"), std::string::npos);
+
+  sockaddr_in tcp_addr{.sin_family = AF_INET,
+                       .sin_port = htons(options.listen_port),
+                       .sin_addr = {htonl(INADDR_LOOPBACK)}};
+  const std::string http_response = Scrape(
+      socket(AF_INET, SOCK_STREAM, 0), reinterpret_cast<sockaddr*>(&tcp_addr), sizeof(tcp_addr),
+      "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  EXPECT_TRUE(http_response.starts_with("HTTP/1.0 200 OK\r\n"));
+  EXPECT_NE(http_response.find("\r\n\r\n# TYPE test_scrape_total counter\n"), std::string::npos);
+
+  EXPECT_EQ(exporter.GetScrapeNum(), 2);
+  exporter.Stop();
+  EXPECT_FALSE(std::filesystem::exists(options.listen_path));
+  executor.Shutdown();
+}
+
+TEST(MetricsExporterTest, large_response) {
+  executor::GuardThreadExecutor executor;
+  executor.Initialize("metrics_test", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+
+  // Far more than a socket buffer, the rest is sent by the exporter thread.
+  constexpr size_t kSeriesNum = 50000;
+  MetricsRegistry registry;
+  registry.RegisterCollector([](MetricWriter& writer) {
+    for (size_t ii = 0; ii < kSeriesNum; ++ii) {
+      writer.AddGauge("test_large_gauge", "", {{"idx", std::to_string(ii)}}, 1);
+    }
+  });
+
+  MetricsExporter::Options options;
+  options.enable = true;
+  options.listen_path = GetSocketPath();
+  MetricsExporter exporter;
+  exporter.Start(options, &executor, &registry);
+
+  const std::string response = ScrapeUds(options.listen_path);
+  EXPECT_GT(response.size(), kSeriesNum * 20);
+  EXPECT_TRUE(
+      response.ends_with(std::format("test_large_gauge{{idx=\"{}\"}} 1\n", kSeriesNum - 1)));
+
+  exporter.Stop();
+  executor.Shutdown();
+}
+
+TEST(MetricsExporterTest, discarded_scrape_closes_connection) {
+  DiscardExecutor executor;
+  MetricsRegistry registry;
+  MetricsExporter::Options options;
+  options.enable = true;
+  options.listen_path = GetSocketPath();
+  MetricsExporter exporter;
+  exporter.Start(options, &executor, &registry);
+
+  // The connection is closed with the discarded task, the client does not wait for the timeout.
+  const auto begin_time_point = std::chrono::steady_clock::now();
+  EXPECT_EQ(ScrapeUds(options.listen_path), "");
+  EXPECT_LT(std::chrono::steady_clock::now() - begin_time_point, std::chrono::seconds(5));
+  EXPECT_EQ(exporter.GetScrapeNum(), 0);
+
+  exporter.Stop();
+}
+
+TEST(MetricsExporterTest, executor_manager) {
+  executor::ExecutorManager executor_manager;
+  executor_manager.Initialize(YAML::Load(R"(
+executors:
+  - name: metrics_test_timer
+    type: time_wheel
+)"));
+  executor_manager.Start();
+
+  // The executor manager only registers its collectors, the exporter is configured on its own.
+  MetricsExporter exporter;
+  exporter.Initialize(YAML::Load(std::format(R"(
+enable: true
+listen_path: {}
+)",
+                                             GetSocketPath())));
+  exporter.Start(executor_manager.GetExecutor(executor_manager.GetGuardThreadName()));
+
+  const std::string text = ScrapeUds(GetSocketPath());
+  EXPECT_NE(text.find("# TYPE nxpilot_executor_queued_tasks gauge\n"), std::string::npos);
+  EXPECT_NE(text.find("nxpilot_executor_queued_tasks{executor=\"metrics_test_timer\"} "),
+            std::string::npos);
+
+  exporter.Stop();
+  EXPECT_FALSE(std::filesystem::exists(GetSocketPath()));
+  executor_manager.Shutdown();
+  EXPECT_EQ(GetMetricsRegistry().Render().find("nxpilot_executor_queued_tasks"),
+            std::string::npos);
+}
+
+TEST(MetricsExporterTest, invalid_options) {
+  MetricsExporter exporter;
+  EXPECT_THROW(exporter.Initialize(YAML::Load("listen_prot: 9100")), std::exception);
+  EXPECT_NO_THROW(exporter.Initialize(YAML::Node()));
+  EXPECT_FALSE(exporter.GetOptions().enable);
+}
+
+}  // namespace nxpilot::runtime::core::metrics
@@ -0,0 +1,246 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/metrics/metrics_registry.h"
+
+#include <format>
+
+namespace nxpilot::runtime::core::metrics {
+
+namespace {
+
+bool IsValidName(std::string_view name) {
+  if (name.empty()) return false;
+  for (size_t ii = 0; ii < name.size(); ++ii) {
+    const char c = name[ii];
+    const bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' ||
+                       (ii > 0 && c >= '0' && c <= '9');
+    if (!valid) return false;
+  }
+  return true;
+}
+
+void AppendEscaped(std::string& out, std::string_view str, bool escape_quote) {
+  for (const char c : str) {
+    if (c == '\\') {
+      out += "\\\\";
+    } else if (c == '\n') {
+      out += "\\n";
+    } else if (c == '"' && escape_quote) {
+      out += "\\\"";
+    } else {
+      out += c;
+    }
+  }
+}
+
+// '{a="x",b="y"}', or empty without labels. 'extra_label' is appended if not empty, e.g. the
+// quantile of a summary.
+std::string FormatLabels(const MetricLabels& labels, std::string_view extra_label = "") {
+  if (labels.empty() && extra_label.empty()) return {};
+
+  std::string out = "{";
+  for (const auto& [label_name, label_value] : labels) {
+    if (out.size() > 1) out += ',';
+    out += label_name;
+    out += "=\"";
+    AppendEscaped(out, label_value, true);
+    out += '"';
+  }
+  if (!extra_label.empty()) {
+    if (out.size() > 1) out += ',';
+    out += extra_label;
+  }
+  out += '}';
+  return out;
+}
+
+void AppendSample(std::string& out, std::string_view name, std::string_view labels,
+                  double value) {
+  out += std::format("{}{} {}\n", name, labels, value);
+}
+
+}  // namespace
+
+size_t GetMetricShardIdx() noexcept {
+  static std::atomic_size_t next_shard_idx = 0;
+  thread_local const size_t shard_idx = next_shard_idx.fetch_add(1) % kMetricShardNum;
+  return shard_idx;
+}
+
+void MetricWriter::AddCounter(std::string_view name, std::string_view help,
+                              const MetricLabels& labels, double value) {
+  if (auto* family_ptr = GetFamily(name, help, "counter")) {
+    AppendSample(family_ptr->sample_lines, name, FormatLabels(labels), value);
+  }
+}
+
+void MetricWriter::AddGauge(std::string_view name, std::string_view help,
+                            const MetricLabels& labels, double value) {
+  if (auto* family_ptr = GetFamily(name, help, "gauge")) {
+    AppendSample(family_ptr->sample_lines, name, FormatLabels(labels), value);
+  }
+}
+
+void MetricWriter::AddSummary(std::string_view name, std::string_view help,
+                              const MetricLabels& labels,
+                              const nxpilot::utils::common::Histogram& histogram,
+                              double unit_scale) {
+  auto* family_ptr = GetFamily(name, help, "summary");
+  if (family_ptr == nullptr) return;
+
+  auto& out = family_ptr->sample_lines;
+  for (const auto& [quantile, percentile] : {std::pair<std::string_view, double>{"0.5", 50},
+                                             {"0.9", 90},
+                                             {"0.99", 99}}) {
+    AppendSample(out, name, FormatLabels(labels, std::format("quantile=\"{}\"", quantile)),
+                 static_cast<double>(histogram.GetPercentile(percentile)) * unit_scale);
+  }
+  const std::string label_str = FormatLabels(labels);
+  AppendSample(out, std::string(name) + "_sum", label_str,
+               static_cast<double>(histogram.GetSum()) * unit_scale);
+  AppendSample(out, std::string(name) + "_count", label_str,
+               static_cast<double>(histogram.GetCount()));
+}
+
+MetricWriter::Family* MetricWriter::GetFamily(std::string_view name, std::string_view help,
+                                              std::string_view type) {
+  if (!IsValidName(name)) return nullptr;
+
+  auto iter = family_map_.find(name);
+  if (iter == family_map_.end()) {
+    iter = family_map_.emplace(std::string(name), Family{.type = type, .help = std::string(help)})
+               .first;
+    family_name_vec_.emplace_back(name);
+  }
+  return iter->second.type == type ? &(iter->second) : nullptr;
+}
+
+std::string MetricWriter::Finish() const {
+  std::string out;
+  for (const auto& name : family_name_vec_) {
+    const auto& family = family_map_.find(name)->second;
+    if (!family.help.empty()) {
+      out += std::format("# HELP {} ", name);
+      AppendEscaped(out, family.help, false);
+      out += '\n';
+    }
+    out += std::format("# TYPE {} {}\n", name, family.type);
+    out += family.sample_lines;
+  }
+  return out;
+}
+
+Counter& MetricsRegistry::GetCounter(std::string_view name, std::string_view help,
+                                     const MetricLabels& labels) {
+  return *(GetSeries(name, help, labels, MetricType::kCounter, [](Series& series) {
+            series.counter_ptr = std::make_unique<Counter>();
+          }).counter_ptr);
+}
+
+Gauge& MetricsRegistry::GetGauge(std::string_view name, std::string_view help,
+                                 const MetricLabels& labels) {
+  return *(GetSeries(name, help, labels, MetricType::kGauge, [](Series& series) {
+            series.gauge_ptr = std::make_unique<Gauge>();
+          }).gauge_ptr);
+}
+
+HistogramMetric& MetricsRegistry::GetHistogram(std::string_view name, std::string_view help,
+                                               const MetricLabels& labels, double unit_scale) {
+  return *(GetSeries(name, help, labels, MetricType::kHistogram, [unit_scale](Series& series) {
+            series.histogram_ptr = std::make_unique<HistogramMetric>(unit_scale);
+          }).histogram_ptr);
+}
+
+MetricsRegistry::Series& MetricsRegistry::GetSeries(
+    std::string_view name, std::string_view help, const MetricLabels& labels, MetricType type,
+    const std::function<void(Series&)>& init_func) {
+  NXPILOT_CHECK_ERROR(IsValidName(name), "Invalid metric name '{}'", name);
+  for (const auto& [label_name, label_value] : labels) {
+    NXPILOT_CHECK_ERROR(IsValidName(label_name) && label_name.find(':') == std::string::npos,
+                        "Invalid label name '{}' of metric '{}'", label_name, name);
+  }
+  const std::string label_str = FormatLabels(labels);
+
+  std::unique_lock<std::shared_mutex> lck(mutex_);
+  auto family_iter = family_map_.find(name);
+  if (family_iter == family_map_.end()) {
+    auto family_ptr = std::make_unique<Family>();
+    family_ptr->type = type;
+    family_ptr->help = std::string(help);
+    family_iter = family_map_.emplace(std::string(name), std::move(family_ptr)).first;
+    family_name_vec_.emplace_back(name);
+  }
+  auto& family = *(family_iter->second);
+  NXPILOT_CHECK_ERROR(family.type == type, "Metric '{}' is already of another type", name);
+
+  auto& series_ptr = family.series_map[label_str];
+  if (!series_ptr) {
+    series_ptr = std::make_unique<Series>();
+    series_ptr->labels = labels;
+    init_func(*series_ptr);
+  }
+  return *series_ptr;
+}
+
+uint64_t MetricsRegistry::RegisterCollector(CollectFunc&& func) {
+  std::lock_guard<std::mutex> lck(collector_mutex_);
+  const uint64_t id = next_collector_id_++;
+  collector_map_.emplace(id, std::move(func));
+  return id;
+}
+
+void MetricsRegistry::UnregisterCollector(uint64_t id) {
+  std::lock_guard<std::mutex> lck(collector_mutex_);
+  collector_map_.erase(id);
+}
+
+std::string MetricsRegistry::Render() const {
+  MetricWriter writer;
+
+  {
+    std::shared_lock<std::shared_mutex> lck(mutex_);
+    for (const auto& name : family_name_vec_) {
+      const auto& family = *(family_map_.find(name)->second);
+      for (const auto& [label_str, series_ptr] : family.series_map) {
+        switch (family.type) {
+          case MetricType::kCounter:
+            writer.AddCounter(name, family.help, series_ptr->labels,
+                              static_cast<double>(series_ptr->counter_ptr->GetValue()));
+            break;
+          case MetricType::kGauge:
+            writer.AddGauge(name, family.help, series_ptr->labels,
+                            series_ptr->gauge_ptr->GetValue());
+            break;
+          case MetricType::kHistogram: {
+            nxpilot::utils::common::Histogram histogram;
+            series_ptr->histogram_ptr->Snapshot(histogram);
+            writer.AddSummary(name, family.help, series_ptr->labels, histogram,
+                              series_ptr->histogram_ptr->GetUnitScale());
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // Collectors may create metrics, so the registry lock is not held meanwhile.
+  {
+    std::lock_guard<std::mutex> lck(collector_mutex_);
+    for (const auto& [id, func] : collector_map_) {
+      try {
+        func(writer);
+      } catch (const std::exception& e) {
+        NXPILOT_ERROR("Metrics collector {} get exception, {}", id, e.what());
+      }
+    }
+  }
+
+  return writer.Finish();
+}
+
+MetricsRegistry& GetMetricsRegistry() {
+  static MetricsRegistry metrics_registry;
+  return metrics_registry;
+}
+
+}  // namespace nxpilot::runtime::core::metrics
@@ -0,0 +1,207 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "utils/common/histogram_tool.h"
+#include "utils/common/log_tool.h"
+#include "utils/common/string_tool.h"
+
+namespace nxpilot::runtime::core::metrics {
+
+// Label name and value pairs of a series, e.g. {{"executor", "planning"}}.
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+// Hot path updates go to one of the shards, picked per thread, so threads updating the same
+// metric rarely share a cache line. Reads sum the shards.
+inline constexpr size_t kMetricShardNum = 8;
+
+// The shard of the calling thread, threads are spread round robin.
+size_t GetMetricShardIdx() noexcept;
+
+class Counter {
+ public:
+  Counter() = default;
+
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+
+  void Inc(uint64_t value = 1) noexcept {
+    shard_array_[GetMetricShardIdx()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint64_t GetValue() const noexcept {
+    uint64_t value = 0;
+    for (const auto& shard : shard_array_) value += shard.value.load(std::memory_order_relaxed);
+    return value;
+  }
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic_uint64_t value = 0;
+  };
+  std::array<Shard, kMetricShardNum> shard_array_;
+};
+
+class Gauge {
+ public:
+  Gauge() = default;
+
+  Gauge(const Gauge&) = delete;
+  Gauge& operator=(const Gauge&) = delete;
+
+  void Set(double value) noexcept { value_.store(value, std::memory_order_relaxed); }
+  void Add(double delta) noexcept { value_.fetch_add(delta, std::memory_order_relaxed); }
+
+  double GetValue() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<double> value_ = 0;
+};
+
+// Exported as a summary with the p50/p90/p99 of the records, in 'unit_scale' units, e.g. 1e-9 to
+// record ns and export seconds.
+class HistogramMetric {
+ public:
+  explicit HistogramMetric(double unit_scale = 1.0) : unit_scale_(unit_scale) {}
+
+  HistogramMetric(const HistogramMetric&) = delete;
+  HistogramMetric& operator=(const HistogramMetric&) = delete;
+
+  void Record(uint64_t value) noexcept { shard_array_[GetMetricShardIdx()].Record(value); }
+
+  // Merge the shards into 'histogram'.
+  void Snapshot(nxpilot::utils::common::Histogram& histogram) const noexcept {
+    for (const auto& shard : shard_array_) histogram.Merge(shard);
+  }
+
+  double GetUnitScale() const { return unit_scale_; }
+
+ private:
+  const double unit_scale_;
+  std::array<nxpilot::utils::common::Histogram, kMetricShardNum> shard_array_;
+};
+
+/**
+ * @brief Build the Prometheus text exposition of a scrape, see 'MetricsRegistry::Render'.
+ *
+ * Samples are grouped into families by name, a family keeps the type and help of its first
+ * sample, later samples of another type are dropped.
+ */
+class MetricWriter {
+ public:
+  void AddCounter(std::string_view name, std::string_view help, const MetricLabels& labels,
+                  double value);
+  void AddGauge(std::string_view name, std::string_view help, const MetricLabels& labels,
+                double value);
+  void AddSummary(std::string_view name, std::string_view help, const MetricLabels& labels,
+                  const nxpilot::utils::common::Histogram& histogram, double unit_scale);
+
+  std::string Finish() const;
+
+ private:
+  struct Family {
+    std::string_view type;
+    std::string help;
+    std::string sample_lines;
+  };
+
+  Family* GetFamily(std::string_view name, std::string_view help, std::string_view type);
+
+ private:
+  std::vector<std::string> family_name_vec_;
+  std::unordered_map<std::string, Family, nxpilot::utils::common::StringHash, std::equal_to<>>
+      family_map_;
+};
+
+/**
+ * @brief Registry of the metrics of the process, rendered in the Prometheus text format on scrape.
+ *
+ * Metrics are created once, e.g. at init, and updated through the returned references, which stay
+ * valid for the life of the registry. Updates are relaxed atomics on a per thread shard, the cost
+ * of a scrape only depends on the number of series. Values that already live elsewhere, e.g. queue
+ * sizes, are better reported by a collector, called on every scrape.
+ */
+class MetricsRegistry {
+ public:
+  using CollectFunc = std::function<void(MetricWriter&)>;
+
+  MetricsRegistry() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  // Get or create a series. Throw if the name is invalid or taken by another type.
+  Counter& GetCounter(std::string_view name, std::string_view help,
+                      const MetricLabels& labels = {});
+  Gauge& GetGauge(std::string_view name, std::string_view help, const MetricLabels& labels = {});
+  HistogramMetric& GetHistogram(std::string_view name, std::string_view help,
+                                const MetricLabels& labels = {}, double unit_scale = 1.0);
+
+  // 'func' is called on the scraping thread. Return an id to unregister it, which waits for a
+  // running call.
+  uint64_t RegisterCollector(CollectFunc&& func);
+  void UnregisterCollector(uint64_t id);
+
+  // The metrics and the output of the collectors in the Prometheus text format, version 0.0.4.
+  std::string Render() const;
+
+ private:
+  enum class MetricType : uint32_t {
+    kCounter,
+    kGauge,
+    kHistogram,
+  };
+
+  struct Series {
+    MetricLabels labels;
+    std::unique_ptr<Counter> counter_ptr;
+    std::unique_ptr<Gauge> gauge_ptr;
+    std::unique_ptr<HistogramMetric> histogram_ptr;
+  };
+
+  struct Family {
+    MetricType type;
+    std::string help;
+    std::map<std::string, std::unique_ptr<Series>> series_map;
+  };
+
+  Series& GetSeries(std::string_view name, std::string_view help, const MetricLabels& labels,
+                    MetricType type, const std::function<void(Series&)>& init_func);
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+
+  mutable std::shared_mutex mutex_;
+  std::vector<std::string> family_name_vec_;
+  std::unordered_map<std::string, std::unique_ptr<Family>, nxpilot::utils::common::StringHash,
+                     std::equal_to<>>
+      family_map_;
+
+  mutable std::mutex collector_mutex_;
+  uint64_t next_collector_id_ = 1;
+  std::map<uint64_t, CollectFunc> collector_map_;
+};
+
+// The process wide registry, scraped by the metrics exporter.
+MetricsRegistry& GetMetricsRegistry();
+
+}  // namespace nxpilot::runtime::core::metrics
@@ -0,0 +1,80 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/metrics/metrics_registry.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace nxpilot::runtime::core::metrics {
+
+TEST(MetricsRegistryTest, counter_across_threads) {
+  MetricsRegistry registry;
+  auto& counter = registry.GetCounter("test_events_total", "Events.", {{"kind", "a"}});
+  EXPECT_EQ(&counter, &registry.GetCounter("test_events_total", "", {{"kind", "a"}}));
+  EXPECT_NE(&counter, &registry.GetCounter("test_events_total", "", {{"kind", "b"}}));
+
+  std::vector<std::thread> thread_vec;
+  for (size_t ii = 0; ii < 4; ++ii) {
+    thread_vec.emplace_back([&counter]() {
+      for (size_t jj = 0; jj < 10000; ++jj) counter.Inc();
+    });
+  }
+  for (auto& thread : thread_vec) thread.join();
+  EXPECT_EQ(counter.GetValue(), 40000);
+
+  const std::string text = registry.Render();
+  EXPECT_NE(text.find("# HELP test_events_total Events.\n# TYPE test_events_total counter\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_events_total{kind=\"a\"} 40000\n"), std::string::npos);
+  EXPECT_NE(text.find("test_events_total{kind=\"b\"} 0\n"), std::string::npos);
+}
+
+TEST(MetricsRegistryTest, gauge_and_summary) {
+  MetricsRegistry registry;
+  auto& gauge = registry.GetGauge("test_temperature", "");
+  gauge.Set(1.5);
+  gauge.Add(1);
+
+  auto& histogram = registry.GetHistogram("test_latency_seconds", "", {}, 1e-3);
+  for (uint64_t ii = 1; ii <= 1000; ++ii) histogram.Record(ii);
+
+  const std::string text = registry.Render();
+  EXPECT_NE(text.find("# TYPE test_temperature gauge\ntest_temperature 2.5\n"), std::string::npos);
+  EXPECT_NE(text.find("# TYPE test_latency_seconds summary\n"), std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds{quantile=\"0.99\"} "), std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds_sum 500.5\n"), std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds_count 1000\n"), std::string::npos);
+}
+
+TEST(MetricsRegistryTest, collector) {
+  MetricsRegistry registry;
+  const uint64_t id = registry.RegisterCollector([&registry](MetricWriter& writer) {
+    writer.AddGauge("test_queue_size", "Queued tasks.", {{"name", "a\"b\\c\nd"}}, 3);
+    // A collector may create metrics, they show up from the next scrape.
+    registry.GetCounter("test_created_total", "");
+    // Dropped, the family is a gauge.
+    writer.AddCounter("test_queue_size", "", {}, 1);
+  });
+
+  std::string text = registry.Render();
+  EXPECT_NE(text.find("test_queue_size{name=\"a\\\"b\\\\c\\nd\"} 3\n"), std::string::npos);
+  EXPECT_EQ(text.find("test_queue_size 1"), std::string::npos);
+  EXPECT_EQ(text.find("test_created_total"), std::string::npos);
+  EXPECT_NE(registry.Render().find("test_created_total 0\n"), std::string::npos);
+
+  registry.UnregisterCollector(id);
+  EXPECT_EQ(registry.Render().find("test_queue_size"), std::string::npos);
+}
+
+TEST(MetricsRegistryTest, invalid_metrics) {
+  MetricsRegistry registry;
+  registry.GetCounter("test_total", "");
+  EXPECT_THROW(registry.GetGauge("test_total", ""), std::exception);
+  EXPECT_THROW(registry.GetGauge("0test", ""), std::exception);
+  EXPECT_THROW(registry.GetGauge("test-gauge", ""), std::exception);
+  EXPECT_THROW(registry.GetGauge("test_gauge", "", {{"a:b", "c"}}), std::exception);
+}
+
+}  // namespace nxpilot::runtime::core::metrics
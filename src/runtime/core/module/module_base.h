@@ -0,0 +1,32 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <string_view>
+
+#include "runtime/core/module/module_core_ref.h"
+
+namespace nxpilot::runtime::core::module {
+
+/**
+ * @brief Interface of a module hosted by the runtime.
+ *
+ * Independent modules are initialized and started in parallel, so 'Initialize' and 'Start' may
+ * be called on a thread other than the main thread. Failures are reported by throwing.
+ */
+class ModuleBase {
+ public:
+  ModuleBase() = default;
+  virtual ~ModuleBase() = default;
+
+  ModuleBase(const ModuleBase&) = delete;
+  ModuleBase& operator=(const ModuleBase&) = delete;
+
+  virtual std::string_view Name() const noexcept = 0;
+
+  virtual void Initialize(ModuleCoreRef core) = 0;
+  virtual void Start() = 0;
+  virtual void Shutdown() = 0;
+};
+
+}  // namespace nxpilot::runtime::core::module
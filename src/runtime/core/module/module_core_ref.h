@@ -0,0 +1,70 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "runtime/core/channel/channel_manager.h"
+#include "runtime/core/executor/executor_base.h"
+#include "runtime/core/executor/time_source.h"
+#include "runtime/core/parameter/parameter_manager.h"
+#include "runtime/core/rpc/rpc_manager.h"
+#include "utils/common/log_tool.h"
+#include "utils/common/string_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::module {
+
+struct ModuleContext {
+  std::string name;
+  YAML::Node options;
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr;
+  std::unordered_map<std::string, nxpilot::runtime::core::executor::ExecutorBase*,
+                     nxpilot::utils::common::StringHash, std::equal_to<>>
+      executor_map;
+  nxpilot::runtime::core::rpc::RpcManager* rpc_manager_ptr = nullptr;
+  nxpilot::runtime::core::channel::ChannelManager* channel_manager_ptr = nullptr;
+  nxpilot::runtime::core::parameter::ParameterManager* parameter_manager_ptr = nullptr;
+  const nxpilot::runtime::core::executor::TimeSource* time_source_ptr = nullptr;
+};
+
+// Lightweight handle to the runtime resources a module is allowed to use.
+class ModuleCoreRef {
+ public:
+  ModuleCoreRef() = default;
+  explicit ModuleCoreRef(const ModuleContext* ctx_ptr) : ctx_ptr_(ctx_ptr) {}
+
+  std::string_view Name() const { return ctx_ptr_->name; }
+  YAML::Node GetOptions() const { return ctx_ptr_->options; }
+  const nxpilot::utils::common::Logger& GetLogger() const { return *(ctx_ptr_->logger_ptr); }
+
+  // Only executors listed in the 'executors' options of the module can be got.
+  nxpilot::runtime::core::executor::ExecutorBase* GetExecutor(std::string_view name) const {
+    auto iter = ctx_ptr_->executor_map.find(name);
+    return (iter == ctx_ptr_->executor_map.end()) ? nullptr : iter->second;
+  }
+
+  // Read the time from here rather than the system clock, so the module can run on virtual time.
+  const nxpilot::runtime::core::executor::TimeSource& GetTimeSource() const {
+    return *(ctx_ptr_->time_source_ptr);
+  }
+
+  nxpilot::runtime::core::rpc::RpcManager& GetRpcManager() const {
+    return *(ctx_ptr_->rpc_manager_ptr);
+  }
+
+  nxpilot::runtime::core::channel::ChannelManager& GetChannelManager() const {
+    return *(ctx_ptr_->channel_manager_ptr);
+  }
+
+  nxpilot::runtime::core::parameter::ParameterManager& GetParameterManager() const {
+    return *(ctx_ptr_->parameter_manager_ptr);
+  }
+
+ private:
+  const ModuleContext* ctx_ptr_ = nullptr;
+};
+
+}  // namespace nxpilot::runtime::core::module
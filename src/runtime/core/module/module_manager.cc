@@ -0,0 +1,294 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/module/module_manager.h"
+
+#include <algorithm>
+#include <ranges>
+
+#include "runtime/core/configurator/options_checker.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::module::ModuleManager::Options> {
+  using Options = nxpilot::runtime::core::module::ModuleManager::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["modules"] = YAML::Node();
+    for (const auto& module_options : rhs.modules_options) {
+      Node module_node;
+      module_node["name"] = module_options.name;
+      module_node["log_lvl"] = module_options.log_lvl;
+      module_node["executors"] = module_options.executors;
+      module_node["depends_on"] = module_options.depends_on;
+      module_node["options"] = module_options.options;
+      node["modules"].push_back(module_node);
+    }
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["modules"] && node["modules"].IsSequence()) {
+      for (const auto& module_node : node["modules"]) {
+        auto module_options = Options::ModuleOptions{.name = module_node["name"].as<std::string>()};
+
+        if (module_node["log_lvl"])
+          module_options.log_lvl = module_node["log_lvl"].as<std::string>();
+        if (module_node["executors"])
+          module_options.executors = module_node["executors"].as<std::vector<std::string>>();
+        if (module_node["depends_on"])
+          module_options.depends_on = module_node["depends_on"].as<std::vector<std::string>>();
+        if (module_node["options"]) {
+          module_options.options = module_node["options"];
+        } else {
+          module_options.options = YAML::Node(YAML::NodeType::Null);
+        }
+
+        rhs.modules_options.emplace_back(std::move(module_options));
+      }
+    }
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::module {
+
+void ModuleManager::RegisterModule(std::unique_ptr<ModuleBase> module_ptr) {
+  NXPILOT_CHECK_ERROR(state_.load() == State::kPreInit,
+                      "Module can only be registered when state is 'PreInit'.");
+  NXPILOT_CHECK_ERROR(module_ptr != nullptr, "Can not register a null module.");
+
+  std::string name(module_ptr->Name());
+  std::lock_guard<std::mutex> lck(registered_module_map_mutex_);
+  auto emplace_ret = registered_module_map_.emplace(name, std::move(module_ptr));
+  NXPILOT_CHECK_ERROR(emplace_ret.second, "Duplicate module name '{}'", name);
+}
+
+void ModuleManager::Initialize(YAML::Node options_node) {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
+                      "ModuleManager can only be initialized once.");
+
+  auto err = configurator::CheckOptionsKeys(options_node, {"modules"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid module options, {}", err);
+
+  if (options_node && !options_node.IsNull()) {
+    options_ = options_node.as<Options>();
+  }
+
+  const size_t module_num = options_.modules_options.size();
+  std::unordered_map<std::string, size_t, nxpilot::utils::common::StringHash, std::equal_to<>>
+      module_idx_map;
+
+  for (auto& module_options : options_.modules_options) {
+    auto iter = registered_module_map_.find(module_options.name);
+    NXPILOT_CHECK_ERROR(iter != registered_module_map_.end(), "Module '{}' is not registered",
+                        module_options.name);
+    NXPILOT_CHECK_ERROR(
+        module_idx_map.emplace(module_options.name, module_wrapper_vec_.size()).second,
+        "Duplicate module '{}' in options", module_options.name);
+
+    auto wrapper_ptr = std::make_unique<ModuleWrapper>();
+    wrapper_ptr->module_ptr = std::move(iter->second);
+    registered_module_map_.erase(iter);
+
+    auto& ctx = wrapper_ptr->ctx;
+    ctx.name = module_options.name;
+    ctx.options = module_options.options;
+    ctx.rpc_manager_ptr = rpc_manager_ptr_;
+    ctx.channel_manager_ptr = channel_manager_ptr_;
+    ctx.parameter_manager_ptr = parameter_manager_ptr_;
+    ctx.time_source_ptr = time_source_ptr_;
+
+    if (!module_options.log_lvl.empty()) {
+      wrapper_ptr->log_lvl = nxpilot::utils::common::GetLogLevelFromName(module_options.log_lvl);
+    }
+    // Read the level on every log call, so 'UpdateOptions' can change it while running.
+    ctx.logger_ptr = std::make_shared<nxpilot::utils::common::Logger>(*logger_ptr_);
+    ctx.logger_ptr->get_log_level_func = [wrapper = wrapper_ptr.get(), logger_ptr = logger_ptr_]() {
+      auto log_lvl = wrapper->log_lvl.load(std::memory_order_relaxed);
+      return log_lvl == kInheritLogLevel ? logger_ptr->GetLogLevel() : log_lvl;
+    };
+
+    for (const auto& executor_name : module_options.executors) {
+      NXPILOT_CHECK_ERROR(get_executor_func_, "ModuleManager requires a get executor func.");
+      auto* executor_ptr = get_executor_func_(executor_name);
+      NXPILOT_CHECK_ERROR(executor_ptr != nullptr, "Invalid executor '{}' for module '{}'",
+                          executor_name, module_options.name);
+      ctx.executor_map.emplace(executor_name, executor_ptr);
+    }
+
+    module_wrapper_vec_.emplace_back(std::move(wrapper_ptr));
+  }
+
+  for (auto& itr : registered_module_map_) {
+    NXPILOT_WARN("Module '{}' is registered but not configured, it will not be loaded.",
+                 itr.first);
+  }
+  registered_module_map_.clear();
+
+  // Check 'depends_on' up front, shutdown runs in the reverse of this order.
+  try {
+    module_order_ = BuildGraph("check", [](ModuleWrapper&) {})->TopologicalOrder();
+  } catch (const std::exception& e) {
+    NXPILOT_CHECK_ERROR(false, "Invalid module dependencies, {}", e.what());
+  }
+
+  RunByGraph("initialize", [](ModuleWrapper& wrapper) {
+    wrapper.module_ptr->Initialize(ModuleCoreRef(&wrapper.ctx));
+    wrapper.initialized_flag.store(true);
+  });
+
+  NXPILOT_INFO("ModuleManager init completed, {} modules loaded", module_num);
+}
+
+std::vector<std::string> ModuleManager::UpdateOptions(YAML::Node options_node) {
+  Options new_options = ParseUpdateOptions(options_node);
+
+  // Resolve every level first, so an invalid one changes nothing.
+  struct LogLevelUpdate {
+    ModuleWrapper* wrapper_ptr;
+    Options::ModuleOptions* options_ptr;
+    std::string log_lvl_name;
+    uint32_t log_lvl;
+  };
+  std::vector<LogLevelUpdate> log_lvl_update_vec;
+  std::vector<std::string> restart_reason_vec;
+
+  for (const auto& new_module_options : new_options.modules_options) {
+    const auto& name = new_module_options.name;
+    auto old_itr =
+        std::ranges::find(options_.modules_options, name, &Options::ModuleOptions::name);
+    if (old_itr == options_.modules_options.end()) {
+      restart_reason_vec.emplace_back("module '" + name + "' is added");
+      continue;
+    }
+
+    if (old_itr->executors != new_module_options.executors ||
+        old_itr->depends_on != new_module_options.depends_on ||
+        YAML::Dump(old_itr->options) != YAML::Dump(new_module_options.options)) {
+      restart_reason_vec.emplace_back("options of module '" + name + "' are changed");
+    }
+
+    if (old_itr->log_lvl != new_module_options.log_lvl) {
+      auto wrapper_itr = std::ranges::find_if(
+          module_wrapper_vec_, [&name](const auto& ptr) { return ptr->ctx.name == name; });
+      log_lvl_update_vec.emplace_back(LogLevelUpdate{
+          .wrapper_ptr = wrapper_itr->get(),
+          .options_ptr = &(*old_itr),
+          .log_lvl_name = new_module_options.log_lvl,
+          .log_lvl = new_module_options.log_lvl.empty()
+                         ? kInheritLogLevel
+                         : nxpilot::utils::common::GetLogLevelFromName(
+                               new_module_options.log_lvl)});
+    }
+  }
+
+  for (const auto& old_module_options : options_.modules_options) {
+    if (std::ranges::none_of(new_options.modules_options, [&](const auto& new_module_options) {
+          return new_module_options.name == old_module_options.name;
+        })) {
+      restart_reason_vec.emplace_back("module '" + old_module_options.name + "' is removed");
+    }
+  }
+
+  for (auto& update : log_lvl_update_vec) {
+    update.wrapper_ptr->log_lvl = update.log_lvl;
+    update.options_ptr->log_lvl = update.log_lvl_name;
+    NXPILOT_INFO("Log level of module '{}' updated to '{}'", update.wrapper_ptr->ctx.name,
+                 update.log_lvl_name.empty() ? "inherit" : update.log_lvl_name);
+  }
+
+  return restart_reason_vec;
+}
+
+void ModuleManager::CheckOptions(YAML::Node options_node) const {
+  ParseUpdateOptions(options_node);
+}
+
+ModuleManager::Options ModuleManager::ParseUpdateOptions(YAML::Node options_node) const {
+  NXPILOT_CHECK_ERROR(state_.load() == State::kStart,
+                      "Method can only be called when state is 'Start'.");
+
+  auto err = configurator::CheckOptionsKeys(options_node, {"modules"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid module options, {}", err);
+
+  Options new_options;
+  if (options_node && !options_node.IsNull()) {
+    new_options = options_node.as<Options>();
+  }
+  for (const auto& module_options : new_options.modules_options) {
+    if (!module_options.log_lvl.empty()) {
+      nxpilot::utils::common::GetLogLevelFromName(module_options.log_lvl);
+    }
+  }
+  return new_options;
+}
+
+void ModuleManager::Start() {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
+                      "Method can only be called when state is 'Init'.");
+
+  RunByGraph("start", [](ModuleWrapper& wrapper) { wrapper.module_ptr->Start(); });
+
+  NXPILOT_INFO("ModuleManager start completed");
+}
+
+void ModuleManager::Shutdown() {
+  if (std::atomic_exchange(&state_, State::kShutdown) == State::kShutdown) {
+    return;
+  }
+
+  // A failed init leaves the modules after the failed one uninitialized, skip them.
+  for (auto idx : std::views::reverse(module_order_)) {
+    auto& wrapper = *module_wrapper_vec_[idx];
+    if (!wrapper.initialized_flag.load()) continue;
+    try {
+      wrapper.module_ptr->Shutdown();
+    } catch (const std::exception& e) {
+      NXPILOT_ERROR("Module '{}' shutdown get exception, {}", wrapper.ctx.name, e.what());
+    }
+  }
+
+  module_wrapper_vec_.clear();
+  module_order_.clear();
+
+  NXPILOT_INFO("ModuleManager shutdown");
+}
+
+std::unique_ptr<nxpilot::utils::common::DependencyGraph> ModuleManager::BuildGraph(
+    std::string_view stage_name, const std::function<void(ModuleWrapper&)>& func) const {
+  auto graph_ptr = std::make_unique<nxpilot::utils::common::DependencyGraph>();
+  for (size_t ii = 0; ii < module_wrapper_vec_.size(); ++ii) {
+    auto& wrapper = *module_wrapper_vec_[ii];
+    graph_ptr->AddNode(
+        wrapper.ctx.name,
+        [this, &wrapper, &func, stage_name]() {
+          auto begin_time_point = std::chrono::steady_clock::now();
+          try {
+            func(wrapper);
+          } catch (const std::exception& e) {
+            NXPILOT_ERROR("Module '{}' {} get exception, {}", wrapper.ctx.name, stage_name,
+                          e.what());
+            throw;
+          }
+          NXPILOT_INFO("Module '{}' {} completed in {} us", wrapper.ctx.name, stage_name,
+                       std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - begin_time_point)
+                           .count());
+        },
+        options_.modules_options[ii].depends_on);
+  }
+  return graph_ptr;
+}
+
+void ModuleManager::RunByGraph(std::string_view stage_name,
+                               const std::function<void(ModuleWrapper&)>& func) const {
+  // Module callbacks may block on io, so do not bound the parallelism by the cpu number.
+  BuildGraph(stage_name, func)->Run(std::max<size_t>(module_wrapper_vec_.size(), 1));
+}
+
+}  // namespace nxpilot::runtime::core::module
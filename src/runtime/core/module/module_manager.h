@@ -0,0 +1,133 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "runtime/core/module/module_base.h"
+#include "runtime/core/module/module_core_ref.h"
+#include "utils/common/dependency_graph.h"
+#include "utils/common/log_tool.h"
+#include "utils/common/string_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::module {
+
+class ModuleManager {
+ public:
+  ModuleManager() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~ModuleManager() = default;
+
+  ModuleManager(const ModuleManager&) = delete;
+  ModuleManager& operator=(const ModuleManager&) = delete;
+
+  struct Options {
+    struct ModuleOptions {
+      std::string name;
+      std::string log_lvl;
+      std::vector<std::string> executors;
+      std::vector<std::string> depends_on;
+      YAML::Node options;
+    };
+    std::vector<ModuleOptions> modules_options;
+  };
+
+  enum class State : uint32_t {
+    kPreInit,
+    kInit,
+    kStart,
+    kShutdown,
+  };
+
+  using GetExecutorFunc =
+      std::function<nxpilot::runtime::core::executor::ExecutorBase*(std::string_view)>;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  void RegisterGetExecutorFunc(GetExecutorFunc&& get_executor_func) {
+    get_executor_func_ = std::move(get_executor_func);
+  }
+  void SetRpcManager(nxpilot::runtime::core::rpc::RpcManager* rpc_manager_ptr) {
+    rpc_manager_ptr_ = rpc_manager_ptr;
+  }
+  void SetChannelManager(nxpilot::runtime::core::channel::ChannelManager* channel_manager_ptr) {
+    channel_manager_ptr_ = channel_manager_ptr;
+  }
+  void SetParameterManager(
+      nxpilot::runtime::core::parameter::ParameterManager* parameter_manager_ptr) {
+    parameter_manager_ptr_ = parameter_manager_ptr;
+  }
+  void SetTimeSource(const nxpilot::runtime::core::executor::TimeSource* time_source_ptr) {
+    time_source_ptr_ = time_source_ptr;
+  }
+
+  // Modules can only be registered before 'Initialize', only the configured ones will be loaded.
+  // Plugins register modules from their parallel 'Initialize', so this is thread safe.
+  void RegisterModule(std::unique_ptr<ModuleBase> module_ptr);
+
+  void Initialize(YAML::Node options_node);
+  void Start();
+  void Shutdown();
+
+  State GetState() const { return state_.load(); }
+
+  // Apply changed module log levels while running. Return the other changes, they need a restart.
+  std::vector<std::string> UpdateOptions(YAML::Node options_node);
+  // Throw if 'UpdateOptions' would reject 'options_node', without applying anything.
+  void CheckOptions(YAML::Node options_node) const;
+
+ private:
+  // The module logger follows the core log level.
+  static constexpr uint32_t kInheritLogLevel = std::numeric_limits<uint32_t>::max();
+
+  struct ModuleWrapper {
+    std::unique_ptr<ModuleBase> module_ptr;
+    ModuleContext ctx;
+    std::atomic_uint32_t log_lvl = kInheritLogLevel;
+    // Set once 'Initialize' of the module returns, only those are shut down.
+    std::atomic_bool initialized_flag = false;
+  };
+
+  // Parse the options of a reload, throw if a key or a log level is invalid.
+  Options ParseUpdateOptions(YAML::Node options_node) const;
+
+  std::unique_ptr<nxpilot::utils::common::DependencyGraph> BuildGraph(
+      std::string_view stage_name, const std::function<void(ModuleWrapper&)>& func) const;
+
+  // Run 'func' on every module, a module starts as soon as all modules it depends on are done.
+  void RunByGraph(std::string_view stage_name,
+                  const std::function<void(ModuleWrapper&)>& func) const;
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  std::atomic<State> state_ = State::kPreInit;
+
+  GetExecutorFunc get_executor_func_;
+  nxpilot::runtime::core::rpc::RpcManager* rpc_manager_ptr_ = nullptr;
+  nxpilot::runtime::core::channel::ChannelManager* channel_manager_ptr_ = nullptr;
+  nxpilot::runtime::core::parameter::ParameterManager* parameter_manager_ptr_ = nullptr;
+  const nxpilot::runtime::core::executor::TimeSource* time_source_ptr_ =
+      &nxpilot::runtime::core::executor::GetSystemTimeSource();
+
+  std::mutex registered_module_map_mutex_;
+  std::unordered_map<std::string, std::unique_ptr<ModuleBase>, nxpilot::utils::common::StringHash,
+                     std::equal_to<>>
+      registered_module_map_;
+
+  // Modules in config order, and a dependency order as indexes into it.
+  std::vector<std::unique_ptr<ModuleWrapper>> module_wrapper_vec_;
+  std::vector<size_t> module_order_;
+};
+
+}  // namespace nxpilot::runtime::core::module
@@ -0,0 +1,155 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "runtime/core/executor/guard_thread_executor.h"
+#include "runtime/core/module/module_manager.h"
+
+namespace nxpilot::runtime::core::module {
+
+class TestModule : public ModuleBase {
+ public:
+  TestModule(std::string name, std::vector<std::string>& record_vec, std::mutex& record_mutex)
+      : name_(std::move(name)), record_vec_(record_vec), record_mutex_(record_mutex) {}
+
+  std::string_view Name() const noexcept override { return name_; }
+
+  void Initialize(ModuleCoreRef core) override {
+    core_ = core;
+    if (fail_init_flag) throw std::runtime_error("init failed");
+    Record("init");
+  }
+  void Start() override { Record("start"); }
+  void Shutdown() override { Record("shutdown"); }
+
+  ModuleCoreRef core_;
+  bool fail_init_flag = false;
+
+ private:
+  void Record(std::string_view stage) {
+    std::lock_guard<std::mutex> lck(record_mutex_);
+    record_vec_.emplace_back(std::string(stage) + ":" + name_);
+  }
+
+  std::string name_;
+  std::vector<std::string>& record_vec_;
+  std::mutex& record_mutex_;
+};
+
+class ModuleManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    guard_executor_.Initialize("module_test_guard", YAML::Node(YAML::NodeType::Null));
+    module_manager_.RegisterGetExecutorFunc(
+        [this](std::string_view name) -> executor::ExecutorBase* {
+          return (name == guard_executor_.Name()) ? &guard_executor_ : nullptr;
+        });
+  }
+
+  void TearDown() override {
+    module_manager_.Shutdown();
+    guard_executor_.Shutdown();
+  }
+
+  TestModule* AddModule(std::string name) {
+    auto module_ptr = std::make_unique<TestModule>(std::move(name), record_vec_, record_mutex_);
+    auto* ptr = module_ptr.get();
+    module_manager_.RegisterModule(std::move(module_ptr));
+    return ptr;
+  }
+
+  size_t IndexOf(std::string_view record) {
+    auto iter = std::find(record_vec_.begin(), record_vec_.end(), record);
+    EXPECT_NE(iter, record_vec_.end()) << record;
+    return iter - record_vec_.begin();
+  }
+
+  executor::GuardThreadExecutor guard_executor_;
+  ModuleManager module_manager_;
+  std::mutex record_mutex_;
+  std::vector<std::string> record_vec_;
+};
+
+TEST_F(ModuleManagerTest, dependency_order) {
+  auto* sensor = AddModule("sensor");
+  AddModule("perception");
+  AddModule("map");
+  AddModule("planning");
+  AddModule("unused");
+
+  module_manager_.Initialize(YAML::Load(R"str(
+    modules:
+      - name: sensor
+        executors: [module_test_guard]
+        options:
+          rate_hz: 10
+      - name: perception
+        depends_on: [sensor]
+      - name: map
+      - name: planning
+        depends_on: [perception, map]
+  )str"));
+  module_manager_.Start();
+
+  EXPECT_EQ(sensor->core_.Name(), "sensor");
+  EXPECT_EQ(sensor->core_.GetOptions()["rate_hz"].as<int>(), 10);
+  EXPECT_EQ(sensor->core_.GetExecutor("module_test_guard"), &guard_executor_);
+  EXPECT_EQ(sensor->core_.GetExecutor("not_bound"), nullptr);
+
+  module_manager_.Shutdown();
+
+  EXPECT_EQ(record_vec_.size(), 12);
+  EXPECT_LT(IndexOf("init:sensor"), IndexOf("init:perception"));
+  EXPECT_LT(IndexOf("init:perception"), IndexOf("init:planning"));
+  EXPECT_LT(IndexOf("init:map"), IndexOf("init:planning"));
+  EXPECT_LT(IndexOf("init:planning"), IndexOf("start:sensor"));
+  EXPECT_LT(IndexOf("start:perception"), IndexOf("start:planning"));
+  EXPECT_LT(IndexOf("shutdown:planning"), IndexOf("shutdown:sensor"));
+}
+
+TEST_F(ModuleManagerTest, shutdown_only_initialized) {
+  AddModule("sensor");
+  AddModule("perception")->fail_init_flag = true;
+  AddModule("planning");
+  AddModule("map");
+
+  EXPECT_ANY_THROW(module_manager_.Initialize(YAML::Load(R"str(
+    modules:
+      - name: sensor
+      - name: perception
+        depends_on: [sensor]
+      - name: planning
+        depends_on: [perception]
+      - name: map
+  )str")));
+  module_manager_.Shutdown();
+
+  // 'map' may or may not have run before the failure stopped the graph.
+  for (std::string_view name : {"sensor", "perception", "planning", "map"}) {
+    const bool init_flag = std::ranges::count(record_vec_, "init:" + std::string(name)) > 0;
+    EXPECT_EQ(std::ranges::count(record_vec_, "shutdown:" + std::string(name)), init_flag ? 1 : 0)
+        << name;
+  }
+  EXPECT_EQ(std::ranges::count(record_vec_, "init:sensor"), 1);
+  EXPECT_EQ(std::ranges::count(record_vec_, "init:planning"), 0);
+}
+
+TEST_F(ModuleManagerTest, invalid_options) {
+  AddModule("a");
+  AddModule("b");
+
+  EXPECT_ANY_THROW(module_manager_.Initialize(YAML::Load(R"str(
+    modules:
+      - name: a
+        depends_on: [b]
+      - name: b
+        depends_on: [a]
+  )str")));
+}
+
+}  // namespace nxpilot::runtime::core::module
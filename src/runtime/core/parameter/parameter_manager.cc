@@ -0,0 +1,147 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/parameter/parameter_manager.h"
+#include "runtime/core/configurator/options_checker.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::parameter::ParameterManager::Options> {
+  using Options = nxpilot::runtime::core::parameter::ParameterManager::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["values"] = rhs.values;
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["values"]) rhs.values = node["values"];
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::parameter {
+
+void ParameterReadDomain::Retire(std::shared_ptr<const void> value) {
+  // Destroyed after the lock is released, a snapshot may be large.
+  std::vector<std::shared_ptr<const void>> free_vec;
+  {
+    std::lock_guard<std::mutex> lck(mutex_);
+    if (value) retired_deque_.emplace_back(RetiredValue{.value = std::move(value)});
+
+    for (uint32_t phase = 0; phase < 2; ++phase) {
+      if (!NoReader(phase)) continue;
+      for (auto& retired_value : retired_deque_) retired_value.left_phase_mask &= ~(1u << phase);
+    }
+    while (!retired_deque_.empty() && retired_deque_.front().left_phase_mask == 0) {
+      free_vec.emplace_back(std::move(retired_deque_.front().value));
+      retired_deque_.pop_front();
+    }
+
+    phase_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+size_t ParameterReadDomain::GetRetiredNum() const {
+  std::lock_guard<std::mutex> lck(mutex_);
+  return retired_deque_.size();
+}
+
+size_t ParameterReadDomain::GetShardIdx() noexcept {
+  static std::atomic_size_t next_shard_idx = 0;
+  thread_local const size_t shard_idx = next_shard_idx.fetch_add(1) % kShardNum;
+  return shard_idx;
+}
+
+bool ParameterReadDomain::NoReader(uint32_t phase) const noexcept {
+  for (const auto& shard : shard_array_) {
+    if (shard.reader_num_array[phase].load(std::memory_order_seq_cst) != 0) return false;
+  }
+  return true;
+}
+
+void ParameterManager::Initialize(YAML::Node options_node) {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
+                      "ParameterManager can only be initialized once.");
+
+  auto err = configurator::CheckOptionsKeys(options_node, {"values"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid parameter options, {}", err);
+
+  if (options_node && !options_node.IsNull()) {
+    options_ = options_node.as<Options>();
+  }
+
+  if (options_.values && options_.values.IsMap()) {
+    for (const auto& itr : options_.values) {
+      auto* slot_ptr = GetSlot(itr.first.as<std::string>());
+      std::lock_guard<std::mutex> lck(slot_ptr->mutex);
+      slot_ptr->init_node = itr.second;
+    }
+  }
+
+  NXPILOT_INFO("ParameterManager init completed");
+}
+
+void ParameterManager::Start() {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
+                      "Method can only be called when state is 'Init'.");
+  NXPILOT_INFO("ParameterManager start completed");
+}
+
+void ParameterManager::Shutdown() {
+  if (std::atomic_exchange(&state_, State::kShutdown) == State::kShutdown) {
+    return;
+  }
+
+  std::unique_lock<std::shared_mutex> lck(slot_map_mutex_);
+  for (auto& itr : slot_map_) {
+    std::lock_guard<std::mutex> slot_lck(itr.second->mutex);
+    itr.second->subscriber_vec.clear();
+  }
+
+  NXPILOT_INFO("ParameterManager shutdown");
+}
+
+ParameterSlot* ParameterManager::GetSlot(std::string_view name) {
+  {
+    std::shared_lock<std::shared_mutex> lck(slot_map_mutex_);
+    auto iter = slot_map_.find(name);
+    if (iter != slot_map_.end()) return iter->second.get();
+  }
+
+  std::unique_lock<std::shared_mutex> lck(slot_map_mutex_);
+  auto iter = slot_map_.find(name);
+  if (iter != slot_map_.end()) return iter->second.get();
+
+  auto slot_ptr = std::make_unique<ParameterSlot>();
+  slot_ptr->name = std::string(name);
+  return slot_map_.emplace(std::string(name), std::move(slot_ptr)).first->second.get();
+}
+
+void ParameterManager::Publish(ParameterSlot* slot_ptr, std::shared_ptr<const void> value) {
+  std::vector<ParameterSlot::Subscriber> subscriber_vec;
+  std::shared_ptr<const void> retired_value;
+  {
+    std::lock_guard<std::mutex> lck(slot_ptr->mutex);
+
+    retired_value = std::move(slot_ptr->current);
+    slot_ptr->current = value;
+    slot_ptr->value_ptr.store(value.get(), std::memory_order_seq_cst);
+    slot_ptr->version.fetch_add(1, std::memory_order_acq_rel);
+
+    if (state_.load() == State::kStart) subscriber_vec = slot_ptr->subscriber_vec;
+  }
+
+  read_domain_.Retire(std::move(retired_value));
+
+  for (auto& subscriber : subscriber_vec) {
+    subscriber.executor_ptr->Execute(
+        [callback{std::move(subscriber.callback)}, value]() { callback(value); });
+  }
+}
+
+}  // namespace nxpilot::runtime::core::parameter
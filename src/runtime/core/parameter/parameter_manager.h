@@ -0,0 +1,286 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "runtime/core/executor/executor_base.h"
+#include "utils/common/log_tool.h"
+#include "utils/common/string_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::parameter {
+
+struct ParameterSlot {
+  using Callback = std::function<void(const std::shared_ptr<const void>&)>;
+
+  struct Subscriber {
+    nxpilot::runtime::core::executor::ExecutorBase* executor_ptr;
+    Callback callback;
+  };
+
+  std::string name;
+  std::type_index type = typeid(void);
+
+  // Readers only touch these two atomics.
+  std::atomic<const void*> value_ptr = nullptr;
+  std::atomic_uint64_t version = 0;
+
+  // Guarded by 'mutex'.
+  std::mutex mutex;
+  std::shared_ptr<const void> current;
+  std::vector<Subscriber> subscriber_vec;
+  YAML::Node init_node;
+};
+
+/**
+ * @brief Tracks the readers of parameter snapshots, so replaced snapshots are freed only when no
+ * reader can still see them.
+ *
+ * A reader increments one of two counters of its thread's shard before loading the snapshot
+ * pointer and decrements it when done. A snapshot retired after that load had to wait for the
+ * counter: it is freed once both counters of every shard have been seen at zero after its
+ * retirement. Every 'Retire' flips the counter new readers use, so the other one drains.
+ */
+class ParameterReadDomain {
+ public:
+  ParameterReadDomain() = default;
+  ~ParameterReadDomain() = default;
+
+  ParameterReadDomain(const ParameterReadDomain&) = delete;
+  ParameterReadDomain& operator=(const ParameterReadDomain&) = delete;
+
+  // Return the counter to pass to 'Unlock'.
+  std::atomic_uint64_t* Lock() noexcept {
+    const uint32_t phase = phase_.load(std::memory_order_relaxed) & 1;
+    auto* reader_num_ptr = &(shard_array_[GetShardIdx()].reader_num_array[phase]);
+    // Sequentially consistent with the pointer load that follows and the checks of 'Retire'.
+    reader_num_ptr->fetch_add(1, std::memory_order_seq_cst);
+    return reader_num_ptr;
+  }
+
+  static void Unlock(std::atomic_uint64_t* reader_num_ptr) noexcept {
+    reader_num_ptr->fetch_sub(1, std::memory_order_release);
+  }
+
+  // Keep 'value' until no reader can see it, and free the earlier retired snapshots that no
+  // reader can see anymore. Must be called after the snapshot pointer has been replaced.
+  void Retire(std::shared_ptr<const void> value);
+
+  size_t GetRetiredNum() const;
+
+ private:
+  static constexpr size_t kShardNum = 16;
+
+  struct alignas(64) Shard {
+    std::array<std::atomic_uint64_t, 2> reader_num_array = {0, 0};
+  };
+
+  struct RetiredValue {
+    std::shared_ptr<const void> value;
+    // Bit 'ii' is cleared once the counters of phase 'ii' have been seen at zero.
+    uint32_t left_phase_mask = 0b11;
+  };
+
+  static size_t GetShardIdx() noexcept;
+  bool NoReader(uint32_t phase) const noexcept;
+
+  std::array<Shard, kShardNum> shard_array_;
+  std::atomic_uint32_t phase_ = 0;
+
+  mutable std::mutex mutex_;
+  std::deque<RetiredValue> retired_deque_;
+};
+
+/**
+ * @brief Read guard of a parameter snapshot, the snapshot is not freed while the guard lives.
+ *
+ * Meant to be short-lived, e.g. for the scope of one task. Use 'ParameterManager::GetShared' to
+ * keep a snapshot for longer.
+ */
+template <typename T>
+class ParameterReadGuard {
+ public:
+  ParameterReadGuard(std::atomic_uint64_t* reader_num_ptr, const T* value_ptr) noexcept
+      : reader_num_ptr_(reader_num_ptr), value_ptr_(value_ptr) {}
+  ~ParameterReadGuard() {
+    if (reader_num_ptr_) ParameterReadDomain::Unlock(reader_num_ptr_);
+  }
+
+  ParameterReadGuard(const ParameterReadGuard&) = delete;
+  ParameterReadGuard& operator=(const ParameterReadGuard&) = delete;
+  ParameterReadGuard(ParameterReadGuard&& other) noexcept
+      : reader_num_ptr_(std::exchange(other.reader_num_ptr_, nullptr)),
+        value_ptr_(other.value_ptr_) {}
+  ParameterReadGuard& operator=(ParameterReadGuard&&) = delete;
+
+  const T& Get() const noexcept { return *value_ptr_; }
+  const T& operator*() const noexcept { return *value_ptr_; }
+  const T* operator->() const noexcept { return value_ptr_; }
+
+ private:
+  std::atomic_uint64_t* reader_num_ptr_;
+  const T* value_ptr_;
+};
+
+/**
+ * @brief Wait-free read handle of a typed parameter.
+ *
+ * 'Get' returns a guard of the latest published snapshot, the read itself is one atomic
+ * increment and one pointer load.
+ */
+template <typename T>
+class ParameterHandle {
+ public:
+  ParameterHandle() = default;
+  ParameterHandle(ParameterSlot* slot_ptr, ParameterReadDomain* domain_ptr)
+      : slot_ptr_(slot_ptr), domain_ptr_(domain_ptr) {}
+
+  ParameterReadGuard<T> Get() const noexcept {
+    auto* reader_num_ptr = domain_ptr_->Lock();
+    return ParameterReadGuard<T>(
+        reader_num_ptr,
+        static_cast<const T*>(slot_ptr_->value_ptr.load(std::memory_order_seq_cst)));
+  }
+
+  uint64_t Version() const noexcept { return slot_ptr_->version.load(std::memory_order_acquire); }
+
+  std::string_view Name() const noexcept { return slot_ptr_->name; }
+
+ private:
+  ParameterSlot* slot_ptr_ = nullptr;
+  ParameterReadDomain* domain_ptr_ = nullptr;
+};
+
+class ParameterManager {
+ public:
+  ParameterManager() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~ParameterManager() = default;
+
+  ParameterManager(const ParameterManager&) = delete;
+  ParameterManager& operator=(const ParameterManager&) = delete;
+
+  struct Options {
+    YAML::Node values;
+  };
+
+  enum class State : uint32_t {
+    kPreInit,
+    kInit,
+    kStart,
+    kShutdown,
+  };
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  void Initialize(YAML::Node options_node);
+  void Start();
+  void Shutdown();
+
+  State GetState() const { return state_.load(); }
+
+  // The first typed access fixes the type of a parameter, its initial value comes from the
+  // 'values' options if present, otherwise it is value-initialized.
+  template <typename T>
+  ParameterHandle<T> GetHandle(std::string_view name) {
+    return ParameterHandle<T>(GetTypedSlot<T>(name), &read_domain_);
+  }
+
+  // Snapshots replaced but possibly still read, e.g. for tests and diagnostics.
+  size_t GetRetiredNum() const { return read_domain_.GetRetiredNum(); }
+
+  template <typename T>
+  std::shared_ptr<const T> GetShared(std::string_view name) {
+    auto* slot_ptr = GetTypedSlot<T>(name);
+    std::lock_guard<std::mutex> lck(slot_ptr->mutex);
+    return std::static_pointer_cast<const T>(slot_ptr->current);
+  }
+
+  template <typename T>
+  void Set(std::string_view name, T value) {
+    Publish(GetTypedSlot<T>(name), std::make_shared<const T>(std::move(value)));
+  }
+
+  // Callback is executed on 'executor_ptr' with the new snapshot after every 'Set'.
+  template <typename T>
+  void Subscribe(std::string_view name,
+                 nxpilot::runtime::core::executor::ExecutorBase* executor_ptr,
+                 std::function<void(const std::shared_ptr<const T>&)>&& callback) {
+    NXPILOT_CHECK_ERROR(executor_ptr != nullptr && executor_ptr->ThreadSafe(),
+                        "Invalid executor for parameter '{}' subscriber", name);
+    auto* slot_ptr = GetTypedSlot<T>(name);
+    std::lock_guard<std::mutex> lck(slot_ptr->mutex);
+    slot_ptr->subscriber_vec.emplace_back(ParameterSlot::Subscriber{
+        .executor_ptr = executor_ptr,
+        .callback = [callback{std::move(callback)}](const std::shared_ptr<const void>& value) {
+          callback(std::static_pointer_cast<const T>(value));
+        }});
+  }
+
+ private:
+  ParameterSlot* GetSlot(std::string_view name);
+  void Publish(ParameterSlot* slot_ptr, std::shared_ptr<const void> value);
+
+  template <typename T>
+  ParameterSlot* GetTypedSlot(std::string_view name) {
+    auto* slot_ptr = GetSlot(name);
+
+    // Fast path, the type has been fixed already.
+    if (slot_ptr->value_ptr.load(std::memory_order_acquire) != nullptr) {
+      NXPILOT_CHECK_ERROR(slot_ptr->type == typeid(T), "Parameter '{}' type mismatch", name);
+      return slot_ptr;
+    }
+
+    std::shared_ptr<const T> init_value;
+    {
+      std::lock_guard<std::mutex> lck(slot_ptr->mutex);
+      if (slot_ptr->current) {
+        NXPILOT_CHECK_ERROR(slot_ptr->type == typeid(T), "Parameter '{}' type mismatch", name);
+        return slot_ptr;
+      }
+
+      if constexpr (requires(const YAML::Node& node, T& value) {
+                      YAML::convert<T>::decode(node, value);
+                    }) {
+        if (slot_ptr->init_node && !slot_ptr->init_node.IsNull()) {
+          init_value = std::make_shared<const T>(slot_ptr->init_node.as<T>());
+        }
+      }
+      if (!init_value) init_value = std::make_shared<const T>();
+
+      slot_ptr->type = typeid(T);
+      slot_ptr->current = init_value;
+      slot_ptr->value_ptr.store(init_value.get(), std::memory_order_release);
+    }
+
+    return slot_ptr;
+  }
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  std::atomic<State> state_ = State::kPreInit;
+
+  ParameterReadDomain read_domain_;
+
+  std::shared_mutex slot_map_mutex_;
+  std::unordered_map<std::string, std::unique_ptr<ParameterSlot>,
+                     nxpilot::utils::common::StringHash, std::equal_to<>>
+      slot_map_;
+};
+
+}  // namespace nxpilot::runtime::core::parameter
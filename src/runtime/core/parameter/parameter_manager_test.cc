@@ -0,0 +1,111 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "gtest/gtest.h"
+
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "runtime/core/executor/guard_thread_executor.h"
+#include "runtime/core/parameter/parameter_manager.h"
+
+namespace nxpilot::runtime::core::parameter {
+
+class ParameterManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    guard_executor_.Initialize("param_test_guard", YAML::Node(YAML::NodeType::Null));
+    guard_executor_.Start();
+
+    YAML::Node options = YAML::Load(R"str(
+      values:
+        max_speed: 12.5
+        planner_name: lattice
+    )str");
+    parameter_manager_.Initialize(options);
+    parameter_manager_.Start();
+  }
+
+  void TearDown() override {
+    parameter_manager_.Shutdown();
+    guard_executor_.Shutdown();
+  }
+
+  executor::GuardThreadExecutor guard_executor_;
+  ParameterManager parameter_manager_;
+};
+
+TEST_F(ParameterManagerTest, initial_values) {
+  auto max_speed = parameter_manager_.GetHandle<double>("max_speed");
+  EXPECT_DOUBLE_EQ(*max_speed.Get(), 12.5);
+  EXPECT_EQ(max_speed.Version(), 0);
+
+  auto planner_name = parameter_manager_.GetHandle<std::string>("planner_name");
+  EXPECT_EQ(*planner_name.Get(), "lattice");
+
+  auto not_configured = parameter_manager_.GetHandle<int64_t>("not_configured");
+  EXPECT_EQ(*not_configured.Get(), 0);
+
+  EXPECT_ANY_THROW(parameter_manager_.GetHandle<int64_t>("max_speed"));
+}
+
+TEST_F(ParameterManagerTest, set_and_subscribe) {
+  auto max_speed = parameter_manager_.GetHandle<double>("max_speed");
+
+  std::promise<double> promise;
+  parameter_manager_.Subscribe<double>(
+      "max_speed", &guard_executor_,
+      [&promise](const std::shared_ptr<const double>& value) { promise.set_value(*value); });
+
+  parameter_manager_.Set<double>("max_speed", 20.0);
+  EXPECT_DOUBLE_EQ(*max_speed.Get(), 20.0);
+  EXPECT_EQ(max_speed.Version(), 1);
+  EXPECT_DOUBLE_EQ(promise.get_future().get(), 20.0);
+  EXPECT_DOUBLE_EQ(*parameter_manager_.GetShared<double>("max_speed"), 20.0);
+}
+
+TEST_F(ParameterManagerTest, concurrent_read_write) {
+  auto handle = parameter_manager_.GetHandle<std::string>("planner_name");
+
+  // Long enough values to be heap allocated, a freed snapshot shows up under sanitizers.
+  std::atomic_bool stop_flag = false;
+  std::vector<std::thread> reader_vec;
+  for (int ii = 0; ii < 2; ++ii) {
+    reader_vec.emplace_back([&]() {
+      while (!stop_flag.load()) {
+        auto value = handle.Get();
+        EXPECT_TRUE(value->starts_with("lattice") || value->starts_with("planner_"));
+      }
+    });
+  }
+
+  for (int ii = 0; ii < 1000; ++ii) {
+    parameter_manager_.Set<std::string>("planner_name",
+                                        "planner_with_a_long_name_" + std::to_string(ii));
+  }
+  stop_flag.store(true);
+  for (auto& reader : reader_vec) reader.join();
+
+  EXPECT_EQ(*handle.Get(), "planner_with_a_long_name_999");
+  EXPECT_EQ(handle.Version(), 1000);
+}
+
+TEST_F(ParameterManagerTest, retire_while_read) {
+  auto handle = parameter_manager_.GetHandle<std::string>("planner_name");
+
+  {
+    // The guarded snapshot survives any number of updates.
+    auto value = handle.Get();
+    parameter_manager_.Set<std::string>("planner_name", "first");
+    parameter_manager_.Set<std::string>("planner_name", "second");
+    EXPECT_EQ(*value, "lattice");
+    EXPECT_EQ(*handle.Get(), "second");
+    EXPECT_GE(parameter_manager_.GetRetiredNum(), 1);
+  }
+
+  // Without readers the next update frees all retired snapshots.
+  parameter_manager_.Set<std::string>("planner_name", "third");
+  EXPECT_EQ(parameter_manager_.GetRetiredNum(), 0);
+}
+
+}  // namespace nxpilot::runtime::core::parameter
@@ -0,0 +1,67 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core {
+class AdosCore;
+}  // namespace nxpilot::runtime::core
+
+namespace nxpilot::runtime::core::plugin {
+
+// Bump when 'PluginBase' or the entry points below change in an incompatible way.
+constexpr uint32_t kPluginAbiVersion = 1;
+
+/**
+ * @brief Interface of a plugin loaded from a shared object.
+ *
+ * Plugins are initialized in parallel right after the configurator, before any other manager is
+ * initialized, so this is the place to register executor types or modules into the core.
+ * 'Initialize' may be called on a thread other than the main thread.
+ *
+ * The shared object is never unmapped, so functions a plugin leaves in process wide structures
+ * stay callable. The plugin object itself is destroyed after 'Shutdown' though, which has to undo
+ * every registration that refers to it, e.g. a metrics collector capturing 'this'.
+ */
+class PluginBase {
+ public:
+  PluginBase() = default;
+  virtual ~PluginBase() = default;
+
+  PluginBase(const PluginBase&) = delete;
+  PluginBase& operator=(const PluginBase&) = delete;
+
+  virtual std::string_view Name() const noexcept = 0;
+
+  virtual bool Initialize(nxpilot::runtime::core::AdosCore* core_ptr,
+                          YAML::Node options_node) noexcept = 0;
+  virtual void Shutdown() noexcept = 0;
+};
+
+}  // namespace nxpilot::runtime::core::plugin
+
+// C entry points every plugin shared object has to export, see 'NXPILOT_PLUGIN_MAIN'.
+extern "C" {
+using NxpilotPluginGetAbiVersionFunc = uint32_t (*)();
+using NxpilotPluginCreateFunc = nxpilot::runtime::core::plugin::PluginBase* (*)();
+using NxpilotPluginDestroyFunc = void (*)(const nxpilot::runtime::core::plugin::PluginBase*);
+}
+
+#define NXPILOT_PLUGIN_MAIN(__plugin_type__)                                                 \
+  extern "C" {                                                                              \
+  __attribute__((visibility("default"))) uint32_t NxpilotPluginGetAbiVersion() {            \
+    return nxpilot::runtime::core::plugin::kPluginAbiVersion;                               \
+  }                                                                                         \
+  __attribute__((visibility("default"))) nxpilot::runtime::core::plugin::PluginBase*        \
+  NxpilotPluginCreate() {                                                                   \
+    return new __plugin_type__();                                                           \
+  }                                                                                         \
+  __attribute__((visibility("default"))) void NxpilotPluginDestroy(                         \
+      const nxpilot::runtime::core::plugin::PluginBase* plugin_ptr) {                       \
+    delete plugin_ptr;                                                                      \
+  }                                                                                         \
+  }
@@ -0,0 +1,198 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/plugin/plugin_manager.h"
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <ranges>
+
+#include "runtime/core/configurator/options_checker.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::plugin::PluginManager::Options> {
+  using Options = nxpilot::runtime::core::plugin::PluginManager::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["plugin_dir"] = rhs.plugin_dir;
+    node["plugins"] = YAML::Node();
+    for (const auto& plugin_options : rhs.plugins_options) {
+      Node plugin_node;
+      plugin_node["name"] = plugin_options.name;
+      plugin_node["path"] = plugin_options.path;
+      plugin_node["options"] = plugin_options.options;
+      node["plugins"].push_back(plugin_node);
+    }
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["plugin_dir"]) rhs.plugin_dir = node["plugin_dir"].as<std::string>();
+
+    if (node["plugins"] && node["plugins"].IsSequence()) {
+      for (const auto& plugin_node : node["plugins"]) {
+        auto plugin_options = Options::PluginOptions{.name = plugin_node["name"].as<std::string>()};
+
+        if (plugin_node["path"]) plugin_options.path = plugin_node["path"].as<std::string>();
+        if (plugin_node["options"]) {
+          plugin_options.options = plugin_node["options"];
+        } else {
+          plugin_options.options = YAML::Node(YAML::NodeType::Null);
+        }
+
+        rhs.plugins_options.emplace_back(std::move(plugin_options));
+      }
+    }
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::plugin {
+
+PluginManager::~PluginManager() {
+  try {
+    Shutdown();
+    UnloadPlugins();
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("PluginManager destruct get exception, {}", e.what());
+  }
+}
+
+void PluginManager::Initialize(YAML::Node options_node) {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
+                      "PluginManager can only be initialized once.");
+
+  auto err = configurator::CheckOptionsKeys(options_node, {"plugin_dir", "plugins"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid plugin options, {}", err);
+
+  if (options_node && !options_node.IsNull()) {
+    options_ = options_node.as<Options>();
+  }
+
+  for (const auto& plugin_options : options_.plugins_options) {
+    NXPILOT_CHECK_ERROR(
+        std::ranges::none_of(plugin_wrapper_vec_,
+                             [&](const auto& ptr) { return ptr->name == plugin_options.name; }),
+        "Duplicate plugin '{}'", plugin_options.name);
+
+    // Default path is '<plugin_dir>/lib<name>.so', relative paths are based on 'plugin_dir'.
+    std::filesystem::path path =
+        plugin_options.path.empty() ? ("lib" + plugin_options.name + ".so") : plugin_options.path;
+    if (path.is_relative() && !options_.plugin_dir.empty()) {
+      path = std::filesystem::path(options_.plugin_dir) / path;
+    }
+
+    auto wrapper_ptr = std::make_unique<PluginWrapper>();
+    wrapper_ptr->name = plugin_options.name;
+    wrapper_ptr->path = path.string();
+    wrapper_ptr->options = plugin_options.options;
+    plugin_wrapper_vec_.emplace_back(std::move(wrapper_ptr));
+  }
+
+  // Plugins do not depend on each other, open and initialize them all in parallel. The first one
+  // runs on the calling thread.
+  std::vector<std::future<void>> future_vec;
+  for (size_t ii = 1; ii < plugin_wrapper_vec_.size(); ++ii) {
+    future_vec.emplace_back(std::async(std::launch::async, &PluginManager::LoadPlugin, this,
+                                       std::ref(*plugin_wrapper_vec_[ii])));
+  }
+
+  std::exception_ptr exception_ptr;
+  try {
+    if (!plugin_wrapper_vec_.empty()) LoadPlugin(*plugin_wrapper_vec_[0]);
+  } catch (...) {
+    exception_ptr = std::current_exception();
+  }
+
+  for (auto& future : future_vec) {
+    try {
+      future.get();
+    } catch (...) {
+      if (!exception_ptr) exception_ptr = std::current_exception();
+    }
+  }
+
+  if (exception_ptr) std::rethrow_exception(exception_ptr);
+
+  NXPILOT_INFO("PluginManager init completed, {} plugins loaded", plugin_wrapper_vec_.size());
+}
+
+void PluginManager::Start() {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
+                      "Method can only be called when state is 'Init'.");
+
+  NXPILOT_INFO("PluginManager start completed");
+}
+
+void PluginManager::Shutdown() {
+  if (std::atomic_exchange(&state_, State::kShutdown) == State::kShutdown) {
+    return;
+  }
+
+  for (auto& wrapper_ptr : std::views::reverse(plugin_wrapper_vec_)) {
+    if (wrapper_ptr->initialized) wrapper_ptr->plugin_ptr->Shutdown();
+  }
+
+  NXPILOT_INFO("PluginManager shutdown");
+}
+
+void PluginManager::LoadPlugin(PluginWrapper& wrapper) const {
+  auto begin_time_point = std::chrono::steady_clock::now();
+
+  // Symbols are resolved lazily, so a plugin only pays for what it actually calls. The code stays
+  // mapped after 'dlclose', process wide structures, e.g. the metrics registry, may still hold
+  // functions of the plugin when the manager is destroyed.
+  wrapper.dl_handle = dlopen(wrapper.path.c_str(), RTLD_LAZY | RTLD_LOCAL | RTLD_NODELETE);
+  NXPILOT_CHECK_ERROR(wrapper.dl_handle != nullptr, "Can not open plugin '{}' from '{}', {}",
+                      wrapper.name, wrapper.path, dlerror());
+
+  auto get_abi_version_func = reinterpret_cast<NxpilotPluginGetAbiVersionFunc>(
+      dlsym(wrapper.dl_handle, "NxpilotPluginGetAbiVersion"));
+  auto create_func =
+      reinterpret_cast<NxpilotPluginCreateFunc>(dlsym(wrapper.dl_handle, "NxpilotPluginCreate"));
+  auto destroy_func =
+      reinterpret_cast<NxpilotPluginDestroyFunc>(dlsym(wrapper.dl_handle, "NxpilotPluginDestroy"));
+  NXPILOT_CHECK_ERROR(get_abi_version_func && create_func && destroy_func,
+                      "Plugin '{}' does not export the nxpilot plugin entry points", wrapper.name);
+
+  auto abi_version = get_abi_version_func();
+  NXPILOT_CHECK_ERROR(abi_version == kPluginAbiVersion,
+                      "Plugin '{}' is built with abi version {}, but {} is required", wrapper.name,
+                      abi_version, kPluginAbiVersion);
+
+  wrapper.destroy_func = destroy_func;
+  wrapper.plugin_ptr = create_func();
+  NXPILOT_CHECK_ERROR(wrapper.plugin_ptr != nullptr, "Plugin '{}' create a null handle",
+                      wrapper.name);
+  NXPILOT_CHECK_ERROR(wrapper.plugin_ptr->Name() == wrapper.name,
+                      "Plugin name mismatch, '{}' in options but '{}' in shared object",
+                      wrapper.name, wrapper.plugin_ptr->Name());
+
+  NXPILOT_CHECK_ERROR(wrapper.plugin_ptr->Initialize(core_ptr_, wrapper.options),
+                      "Plugin '{}' initialize failed", wrapper.name);
+  wrapper.initialized = true;
+
+  NXPILOT_INFO("Plugin '{}' loaded from '{}' in {} us", wrapper.name, wrapper.path,
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - begin_time_point)
+                   .count());
+}
+
+void PluginManager::UnloadPlugins() {
+  for (auto& wrapper_ptr : std::views::reverse(plugin_wrapper_vec_)) {
+    if (wrapper_ptr->plugin_ptr != nullptr) wrapper_ptr->destroy_func(wrapper_ptr->plugin_ptr);
+    if (wrapper_ptr->dl_handle != nullptr) dlclose(wrapper_ptr->dl_handle);
+  }
+  plugin_wrapper_vec_.clear();
+}
+
+}  // namespace nxpilot::runtime::core::plugin
@@ -0,0 +1,83 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "runtime/core/plugin/plugin_base.h"
+#include "utils/common/log_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::plugin {
+
+class PluginManager {
+ public:
+  PluginManager() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~PluginManager();
+
+  PluginManager(const PluginManager&) = delete;
+  PluginManager& operator=(const PluginManager&) = delete;
+
+  struct Options {
+    struct PluginOptions {
+      std::string name;
+      std::string path;
+      YAML::Node options;
+    };
+    std::string plugin_dir;
+    std::vector<PluginOptions> plugins_options;
+  };
+
+  enum class State : uint32_t {
+    kPreInit,
+    kInit,
+    kStart,
+    kShutdown,
+  };
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  void SetCorePtr(nxpilot::runtime::core::AdosCore* core_ptr) { core_ptr_ = core_ptr; }
+
+  // Only the plugins listed in options are opened, nothing else in 'plugin_dir' is touched.
+  void Initialize(YAML::Node options_node);
+  void Start();
+  void Shutdown();
+
+  State GetState() const { return state_.load(); }
+
+ private:
+  struct PluginWrapper {
+    std::string name;
+    std::string path;
+    YAML::Node options;
+    void* dl_handle = nullptr;
+    NxpilotPluginDestroyFunc destroy_func = nullptr;
+    PluginBase* plugin_ptr = nullptr;
+    bool initialized = false;
+  };
+
+  void LoadPlugin(PluginWrapper& wrapper) const;
+
+  // Objects created by plugins (executors, modules, ...) may outlive 'Shutdown', so the shared
+  // objects are only closed when the manager is destroyed. They are opened with RTLD_NODELETE, so
+  // closing never unmaps code still referenced from outside the core members.
+  void UnloadPlugins();
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  std::atomic<State> state_ = State::kPreInit;
+
+  nxpilot::runtime::core::AdosCore* core_ptr_ = nullptr;
+
+  std::vector<std::unique_ptr<PluginWrapper>> plugin_wrapper_vec_;
+};
+
+}  // namespace nxpilot::runtime::core::plugin
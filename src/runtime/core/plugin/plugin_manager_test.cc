@@ -0,0 +1,96 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/ados_core.h"
+#include "runtime/core/plugin/plugin_manager.h"
+
+namespace nxpilot::runtime::core::plugin {
+
+TEST(PluginManagerTest, no_plugin) {
+  PluginManager plugin_manager;
+  plugin_manager.Initialize(YAML::Load(R"str(
+    plugin_dir: /not/exist/dir
+  )str"));
+  plugin_manager.Start();
+  plugin_manager.Shutdown();
+  EXPECT_EQ(plugin_manager.GetState(), PluginManager::State::kShutdown);
+}
+
+TEST(PluginManagerTest, missing_shared_object) {
+  PluginManager plugin_manager;
+  EXPECT_ANY_THROW(plugin_manager.Initialize(YAML::Load(R"str(
+    plugin_dir: /not/exist/dir
+    plugins:
+      - name: foo
+  )str")));
+}
+
+TEST(PluginManagerTest, missing_entry_points) {
+  PluginManager plugin_manager;
+  EXPECT_ANY_THROW(plugin_manager.Initialize(YAML::Load(R"str(
+    plugins:
+      - name: m
+        path: libm.so.6
+  )str")));
+}
+
+TEST(PluginManagerTest, duplicate_plugin) {
+  PluginManager plugin_manager;
+  EXPECT_ANY_THROW(plugin_manager.Initialize(YAML::Load(R"str(
+    plugins:
+      - name: foo
+      - name: foo
+  )str")));
+}
+
+// The test plugin is built from 'test_plugin/test_plugin.cc', its path is set by the build.
+TEST(PluginManagerTest, load_plugin) {
+  const auto cfg_file_path =
+      std::filesystem::temp_directory_path() / std::format("plugin_manager_test_{}.yaml", getpid());
+  std::ofstream(cfg_file_path) << std::format(R"str(
+nxpilot:
+  plugin:
+    plugins:
+      - name: test_plugin
+        path: {}
+        options:
+          register_module: true
+  executor:
+    executors:
+      - name: plugin_executor
+        type: test_plugin_inline
+  module:
+    modules:
+      - name: test_plugin_module
+)str",
+                                              NXPILOT_TEST_PLUGIN_PATH);
+
+  {
+    AdosCore core;
+    core.RegisterHookFunc(AdosCore::State::kPostStart, [&core]() { core.Shutdown(); });
+    core.Initialize(AdosCore::Options{.cfg_file_path = cfg_file_path.string()});
+
+    // The executor type and the module both come from the plugin.
+    auto* executor_ptr = core.GetExecutorManager().GetExecutor("plugin_executor");
+    ASSERT_NE(executor_ptr, nullptr);
+    EXPECT_EQ(executor_ptr->Type(), "test_plugin_inline");
+    EXPECT_EQ(*core.GetParameterManager().GetShared<std::string>("test_plugin_module_stage"),
+              "init");
+
+    core.Start();
+    EXPECT_EQ(*core.GetParameterManager().GetShared<std::string>("test_plugin_module_stage"),
+              "start");
+  }
+
+  std::filesystem::remove(cfg_file_path);
+}
+
+}  // namespace nxpilot::runtime::core::plugin
@@ -0,0 +1,81 @@
+// Copyright (C) 2024. All rights reserved.
+
+// Plugin loaded by 'plugin_manager_test', built as a separate shared object. It only uses
+// symbols of the core exported by the host executable.
+
+#include <memory>
+#include <string>
+
+#include "runtime/core/ados_core.h"
+#include "runtime/core/plugin/plugin_base.h"
+
+namespace nxpilot::runtime::core::plugin {
+
+namespace {
+
+// Runs the tasks right away on the posting thread.
+class TestPluginExecutor : public nxpilot::runtime::core::executor::ExecutorBase {
+ public:
+  void Initialize(std::string_view name, YAML::Node options_node) override { name_ = name; }
+  void Start() override {}
+  void Shutdown() override {}
+  std::string_view Type() const noexcept override { return "test_plugin_inline"; }
+  std::string_view Name() const noexcept override { return name_; }
+  bool ThreadSafe() const noexcept override { return true; }
+  void Execute(Task&& task) noexcept override { task(); }
+  bool SupportTimerSchedule() const noexcept override { return false; }
+  std::chrono::system_clock::time_point Now() const noexcept override {
+    return std::chrono::system_clock::now();
+  }
+  void ExecuteAt(std::chrono::system_clock::time_point tp, Task&& task) noexcept override {}
+
+ private:
+  std::string name_;
+};
+
+// Publishes its lifecycle as the parameter 'test_plugin_module_stage'.
+class TestPluginModule : public nxpilot::runtime::core::module::ModuleBase {
+ public:
+  std::string_view Name() const noexcept override { return "test_plugin_module"; }
+
+  void Initialize(nxpilot::runtime::core::module::ModuleCoreRef core) override {
+    core_ = core;
+    core_.GetParameterManager().Set<std::string>("test_plugin_module_stage", "init");
+  }
+  void Start() override {
+    core_.GetParameterManager().Set<std::string>("test_plugin_module_stage", "start");
+  }
+  void Shutdown() override {}
+
+ private:
+  nxpilot::runtime::core::module::ModuleCoreRef core_;
+};
+
+class TestPlugin : public PluginBase {
+ public:
+  std::string_view Name() const noexcept override { return "test_plugin"; }
+
+  bool Initialize(nxpilot::runtime::core::AdosCore* core_ptr,
+                  YAML::Node options_node) noexcept override {
+    if (core_ptr == nullptr) return false;
+
+    try {
+      core_ptr->GetExecutorManager().RegisterExecutorGenFunc(
+          "test_plugin_inline", []() { return std::make_unique<TestPluginExecutor>(); });
+      if (options_node["register_module"] && options_node["register_module"].as<bool>()) {
+        core_ptr->RegisterModule(std::make_unique<TestPluginModule>());
+      }
+    } catch (const std::exception&) {
+      return false;
+    }
+    return true;
+  }
+
+  void Shutdown() noexcept override {}
+};
+
+}  // namespace
+
+}  // namespace nxpilot::runtime::core::plugin
+
+NXPILOT_PLUGIN_MAIN(nxpilot::runtime::core::plugin::TestPlugin)
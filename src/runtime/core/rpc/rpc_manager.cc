@@ -0,0 +1,328 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/rpc/rpc_manager.h"
+#include "runtime/core/configurator/options_checker.h"
+#include "runtime/core/trace/latency_trace.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::rpc::RpcManager::Options> {
+  using Options = nxpilot::runtime::core::rpc::RpcManager::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["timeout_executor"] = rhs.timeout_executor;
+    node["default_timeout_ms"] = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(rhs.default_timeout).count());
+    node["serve_executor"] = rhs.serve_executor;
+    if (rhs.uds_options) node["uds"] = rhs.uds_options;
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["timeout_executor"])
+      rhs.timeout_executor = node["timeout_executor"].as<std::string>();
+    if (node["default_timeout_ms"])
+      rhs.default_timeout = std::chrono::milliseconds(node["default_timeout_ms"].as<uint64_t>());
+    if (node["serve_executor"]) rhs.serve_executor = node["serve_executor"].as<std::string>();
+    if (node["uds"]) rhs.uds_options = node["uds"];
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::rpc {
+
+// Shared by the done callback of the handler and the timeout timer. It holds no req/rsp, those are
+// only kept by the handler side, so a timer waiting for its deadline keeps nothing large alive.
+struct RpcManager::InvokeContext {
+  std::atomic_bool done_flag = false;
+  std::string service_name;
+  RpcDoneCallback callback;
+  nxpilot::runtime::core::executor::ExecutorBase* callback_executor_ptr = nullptr;
+  // The latency trace the done callback runs with, released once it is delivered.
+  std::shared_ptr<const nxpilot::runtime::core::trace::LatencyTraceContext> trace_ptr;
+};
+
+void RpcManager::Initialize(YAML::Node options_node) {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
+                      "RpcManager can only be initialized once.");
+
+  auto err = configurator::CheckOptionsKeys(
+      options_node, {"timeout_executor", "default_timeout_ms", "serve_executor", "uds"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid rpc options, {}", err);
+
+  if (options_node && !options_node.IsNull()) {
+    options_ = options_node.as<Options>();
+  }
+
+  if (!options_.timeout_executor.empty()) {
+    NXPILOT_CHECK_ERROR(get_executor_func_, "RpcManager requires a get executor func.");
+    timeout_executor_ptr_ = get_executor_func_(options_.timeout_executor);
+    NXPILOT_CHECK_ERROR(timeout_executor_ptr_ != nullptr, "Invalid timeout executor '{}'",
+                        options_.timeout_executor);
+    NXPILOT_CHECK_ERROR(timeout_executor_ptr_->SupportTimerSchedule(),
+                        "Timeout executor '{}' does not support timer schedule",
+                        options_.timeout_executor);
+  }
+
+  if (!timeout_executor_ptr_ && options_.default_timeout.count() > 0) {
+    NXPILOT_WARN(
+        "RpcManager has no 'timeout_executor', 'default_timeout_ms' is only enforced for remote "
+        "services.");
+  }
+
+  if (!options_.serve_executor.empty()) {
+    NXPILOT_CHECK_ERROR(get_executor_func_, "RpcManager requires a get executor func.");
+    serve_executor_ptr_ = get_executor_func_(options_.serve_executor);
+    NXPILOT_CHECK_ERROR(serve_executor_ptr_ != nullptr && serve_executor_ptr_->ThreadSafe(),
+                        "Invalid serve executor '{}'", options_.serve_executor);
+  }
+
+  if (options_.uds_options && !options_.uds_options.IsNull()) {
+    uds_backend_ptr_ = std::make_unique<UdsRpcBackend>();
+    uds_backend_ptr_->SetLogger(logger_ptr_);
+    uds_backend_ptr_->RegisterServeFunc(
+        [this](std::string_view service_name, std::string_view req_payload,
+               UdsRpcBackend::ResponseCallback&& response_callback) {
+          ServeRemote(service_name, req_payload, std::move(response_callback));
+        });
+    uds_backend_ptr_->Initialize(options_.uds_options);
+  }
+
+  NXPILOT_INFO("RpcManager init completed");
+}
+
+void RpcManager::Start() {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
+                      "Method can only be called when state is 'Init'.");
+
+  if (uds_backend_ptr_) uds_backend_ptr_->Start();
+
+  NXPILOT_INFO("RpcManager start completed, {} services registered", service_map_.size());
+}
+
+void RpcManager::Shutdown() {
+  if (std::atomic_exchange(&state_, State::kShutdown) == State::kShutdown) {
+    return;
+  }
+
+  if (uds_backend_ptr_) uds_backend_ptr_->Shutdown();
+
+  timeout_executor_ptr_ = nullptr;
+  serve_executor_ptr_ = nullptr;
+  NXPILOT_INFO("RpcManager shutdown");
+}
+
+void RpcManager::RegisterServiceImpl(std::string_view service_name, ServiceInfo&& service_info,
+                                     ServiceFunc&& service_func) {
+  auto state = state_.load();
+  NXPILOT_CHECK_ERROR(state == State::kPreInit || state == State::kInit,
+                      "Service can only be registered before 'Start'.");
+
+  service_info.service_func = std::move(service_func);
+  service_info.trace_stage = "rpc:" + std::string(service_name);
+  auto emplace_ret = service_map_.emplace(std::string(service_name), std::move(service_info));
+  NXPILOT_CHECK_ERROR(emplace_ret.second, "Duplicate service name '{}'", service_name);
+}
+
+void RpcManager::InvokeImpl(std::string_view service_name, const ServiceInfo& invoke_info,
+                            std::shared_ptr<const void> req, std::shared_ptr<void> rsp,
+                            RpcDoneCallback&& callback, const InvokeOptions& options) noexcept {
+  auto ctx_ptr = std::make_shared<InvokeContext>();
+  ctx_ptr->service_name = std::string(service_name);
+  ctx_ptr->callback = std::move(callback);
+  ctx_ptr->callback_executor_ptr = options.callback_executor;
+
+  if (state_.load() != State::kStart) [[unlikely]] {
+    NXPILOT_ERROR("Rpc '{}' can only be invoked when state is 'Start'.", service_name);
+    Finish(ctx_ptr, RpcStatus(RpcStatusCode::kNotStarted));
+    return;
+  }
+
+  auto timeout = (options.timeout.count() == 0) ? options_.default_timeout : options.timeout;
+
+  // Remote handlers do not get the trace, it is not part of the uds protocol.
+  const auto* trace_ctx_ptr = nxpilot::runtime::core::trace::ScopedLatencyTrace::Current();
+  if (trace_ctx_ptr) {
+    ctx_ptr->trace_ptr =
+        std::make_shared<const nxpilot::runtime::core::trace::LatencyTraceContext>(*trace_ctx_ptr);
+  }
+
+  auto iter = service_map_.find(service_name);
+  if (iter == service_map_.end()) {
+    if (uds_backend_ptr_ && uds_backend_ptr_->HasRemoteService(service_name)) {
+      InvokeRemote(ctx_ptr, invoke_info, req, std::move(rsp), timeout);
+      return;
+    }
+
+    Finish(ctx_ptr, RpcStatus(RpcStatusCode::kServiceNotFound));
+    return;
+  }
+
+  const auto& service_info = iter->second;
+  if (service_info.req_type != invoke_info.req_type ||
+      service_info.rsp_type != invoke_info.rsp_type) [[unlikely]] {
+    NXPILOT_ERROR("Rpc '{}' invoked with mismatched req/rsp type.", service_name);
+    Finish(ctx_ptr, RpcStatus(RpcStatusCode::kTypeMismatch));
+    return;
+  }
+
+  if (trace_ctx_ptr) {
+    ctx_ptr->trace_ptr = std::make_shared<const nxpilot::runtime::core::trace::LatencyTraceContext>(
+        nxpilot::runtime::core::trace::ForkLatencyTrace(service_info.trace_stage.c_str()));
+  }
+  // The timer may deliver and release the context trace before the handler returns.
+  const auto trace_ptr = ctx_ptr->trace_ptr;
+
+  if (timeout.count() > 0) {
+    if (timeout_executor_ptr_) {
+      // The timer owns the context too, so a handler dropping 'done' still times out.
+      timeout_executor_ptr_->ExecuteAt(
+          timeout_executor_ptr_->Now() +
+              std::chrono::duration_cast<std::chrono::system_clock::duration>(timeout),
+          [this, ctx_ptr]() { Finish(ctx_ptr, RpcStatus(RpcStatusCode::kTimeout)); });
+    } else if (!timeout_warned_flag_.exchange(true, std::memory_order_relaxed)) [[unlikely]] {
+      NXPILOT_WARN("Rpc '{}' has a timeout but no 'timeout_executor' is set, not enforced.",
+                   service_name);
+    }
+  }
+
+  // In-process fast path, the handler is called directly without any serialization. The done
+  // callback keeps 'req' and 'rsp' alive until the handler calls or drops it.
+  nxpilot::runtime::core::trace::ScopedLatencyTrace scoped_trace(trace_ptr.get());
+  try {
+    service_info.service_func(req, rsp, [this, ctx_ptr, req, rsp](RpcStatus status) {
+      Finish(ctx_ptr, status);
+    });
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("Rpc '{}' handler get exception, {}", service_name, e.what());
+    Finish(ctx_ptr, RpcStatus(RpcStatusCode::kHandlerException));
+  }
+}
+
+void RpcManager::InvokeRemote(const std::shared_ptr<InvokeContext>& ctx_ptr,
+                              const ServiceInfo& invoke_info,
+                              const std::shared_ptr<const void>& req, std::shared_ptr<void> rsp,
+                              std::chrono::nanoseconds timeout) noexcept {
+  if (!invoke_info.req_type_support || !invoke_info.rsp_type_support) [[unlikely]] {
+    NXPILOT_ERROR("Rpc '{}' is remote but req/rsp type is not serializable.",
+                  ctx_ptr->service_name);
+    Finish(ctx_ptr, RpcStatus(RpcStatusCode::kSerializationFailed));
+    return;
+  }
+
+  std::string req_payload;
+  try {
+    invoke_info.req_type_support->serialize(req.get(), req_payload);
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("Rpc '{}' serialize req get exception, {}", ctx_ptr->service_name, e.what());
+    Finish(ctx_ptr, RpcStatus(RpcStatusCode::kSerializationFailed));
+    return;
+  }
+
+  auto deadline = (timeout.count() > 0) ? std::chrono::steady_clock::now() + timeout
+                                        : std::chrono::steady_clock::time_point::max();
+
+  uds_backend_ptr_->Invoke(
+      ctx_ptr->service_name, req_payload, deadline,
+      [this, ctx_ptr, rsp{std::move(rsp)}, rsp_type_support = invoke_info.rsp_type_support](
+          RpcStatus status, std::string_view rsp_payload) {
+        if (!Claim(ctx_ptr)) return;
+
+        if (status.OK() && !rsp_type_support->deserialize(rsp_payload, rsp.get()))
+            [[unlikely]] {
+          status = RpcStatus(RpcStatusCode::kSerializationFailed);
+        }
+        Deliver(ctx_ptr, status);
+      });
+}
+
+void RpcManager::ServeRemote(std::string_view service_name, std::string_view req_payload,
+                             UdsRpcBackend::ResponseCallback&& response_callback) {
+  auto iter = service_map_.find(service_name);
+  if (iter == service_map_.end()) [[unlikely]] {
+    response_callback(RpcStatus(RpcStatusCode::kServiceNotFound), {});
+    return;
+  }
+
+  const auto& service_info = iter->second;
+  if (!service_info.req_type_support || !service_info.rsp_type_support) [[unlikely]] {
+    response_callback(RpcStatus(RpcStatusCode::kSerializationFailed), {});
+    return;
+  }
+
+  auto req = service_info.req_type_support->create();
+  if (!service_info.req_type_support->deserialize(req_payload, req.get())) [[unlikely]] {
+    response_callback(RpcStatus(RpcStatusCode::kSerializationFailed), {});
+    return;
+  }
+  auto rsp = service_info.rsp_type_support->create();
+
+  auto response_callback_ptr =
+      std::make_shared<UdsRpcBackend::ResponseCallback>(std::move(response_callback));
+  auto serve_task = [&service_info, req{std::move(req)}, rsp{std::move(rsp)},
+                     response_callback_ptr]() {
+    try {
+      service_info.service_func(
+          req, rsp, [&service_info, rsp, response_callback_ptr](RpcStatus status) {
+            std::string rsp_payload;
+            if (status.OK()) {
+              try {
+                service_info.rsp_type_support->serialize(rsp.get(), rsp_payload);
+              } catch (const std::exception& e) {
+                rsp_payload.clear();
+                status = RpcStatus(RpcStatusCode::kSerializationFailed);
+              }
+            }
+            (*response_callback_ptr)(status, rsp_payload);
+          });
+    } catch (const std::exception& e) {
+      (*response_callback_ptr)(RpcStatus(RpcStatusCode::kHandlerException), {});
+    }
+  };
+
+  if (serve_executor_ptr_) {
+    serve_executor_ptr_->Execute(std::move(serve_task));
+  } else {
+    serve_task();
+  }
+}
+
+bool RpcManager::Claim(const std::shared_ptr<InvokeContext>& ctx_ptr) noexcept {
+  return !std::atomic_exchange(&ctx_ptr->done_flag, true);
+}
+
+void RpcManager::Finish(const std::shared_ptr<InvokeContext>& ctx_ptr, RpcStatus status) noexcept {
+  if (Claim(ctx_ptr)) Deliver(ctx_ptr, status);
+}
+
+void RpcManager::Deliver(const std::shared_ptr<InvokeContext>& ctx_ptr, RpcStatus status) noexcept {
+  if (status.Code() == RpcStatusCode::kTimeout) {
+    NXPILOT_WARN("Rpc '{}' timeout", ctx_ptr->service_name);
+  }
+
+  // Nothing else reads the context after the claim, e.g. a pending timer, release what it holds.
+  const auto trace_ptr = std::move(ctx_ptr->trace_ptr);
+  if (!ctx_ptr->callback) {
+    return;
+  }
+
+  nxpilot::runtime::core::trace::ScopedLatencyTrace scoped_trace(trace_ptr.get());
+  try {
+    if (ctx_ptr->callback_executor_ptr) {
+      ctx_ptr->callback_executor_ptr->Execute(
+          [callback{std::move(ctx_ptr->callback)}, status]() { callback(status); });
+    } else {
+      auto callback = std::move(ctx_ptr->callback);
+      callback(status);
+    }
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("Rpc '{}' done callback get exception, {}", ctx_ptr->service_name, e.what());
+  }
+}
+
+}  // namespace nxpilot::runtime::core::rpc
@@ -0,0 +1,212 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+
+#include "runtime/core/executor/executor_base.h"
+#include "runtime/core/rpc/rpc_status.h"
+#include "runtime/core/rpc/rpc_type_support.h"
+#include "runtime/core/rpc/uds_rpc_backend.h"
+#include "utils/common/log_tool.h"
+#include "utils/common/string_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::rpc {
+
+using RpcDoneCallback = std::function<void(RpcStatus)>;
+
+template <typename Req, typename Rsp>
+using RpcServiceHandler =
+    std::function<void(const std::shared_ptr<const Req>&, const std::shared_ptr<Rsp>&,
+                       RpcDoneCallback&&)>;
+
+struct InvokeOptions {
+  // Zero means using 'default_timeout_ms' of RpcManager, negative means no timeout. In-process
+  // services only time out if RpcManager has a 'timeout_executor'.
+  std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0);
+
+  // Deliver the done callback on this executor, nullptr means calling it inline.
+  nxpilot::runtime::core::executor::ExecutorBase* callback_executor = nullptr;
+};
+
+class RpcAwaitable {
+ public:
+  using StartFunc = std::function<void(RpcDoneCallback&&)>;
+
+  explicit RpcAwaitable(StartFunc&& start_func) : start_func_(std::move(start_func)) {}
+
+  bool await_ready() const noexcept { return false; }
+  // The result may arrive on another thread before 'start_func' returns, the coroutine is resumed
+  // by whichever of the two comes last. The awaitable lives in the coroutine frame, nothing of it
+  // may be touched after the resume, so 'start_func' is moved out first.
+  bool await_suspend(std::coroutine_handle<> handle) {
+    StartFunc start_func = std::move(start_func_);
+    start_func([this, handle](RpcStatus status) {
+      status_ = status;
+      if (completed_flag_.exchange(true)) handle.resume();
+    });
+    // False means the result is already there, the coroutine goes on without suspending.
+    return !completed_flag_.exchange(true);
+  }
+  RpcStatus await_resume() const noexcept { return status_; }
+
+ private:
+  StartFunc start_func_;
+  RpcStatus status_;
+  std::atomic_bool completed_flag_ = false;
+};
+
+class RpcManager {
+ public:
+  RpcManager() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~RpcManager() = default;
+
+  RpcManager(const RpcManager&) = delete;
+  RpcManager& operator=(const RpcManager&) = delete;
+
+  struct Options {
+    std::string timeout_executor;
+    std::chrono::nanoseconds default_timeout = std::chrono::milliseconds(1000);
+
+    // Run handlers of remote requests on this executor instead of the uds io thread.
+    std::string serve_executor;
+    YAML::Node uds_options;
+  };
+
+  enum class State : uint32_t {
+    kPreInit,
+    kInit,
+    kStart,
+    kShutdown,
+  };
+
+  using GetExecutorFunc =
+      std::function<nxpilot::runtime::core::executor::ExecutorBase*(std::string_view)>;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  void RegisterGetExecutorFunc(GetExecutorFunc&& get_executor_func) {
+    get_executor_func_ = std::move(get_executor_func);
+  }
+
+  void Initialize(YAML::Node options_node);
+  void Start();
+  void Shutdown();
+
+  State GetState() const { return state_.load(); }
+
+  // Services can only be registered before 'Start', the service table is read-only afterwards.
+  // Services whose req/rsp types are serializable can also be called by other processes.
+  template <typename Req, typename Rsp>
+  void RegisterService(std::string_view service_name, RpcServiceHandler<Req, Rsp>&& handler) {
+    RegisterServiceImpl(
+        service_name,
+        ServiceInfo{.req_type = typeid(Req),
+                    .rsp_type = typeid(Rsp),
+                    .req_type_support = GetRpcTypeSupport<Req>(),
+                    .rsp_type_support = GetRpcTypeSupport<Rsp>()},
+        [handler{std::move(handler)}](const std::shared_ptr<const void>& req,
+                                      const std::shared_ptr<void>& rsp, RpcDoneCallback&& done) {
+          handler(std::static_pointer_cast<const Req>(req), std::static_pointer_cast<Rsp>(rsp),
+                  std::move(done));
+        });
+  }
+
+  // 'req' and 'rsp' are kept alive until the service handler finishes, even after a timeout.
+  // Services not registered in this process are routed to the uds backend.
+  template <typename Req, typename Rsp>
+  void Invoke(std::string_view service_name, std::shared_ptr<const Req> req,
+              std::shared_ptr<Rsp> rsp, RpcDoneCallback&& callback,
+              const InvokeOptions& options = {}) noexcept {
+    InvokeImpl(service_name,
+               ServiceInfo{.req_type = typeid(Req),
+                           .rsp_type = typeid(Rsp),
+                           .req_type_support = GetRpcTypeSupport<Req>(),
+                           .rsp_type_support = GetRpcTypeSupport<Rsp>()},
+               std::move(req), std::move(rsp), std::move(callback), options);
+  }
+
+  template <typename Req, typename Rsp>
+  std::future<RpcStatus> InvokeAsFuture(std::string_view service_name,
+                                        std::shared_ptr<const Req> req, std::shared_ptr<Rsp> rsp,
+                                        const InvokeOptions& options = {}) noexcept {
+    auto promise_ptr = std::make_shared<std::promise<RpcStatus>>();
+    auto future = promise_ptr->get_future();
+    Invoke<Req, Rsp>(
+        service_name, std::move(req), std::move(rsp),
+        [promise_ptr](RpcStatus status) { promise_ptr->set_value(status); }, options);
+    return future;
+  }
+
+  // Usage: 'RpcStatus status = co_await rpc_manager.CoInvoke<Req, Rsp>(...);'
+  template <typename Req, typename Rsp>
+  RpcAwaitable CoInvoke(std::string_view service_name, std::shared_ptr<const Req> req,
+                        std::shared_ptr<Rsp> rsp, const InvokeOptions& options = {}) noexcept {
+    return RpcAwaitable([this, service_name = std::string(service_name), req{std::move(req)},
+                         rsp{std::move(rsp)}, options](RpcDoneCallback&& callback) {
+      Invoke<Req, Rsp>(service_name, req, rsp, std::move(callback), options);
+    });
+  }
+
+ private:
+  using ServiceFunc = std::function<void(const std::shared_ptr<const void>&,
+                                         const std::shared_ptr<void>&, RpcDoneCallback&&)>;
+
+  struct ServiceInfo {
+    std::type_index req_type;
+    std::type_index rsp_type;
+    const RpcTypeSupport* req_type_support = nullptr;
+    const RpcTypeSupport* rsp_type_support = nullptr;
+    ServiceFunc service_func;
+    std::string trace_stage;  // the latency trace hop of a call
+  };
+
+  struct InvokeContext;
+
+  void RegisterServiceImpl(std::string_view service_name, ServiceInfo&& service_info,
+                           ServiceFunc&& service_func);
+
+  void InvokeImpl(std::string_view service_name, const ServiceInfo& invoke_info,
+                  std::shared_ptr<const void> req, std::shared_ptr<void> rsp,
+                  RpcDoneCallback&& callback, const InvokeOptions& options) noexcept;
+  void InvokeRemote(const std::shared_ptr<InvokeContext>& ctx_ptr, const ServiceInfo& invoke_info,
+                    const std::shared_ptr<const void>& req, std::shared_ptr<void> rsp,
+                    std::chrono::nanoseconds timeout) noexcept;
+  void ServeRemote(std::string_view service_name, std::string_view req_payload,
+                   UdsRpcBackend::ResponseCallback&& response_callback);
+
+  // Only the first caller of 'Claim' may deliver the result.
+  static bool Claim(const std::shared_ptr<InvokeContext>& ctx_ptr) noexcept;
+  void Deliver(const std::shared_ptr<InvokeContext>& ctx_ptr, RpcStatus status) noexcept;
+  void Finish(const std::shared_ptr<InvokeContext>& ctx_ptr, RpcStatus status) noexcept;
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  std::atomic<State> state_ = State::kPreInit;
+
+  GetExecutorFunc get_executor_func_;
+  nxpilot::runtime::core::executor::ExecutorBase* timeout_executor_ptr_ = nullptr;
+  nxpilot::runtime::core::executor::ExecutorBase* serve_executor_ptr_ = nullptr;
+  std::unique_ptr<UdsRpcBackend> uds_backend_ptr_;
+  // A timeout without a 'timeout_executor' is only warned about once.
+  std::atomic_bool timeout_warned_flag_ = false;
+
+  std::unordered_map<std::string, ServiceInfo, nxpilot::utils::common::StringHash,
+                     std::equal_to<>>
+      service_map_;
+};
+
+}  // namespace nxpilot::runtime::core::rpc
@@ -0,0 +1,198 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "gtest/gtest.h"
+
+#include <coroutine>
+#include <future>
+#include <thread>
+
+#include "runtime/core/executor/guard_thread_executor.h"
+#include "runtime/core/executor/time_wheel_executor.h"
+#include "runtime/core/rpc/rpc_manager.h"
+
+namespace nxpilot::runtime::core::rpc {
+
+struct TestReq {
+  int32_t value = 0;
+};
+
+struct TestRsp {
+  int32_t value = 0;
+};
+
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+class RpcManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    guard_executor_.Initialize("rpc_test_guard", YAML::Node(YAML::NodeType::Null));
+    guard_executor_.Start();
+
+    YAML::Node timer_options;
+    timer_options["dt_us"] = 1000;
+    timer_executor_.Initialize("rpc_test_timer", timer_options);
+    timer_executor_.Start();
+
+    rpc_manager_.RegisterGetExecutorFunc(
+        [this](std::string_view name) -> executor::ExecutorBase* {
+          if (name == timer_executor_.Name()) return &timer_executor_;
+          if (name == guard_executor_.Name()) return &guard_executor_;
+          return nullptr;
+        });
+
+    rpc_manager_.RegisterService<TestReq, TestRsp>(
+        "add_one", [](const std::shared_ptr<const TestReq>& req,
+                      const std::shared_ptr<TestRsp>& rsp, RpcDoneCallback&& done) {
+          rsp->value = req->value + 1;
+          done(RpcStatus());
+        });
+
+    rpc_manager_.RegisterService<TestReq, TestRsp>(
+        "never_done", [this](const std::shared_ptr<const TestReq>& req,
+                             const std::shared_ptr<TestRsp>& rsp, RpcDoneCallback&& done) {
+          pending_done_ = std::move(done);
+        });
+
+    rpc_manager_.RegisterService<TestReq, TestRsp>(
+        "drop_done", [](const std::shared_ptr<const TestReq>& req,
+                        const std::shared_ptr<TestRsp>& rsp, RpcDoneCallback&& done) {});
+
+    YAML::Node rpc_options;
+    rpc_options["timeout_executor"] = "rpc_test_timer";
+    rpc_options["default_timeout_ms"] = 20;
+    rpc_manager_.Initialize(rpc_options);
+    rpc_manager_.Start();
+  }
+
+  void TearDown() override {
+    rpc_manager_.Shutdown();
+    timer_executor_.Shutdown();
+    guard_executor_.Shutdown();
+  }
+
+  executor::GuardThreadExecutor guard_executor_;
+  executor::TimeWheelExecutor timer_executor_;
+  RpcManager rpc_manager_;
+  RpcDoneCallback pending_done_;
+};
+
+TEST_F(RpcManagerTest, invoke_in_process) {
+  auto req = std::make_shared<TestReq>(TestReq{.value = 41});
+  auto rsp = std::make_shared<TestRsp>();
+
+  bool called = false;
+  rpc_manager_.Invoke<TestReq, TestRsp>("add_one", req, rsp, [&called](RpcStatus status) {
+    EXPECT_TRUE(status.OK());
+    called = true;
+  });
+
+  EXPECT_TRUE(called);
+  EXPECT_EQ(rsp->value, 42);
+}
+
+TEST_F(RpcManagerTest, invoke_errors) {
+  auto req = std::make_shared<TestReq>();
+  auto rsp = std::make_shared<TestRsp>();
+
+  auto status = rpc_manager_.InvokeAsFuture<TestReq, TestRsp>("not_exist", req, rsp).get();
+  EXPECT_EQ(status.Code(), RpcStatusCode::kServiceNotFound);
+
+  auto bad_rsp = std::make_shared<TestReq>();
+  status = rpc_manager_.InvokeAsFuture<TestReq, TestReq>("add_one", req, bad_rsp).get();
+  EXPECT_EQ(status.Code(), RpcStatusCode::kTypeMismatch);
+}
+
+TEST_F(RpcManagerTest, invoke_on_callback_executor) {
+  auto req = std::make_shared<TestReq>(TestReq{.value = 1});
+  auto rsp = std::make_shared<TestRsp>();
+
+  std::promise<std::thread::id> promise;
+  rpc_manager_.Invoke<TestReq, TestRsp>(
+      "add_one", req, rsp,
+      [&promise](RpcStatus status) { promise.set_value(std::this_thread::get_id()); },
+      InvokeOptions{.callback_executor = &guard_executor_});
+
+  EXPECT_NE(promise.get_future().get(), std::this_thread::get_id());
+  EXPECT_EQ(rsp->value, 2);
+}
+
+TEST_F(RpcManagerTest, invoke_timeout) {
+  auto req = std::make_shared<TestReq>();
+  auto rsp = std::make_shared<TestRsp>();
+
+  auto future = rpc_manager_.InvokeAsFuture<TestReq, TestRsp>("never_done", req, rsp);
+  ASSERT_EQ(future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+  EXPECT_EQ(future.get().Code(), RpcStatusCode::kTimeout);
+
+  // Late completion after timeout is ignored.
+  pending_done_(RpcStatus());
+}
+
+TEST_F(RpcManagerTest, invoke_timeout_after_done_dropped) {
+  auto req = std::make_shared<TestReq>();
+  auto rsp = std::make_shared<TestRsp>();
+
+  // The handler drops 'done' without calling it, the caller still gets the timeout.
+  auto future = rpc_manager_.InvokeAsFuture<TestReq, TestRsp>("drop_done", req, rsp);
+  ASSERT_EQ(future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+  EXPECT_EQ(future.get().Code(), RpcStatusCode::kTimeout);
+}
+
+TEST_F(RpcManagerTest, done_releases_req_and_rsp) {
+  auto req = std::make_shared<TestReq>(TestReq{.value = 1});
+  auto rsp = std::make_shared<TestRsp>();
+  std::weak_ptr<TestReq> req_weak = req;
+  std::weak_ptr<TestRsp> rsp_weak = rsp;
+
+  // The timer of the default timeout is still pending, it does not keep them alive.
+  auto status = rpc_manager_.InvokeAsFuture<TestReq, TestRsp>("add_one", std::move(req),
+                                                              std::move(rsp))
+                    .get();
+  EXPECT_TRUE(status.OK());
+  EXPECT_TRUE(req_weak.expired());
+  EXPECT_TRUE(rsp_weak.expired());
+}
+
+TEST_F(RpcManagerTest, co_invoke) {
+  auto req = std::make_shared<TestReq>(TestReq{.value = 9});
+  auto rsp = std::make_shared<TestRsp>();
+
+  std::promise<RpcStatus> promise;
+  [&]() -> DetachedTask {
+    auto status = co_await rpc_manager_.CoInvoke<TestReq, TestRsp>(
+        "add_one", req, rsp, InvokeOptions{.callback_executor = &guard_executor_});
+    promise.set_value(status);
+  }();
+
+  EXPECT_TRUE(promise.get_future().get().OK());
+  EXPECT_EQ(rsp->value, 10);
+}
+
+TEST_F(RpcManagerTest, co_invoke_inline) {
+  auto req = std::make_shared<TestReq>(TestReq{.value = 19});
+  auto rsp = std::make_shared<TestRsp>();
+
+  // The handler completes synchronously and the callback is inline, the result arrives before
+  // the coroutine is suspended.
+  bool finished = false;
+  RpcStatus status(RpcStatusCode::kTimeout);
+  [&]() -> DetachedTask {
+    status = co_await rpc_manager_.CoInvoke<TestReq, TestRsp>(
+        "add_one", req, rsp, InvokeOptions{.callback_executor = nullptr});
+    finished = true;
+  }();
+
+  EXPECT_TRUE(finished);
+  EXPECT_TRUE(status.OK());
+  EXPECT_EQ(rsp->value, 20);
+}
+
+}  // namespace nxpilot::runtime::core::rpc
@@ -0,0 +1,53 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace nxpilot::runtime::core::rpc {
+
+enum class RpcStatusCode : uint32_t {
+  kOk = 0,
+  kServiceNotFound,
+  kTypeMismatch,
+  kTimeout,
+  kHandlerException,
+  kHandlerFailed,
+  kNotStarted,
+  kTransportError,
+  kSerializationFailed,
+};
+
+class RpcStatus {
+ public:
+  RpcStatus() = default;
+  explicit RpcStatus(RpcStatusCode code) : code_(code) {}
+
+  bool OK() const noexcept { return code_ == RpcStatusCode::kOk; }
+  RpcStatusCode Code() const noexcept { return code_; }
+
+  std::string_view ToString() const noexcept {
+    static constexpr std::string_view kCodeNameArray[] = {
+        "OK",
+        "ServiceNotFound",
+        "TypeMismatch",
+        "Timeout",
+        "HandlerException",
+        "HandlerFailed",
+        "NotStarted",
+        "TransportError",
+        "SerializationFailed",
+    };
+    static constexpr uint32_t kCodeNameArraySize =
+        sizeof(kCodeNameArray) / sizeof(kCodeNameArray[0]);
+    auto idx = static_cast<uint32_t>(code_);
+    return idx < kCodeNameArraySize ? kCodeNameArray[idx] : "Unknown";
+  }
+
+ private:
+  RpcStatusCode code_ = RpcStatusCode::kOk;
+};
+
+}  // namespace nxpilot::runtime::core::rpc
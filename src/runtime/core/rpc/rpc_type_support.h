@@ -0,0 +1,41 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "utils/common/serialization_tool.h"
+
+namespace nxpilot::runtime::core::rpc {
+
+// Type-erased (de)serialization functions of a req/rsp type, only used by remote rpc backends.
+struct RpcTypeSupport {
+  std::shared_ptr<void> (*create)();
+  void (*serialize)(const void* msg, std::string& buffer);
+  bool (*deserialize)(std::string_view buffer, void* msg);
+};
+
+template <typename T>
+const RpcTypeSupport* GetRpcTypeSupport() {
+  if constexpr (nxpilot::utils::common::Serializable<T> && std::is_default_constructible_v<T>) {
+    static const RpcTypeSupport kTypeSupport{
+        .create = []() -> std::shared_ptr<void> { return std::make_shared<T>(); },
+        .serialize =
+            [](const void* msg, std::string& buffer) {
+              nxpilot::utils::common::SerializationTraits<T>::Serialize(
+                  *static_cast<const T*>(msg), buffer);
+            },
+        .deserialize =
+            [](std::string_view buffer, void* msg) -> bool {
+          return nxpilot::utils::common::SerializationTraits<T>::Deserialize(buffer,
+                                                                             *static_cast<T*>(msg));
+        }};
+    return &kTypeSupport;
+  } else {
+    return nullptr;
+  }
+}
+
+}  // namespace nxpilot::runtime::core::rpc
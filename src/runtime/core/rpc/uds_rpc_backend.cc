@@ -0,0 +1,650 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/rpc/uds_rpc_backend.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "runtime/core/configurator/options_checker.h"
+#include "utils/common/thread_tool.h"
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::rpc::UdsRpcBackend::Options> {
+  using Options = nxpilot::runtime::core::rpc::UdsRpcBackend::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["listen_path"] = rhs.listen_path;
+    node["thread_sched_policy"] = rhs.thread_sched_policy;
+    node["thread_bind_cpu"] = rhs.thread_bind_cpu;
+    node["max_frame_size"] = rhs.max_frame_size;
+    node["max_write_buffer_size"] = rhs.max_write_buffer_size;
+    node["remote_services"] = YAML::Node();
+    for (const auto& remote_service : rhs.remote_services) {
+      Node remote_service_node;
+      remote_service_node["service"] = remote_service.service;
+      remote_service_node["path"] = remote_service.path;
+      node["remote_services"].push_back(remote_service_node);
+    }
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["listen_path"]) rhs.listen_path = node["listen_path"].as<std::string>();
+    if (node["thread_sched_policy"])
+      rhs.thread_sched_policy = node["thread_sched_policy"].as<std::string>();
+    if (node["thread_bind_cpu"])
+      rhs.thread_bind_cpu = node["thread_bind_cpu"].as<std::vector<uint32_t>>();
+    if (node["max_frame_size"]) rhs.max_frame_size = node["max_frame_size"].as<uint32_t>();
+    if (node["max_write_buffer_size"])
+      rhs.max_write_buffer_size = node["max_write_buffer_size"].as<uint64_t>();
+
+    if (node["remote_services"] && node["remote_services"].IsSequence()) {
+      for (const auto& remote_service_node : node["remote_services"]) {
+        rhs.remote_services.emplace_back(Options::RemoteServiceOptions{
+            .service = remote_service_node["service"].as<std::string>(),
+            .path = remote_service_node["path"].as<std::string>()});
+      }
+    }
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::rpc {
+
+namespace {
+
+constexpr uint16_t kFrameMagic = 0x4e58;
+constexpr uint8_t kFrameTypeRequest = 1;
+constexpr uint8_t kFrameTypeResponse = 2;
+
+struct FrameHeader {
+  uint16_t magic;
+  uint8_t type;
+  uint8_t status;
+  uint32_t req_id;
+  uint32_t name_size;
+  uint32_t payload_size;
+};
+static_assert(sizeof(FrameHeader) == 16);
+
+bool FillSocketAddr(const std::string& path, sockaddr_un& addr) {
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) return false;
+  std::memcpy(addr.sun_path, path.data(), path.size());
+  return true;
+}
+
+}  // namespace
+
+void UdsRpcBackend::Initialize(YAML::Node options_node) {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
+                      "UdsRpcBackend can only be initialized once.");
+
+  auto err = configurator::CheckOptionsKeys(
+      options_node, {"listen_path", "thread_sched_policy", "thread_bind_cpu", "max_frame_size",
+                     "max_write_buffer_size", "remote_services"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid uds rpc backend options, {}", err);
+
+  if (options_node && !options_node.IsNull()) {
+    options_ = options_node.as<Options>();
+  }
+
+  err = configurator::CheckThreadOptions(options_.thread_sched_policy, options_.thread_bind_cpu);
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid uds rpc backend options, {}", err);
+
+  sockaddr_un addr;
+  NXPILOT_CHECK_ERROR(options_.listen_path.empty() || FillSocketAddr(options_.listen_path, addr),
+                      "Invalid uds listen path '{}'", options_.listen_path);
+
+  for (const auto& remote_service : options_.remote_services) {
+    NXPILOT_CHECK_ERROR(FillSocketAddr(remote_service.path, addr),
+                        "Invalid uds path '{}' of remote service '{}'", remote_service.path,
+                        remote_service.service);
+    auto emplace_ret = remote_service_map_.emplace(remote_service.service, remote_service.path);
+    NXPILOT_CHECK_ERROR(emplace_ret.second, "Duplicate remote service '{}'",
+                        remote_service.service);
+  }
+
+  NXPILOT_INFO("UdsRpcBackend init completed");
+}
+
+void UdsRpcBackend::Start() {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
+                      "Method can only be called when state is 'Init'.");
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  NXPILOT_CHECK_ERROR(epoll_fd_ >= 0, "Call 'epoll_create1' get error, {}", strerror(errno));
+
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  NXPILOT_CHECK_ERROR(event_fd_ >= 0, "Call 'eventfd' get error, {}", strerror(errno));
+
+  epoll_event event{.events = EPOLLIN, .data = {.fd = event_fd_}};
+  NXPILOT_CHECK_ERROR(epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &event) == 0,
+                      "Call 'epoll_ctl' get error, {}", strerror(errno));
+
+  // 'steady_clock' is CLOCK_MONOTONIC, the deadlines are set as absolute times.
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  NXPILOT_CHECK_ERROR(timer_fd_ >= 0, "Call 'timerfd_create' get error, {}", strerror(errno));
+
+  epoll_event timer_event{.events = EPOLLIN, .data = {.fd = timer_fd_}};
+  NXPILOT_CHECK_ERROR(epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &timer_event) == 0,
+                      "Call 'epoll_ctl' get error, {}", strerror(errno));
+
+  if (!options_.listen_path.empty()) {
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    NXPILOT_CHECK_ERROR(listen_fd_ >= 0, "Call 'socket' get error, {}", strerror(errno));
+
+    sockaddr_un addr;
+    FillSocketAddr(options_.listen_path, addr);
+    unlink(options_.listen_path.c_str());
+    NXPILOT_CHECK_ERROR(bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0,
+                        "Bind uds path '{}' get error, {}", options_.listen_path, strerror(errno));
+    NXPILOT_CHECK_ERROR(listen(listen_fd_, SOMAXCONN) == 0, "Call 'listen' get error, {}",
+                        strerror(errno));
+
+    epoll_event listen_event{.events = EPOLLIN, .data = {.fd = listen_fd_}};
+    NXPILOT_CHECK_ERROR(epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &listen_event) == 0,
+                        "Call 'epoll_ctl' get error, {}", strerror(errno));
+  }
+
+  io_thread_ptr_ = std::make_unique<std::thread>(std::bind(&UdsRpcBackend::IoLoop, this));
+
+  NXPILOT_INFO("UdsRpcBackend start completed");
+}
+
+void UdsRpcBackend::Shutdown() {
+  auto pre_state = std::atomic_exchange(&state_, State::kShutdown);
+  if (pre_state == State::kShutdown) {
+    return;
+  }
+
+  if (io_thread_ptr_ && io_thread_ptr_->joinable()) {
+    uint64_t value = 1;
+    [[maybe_unused]] auto ret = write(event_fd_, &value, sizeof(value));
+    io_thread_ptr_->join();
+  }
+  io_thread_ptr_.reset();
+
+  std::vector<ConnectionPtr> conn_vec;
+  {
+    std::lock_guard<std::mutex> lck(conn_mutex_);
+    for (auto& itr : conn_map_) conn_vec.emplace_back(itr.second);
+  }
+  for (auto& conn_ptr : conn_vec) CloseConnection(conn_ptr);
+
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+    unlink(options_.listen_path.c_str());
+  }
+  if (timer_fd_ >= 0) {
+    close(timer_fd_);
+    timer_fd_ = -1;
+  }
+  if (event_fd_ >= 0) {
+    close(event_fd_);
+    event_fd_ = -1;
+  }
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+
+  if (pre_state != State::kPreInit) {
+    NXPILOT_INFO("UdsRpcBackend shutdown");
+  }
+}
+
+void UdsRpcBackend::Invoke(std::string_view service_name, std::string_view req_payload,
+                           std::chrono::steady_clock::time_point deadline,
+                           ResponseCallback&& callback) noexcept {
+  auto iter = remote_service_map_.find(service_name);
+  if (iter == remote_service_map_.end()) [[unlikely]] {
+    callback(RpcStatus(RpcStatusCode::kServiceNotFound), {});
+    return;
+  }
+
+  if (state_.load() != State::kStart) [[unlikely]] {
+    callback(RpcStatus(RpcStatusCode::kNotStarted), {});
+    return;
+  }
+
+  auto conn_ptr = GetClientConnection(iter->second);
+  if (!conn_ptr) [[unlikely]] {
+    callback(RpcStatus(RpcStatusCode::kTransportError), {});
+    return;
+  }
+
+  uint32_t req_id = ++req_id_;
+  {
+    std::unique_lock<std::mutex> lck(conn_ptr->pending_mutex);
+    if (conn_ptr->fd < 0) [[unlikely]] {
+      lck.unlock();
+      callback(RpcStatus(RpcStatusCode::kTransportError), {});
+      return;
+    }
+    conn_ptr->pending_map.emplace(
+        req_id, PendingRequest{.deadline = deadline, .callback = std::move(callback)});
+  }
+
+  {
+    std::lock_guard<std::mutex> lck(timer_mutex_);
+    if (deadline < next_deadline_) {
+      next_deadline_ = deadline;
+      ArmTimer(deadline);
+    }
+  }
+
+  if (!EnqueueFrame(conn_ptr, kFrameTypeRequest, 0, req_id, service_name, req_payload))
+      [[unlikely]] {
+    // The connection closed or backed up meanwhile, fail now instead of at the deadline, unless
+    // the request was already reported.
+    PendingRequest pending_request;
+    {
+      std::lock_guard<std::mutex> lck(conn_ptr->pending_mutex);
+      auto iter = conn_ptr->pending_map.find(req_id);
+      if (iter == conn_ptr->pending_map.end()) return;
+      pending_request = std::move(iter->second);
+      conn_ptr->pending_map.erase(iter);
+    }
+    pending_request.callback(RpcStatus(RpcStatusCode::kTransportError), {});
+  }
+}
+
+void UdsRpcBackend::IoLoop() {
+  try {
+    nxpilot::utils::common::SetNameForCurrentThread("nxpilot_rpc_uds");
+    nxpilot::utils::common::BindCpuForCurrentThread(options_.thread_bind_cpu);
+    nxpilot::utils::common::SetCpuSchedForCurrentThread(options_.thread_sched_policy);
+  } catch (const std::exception& e) {
+    NXPILOT_ERROR("Set thread policy for UdsRpcBackend get exception, {}", e.what());
+  }
+
+  constexpr int kMaxEvents = 64;
+  epoll_event events[kMaxEvents];
+
+  while (state_.load() != State::kShutdown) {
+    int event_num = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+    if (event_num < 0) {
+      if (errno != EINTR) NXPILOT_ERROR("Call 'epoll_wait' get error, {}", strerror(errno));
+      continue;
+    }
+
+    for (int ii = 0; ii < event_num; ++ii) {
+      const int fd = events[ii].data.fd;
+      const uint32_t event_flags = events[ii].events;
+
+      if (fd == event_fd_) {
+        uint64_t value;
+        [[maybe_unused]] auto ret = read(event_fd_, &value, sizeof(value));
+
+        std::vector<ConnectionPtr> dirty_conn_vec;
+        {
+          std::lock_guard<std::mutex> lck(dirty_mutex_);
+          dirty_conn_vec.swap(dirty_conn_vec_);
+        }
+        for (auto& conn_ptr : dirty_conn_vec) FlushConnection(conn_ptr);
+        continue;
+      }
+
+      if (fd == listen_fd_) {
+        AcceptConnections();
+        continue;
+      }
+
+      if (fd == timer_fd_) {
+        uint64_t expiration_num;
+        [[maybe_unused]] auto ret = read(timer_fd_, &expiration_num, sizeof(expiration_num));
+        SweepTimeoutRequests();
+        continue;
+      }
+
+      ConnectionPtr conn_ptr;
+      {
+        std::lock_guard<std::mutex> lck(conn_mutex_);
+        auto iter = conn_map_.find(fd);
+        if (iter == conn_map_.end()) continue;
+        conn_ptr = iter->second;
+      }
+
+      if (event_flags & EPOLLIN) ReadConnection(conn_ptr);
+      if ((event_flags & EPOLLOUT) && conn_ptr->fd >= 0) FlushConnection(conn_ptr);
+      if ((event_flags & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) && conn_ptr->fd >= 0)
+        CloseConnection(conn_ptr);
+    }
+  }
+}
+
+void UdsRpcBackend::AcceptConnections() {
+  while (true) {
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        NXPILOT_ERROR("Call 'accept4' get error, {}", strerror(errno));
+      return;
+    }
+
+    auto conn_ptr = std::make_shared<Connection>();
+    conn_ptr->fd = fd;
+
+    std::lock_guard<std::mutex> lck(conn_mutex_);
+    AddConnection(conn_ptr);
+  }
+}
+
+UdsRpcBackend::ConnectionPtr UdsRpcBackend::GetClientConnection(const std::string& path) {
+  std::lock_guard<std::mutex> lck(conn_mutex_);
+
+  auto iter = client_conn_map_.find(path);
+  if (iter != client_conn_map_.end()) return iter->second;
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    NXPILOT_ERROR("Call 'socket' get error, {}", strerror(errno));
+    return nullptr;
+  }
+
+  sockaddr_un addr;
+  FillSocketAddr(path, addr);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    NXPILOT_ERROR("Connect uds path '{}' get error, {}", path, strerror(errno));
+    close(fd);
+    return nullptr;
+  }
+
+  auto conn_ptr = std::make_shared<Connection>();
+  conn_ptr->fd = fd;
+  AddConnection(conn_ptr);
+  client_conn_map_.emplace(path, conn_ptr);
+
+  return conn_ptr;
+}
+
+// 'conn_mutex_' must be held by the caller.
+void UdsRpcBackend::AddConnection(const ConnectionPtr& conn_ptr) {
+  epoll_event event{.events = EPOLLIN | EPOLLRDHUP, .data = {.fd = conn_ptr->fd}};
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, conn_ptr->fd, &event) != 0) {
+    NXPILOT_ERROR("Call 'epoll_ctl' get error, {}", strerror(errno));
+  }
+  conn_map_[conn_ptr->fd] = conn_ptr;
+}
+
+void UdsRpcBackend::CloseConnection(const ConnectionPtr& conn_ptr) {
+  std::unordered_map<uint32_t, PendingRequest> pending_map;
+  {
+    std::lock_guard<std::mutex> pending_lck(conn_ptr->pending_mutex);
+    if (conn_ptr->fd < 0) return;
+
+    {
+      // Erase before closing the fd, otherwise a new socket may reuse the fd number.
+      std::lock_guard<std::mutex> lck(conn_mutex_);
+      conn_map_.erase(conn_ptr->fd);
+      std::erase_if(client_conn_map_,
+                    [&conn_ptr](const auto& itr) { return itr.second == conn_ptr; });
+    }
+
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn_ptr->fd, nullptr);
+    close(conn_ptr->fd);
+    conn_ptr->fd = -1;
+    pending_map.swap(conn_ptr->pending_map);
+
+    std::lock_guard<std::mutex> write_lck(conn_ptr->write_mutex);
+    conn_ptr->closed_flag = true;
+    conn_ptr->write_buffer.clear();
+  }
+
+  for (auto& itr : pending_map) {
+    itr.second.callback(RpcStatus(RpcStatusCode::kTransportError), {});
+  }
+}
+
+void UdsRpcBackend::ReadConnection(const ConnectionPtr& conn_ptr) {
+  thread_local std::string recv_buffer(64 * 1024, '\0');
+
+  while (true) {
+    auto ret = recv(conn_ptr->fd, recv_buffer.data(), recv_buffer.size(), MSG_DONTWAIT);
+    if (ret > 0) {
+      conn_ptr->read_buffer.append(recv_buffer.data(), ret);
+      continue;
+    }
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+
+    // Peer closed or error, handle the received frames first.
+    break;
+  }
+
+  auto& buffer = conn_ptr->read_buffer;
+  size_t offset = 0;
+  while (buffer.size() - offset >= sizeof(FrameHeader)) {
+    FrameHeader header;
+    std::memcpy(&header, buffer.data() + offset, sizeof(FrameHeader));
+
+    if (header.magic != kFrameMagic ||
+        static_cast<uint64_t>(header.name_size) + header.payload_size > options_.max_frame_size)
+        [[unlikely]] {
+      NXPILOT_ERROR("UdsRpcBackend get invalid frame, close the connection.");
+      CloseConnection(conn_ptr);
+      return;
+    }
+
+    const size_t frame_size = sizeof(FrameHeader) + header.name_size + header.payload_size;
+    if (buffer.size() - offset < frame_size) break;
+
+    const char* data = buffer.data() + offset + sizeof(FrameHeader);
+    HandleFrame(conn_ptr, header.type, header.status, header.req_id,
+                std::string_view(data, header.name_size),
+                std::string_view(data + header.name_size, header.payload_size));
+    offset += frame_size;
+  }
+
+  buffer.erase(0, offset);
+}
+
+void UdsRpcBackend::HandleFrame(const ConnectionPtr& conn_ptr, uint8_t type, uint8_t status,
+                                uint32_t req_id, std::string_view service_name,
+                                std::string_view payload) {
+  if (type == kFrameTypeRequest) {
+    std::weak_ptr<Connection> conn_weak_ptr = conn_ptr;
+    ResponseCallback response_callback = [this, conn_weak_ptr, req_id](
+                                             RpcStatus rsp_status, std::string_view rsp_payload) {
+      auto ptr = conn_weak_ptr.lock();
+      if (ptr && !EnqueueFrame(ptr, kFrameTypeResponse, static_cast<uint8_t>(rsp_status.Code()),
+                               req_id, {}, rsp_payload)) [[unlikely]] {
+        NXPILOT_WARN("UdsRpcBackend drop the response of request {}, the connection is closed "
+                     "or its write buffer is full.",
+                     req_id);
+      }
+    };
+
+    if (!serve_func_) [[unlikely]] {
+      response_callback(RpcStatus(RpcStatusCode::kServiceNotFound), {});
+      return;
+    }
+
+    try {
+      serve_func_(service_name, payload, std::move(response_callback));
+    } catch (const std::exception& e) {
+      NXPILOT_ERROR("UdsRpcBackend serve '{}' get exception, {}", service_name, e.what());
+    }
+    return;
+  }
+
+  if (type == kFrameTypeResponse) {
+    PendingRequest pending_request;
+    {
+      std::lock_guard<std::mutex> lck(conn_ptr->pending_mutex);
+      auto iter = conn_ptr->pending_map.find(req_id);
+      if (iter == conn_ptr->pending_map.end()) return;
+      pending_request = std::move(iter->second);
+      conn_ptr->pending_map.erase(iter);
+    }
+
+    pending_request.callback(RpcStatus(static_cast<RpcStatusCode>(status)), payload);
+    return;
+  }
+
+  NXPILOT_WARN("UdsRpcBackend get unknown frame type {}", type);
+}
+
+bool UdsRpcBackend::EnqueueFrame(const ConnectionPtr& conn_ptr, uint8_t type, uint8_t status,
+                                 uint32_t req_id, std::string_view service_name,
+                                 std::string_view payload) {
+  const FrameHeader header{.magic = kFrameMagic,
+                           .type = type,
+                           .status = status,
+                           .req_id = req_id,
+                           .name_size = static_cast<uint32_t>(service_name.size()),
+                           .payload_size = static_cast<uint32_t>(payload.size())};
+
+  const uint64_t frame_size = sizeof(header) + service_name.size() + payload.size();
+
+  bool need_notify = false;
+  {
+    std::lock_guard<std::mutex> lck(conn_ptr->write_mutex);
+    if (conn_ptr->closed_flag) [[unlikely]] return false;
+    if (conn_ptr->buffered_size.load() + frame_size > options_.max_write_buffer_size)
+        [[unlikely]] {
+      return false;
+    }
+    conn_ptr->buffered_size.fetch_add(frame_size);
+
+    auto& buffer = conn_ptr->write_buffer;
+    buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    buffer.append(service_name);
+    buffer.append(payload);
+
+    // Only the first frame since the last flush wakes up the io thread, later ones are batched.
+    if (!conn_ptr->dirty_flag) {
+      conn_ptr->dirty_flag = true;
+      need_notify = true;
+    }
+  }
+
+  if (need_notify) {
+    {
+      std::lock_guard<std::mutex> lck(dirty_mutex_);
+      dirty_conn_vec_.emplace_back(conn_ptr);
+    }
+    uint64_t value = 1;
+    [[maybe_unused]] auto ret = write(event_fd_, &value, sizeof(value));
+  }
+  return true;
+}
+
+void UdsRpcBackend::FlushConnection(const ConnectionPtr& conn_ptr) {
+  if (conn_ptr->fd < 0) return;
+
+  {
+    std::lock_guard<std::mutex> lck(conn_ptr->write_mutex);
+    if (conn_ptr->sending_buffer.empty()) {
+      conn_ptr->sending_buffer.swap(conn_ptr->write_buffer);
+    } else {
+      conn_ptr->sending_buffer.append(conn_ptr->write_buffer);
+      conn_ptr->write_buffer.clear();
+    }
+    conn_ptr->dirty_flag = false;
+  }
+
+  auto& buffer = conn_ptr->sending_buffer;
+  auto& offset = conn_ptr->sending_offset;
+  while (offset < buffer.size()) {
+    auto ret = send(conn_ptr->fd, buffer.data() + offset, buffer.size() - offset,
+                    MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (ret > 0) {
+      offset += ret;
+      conn_ptr->buffered_size.fetch_sub(static_cast<uint64_t>(ret));
+      continue;
+    }
+    if (ret < 0 && errno == EINTR) continue;
+
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      if (!conn_ptr->epollout_flag) {
+        epoll_event event{.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP, .data = {.fd = conn_ptr->fd}};
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn_ptr->fd, &event);
+        conn_ptr->epollout_flag = true;
+      }
+      return;
+    }
+
+    NXPILOT_ERROR("UdsRpcBackend send get error, {}", strerror(errno));
+    CloseConnection(conn_ptr);
+    return;
+  }
+
+  buffer.clear();
+  offset = 0;
+  if (conn_ptr->epollout_flag) {
+    epoll_event event{.events = EPOLLIN | EPOLLRDHUP, .data = {.fd = conn_ptr->fd}};
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn_ptr->fd, &event);
+    conn_ptr->epollout_flag = false;
+  }
+}
+
+void UdsRpcBackend::SweepTimeoutRequests() {
+  std::vector<ConnectionPtr> conn_vec;
+  {
+    std::lock_guard<std::mutex> lck(conn_mutex_);
+    for (auto& itr : conn_map_) conn_vec.emplace_back(itr.second);
+  }
+
+  std::vector<ResponseCallback> timeout_callback_vec;
+  {
+    std::lock_guard<std::mutex> timer_lck(timer_mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    auto next_deadline = std::chrono::steady_clock::time_point::max();
+    for (auto& conn_ptr : conn_vec) {
+      std::lock_guard<std::mutex> lck(conn_ptr->pending_mutex);
+      for (auto iter = conn_ptr->pending_map.begin(); iter != conn_ptr->pending_map.end();) {
+        if (iter->second.deadline <= now) {
+          timeout_callback_vec.emplace_back(std::move(iter->second.callback));
+          iter = conn_ptr->pending_map.erase(iter);
+        } else {
+          next_deadline = std::min(next_deadline, iter->second.deadline);
+          ++iter;
+        }
+      }
+    }
+    next_deadline_ = next_deadline;
+    ArmTimer(next_deadline);
+  }
+
+  for (auto& callback : timeout_callback_vec) {
+    callback(RpcStatus(RpcStatusCode::kTimeout), {});
+  }
+}
+
+// 'timer_mutex_' must be held by the caller.
+void UdsRpcBackend::ArmTimer(std::chrono::steady_clock::time_point deadline) {
+  // A zero time disarms the timer, a deadline in the past fires it right away.
+  itimerspec spec;
+  std::memset(&spec, 0, sizeof(spec));
+  if (deadline != std::chrono::steady_clock::time_point::max()) {
+    const auto ns = std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count(),
+        1);
+    spec.it_value.tv_sec = ns / 1000000000;
+    spec.it_value.tv_nsec = ns % 1000000000;
+  }
+  if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) != 0) {
+    NXPILOT_ERROR("Call 'timerfd_settime' get error, {}", strerror(errno));
+  }
+}
+
+}  // namespace nxpilot::runtime::core::rpc
@@ -0,0 +1,162 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "runtime/core/rpc/rpc_status.h"
+#include "utils/common/log_tool.h"
+#include "utils/common/string_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::rpc {
+
+/**
+ * @brief Inter-process rpc transport over unix domain stream sockets.
+ *
+ * Every frame is a 16 bytes header followed by the service name (request only) and the payload.
+ * Requests are matched with responses by request id, so any number of requests can be in flight
+ * on one connection. Frames queued by other threads are coalesced and written by the io thread
+ * with a single send call. A timerfd is armed on the earliest deadline of the pending requests,
+ * so a timeout is reported when it expires rather than on a polling tick.
+ */
+class UdsRpcBackend {
+ public:
+  UdsRpcBackend() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~UdsRpcBackend() { Shutdown(); }
+
+  UdsRpcBackend(const UdsRpcBackend&) = delete;
+  UdsRpcBackend& operator=(const UdsRpcBackend&) = delete;
+
+  struct Options {
+    struct RemoteServiceOptions {
+      std::string service;
+      std::string path;
+    };
+
+    std::string listen_path;
+    std::string thread_sched_policy;
+    std::vector<uint32_t> thread_bind_cpu;
+    uint32_t max_frame_size = 64 * 1024 * 1024;
+    // Bytes queued on one connection but not sent yet, further frames fail beyond it, e.g. when
+    // the peer stops reading.
+    uint64_t max_write_buffer_size = 256 * 1024 * 1024;
+    std::vector<RemoteServiceOptions> remote_services;
+  };
+
+  enum class State : uint32_t {
+    kPreInit,
+    kInit,
+    kStart,
+    kShutdown,
+  };
+
+  using ResponseCallback = std::function<void(RpcStatus, std::string_view)>;
+  using ServeFunc = std::function<void(std::string_view, std::string_view, ResponseCallback&&)>;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  // Called on the io thread for every incoming request.
+  void RegisterServeFunc(ServeFunc&& serve_func) { serve_func_ = std::move(serve_func); }
+
+  void Initialize(YAML::Node options_node);
+  void Start();
+  void Shutdown();
+
+  State GetState() const { return state_.load(); }
+
+  bool HasRemoteService(std::string_view service_name) const {
+    return remote_service_map_.find(service_name) != remote_service_map_.end();
+  }
+
+  void Invoke(std::string_view service_name, std::string_view req_payload,
+              std::chrono::steady_clock::time_point deadline, ResponseCallback&& callback) noexcept;
+
+ private:
+  struct PendingRequest {
+    std::chrono::steady_clock::time_point deadline;
+    ResponseCallback callback;
+  };
+
+  struct Connection {
+    int fd = -1;
+    std::string read_buffer;
+
+    // Frames appended by any thread, swapped out and sent by the io thread.
+    std::mutex write_mutex;
+    std::string write_buffer;
+    bool dirty_flag = false;
+    bool closed_flag = false;
+    // Queued and not sent yet, including 'sending_buffer'.
+    std::atomic_uint64_t buffered_size = 0;
+
+    // Only touched by the io thread.
+    std::string sending_buffer;
+    size_t sending_offset = 0;
+    bool epollout_flag = false;
+
+    std::mutex pending_mutex;
+    std::unordered_map<uint32_t, PendingRequest> pending_map;
+  };
+
+  using ConnectionPtr = std::shared_ptr<Connection>;
+
+  void IoLoop();
+  void AcceptConnections();
+  ConnectionPtr GetClientConnection(const std::string& path);
+  void AddConnection(const ConnectionPtr& conn_ptr);
+  void CloseConnection(const ConnectionPtr& conn_ptr);
+  void ReadConnection(const ConnectionPtr& conn_ptr);
+  void HandleFrame(const ConnectionPtr& conn_ptr, uint8_t type, uint8_t status, uint32_t req_id,
+                   std::string_view service_name, std::string_view payload);
+  void FlushConnection(const ConnectionPtr& conn_ptr);
+  // Return false if the connection is closed or its write buffer is full.
+  bool EnqueueFrame(const ConnectionPtr& conn_ptr, uint8_t type, uint8_t status, uint32_t req_id,
+                    std::string_view service_name, std::string_view payload);
+  // Report the requests past their deadline and re-arm the timer on the earliest one left.
+  void SweepTimeoutRequests();
+  void ArmTimer(std::chrono::steady_clock::time_point deadline);
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  std::atomic<State> state_ = State::kPreInit;
+
+  ServeFunc serve_func_;
+  std::unordered_map<std::string, std::string, nxpilot::utils::common::StringHash,
+                     std::equal_to<>>
+      remote_service_map_;
+
+  int epoll_fd_ = -1;
+  int event_fd_ = -1;
+  int listen_fd_ = -1;
+  int timer_fd_ = -1;
+  std::unique_ptr<std::thread> io_thread_ptr_;
+
+  std::atomic_uint32_t req_id_ = 0;
+
+  // Held over a whole sweep, so a request added meanwhile is either swept or re-arms the timer.
+  std::mutex timer_mutex_;
+  std::chrono::steady_clock::time_point next_deadline_ =
+      std::chrono::steady_clock::time_point::max();
+
+  std::mutex conn_mutex_;
+  std::unordered_map<int, ConnectionPtr> conn_map_;
+  std::unordered_map<std::string, ConnectionPtr> client_conn_map_;
+
+  std::mutex dirty_mutex_;
+  std::vector<ConnectionPtr> dirty_conn_vec_;
+};
+
+}  // namespace nxpilot::runtime::core::rpc
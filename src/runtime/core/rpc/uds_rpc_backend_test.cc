@@ -0,0 +1,197 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <format>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include "runtime/core/rpc/rpc_manager.h"
+
+namespace nxpilot::runtime::core::rpc {
+
+// Fails to serialize on the server side.
+struct UdsThrowRsp {
+  int32_t value = 0;
+};
+
+}  // namespace nxpilot::runtime::core::rpc
+
+template <>
+struct nxpilot::utils::common::SerializationTraits<nxpilot::runtime::core::rpc::UdsThrowRsp> {
+  static void Serialize(const nxpilot::runtime::core::rpc::UdsThrowRsp& msg, std::string& buffer) {
+    buffer.append("partial");
+    throw std::runtime_error("serialize");
+  }
+
+  static bool Deserialize(std::string_view buffer, nxpilot::runtime::core::rpc::UdsThrowRsp& msg) {
+    return true;
+  }
+};
+
+namespace nxpilot::runtime::core::rpc {
+
+// With the pid, so concurrent runs of the test do not steal each other's sockets.
+const std::string kUdsRpcTestServerPath =
+    std::format("/tmp/nxpilot_uds_rpc_test_server_{}.sock", getpid());
+const std::string kUdsRpcTestBadPath =
+    std::format("/tmp/nxpilot_uds_rpc_test_not_exist_{}.sock", getpid());
+
+struct UdsTestReq {
+  int32_t value = 0;
+};
+
+struct UdsTestRsp {
+  int32_t value = 0;
+};
+
+class UdsRpcBackendTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    server_rpc_manager_.RegisterService<UdsTestReq, UdsTestRsp>(
+        "double", [](const std::shared_ptr<const UdsTestReq>& req,
+                     const std::shared_ptr<UdsTestRsp>& rsp, RpcDoneCallback&& done) {
+          rsp->value = req->value * 2;
+          done(RpcStatus());
+        });
+    server_rpc_manager_.RegisterService<UdsTestReq, UdsThrowRsp>(
+        "throw_serialize", [](const std::shared_ptr<const UdsTestReq>& req,
+                              const std::shared_ptr<UdsThrowRsp>& rsp,
+                              RpcDoneCallback&& done) { done(RpcStatus()); });
+    server_rpc_manager_.RegisterService<UdsTestReq, UdsTestRsp>(
+        "never_done", [this](const std::shared_ptr<const UdsTestReq>& req,
+                             const std::shared_ptr<UdsTestRsp>& rsp, RpcDoneCallback&& done) {
+          pending_done_ = std::move(done);
+        });
+
+    YAML::Node server_options;
+    server_options["uds"]["listen_path"] = kUdsRpcTestServerPath;
+    server_rpc_manager_.Initialize(server_options);
+    server_rpc_manager_.Start();
+
+    YAML::Node client_options;
+    YAML::Node remote_service;
+    remote_service["service"] = "double";
+    remote_service["path"] = kUdsRpcTestServerPath;
+    client_options["uds"]["remote_services"].push_back(remote_service);
+    YAML::Node throw_remote_service;
+    throw_remote_service["service"] = "throw_serialize";
+    throw_remote_service["path"] = kUdsRpcTestServerPath;
+    client_options["uds"]["remote_services"].push_back(throw_remote_service);
+    YAML::Node never_done_remote_service;
+    never_done_remote_service["service"] = "never_done";
+    never_done_remote_service["path"] = kUdsRpcTestServerPath;
+    client_options["uds"]["remote_services"].push_back(never_done_remote_service);
+    YAML::Node bad_remote_service;
+    bad_remote_service["service"] = "unreachable";
+    bad_remote_service["path"] = kUdsRpcTestBadPath;
+    client_options["uds"]["remote_services"].push_back(bad_remote_service);
+    client_rpc_manager_.Initialize(client_options);
+    client_rpc_manager_.Start();
+  }
+
+  void TearDown() override {
+    client_rpc_manager_.Shutdown();
+    server_rpc_manager_.Shutdown();
+  }
+
+  RpcManager server_rpc_manager_;
+  RpcManager client_rpc_manager_;
+  RpcDoneCallback pending_done_;
+};
+
+TEST_F(UdsRpcBackendTest, invoke_remote) {
+  auto req = std::make_shared<UdsTestReq>(UdsTestReq{.value = 21});
+  auto rsp = std::make_shared<UdsTestRsp>();
+
+  auto status =
+      client_rpc_manager_.InvokeAsFuture<UdsTestReq, UdsTestRsp>("double", req, rsp).get();
+  EXPECT_TRUE(status.OK()) << status.ToString();
+  EXPECT_EQ(rsp->value, 42);
+}
+
+TEST_F(UdsRpcBackendTest, invoke_remote_pipelined) {
+  constexpr int32_t kReqNum = 1000;
+
+  std::vector<std::shared_ptr<UdsTestRsp>> rsp_vec;
+  std::vector<std::future<RpcStatus>> future_vec;
+  for (int32_t ii = 0; ii < kReqNum; ++ii) {
+    auto req = std::make_shared<UdsTestReq>(UdsTestReq{.value = ii});
+    auto rsp = std::make_shared<UdsTestRsp>();
+    future_vec.emplace_back(
+        client_rpc_manager_.InvokeAsFuture<UdsTestReq, UdsTestRsp>("double", req, rsp));
+    rsp_vec.emplace_back(std::move(rsp));
+  }
+
+  for (int32_t ii = 0; ii < kReqNum; ++ii) {
+    EXPECT_TRUE(future_vec[ii].get().OK());
+    EXPECT_EQ(rsp_vec[ii]->value, ii * 2);
+  }
+}
+
+TEST_F(UdsRpcBackendTest, invoke_remote_serialize_error) {
+  auto req = std::make_shared<UdsTestReq>();
+  auto rsp = std::make_shared<UdsThrowRsp>();
+
+  auto future =
+      client_rpc_manager_.InvokeAsFuture<UdsTestReq, UdsThrowRsp>("throw_serialize", req, rsp);
+  ASSERT_EQ(future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+  EXPECT_EQ(future.get().Code(), RpcStatusCode::kSerializationFailed);
+}
+
+TEST_F(UdsRpcBackendTest, invoke_remote_timeout) {
+  auto req = std::make_shared<UdsTestReq>();
+  auto rsp = std::make_shared<UdsTestRsp>();
+
+  // No timeout executor is configured, the deadline is tracked by the backend itself.
+  const auto begin_time_point = std::chrono::steady_clock::now();
+  auto future = client_rpc_manager_.InvokeAsFuture<UdsTestReq, UdsTestRsp>(
+      "never_done", req, rsp, InvokeOptions{.timeout = std::chrono::milliseconds(20)});
+  ASSERT_EQ(future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+  EXPECT_EQ(future.get().Code(), RpcStatusCode::kTimeout);
+  EXPECT_GE(std::chrono::steady_clock::now() - begin_time_point, std::chrono::milliseconds(20));
+
+  // A shorter timeout issued later still fires first.
+  auto long_future = client_rpc_manager_.InvokeAsFuture<UdsTestReq, UdsTestRsp>(
+      "never_done", req, rsp, InvokeOptions{.timeout = std::chrono::seconds(10)});
+  auto short_future = client_rpc_manager_.InvokeAsFuture<UdsTestReq, UdsTestRsp>(
+      "never_done", req, rsp, InvokeOptions{.timeout = std::chrono::milliseconds(20)});
+  ASSERT_EQ(short_future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+  EXPECT_EQ(short_future.get().Code(), RpcStatusCode::kTimeout);
+  EXPECT_EQ(long_future.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout);
+}
+
+TEST_F(UdsRpcBackendTest, invoke_write_buffer_full) {
+  // The write buffer cannot even hold one frame, the request fails right away.
+  RpcManager rpc_manager;
+  YAML::Node options;
+  YAML::Node remote_service;
+  remote_service["service"] = "double";
+  remote_service["path"] = kUdsRpcTestServerPath;
+  options["uds"]["remote_services"].push_back(remote_service);
+  options["uds"]["max_write_buffer_size"] = 8;
+  rpc_manager.Initialize(options);
+  rpc_manager.Start();
+
+  auto req = std::make_shared<UdsTestReq>();
+  auto rsp = std::make_shared<UdsTestRsp>();
+  auto future = rpc_manager.InvokeAsFuture<UdsTestReq, UdsTestRsp>("double", req, rsp);
+  ASSERT_EQ(future.wait_for(std::chrono::milliseconds(0)), std::future_status::ready);
+  EXPECT_EQ(future.get().Code(), RpcStatusCode::kTransportError);
+  rpc_manager.Shutdown();
+}
+
+TEST_F(UdsRpcBackendTest, invoke_unreachable) {
+  auto req = std::make_shared<UdsTestReq>();
+  auto rsp = std::make_shared<UdsTestRsp>();
+
+  auto status =
+      client_rpc_manager_.InvokeAsFuture<UdsTestReq, UdsTestRsp>("unreachable", req, rsp).get();
+  EXPECT_EQ(status.Code(), RpcStatusCode::kTransportError);
+}
+
+}  // namespace nxpilot::runtime::core::rpc
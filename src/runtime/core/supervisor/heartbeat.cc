@@ -0,0 +1,149 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/supervisor/heartbeat.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <new>
+
+#include "utils/common/string_tool.h"
+
+namespace nxpilot::runtime::core::supervisor {
+
+void HeartbeatTable::Create(size_t slot_num) {
+  Destroy();
+  NXPILOT_CHECK_ERROR(slot_num > 0, "Heartbeat table requires at least one slot");
+
+  name_ = std::format("/nxpilot_heartbeat_{}_{}", getpid(), next_table_id_.fetch_add(1));
+  const size_t size = slot_num * sizeof(HeartbeatSlot);
+  int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  NXPILOT_CHECK_ERROR(fd >= 0, "Create heartbeat table '{}' get error, {}", name_,
+                      strerror(errno));
+  void* addr = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  const int err = errno;
+  close(fd);
+  if (addr == MAP_FAILED) {
+    shm_unlink(name_.c_str());
+    NXPILOT_CHECK_ERROR(false, "Map heartbeat table '{}' get error, {}", name_, strerror(err));
+  }
+
+  slot_ptr_ = new (addr) HeartbeatSlot[slot_num];
+  slot_num_ = slot_num;
+}
+
+void HeartbeatTable::Destroy() {
+  if (slot_ptr_ == nullptr) return;
+
+  munmap(slot_ptr_, slot_num_ * sizeof(HeartbeatSlot));
+  shm_unlink(name_.c_str());
+  slot_ptr_ = nullptr;
+  slot_num_ = 0;
+}
+
+bool HeartbeatSender::IsSupervised() { return getenv(kHeartbeatShmEnv) != nullptr; }
+
+void HeartbeatSender::Start(const GetExecutorFunc& get_executor_func) {
+  const char* shm_name = getenv(kHeartbeatShmEnv);
+  const char* slot_str = getenv(kHeartbeatSlotEnv);
+  NXPILOT_CHECK_ERROR(shm_name != nullptr && slot_str != nullptr,
+                      "HeartbeatSender requires env '{}' and '{}'", kHeartbeatShmEnv,
+                      kHeartbeatSlotEnv);
+  const size_t slot_idx = std::strtoull(slot_str, nullptr, 10);
+  if (const char* interval_str = getenv(kHeartbeatIntervalEnv)) {
+    const uint64_t interval_ms = std::strtoull(interval_str, nullptr, 10);
+    interval_ = std::chrono::milliseconds(std::max<uint64_t>(interval_ms, 1));
+  }
+
+  watched_executor_vec_.clear();
+  if (const char* executors_str = getenv(kHeartbeatExecutorsEnv)) {
+    for (const auto& name : nxpilot::utils::common::SplitToVec(executors_str, ',')) {
+      auto* executor_ptr = get_executor_func ? get_executor_func(name) : nullptr;
+      NXPILOT_CHECK_ERROR(executor_ptr != nullptr, "Invalid heartbeat executor '{}'", name);
+      watched_executor_vec_.emplace_back(
+          WatchedExecutor{.executor_ptr = executor_ptr,
+                          .probe_state_ptr = std::make_shared<ProbeState>()});
+    }
+  }
+
+  int fd = shm_open(shm_name, O_RDWR | O_CLOEXEC, 0);
+  NXPILOT_CHECK_ERROR(fd >= 0, "Open heartbeat table '{}' get error, {}", shm_name,
+                      strerror(errno));
+  struct stat shm_stat;
+  if (fstat(fd, &shm_stat) != 0 ||
+      static_cast<uint64_t>(shm_stat.st_size) < (slot_idx + 1) * sizeof(HeartbeatSlot)) {
+    close(fd);
+    NXPILOT_CHECK_ERROR(false, "Heartbeat table '{}' has no slot {}", shm_name, slot_idx);
+  }
+  map_size_ = shm_stat.st_size;
+  map_addr_ = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  NXPILOT_CHECK_ERROR(map_addr_ != MAP_FAILED, "Map heartbeat table '{}' get error, {}", shm_name,
+                      strerror(errno));
+  slot_ptr_ = static_cast<HeartbeatSlot*>(map_addr_) + slot_idx;
+
+  stop_flag_ = false;
+  thread_ptr_ = std::make_unique<std::thread>([this]() { BeatLoop(); });
+
+  NXPILOT_INFO("HeartbeatSender start, slot {} of '{}', every {} ms, {} watched executors",
+               slot_idx, shm_name, interval_.count(), watched_executor_vec_.size());
+}
+
+void HeartbeatSender::Stop() {
+  {
+    std::lock_guard<std::mutex> lck(stop_mutex_);
+    stop_flag_ = true;
+  }
+  stop_cond_.notify_all();
+
+  if (thread_ptr_ && thread_ptr_->joinable()) thread_ptr_->join();
+  thread_ptr_.reset();
+
+  if (map_addr_ != nullptr && map_addr_ != MAP_FAILED) munmap(map_addr_, map_size_);
+  map_addr_ = nullptr;
+  slot_ptr_ = nullptr;
+}
+
+void HeartbeatSender::BeatLoop() {
+  uint64_t round = 0;
+
+  std::unique_lock<std::mutex> lck(stop_mutex_);
+  while (!stop_flag_) {
+    const bool acked = std::ranges::all_of(watched_executor_vec_, [round](const auto& watched) {
+      return watched.probe_state_ptr->acked_round.load() == round;
+    });
+
+    if (acked) {
+      slot_ptr_->beat_ns.store(GetHeartbeatNowNs(), std::memory_order_release);
+      slot_ptr_->beat_num.fetch_add(1, std::memory_order_relaxed);
+      ++beat_num_;
+
+      ++round;
+      for (const auto& watched : watched_executor_vec_) {
+        auto probe = [probe_state_ptr = watched.probe_state_ptr, round]() {
+          probe_state_ptr->acked_round.store(round);
+        };
+        // Timer executors may not run plain tasks, e.g. the time wheel.
+        if (watched.executor_ptr->SupportTimerSchedule()) {
+          watched.executor_ptr->ExecuteAt(watched.executor_ptr->Now(), std::move(probe));
+        } else {
+          watched.executor_ptr->Execute(std::move(probe));
+        }
+      }
+    }
+
+    stop_cond_.wait_for(lck, interval_, [this]() { return stop_flag_; });
+  }
+}
+
+}  // namespace nxpilot::runtime::core::supervisor
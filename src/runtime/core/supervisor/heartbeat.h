@@ -0,0 +1,151 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "runtime/core/executor/executor_base.h"
+#include "utils/common/log_tool.h"
+
+namespace nxpilot::runtime::core::supervisor {
+
+// Environment of the processes launched by the supervisor, telling where and how often to beat.
+inline constexpr const char* kHeartbeatShmEnv = "NXPILOT_HEARTBEAT_SHM";
+inline constexpr const char* kHeartbeatSlotEnv = "NXPILOT_HEARTBEAT_SLOT";
+inline constexpr const char* kHeartbeatIntervalEnv = "NXPILOT_HEARTBEAT_INTERVAL_MS";
+inline constexpr const char* kHeartbeatExecutorsEnv = "NXPILOT_HEARTBEAT_EXECUTORS";
+
+/**
+ * @brief Heartbeat of one supervised process, in a shared memory table created by the supervisor.
+ *
+ * A beat is a plain atomic store, so neither side makes a syscall per beat. Slots get a cache line
+ * each, processes beating do not contend.
+ */
+struct alignas(64) HeartbeatSlot {
+  // Steady clock, which is CLOCK_MONOTONIC on Linux and so shared by all processes. 0 until the
+  // first beat.
+  std::atomic_uint64_t beat_ns = 0;
+  std::atomic_uint64_t beat_num = 0;
+};
+
+static_assert(std::atomic_uint64_t::is_always_lock_free,
+              "Heartbeat slots are shared between processes, they must be lock free");
+
+inline uint64_t GetHeartbeatNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief The shared memory table of heartbeat slots, owned by the supervisor.
+ *
+ * The table is a POSIX shared memory object named after the supervisor process, supervised
+ * processes map it by the name in their environment.
+ */
+class HeartbeatTable {
+ public:
+  HeartbeatTable() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~HeartbeatTable() { Destroy(); }
+
+  HeartbeatTable(const HeartbeatTable&) = delete;
+  HeartbeatTable& operator=(const HeartbeatTable&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  // Create a table of 'slot_num' zeroed slots under a new name.
+  void Create(size_t slot_num);
+  // Unmap and unlink the table, processes that have mapped it keep their mapping.
+  void Destroy();
+
+  const std::string& GetName() const { return name_; }
+  size_t GetSlotNum() const { return slot_num_; }
+  HeartbeatSlot& GetSlot(size_t idx) { return slot_ptr_[idx]; }
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  std::string name_;
+  HeartbeatSlot* slot_ptr_ = nullptr;
+  size_t slot_num_ = 0;
+
+  static inline std::atomic_uint32_t next_table_id_ = 0;
+};
+
+/**
+ * @brief Beat the heartbeat slot handed over by the supervisor, if the process was launched by
+ * one.
+ *
+ * Every interval a probe task is posted to each watched executor, the slot is only stamped once
+ * all probes of the previous round have run. So a process whose watched executors hang, or are
+ * flooded for longer than the supervisor timeout, stops beating and gets restarted. Without
+ * watched executors the beat only proves the process is scheduled.
+ */
+class HeartbeatSender {
+ public:
+  using GetExecutorFunc =
+      std::function<nxpilot::runtime::core::executor::ExecutorBase*(std::string_view)>;
+
+  HeartbeatSender() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~HeartbeatSender() { Stop(); }
+
+  HeartbeatSender(const HeartbeatSender&) = delete;
+  HeartbeatSender& operator=(const HeartbeatSender&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+  }
+
+  // Whether the environment carries a heartbeat slot.
+  static bool IsSupervised();
+
+  // Map the slot from the environment and start beating. Watched executors are looked up with
+  // 'get_executor_func', they must be started and outlive 'Stop'. Throw on an invalid environment.
+  void Start(const GetExecutorFunc& get_executor_func);
+  void Stop();
+
+  uint64_t GetBeatNum() const { return beat_num_.load(); }
+
+ private:
+  // Shared with the probe tasks, which may run after 'Stop'.
+  struct ProbeState {
+    std::atomic_uint64_t acked_round = 0;
+  };
+
+  struct WatchedExecutor {
+    nxpilot::runtime::core::executor::ExecutorBase* executor_ptr = nullptr;
+    std::shared_ptr<ProbeState> probe_state_ptr;
+  };
+
+  void BeatLoop();
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  std::chrono::milliseconds interval_ = std::chrono::milliseconds(100);
+  std::vector<WatchedExecutor> watched_executor_vec_;
+
+  HeartbeatSlot* slot_ptr_ = nullptr;
+  void* map_addr_ = nullptr;
+  size_t map_size_ = 0;
+
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cond_;
+  bool stop_flag_ = false;
+  std::unique_ptr<std::thread> thread_ptr_;
+
+  std::atomic_uint64_t beat_num_ = 0;
+};
+
+}  // namespace nxpilot::runtime::core::supervisor
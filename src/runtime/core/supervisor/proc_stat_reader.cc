@@ -0,0 +1,111 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/supervisor/proc_stat_reader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace nxpilot::runtime::core::supervisor {
+
+namespace {
+
+// Fields of /proc/<pid>/stat, counted from 1, see proc(5).
+constexpr uint32_t kStatUtimeField = 14;
+constexpr uint32_t kStatStimeField = 15;
+constexpr uint32_t kStatThreadNumField = 20;
+constexpr uint32_t kStatRssField = 24;
+
+uint64_t GetStatusValue(const char* status, const char* key) {
+  const char* pos = strstr(status, key);
+  return pos ? std::strtoull(pos + strlen(key), nullptr, 10) : 0;
+}
+
+}  // namespace
+
+bool ProcStatReader::Open(pid_t pid) {
+  Close();
+
+  const std::string proc_dir = "/proc/" + std::to_string(pid);
+  stat_fd_ = ::open((proc_dir + "/stat").c_str(), O_RDONLY | O_CLOEXEC);
+  if (stat_fd_ < 0) return false;
+
+  int task_fd = ::open((proc_dir + "/task").c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (task_fd >= 0) task_dir_ptr_ = fdopendir(task_fd);
+  if (task_dir_ptr_ == nullptr) {
+    if (task_fd >= 0) close(task_fd);
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void ProcStatReader::Close() {
+  if (task_dir_ptr_ != nullptr) closedir(task_dir_ptr_);
+  task_dir_ptr_ = nullptr;
+  if (stat_fd_ >= 0) close(stat_fd_);
+  stat_fd_ = -1;
+}
+
+bool ProcStatReader::Read(ProcessStat& stat) {
+  if (stat_fd_ < 0) return false;
+
+  const ssize_t stat_size = pread(stat_fd_, buffer_.data(), kBufferSize - 1, 0);
+  if (stat_size <= 0) return false;
+  buffer_[stat_size] = '\0';
+
+  // The command name, the 2nd field, may hold spaces and parentheses.
+  const char* pos = strrchr(buffer_.data(), ')');
+  if (pos == nullptr) return false;
+  ++pos;
+
+  uint64_t utime_ticks = 0, stime_ticks = 0, thread_num = 0, rss_pages = 0;
+  for (uint32_t field = 3; field <= kStatRssField; ++field) {
+    while (*pos == ' ') ++pos;
+    if (*pos == '\0') return false;
+
+    if (field == kStatUtimeField) utime_ticks = std::strtoull(pos, nullptr, 10);
+    if (field == kStatStimeField) stime_ticks = std::strtoull(pos, nullptr, 10);
+    if (field == kStatThreadNumField) thread_num = std::strtoull(pos, nullptr, 10);
+    if (field == kStatRssField) rss_pages = std::strtoull(pos, nullptr, 10);
+
+    while (*pos != ' ' && *pos != '\0') ++pos;
+  }
+
+  static const uint64_t kClockTicksPerSecond = sysconf(_SC_CLK_TCK);
+  static const uint64_t kPageSize = sysconf(_SC_PAGESIZE);
+  stat.cpu_time_ns = (utime_ticks + stime_ticks) * 1000000000 / kClockTicksPerSecond;
+  stat.rss_bytes = rss_pages * kPageSize;
+  stat.thread_num = static_cast<uint32_t>(thread_num);
+
+  // The counts in /proc/<pid>/status are of the main thread only, so sum the threads.
+  stat.voluntary_ctx_switch_num = 0;
+  stat.involuntary_ctx_switch_num = 0;
+  rewinddir(task_dir_ptr_);
+  const int task_fd = dirfd(task_dir_ptr_);
+  while (const dirent* entry_ptr = readdir(task_dir_ptr_)) {
+    if (entry_ptr->d_name[0] < '0' || entry_ptr->d_name[0] > '9') continue;
+
+    char path[sizeof(entry_ptr->d_name) + 8];
+    snprintf(path, sizeof(path), "%s/status", entry_ptr->d_name);
+    int fd = openat(task_fd, path, O_RDONLY | O_CLOEXEC);
+    // The thread has exited meanwhile.
+    if (fd < 0) continue;
+    const ssize_t status_size = read(fd, buffer_.data(), kBufferSize - 1);
+    close(fd);
+    if (status_size <= 0) continue;
+    buffer_[status_size] = '\0';
+
+    stat.voluntary_ctx_switch_num += GetStatusValue(buffer_.data(), "\nvoluntary_ctxt_switches:");
+    stat.involuntary_ctx_switch_num +=
+        GetStatusValue(buffer_.data(), "\nnonvoluntary_ctxt_switches:");
+  }
+
+  return true;
+}
+
+}  // namespace nxpilot::runtime::core::supervisor
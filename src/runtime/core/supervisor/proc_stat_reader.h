@@ -0,0 +1,58 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <dirent.h>
+#include <sys/types.h>
+
+#include <array>
+#include <cstdint>
+
+namespace nxpilot::runtime::core::supervisor {
+
+// Resource usage of a process, summed over its threads.
+struct ProcessStat {
+  uint64_t cpu_time_ns = 0;  // user + system
+  uint64_t rss_bytes = 0;
+  uint32_t thread_num = 0;
+  // Only counts the threads alive at the time of the read.
+  uint64_t voluntary_ctx_switch_num = 0;
+  uint64_t involuntary_ctx_switch_num = 0;
+};
+
+/**
+ * @brief Sample the resource usage of a process from /proc, cheaply enough to run at 10 Hz for a
+ * handful of processes.
+ *
+ * The stat file and the task directory stay open between reads, a read is a 'pread' of the stat
+ * file plus an 'openat' and a 'read' of the status file of each thread, nothing is allocated. The
+ * open files pin the process: once it exits, reads fail even if its pid has been reused.
+ */
+class ProcStatReader {
+ public:
+  ProcStatReader() = default;
+  ~ProcStatReader() { Close(); }
+
+  ProcStatReader(const ProcStatReader&) = delete;
+  ProcStatReader& operator=(const ProcStatReader&) = delete;
+
+  // Return false if the process does not exist.
+  bool Open(pid_t pid);
+  void Close();
+
+  bool IsOpen() const { return stat_fd_ >= 0; }
+
+  // Return false if the process has exited.
+  bool Read(ProcessStat& stat);
+
+ private:
+  // Holds /proc/<pid>/stat, and a whole /proc/<pid>/task/<tid>/status, the context switch counts
+  // are at its end.
+  static constexpr size_t kBufferSize = 4096;
+
+  int stat_fd_ = -1;
+  DIR* task_dir_ptr_ = nullptr;
+  std::array<char, kBufferSize> buffer_;
+};
+
+}  // namespace nxpilot::runtime::core::supervisor
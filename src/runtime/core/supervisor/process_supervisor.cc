@@ -0,0 +1,477 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/supervisor/process_supervisor.h"
+
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "runtime/core/configurator/options_checker.h"
+#include "runtime/core/metrics/metrics_registry.h"
+
+extern char** environ;
+
+namespace YAML {
+template <>
+struct convert<nxpilot::runtime::core::supervisor::ProcessSupervisor::Options> {
+  using Options = nxpilot::runtime::core::supervisor::ProcessSupervisor::Options;
+
+  static Node encode(const Options& rhs) {
+    Node node;
+    node["processes"] = YAML::Node();
+    for (const auto& process_options : rhs.processes) {
+      Node process_node;
+      process_node["name"] = process_options.name;
+      process_node["cmd"] = process_options.cmd;
+      process_node["env"] = process_options.env;
+      process_node["heartbeat_executors"] = process_options.heartbeat_executors;
+      process_node["heartbeat_interval_ms"] = process_options.heartbeat_interval_ms;
+      process_node["heartbeat_timeout_ms"] = process_options.heartbeat_timeout_ms;
+      process_node["startup_timeout_ms"] = process_options.startup_timeout_ms;
+      process_node["stop_timeout_ms"] = process_options.stop_timeout_ms;
+      process_node["restart_delay_ms"] = process_options.restart_delay_ms;
+      process_node["max_restart_num"] = process_options.max_restart_num;
+      node["processes"].push_back(process_node);
+    }
+    node["tick_interval_ms"] = rhs.tick_interval_ms;
+    node["executor"] = rhs.executor;
+    return node;
+  }
+
+  static bool decode(const Node& node, Options& rhs) {
+    if (!node.IsMap()) return false;
+
+    if (node["processes"] && node["processes"].IsSequence()) {
+      for (const auto& process_node : node["processes"]) {
+        auto process_options =
+            Options::ProcessOptions{.name = process_node["name"].as<std::string>()};
+
+        if (process_node["cmd"])
+          process_options.cmd = process_node["cmd"].as<std::vector<std::string>>();
+        if (process_node["env"])
+          process_options.env = process_node["env"].as<std::vector<std::string>>();
+        if (process_node["heartbeat_executors"])
+          process_options.heartbeat_executors =
+              process_node["heartbeat_executors"].as<std::vector<std::string>>();
+        if (process_node["heartbeat_interval_ms"])
+          process_options.heartbeat_interval_ms =
+              process_node["heartbeat_interval_ms"].as<uint32_t>();
+        if (process_node["heartbeat_timeout_ms"])
+          process_options.heartbeat_timeout_ms =
+              process_node["heartbeat_timeout_ms"].as<uint32_t>();
+        if (process_node["startup_timeout_ms"])
+          process_options.startup_timeout_ms = process_node["startup_timeout_ms"].as<uint32_t>();
+        if (process_node["stop_timeout_ms"])
+          process_options.stop_timeout_ms = process_node["stop_timeout_ms"].as<uint32_t>();
+        if (process_node["restart_delay_ms"])
+          process_options.restart_delay_ms = process_node["restart_delay_ms"].as<uint32_t>();
+        if (process_node["max_restart_num"])
+          process_options.max_restart_num = process_node["max_restart_num"].as<uint32_t>();
+
+        rhs.processes.emplace_back(std::move(process_options));
+      }
+    }
+    if (node["tick_interval_ms"]) rhs.tick_interval_ms = node["tick_interval_ms"].as<uint32_t>();
+    if (node["executor"]) rhs.executor = node["executor"].as<std::string>();
+
+    return true;
+  }
+};
+}  // namespace YAML
+
+namespace nxpilot::runtime::core::supervisor {
+
+namespace {
+
+std::string GetExitReason(int status) {
+  if (WIFEXITED(status)) return "exit code " + std::to_string(WEXITSTATUS(status));
+  if (WIFSIGNALED(status)) return std::string("signal ") + strsignal(WTERMSIG(status));
+  return "unknown status";
+}
+
+}  // namespace
+
+std::string_view ProcessSupervisor::GetProcessStateName(ProcessState state) {
+  switch (state) {
+    case ProcessState::kStopped:
+      return "stopped";
+    case ProcessState::kRunning:
+      return "running";
+    case ProcessState::kStopping:
+      return "stopping";
+    case ProcessState::kBackoff:
+      return "backoff";
+    case ProcessState::kFailed:
+      return "failed";
+  }
+  return "unknown";
+}
+
+void ProcessSupervisor::Initialize(YAML::Node options_node) {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kInit) == State::kPreInit,
+                      "ProcessSupervisor can only be initialized once.");
+
+  auto err = configurator::CheckOptionsKeys(options_node,
+                                            {"processes", "tick_interval_ms", "executor"});
+  NXPILOT_CHECK_ERROR(err.empty(), "Invalid supervisor options, {}", err);
+  if (options_node.IsMap() && options_node["processes"] &&
+      options_node["processes"].IsSequence()) {
+    for (const auto& process_node : options_node["processes"]) {
+      err = configurator::CheckOptionsKeys(
+          process_node, {"name", "cmd", "env", "heartbeat_executors", "heartbeat_interval_ms",
+                         "heartbeat_timeout_ms", "startup_timeout_ms", "stop_timeout_ms",
+                         "restart_delay_ms", "max_restart_num"});
+      NXPILOT_CHECK_ERROR(err.empty(), "Invalid supervisor process options, {}", err);
+    }
+  }
+
+  if (options_node && !options_node.IsNull()) {
+    options_ = options_node.as<Options>();
+  }
+  NXPILOT_CHECK_ERROR(options_.tick_interval_ms > 0, "Supervisor 'tick_interval_ms' is 0");
+
+  NXPILOT_CHECK_ERROR(get_executor_func_, "ProcessSupervisor requires a get executor func.");
+  executor_ptr_ = get_executor_func_(options_.executor);
+  NXPILOT_CHECK_ERROR(executor_ptr_ != nullptr && executor_ptr_->ThreadSafe() &&
+                          executor_ptr_->SupportTimerSchedule(),
+                      "Invalid supervisor executor '{}', it must be a thread safe timer executor",
+                      options_.executor);
+
+  for (const auto& process_options : options_.processes) {
+    NXPILOT_CHECK_ERROR(!process_options.cmd.empty(), "Process '{}' has no 'cmd'",
+                        process_options.name);
+    NXPILOT_CHECK_ERROR(
+        std::ranges::count(options_.processes, process_options.name,
+                           &Options::ProcessOptions::name) == 1,
+        "Duplicate process name '{}'", process_options.name);
+  }
+
+  if (!options_.processes.empty()) heartbeat_table_.Create(options_.processes.size());
+  for (size_t ii = 0; ii < options_.processes.size(); ++ii) {
+    auto process_ptr = std::make_unique<Process>();
+    process_ptr->options = options_.processes[ii];
+    process_ptr->slot_ptr = &heartbeat_table_.GetSlot(ii);
+    process_ptr->status.name = process_ptr->options.name;
+    process_vec_.emplace_back(std::move(process_ptr));
+  }
+
+  NXPILOT_INFO("ProcessSupervisor init completed, {} processes, heartbeat table '{}'",
+               process_vec_.size(), heartbeat_table_.GetName());
+}
+
+void ProcessSupervisor::Start() {
+  NXPILOT_CHECK_ERROR(std::atomic_exchange(&state_, State::kStart) == State::kInit,
+                      "ProcessSupervisor can only run when state is 'Init'.");
+
+  std::lock_guard<std::mutex> lck(mutex_);
+  const auto now = std::chrono::steady_clock::now();
+  for (auto& process_ptr : process_vec_) LaunchLocked(*process_ptr, now);
+
+  next_tick_tp_ = executor_ptr_->Now();
+  ScheduleTickLocked();
+
+  metrics_collector_id_ = nxpilot::runtime::core::metrics::GetMetricsRegistry().RegisterCollector(
+      [this](nxpilot::runtime::core::metrics::MetricWriter& writer) { CollectMetrics(writer); });
+
+  NXPILOT_INFO("ProcessSupervisor start completed");
+}
+
+void ProcessSupervisor::Shutdown() {
+  if (std::atomic_exchange(&state_, State::kShutdown) != State::kStart) {
+    heartbeat_table_.Destroy();
+    return;
+  }
+
+  // Not under 'mutex_', the collector takes it.
+  nxpilot::runtime::core::metrics::GetMetricsRegistry().UnregisterCollector(metrics_collector_id_);
+
+  std::lock_guard<std::mutex> lck(mutex_);
+  auto now = std::chrono::steady_clock::now();
+  for (auto& process_ptr : process_vec_) {
+    auto& process = *process_ptr;
+    if (process.status.state == ProcessState::kRunning) {
+      SignalLocked(process, SIGTERM);
+      process.status.state = ProcessState::kStopping;
+      process.state_tp = now;
+    } else if (process.status.state == ProcessState::kBackoff) {
+      process.status.state = ProcessState::kStopped;
+    }
+  }
+
+  // Processes stop in parallel, each within its own timeout.
+  while (true) {
+    now = std::chrono::steady_clock::now();
+    bool stopping = false;
+    for (auto& process_ptr : process_vec_) {
+      auto& process = *process_ptr;
+      if (process.status.state != ProcessState::kStopping) continue;
+      if (ReapLocked(process)) {
+        process.status.state = ProcessState::kStopped;
+        continue;
+      }
+      if (!process.killed_flag &&
+          now - process.state_tp > std::chrono::milliseconds(process.options.stop_timeout_ms)) {
+        NXPILOT_WARN("Process '{}' did not stop in {} ms, kill it", process.options.name,
+                     process.options.stop_timeout_ms);
+        SignalLocked(process, SIGKILL);
+        process.killed_flag = true;
+      }
+      stopping = true;
+    }
+    if (!stopping) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  heartbeat_table_.Destroy();
+  NXPILOT_INFO("ProcessSupervisor shutdown");
+}
+
+std::vector<ProcessSupervisor::ProcessStatus> ProcessSupervisor::GetProcessStatus() const {
+  std::lock_guard<std::mutex> lck(mutex_);
+  std::vector<ProcessStatus> status_vec;
+  status_vec.reserve(process_vec_.size());
+  for (const auto& process_ptr : process_vec_) status_vec.emplace_back(process_ptr->status);
+  return status_vec;
+}
+
+void ProcessSupervisor::ScheduleTickLocked() {
+  // Keep the period, unless the ticks have fallen behind.
+  next_tick_tp_ += std::chrono::milliseconds(options_.tick_interval_ms);
+  next_tick_tp_ = std::max(next_tick_tp_, executor_ptr_->Now());
+  executor_ptr_->ExecuteAt(next_tick_tp_, [this]() { Tick(); });
+}
+
+void ProcessSupervisor::Tick() {
+  std::lock_guard<std::mutex> lck(mutex_);
+  if (state_.load() != State::kStart) return;
+
+  const auto now = std::chrono::steady_clock::now();
+  for (auto& process_ptr : process_vec_) TickLocked(*process_ptr, now);
+
+  ScheduleTickLocked();
+}
+
+void ProcessSupervisor::TickLocked(Process& process, std::chrono::steady_clock::time_point now) {
+  const auto& options = process.options;
+  auto& status = process.status;
+
+  switch (status.state) {
+    case ProcessState::kRunning: {
+      if (ReapLocked(process)) {
+        RestartLocked(process, now);
+        break;
+      }
+
+      const uint64_t beat_ns = process.slot_ptr->beat_ns.load(std::memory_order_acquire);
+      const uint64_t now_ns = GetHeartbeatNowNs();
+      status.beat_age = std::chrono::duration_cast<std::chrono::milliseconds>(
+          beat_ns == 0 ? now - process.state_tp
+                       : std::chrono::nanoseconds(now_ns - std::min(beat_ns, now_ns)));
+      const uint32_t timeout_ms =
+          (beat_ns == 0) ? options.startup_timeout_ms : options.heartbeat_timeout_ms;
+      if (options.heartbeat_timeout_ms > 0 && status.beat_age.count() > timeout_ms) {
+        NXPILOT_WARN("Process '{}' (pid {}) has not beaten for {} ms, stop it", options.name,
+                     status.pid, status.beat_age.count());
+        SignalLocked(process, SIGTERM);
+        status.state = ProcessState::kStopping;
+        process.state_tp = now;
+        break;
+      }
+
+      SampleLocked(process, now);
+      break;
+    }
+    case ProcessState::kStopping: {
+      if (ReapLocked(process)) {
+        RestartLocked(process, now);
+        break;
+      }
+      if (!process.killed_flag &&
+          now - process.state_tp > std::chrono::milliseconds(options.stop_timeout_ms)) {
+        NXPILOT_WARN("Process '{}' (pid {}) did not stop in {} ms, kill it", options.name,
+                     status.pid, options.stop_timeout_ms);
+        SignalLocked(process, SIGKILL);
+        process.killed_flag = true;
+      }
+      break;
+    }
+    case ProcessState::kBackoff: {
+      if (now - process.state_tp >= std::chrono::milliseconds(options.restart_delay_ms)) {
+        ++status.restart_num;
+        LaunchLocked(process, now);
+      }
+      break;
+    }
+    case ProcessState::kStopped:
+    case ProcessState::kFailed:
+      break;
+  }
+}
+
+void ProcessSupervisor::LaunchLocked(Process& process, std::chrono::steady_clock::time_point now) {
+  const auto& options = process.options;
+  auto& status = process.status;
+
+  std::vector<char*> argv;
+  for (const auto& arg : options.cmd) argv.emplace_back(const_cast<char*>(arg.c_str()));
+  argv.emplace_back(nullptr);
+
+  const size_t slot_idx = process.slot_ptr - &heartbeat_table_.GetSlot(0);
+  std::vector<std::string> extra_env_vec = options.env;
+  extra_env_vec.emplace_back(std::string(kHeartbeatShmEnv) + "=" + heartbeat_table_.GetName());
+  extra_env_vec.emplace_back(std::string(kHeartbeatSlotEnv) + "=" + std::to_string(slot_idx));
+  extra_env_vec.emplace_back(std::string(kHeartbeatIntervalEnv) + "=" +
+                             std::to_string(options.heartbeat_interval_ms));
+  std::string executors_env = std::string(kHeartbeatExecutorsEnv) + "=";
+  for (size_t ii = 0; ii < options.heartbeat_executors.size(); ++ii) {
+    executors_env += (ii == 0 ? "" : ",") + options.heartbeat_executors[ii];
+  }
+  extra_env_vec.emplace_back(std::move(executors_env));
+
+  // Entries of the supervisor environment are overridden by the extra ones with the same key.
+  std::vector<char*> envp;
+  for (char** env = environ; env != nullptr && *env != nullptr; ++env) {
+    std::string_view entry(*env);
+    const auto key = entry.substr(0, entry.find('=') + 1);
+    if (std::ranges::none_of(extra_env_vec,
+                             [key](const auto& extra) { return extra.starts_with(key); })) {
+      envp.emplace_back(*env);
+    }
+  }
+  for (const auto& extra : extra_env_vec) envp.emplace_back(const_cast<char*>(extra.c_str()));
+  envp.emplace_back(nullptr);
+
+  // A process group of its own, so that its children are signaled with it, with the default
+  // signal handling and mask whatever the supervisor uses.
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+  posix_spawnattr_setflags(&attr,
+                           POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+  posix_spawnattr_setpgroup(&attr, 0);
+  sigset_t sig_set;
+  sigemptyset(&sig_set);
+  posix_spawnattr_setsigmask(&attr, &sig_set);
+  sigfillset(&sig_set);
+  posix_spawnattr_setsigdefault(&attr, &sig_set);
+
+  process.slot_ptr->beat_ns.store(0);
+  process.slot_ptr->beat_num.store(0);
+  process.killed_flag = false;
+  process.state_tp = now;
+  status.beat_age = std::chrono::milliseconds(0);
+
+  pid_t pid = 0;
+  const int ret = posix_spawnp(&pid, argv[0], nullptr, &attr, argv.data(), envp.data());
+  posix_spawnattr_destroy(&attr);
+  if (ret != 0) {
+    NXPILOT_ERROR("Launch process '{}' get error, {}", options.name, strerror(ret));
+    status.pid = 0;
+    RestartLocked(process, now);
+    return;
+  }
+
+  status.pid = pid;
+  status.state = ProcessState::kRunning;
+  process.stat_reader.Open(pid);
+  process.sample_tp = now;
+  status.stat = ProcessStat{};
+  process.stat_reader.Read(status.stat);
+
+  NXPILOT_INFO("Process '{}' launched, pid {}, restart num {}", options.name, pid,
+               status.restart_num);
+}
+
+void ProcessSupervisor::SignalLocked(Process& process, int sig) {
+  if (process.status.pid > 0) kill(-process.status.pid, sig);
+}
+
+bool ProcessSupervisor::ReapLocked(Process& process) {
+  auto& status = process.status;
+  int wait_status = 0;
+  const pid_t ret = waitpid(status.pid, &wait_status, WNOHANG);
+  if (ret == 0) return false;
+
+  if (ret == status.pid) {
+    NXPILOT_WARN("Process '{}' (pid {}) exited, {}", process.options.name, status.pid,
+                 GetExitReason(wait_status));
+  }
+  // Children it left in its group would hold on to its resources.
+  SignalLocked(process, SIGKILL);
+  process.stat_reader.Close();
+  status.pid = 0;
+  return true;
+}
+
+void ProcessSupervisor::RestartLocked(Process& process, std::chrono::steady_clock::time_point now) {
+  auto& status = process.status;
+  process.state_tp = now;
+  status.cpu_usage = 0;
+  status.voluntary_ctx_switch_rate = 0;
+  status.involuntary_ctx_switch_rate = 0;
+
+  const uint32_t max_restart_num = process.options.max_restart_num;
+  if (max_restart_num > 0 && status.restart_num >= max_restart_num) {
+    NXPILOT_ERROR("Process '{}' is out of restarts after {}, give up", process.options.name,
+                  status.restart_num);
+    status.state = ProcessState::kFailed;
+    return;
+  }
+  status.state = ProcessState::kBackoff;
+}
+
+void ProcessSupervisor::SampleLocked(Process& process, std::chrono::steady_clock::time_point now) {
+  auto& status = process.status;
+  ProcessStat stat;
+  if (!process.stat_reader.Read(stat)) return;
+
+  const double elapsed_s = std::chrono::duration<double>(now - process.sample_tp).count();
+  if (elapsed_s > 0) {
+    auto get_rate = [elapsed_s](uint64_t cur, uint64_t prev) {
+      // Counts of exited threads are lost, the sum may go backwards.
+      return cur > prev ? static_cast<double>(cur - prev) / elapsed_s : 0.0;
+    };
+    status.cpu_usage = get_rate(stat.cpu_time_ns, status.stat.cpu_time_ns) / 1e9;
+    status.voluntary_ctx_switch_rate =
+        get_rate(stat.voluntary_ctx_switch_num, status.stat.voluntary_ctx_switch_num);
+    status.involuntary_ctx_switch_rate =
+        get_rate(stat.involuntary_ctx_switch_num, status.stat.involuntary_ctx_switch_num);
+  }
+  status.stat = stat;
+  process.sample_tp = now;
+}
+
+void ProcessSupervisor::CollectMetrics(
+    nxpilot::runtime::core::metrics::MetricWriter& writer) const {
+  for (const auto& status : GetProcessStatus()) {
+    const nxpilot::runtime::core::metrics::MetricLabels labels{{"process", status.name}};
+    writer.AddGauge("nxpilot_process_up", "1 if the supervised process is running.", labels,
+                    status.state == ProcessState::kRunning ? 1 : 0);
+    writer.AddCounter("nxpilot_process_restarts_total", "Restarts of the supervised process.",
+                      labels, status.restart_num);
+    if (status.state != ProcessState::kRunning) continue;
+
+    writer.AddGauge("nxpilot_process_cpu_usage", "CPU usage of the process, in cores.", labels,
+                    status.cpu_usage);
+    writer.AddGauge("nxpilot_process_rss_bytes", "Resident memory of the process.", labels,
+                    static_cast<double>(status.stat.rss_bytes));
+    writer.AddGauge("nxpilot_process_threads", "Threads of the process.", labels,
+                    static_cast<double>(status.stat.thread_num));
+    writer.AddGauge("nxpilot_process_heartbeat_age_seconds",
+                    "Time since the last heartbeat of the process.", labels,
+                    std::chrono::duration<double>(status.beat_age).count());
+    const std::string_view ctx_switch_help = "Context switches of the current process instance.";
+    writer.AddCounter("nxpilot_process_ctx_switches_total", ctx_switch_help,
+                      {{"process", status.name}, {"kind", "voluntary"}},
+                      static_cast<double>(status.stat.voluntary_ctx_switch_num));
+    writer.AddCounter("nxpilot_process_ctx_switches_total", ctx_switch_help,
+                      {{"process", status.name}, {"kind", "involuntary"}},
+                      static_cast<double>(status.stat.involuntary_ctx_switch_num));
+  }
+}
+
+}  // namespace nxpilot::runtime::core::supervisor
@@ -0,0 +1,167 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "runtime/core/executor/executor_base.h"
+#include "runtime/core/metrics/metrics_registry.h"
+#include "runtime/core/supervisor/heartbeat.h"
+#include "runtime/core/supervisor/proc_stat_reader.h"
+#include "utils/common/log_tool.h"
+#include "yaml-cpp/yaml.h"
+
+namespace nxpilot::runtime::core::supervisor {
+
+/**
+ * @brief Launch the configured processes, keep them alive and sample their resource usage.
+ *
+ * Driven by ticks of a timer executor. Each tick reaps exited processes, checks the heartbeat of
+ * the running ones, see 'HeartbeatSender', and samples them from /proc. A process is restarted
+ * when it exits, or when it has not beaten for 'heartbeat_timeout_ms': it gets SIGTERM, then
+ * SIGKILL after 'stop_timeout_ms'. So a hung process runs again at most 'heartbeat_timeout_ms' +
+ * 'stop_timeout_ms' + 'restart_delay_ms' + 3 ticks after its last beat. Each process is launched
+ * in a process group of its own, the signals go to the whole group.
+ */
+class ProcessSupervisor {
+ public:
+  struct Options {
+    struct ProcessOptions {
+      std::string name;
+      // The first one is searched in PATH.
+      std::vector<std::string> cmd;
+      // Extra 'KEY=VALUE' entries on top of the supervisor environment.
+      std::vector<std::string> env;
+      // Executors of the process that must run a probe between beats, see 'HeartbeatSender'.
+      std::vector<std::string> heartbeat_executors;
+      uint32_t heartbeat_interval_ms = 100;
+      // 0 for processes that do not beat, they are only restarted when they exit.
+      uint32_t heartbeat_timeout_ms = 1000;
+      // Time allowed to the first beat, to cover the init of the process.
+      uint32_t startup_timeout_ms = 10000;
+      uint32_t stop_timeout_ms = 1000;
+      uint32_t restart_delay_ms = 100;
+      // Give up after this many restarts, 0 means never.
+      uint32_t max_restart_num = 0;
+    };
+    std::vector<ProcessOptions> processes;
+    uint32_t tick_interval_ms = 100;
+    // A thread safe timer executor running the ticks.
+    std::string executor;
+  };
+
+  enum class State : uint32_t {
+    kPreInit,
+    kInit,
+    kStart,
+    kShutdown,
+  };
+
+  enum class ProcessState : uint32_t {
+    kStopped,
+    kRunning,
+    // Signaled, waiting for it to exit.
+    kStopping,
+    // Waiting for the restart delay.
+    kBackoff,
+    // Out of restarts.
+    kFailed,
+  };
+
+  struct ProcessStatus {
+    std::string name;
+    ProcessState state = ProcessState::kStopped;
+    pid_t pid = 0;
+    uint32_t restart_num = 0;
+    // Time since the last beat, or since the launch before the first one.
+    std::chrono::milliseconds beat_age = std::chrono::milliseconds(0);
+    // Of the last sample. Rates are over the last tick, 'cpu_usage' in cores, e.g. 1.5.
+    ProcessStat stat;
+    double cpu_usage = 0;
+    double voluntary_ctx_switch_rate = 0;
+    double involuntary_ctx_switch_rate = 0;
+  };
+
+  using GetExecutorFunc =
+      std::function<nxpilot::runtime::core::executor::ExecutorBase*(std::string_view)>;
+
+  static std::string_view GetProcessStateName(ProcessState state);
+
+  ProcessSupervisor() : logger_ptr_(std::make_shared<nxpilot::utils::common::Logger>()) {}
+  ~ProcessSupervisor() { Shutdown(); }
+
+  ProcessSupervisor(const ProcessSupervisor&) = delete;
+  ProcessSupervisor& operator=(const ProcessSupervisor&) = delete;
+
+  const nxpilot::utils::common::Logger& GetLogger() const { return *logger_ptr_; }
+  void SetLogger(const std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr) {
+    logger_ptr_ = logger_ptr;
+    heartbeat_table_.SetLogger(logger_ptr);
+  }
+
+  void RegisterGetExecutorFunc(GetExecutorFunc&& get_executor_func) {
+    get_executor_func_ = std::move(get_executor_func);
+  }
+
+  void Initialize(YAML::Node options_node);
+  // Launch all processes.
+  void Start();
+  // Stop all processes, SIGKILL the ones still running after their 'stop_timeout_ms'.
+  void Shutdown();
+
+  State GetState() const { return state_.load(); }
+
+  std::vector<ProcessStatus> GetProcessStatus() const;
+
+ private:
+  struct Process {
+    Options::ProcessOptions options;
+    HeartbeatSlot* slot_ptr = nullptr;
+    ProcStatReader stat_reader;
+    // Entered the current state at.
+    std::chrono::steady_clock::time_point state_tp;
+    std::chrono::steady_clock::time_point sample_tp;
+    bool killed_flag = false;
+    ProcessStatus status;
+  };
+
+  // The 'Locked' methods are called with 'mutex_' held.
+  void ScheduleTickLocked();
+  void Tick();
+  void TickLocked(Process& process, std::chrono::steady_clock::time_point now);
+  void LaunchLocked(Process& process, std::chrono::steady_clock::time_point now);
+  // Send 'sig' to the process group.
+  void SignalLocked(Process& process, int sig);
+  // Return true if the process has exited, and reap it.
+  bool ReapLocked(Process& process);
+  void RestartLocked(Process& process, std::chrono::steady_clock::time_point now);
+  void SampleLocked(Process& process, std::chrono::steady_clock::time_point now);
+  // Export the process status on scrapes, see 'MetricsRegistry::RegisterCollector'.
+  void CollectMetrics(nxpilot::runtime::core::metrics::MetricWriter& writer) const;
+
+ private:
+  std::shared_ptr<nxpilot::utils::common::Logger> logger_ptr_;
+  Options options_;
+  std::atomic<State> state_ = State::kPreInit;
+
+  GetExecutorFunc get_executor_func_;
+  nxpilot::runtime::core::executor::ExecutorBase* executor_ptr_ = nullptr;
+  std::chrono::system_clock::time_point next_tick_tp_;
+
+  HeartbeatTable heartbeat_table_;
+  uint64_t metrics_collector_id_ = 0;
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Process>> process_vec_;
+};
+
+}  // namespace nxpilot::runtime::core::supervisor
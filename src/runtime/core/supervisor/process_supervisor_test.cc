@@ -0,0 +1,178 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/executor/guard_thread_executor.h"
+#include "runtime/core/executor/time_wheel_executor.h"
+#include "runtime/core/supervisor/heartbeat.h"
+#include "runtime/core/supervisor/proc_stat_reader.h"
+#include "runtime/core/supervisor/process_supervisor.h"
+
+namespace nxpilot::runtime::core::supervisor {
+
+namespace {
+
+// Poll 'pred' until it holds or 5 seconds have passed.
+bool WaitFor(const std::function<bool()>& pred) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
+
+class ProcessSupervisorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executor_.Initialize("supervisor_test", YAML::Load("dt_us: 1000"));
+    executor_.Start();
+    supervisor_.RegisterGetExecutorFunc(
+        [this](std::string_view) -> executor::ExecutorBase* { return &executor_; });
+  }
+
+  void TearDown() override {
+    supervisor_.Shutdown();
+    executor_.Shutdown();
+  }
+
+  ProcessSupervisor::ProcessStatus GetStatus() { return supervisor_.GetProcessStatus().at(0); }
+
+  executor::TimeWheelExecutor executor_;
+  ProcessSupervisor supervisor_;
+};
+
+}  // namespace
+
+TEST(ProcStatReaderTest, read_self) {
+  ProcStatReader reader;
+  ASSERT_TRUE(reader.Open(getpid()));
+
+  std::thread([]() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }).join();
+  const auto begin = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(30)) {
+  }
+
+  ProcessStat stat;
+  ASSERT_TRUE(reader.Read(stat));
+  EXPECT_GT(stat.cpu_time_ns, 0);
+  EXPECT_GT(stat.rss_bytes, 0);
+  EXPECT_GE(stat.thread_num, 1);
+  EXPECT_GT(stat.voluntary_ctx_switch_num + stat.involuntary_ctx_switch_num, 0);
+
+  EXPECT_FALSE(reader.Open(-1));
+  EXPECT_FALSE(reader.Read(stat));
+}
+
+TEST(HeartbeatTest, stops_when_executor_hangs) {
+  executor::GuardThreadExecutor executor;
+  executor.Initialize("heartbeat_test", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+
+  HeartbeatTable table;
+  table.Create(2);
+  setenv(kHeartbeatShmEnv, table.GetName().c_str(), 1);
+  setenv(kHeartbeatSlotEnv, "1", 1);
+  setenv(kHeartbeatIntervalEnv, "2", 1);
+  setenv(kHeartbeatExecutorsEnv, "heartbeat_test", 1);
+  ASSERT_TRUE(HeartbeatSender::IsSupervised());
+
+  HeartbeatSender sender;
+  EXPECT_THROW(sender.Start([](std::string_view) { return nullptr; }), std::exception);
+  sender.Start([&](std::string_view) -> executor::ExecutorBase* { return &executor; });
+
+  auto& slot = table.GetSlot(1);
+  EXPECT_TRUE(WaitFor([&]() { return slot.beat_num.load() > 3; }));
+  EXPECT_EQ(table.GetSlot(0).beat_num.load(), 0);
+
+  // No beat while the executor is stuck in a task, beating again once it is released.
+  std::promise<void> release_promise;
+  executor.Execute([future = release_promise.get_future().share()]() { future.wait(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  const uint64_t hung_beat_num = slot.beat_num.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  EXPECT_LE(slot.beat_num.load(), hung_beat_num + 1);
+
+  release_promise.set_value();
+  EXPECT_TRUE(WaitFor([&]() { return slot.beat_num.load() > hung_beat_num + 3; }));
+  EXPECT_NE(slot.beat_ns.load(), 0);
+
+  sender.Stop();
+  executor.Shutdown();
+  for (const auto* env : {kHeartbeatShmEnv, kHeartbeatSlotEnv, kHeartbeatIntervalEnv,
+                          kHeartbeatExecutorsEnv}) {
+    unsetenv(env);
+  }
+}
+
+TEST_F(ProcessSupervisorTest, restart_exited_process) {
+  supervisor_.Initialize(YAML::Load(R"(
+    tick_interval_ms: 5
+    processes:
+      - name: crash
+        cmd: [sh, -c, "exit 3"]
+        heartbeat_timeout_ms: 0
+        restart_delay_ms: 5
+        max_restart_num: 2
+  )"));
+  supervisor_.Start();
+
+  EXPECT_TRUE(WaitFor(
+      [&]() { return GetStatus().state == ProcessSupervisor::ProcessState::kFailed; }));
+  EXPECT_EQ(GetStatus().restart_num, 2);
+  EXPECT_EQ(GetStatus().pid, 0);
+
+  const std::string text = metrics::GetMetricsRegistry().Render();
+  EXPECT_NE(text.find("nxpilot_process_up{process=\"crash\"} 0\n"), std::string::npos);
+  EXPECT_NE(text.find("nxpilot_process_restarts_total{process=\"crash\"} 2\n"),
+            std::string::npos);
+}
+
+TEST_F(ProcessSupervisorTest, restart_hung_process) {
+  supervisor_.Initialize(YAML::Load(R"(
+    tick_interval_ms: 5
+    processes:
+      - name: hung
+        cmd: [sh, -c, "trap '' TERM; sleep 100 & wait"]
+        startup_timeout_ms: 100
+        stop_timeout_ms: 50
+        restart_delay_ms: 0
+  )"));
+  supervisor_.Start();
+
+  ASSERT_TRUE(WaitFor([&]() { return GetStatus().pid != 0; }));
+  const pid_t first_pid = GetStatus().pid;
+  EXPECT_TRUE(WaitFor([&]() { return GetStatus().stat.rss_bytes > 0; }));
+
+  // It never beats and ignores SIGTERM, so it gets killed and launched again.
+  EXPECT_TRUE(WaitFor([&]() {
+    auto status = GetStatus();
+    return status.restart_num >= 1 && status.pid != 0 && status.pid != first_pid;
+  }));
+  // The whole group was killed, including the 'sleep'.
+  EXPECT_TRUE(WaitFor([&]() { return kill(-first_pid, 0) != 0; }));
+
+  supervisor_.Shutdown();
+  EXPECT_EQ(GetStatus().state, ProcessSupervisor::ProcessState::kStopped);
+}
+
+TEST_F(ProcessSupervisorTest, invalid_options) {
+  EXPECT_THROW(supervisor_.Initialize(YAML::Load(R"(
+    processes:
+      - name: a
+        cmd: [true]
+        unknown_key: 1
+  )")),
+               std::exception);
+}
+
+}  // namespace nxpilot::runtime::core::supervisor
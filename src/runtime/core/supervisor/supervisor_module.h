@@ -0,0 +1,42 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <memory>
+#include <string_view>
+
+#include "runtime/core/module/module_base.h"
+#include "runtime/core/supervisor/process_supervisor.h"
+
+namespace nxpilot::runtime::core::supervisor {
+
+/**
+ * @brief Run a 'ProcessSupervisor' as a module, so that a runtime configured with this module is
+ * the supervisor of the other runtime processes. The module options are the supervisor options,
+ * its 'executor' must be listed in the module executors.
+ */
+class SupervisorModule : public nxpilot::runtime::core::module::ModuleBase {
+ public:
+  static constexpr std::string_view kModuleName = "supervisor";
+
+  SupervisorModule() = default;
+  ~SupervisorModule() override = default;
+
+  std::string_view Name() const noexcept override { return kModuleName; }
+
+  void Initialize(nxpilot::runtime::core::module::ModuleCoreRef core) override {
+    supervisor_.SetLogger(std::make_shared<nxpilot::utils::common::Logger>(core.GetLogger()));
+    supervisor_.RegisterGetExecutorFunc(
+        [core](std::string_view name) { return core.GetExecutor(name); });
+    supervisor_.Initialize(core.GetOptions());
+  }
+  void Start() override { supervisor_.Start(); }
+  void Shutdown() override { supervisor_.Shutdown(); }
+
+  const ProcessSupervisor& GetSupervisor() const { return supervisor_; }
+
+ private:
+  ProcessSupervisor supervisor_;
+};
+
+}  // namespace nxpilot::runtime::core::supervisor
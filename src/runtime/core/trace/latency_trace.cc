@@ -0,0 +1,136 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "runtime/core/trace/latency_trace.h"
+
+#include <algorithm>
+#include <format>
+#include <mutex>
+
+namespace nxpilot::runtime::core::trace {
+
+namespace {
+
+thread_local const LatencyTraceContext* current_trace_ctx_ptr = nullptr;
+
+std::string FormatHistogram(const nxpilot::utils::common::Histogram& histogram) {
+  return std::format("count {}, p50 {}us, p99 {}us, max {}us", histogram.GetCount(),
+                     histogram.GetPercentile(50) / 1000, histogram.GetPercentile(99) / 1000,
+                     histogram.GetMax() / 1000);
+}
+
+}  // namespace
+
+ScopedLatencyTrace::ScopedLatencyTrace(const LatencyTraceContext* ctx_ptr)
+    : prev_ctx_ptr_(current_trace_ctx_ptr) {
+  current_trace_ctx_ptr = ctx_ptr;
+}
+
+ScopedLatencyTrace::~ScopedLatencyTrace() { current_trace_ctx_ptr = prev_ctx_ptr_; }
+
+const LatencyTraceContext* ScopedLatencyTrace::Current() { return current_trace_ctx_ptr; }
+
+LatencyTraceContext ForkLatencyTrace(const char* stage) noexcept {
+  const uint64_t now_ns = GetLatencyTraceNowNs();
+  if (current_trace_ctx_ptr == nullptr) {
+    return LatencyTraceContext{.origin = stage, .origin_ns = now_ns};
+  }
+
+  LatencyTraceContext ctx = *current_trace_ctx_ptr;
+  ctx.AddHop(stage, now_ns);
+  return ctx;
+}
+
+void LatencyTracker::Record(std::string_view pipeline) noexcept {
+  if (current_trace_ctx_ptr) Record(pipeline, *current_trace_ctx_ptr);
+}
+
+void LatencyTracker::Record(std::string_view pipeline, const LatencyTraceContext& ctx) noexcept {
+  if (ctx.origin_ns == 0) return;
+  const uint64_t now_ns = GetLatencyTraceNowNs();
+
+  try {
+    auto& pipeline_info = GetPipeline(pipeline);
+    pipeline_info.histogram.Record(now_ns - ctx.origin_ns);
+
+    uint64_t prev_ns = ctx.origin_ns;
+    const uint32_t kept_hop_num = std::min(ctx.hop_num, LatencyTraceContext::kMaxHopNum);
+    for (uint32_t ii = 0; ii < kept_hop_num; ++ii) {
+      const auto& hop = ctx.hop_array[ii];
+      GetStageHistogram(pipeline_info, hop.stage).Record(hop.ns - prev_ns);
+      prev_ns = hop.ns;
+    }
+    GetStageHistogram(pipeline_info, kEndStage).Record(now_ns - prev_ns);
+  } catch (const std::exception&) {
+    // Only on allocation failures, the trace is lost.
+  }
+}
+
+LatencyTracker::Pipeline& LatencyTracker::GetPipeline(std::string_view pipeline) {
+  {
+    std::shared_lock<std::shared_mutex> lck(mutex_);
+    auto iter = pipeline_map_.find(pipeline);
+    if (iter != pipeline_map_.end()) return *(iter->second);
+  }
+
+  std::unique_lock<std::shared_mutex> lck(mutex_);
+  auto iter = pipeline_map_.find(pipeline);
+  if (iter == pipeline_map_.end()) {
+    iter = pipeline_map_.emplace(std::string(pipeline), std::make_unique<Pipeline>()).first;
+    pipeline_name_vec_.emplace_back(pipeline);
+  }
+  return *(iter->second);
+}
+
+nxpilot::utils::common::Histogram& LatencyTracker::GetStageHistogram(Pipeline& pipeline,
+                                                                      std::string_view stage) {
+  auto get_stage = [](const auto& stage_ptr) -> const std::string& { return stage_ptr->stage; };
+  {
+    std::shared_lock<std::shared_mutex> lck(mutex_);
+    auto iter = std::ranges::find(pipeline.stage_vec, stage, get_stage);
+    if (iter != pipeline.stage_vec.end()) return (*iter)->histogram;
+  }
+
+  std::unique_lock<std::shared_mutex> lck(mutex_);
+  auto iter = std::ranges::find(pipeline.stage_vec, stage, get_stage);
+  if (iter != pipeline.stage_vec.end()) return (*iter)->histogram;
+
+  auto& stage_ptr = pipeline.stage_vec.emplace_back(std::make_unique<StageHistogram>());
+  stage_ptr->stage = std::string(stage);
+  return stage_ptr->histogram;
+}
+
+void LatencyTracker::Visit(const VisitFunc& func) const {
+  std::shared_lock<std::shared_mutex> lck(mutex_);
+  for (const auto& name : pipeline_name_vec_) {
+    const auto& pipeline = *(pipeline_map_.find(name)->second);
+    func(name, pipeline.histogram, pipeline.stage_vec);
+  }
+}
+
+std::string LatencyTracker::Report() const {
+  std::string report;
+  Visit([&report](std::string_view pipeline, const nxpilot::utils::common::Histogram& histogram,
+                  const std::vector<std::unique_ptr<StageHistogram>>& stage_vec) {
+    report += std::format("pipeline '{}': {}\n", pipeline, FormatHistogram(histogram));
+    for (const auto& stage_ptr : stage_vec) {
+      report += std::format("  stage '{}': {}\n", stage_ptr->stage,
+                            FormatHistogram(stage_ptr->histogram));
+    }
+  });
+  return report;
+}
+
+void LatencyTracker::Reset() {
+  std::shared_lock<std::shared_mutex> lck(mutex_);
+  for (auto& [name, pipeline_ptr] : pipeline_map_) {
+    pipeline_ptr->histogram.Reset();
+    for (auto& stage_ptr : pipeline_ptr->stage_vec) stage_ptr->histogram.Reset();
+  }
+}
+
+LatencyTracker& GetLatencyTracker() {
+  static LatencyTracker latency_tracker;
+  return latency_tracker;
+}
+
+}  // namespace nxpilot::runtime::core::trace
@@ -0,0 +1,139 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/common/histogram_tool.h"
+#include "utils/common/string_tool.h"
+
+namespace nxpilot::runtime::core::trace {
+
+inline uint64_t GetLatencyTraceNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// The trace reached 'stage' at 'ns', steady clock. Stages are kept by pointer, they must outlive
+// the trace, e.g. be owned by the channel or executor they name.
+struct LatencyHop {
+  const char* stage = nullptr;
+  uint64_t ns = 0;
+};
+
+/**
+ * @brief Compact trace context carried along with the data flowing through a pipeline.
+ *
+ * A trace starts at the first channel publish of a sensor, and gets a hop for every channel
+ * publish, executor task run and rpc call it goes through. Only the first 'kMaxHopNum' hops are
+ * kept, the time after the last kept hop is accounted to the end of the pipeline.
+ */
+struct LatencyTraceContext {
+  static constexpr uint32_t kMaxHopNum = 8;
+
+  const char* origin = nullptr;
+  uint64_t origin_ns = 0;
+  uint32_t hop_num = 0;
+  std::array<LatencyHop, kMaxHopNum> hop_array{};
+
+  void AddHop(const char* stage, uint64_t ns) noexcept {
+    if (hop_num < kMaxHopNum) hop_array[hop_num] = LatencyHop{.stage = stage, .ns = ns};
+    ++hop_num;
+  }
+};
+
+/**
+ * @brief Make a trace the current one of this thread while in scope. Channel publishes, executor
+ * submissions and rpc calls made meanwhile carry it on.
+ */
+class ScopedLatencyTrace {
+ public:
+  // nullptr clears the current trace.
+  explicit ScopedLatencyTrace(const LatencyTraceContext* ctx_ptr);
+  ~ScopedLatencyTrace();
+
+  ScopedLatencyTrace(const ScopedLatencyTrace&) = delete;
+  ScopedLatencyTrace& operator=(const ScopedLatencyTrace&) = delete;
+
+  static const LatencyTraceContext* Current();
+
+ private:
+  const LatencyTraceContext* prev_ctx_ptr_;
+};
+
+// The current trace with a hop at 'stage', or a new trace starting at 'stage' if there is none.
+LatencyTraceContext ForkLatencyTrace(const char* stage) noexcept;
+
+/**
+ * @brief Aggregate the latencies of finished traces into histograms per pipeline.
+ *
+ * A pipeline is named by the code that ends its traces, e.g. the actuation module. Besides the
+ * end-to-end latency, each hop records the time since the previous hop into the histogram of its
+ * stage, so the stage that blows the budget stands out.
+ */
+class LatencyTracker {
+ public:
+  // The stage of the time from the last kept hop to the end of a trace.
+  static constexpr const char* kEndStage = "end";
+
+  struct StageHistogram {
+    std::string stage;
+    nxpilot::utils::common::Histogram histogram;
+  };
+
+  LatencyTracker() = default;
+
+  LatencyTracker(const LatencyTracker&) = delete;
+  LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+  // Traces are only started while enabled.
+  void SetEnabled(bool enabled) { enabled_.store(enabled); }
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // End the current trace of this thread, if any, in 'pipeline'.
+  void Record(std::string_view pipeline) noexcept;
+  void Record(std::string_view pipeline, const LatencyTraceContext& ctx) noexcept;
+
+  // 'func' is called with the end-to-end histogram of each pipeline, and the histograms of its
+  // stages in the order they were first seen.
+  using VisitFunc = std::function<void(std::string_view, const nxpilot::utils::common::Histogram&,
+                                       const std::vector<std::unique_ptr<StageHistogram>>&)>;
+  void Visit(const VisitFunc& func) const;
+
+  // A table of the count and the p50/p99/max latency of each pipeline and stage, in us.
+  std::string Report() const;
+
+  void Reset();
+
+ private:
+  struct Pipeline {
+    nxpilot::utils::common::Histogram histogram;
+    std::vector<std::unique_ptr<StageHistogram>> stage_vec;
+  };
+
+  Pipeline& GetPipeline(std::string_view pipeline);
+  nxpilot::utils::common::Histogram& GetStageHistogram(Pipeline& pipeline, std::string_view stage);
+
+ private:
+  std::atomic_bool enabled_ = false;
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<Pipeline>, nxpilot::utils::common::StringHash,
+                     std::equal_to<>>
+      pipeline_map_;
+  std::vector<std::string> pipeline_name_vec_;
+};
+
+// The process wide tracker, traces flow across all the managers of the runtime.
+LatencyTracker& GetLatencyTracker();
+
+}  // namespace nxpilot::runtime::core::trace
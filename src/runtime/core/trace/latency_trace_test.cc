@@ -0,0 +1,156 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "runtime/core/channel/channel_manager.h"
+#include "runtime/core/executor/guard_thread_executor.h"
+#include "runtime/core/executor/latency_traced_executor.h"
+#include "runtime/core/executor/time_wheel_executor.h"
+#include "runtime/core/rpc/rpc_manager.h"
+#include "runtime/core/trace/latency_trace.h"
+
+namespace nxpilot::runtime::core::trace {
+
+namespace {
+
+class LatencyTraceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    GetLatencyTracker().Reset();
+    GetLatencyTracker().SetEnabled(true);
+  }
+
+  void TearDown() override { GetLatencyTracker().SetEnabled(false); }
+};
+
+std::vector<std::string> GetStages(std::string_view pipeline, uint64_t* count_ptr) {
+  std::vector<std::string> stage_vec;
+  GetLatencyTracker().Visit(
+      [&](std::string_view name, const nxpilot::utils::common::Histogram& histogram,
+          const std::vector<std::unique_ptr<LatencyTracker::StageHistogram>>& stage_ptr_vec) {
+        if (name != pipeline) return;
+        *count_ptr = histogram.GetCount();
+        for (const auto& stage_ptr : stage_ptr_vec) stage_vec.emplace_back(stage_ptr->stage);
+      });
+  return stage_vec;
+}
+
+}  // namespace
+
+TEST_F(LatencyTraceTest, fork) {
+  EXPECT_EQ(ScopedLatencyTrace::Current(), nullptr);
+  auto ctx = ForkLatencyTrace("a");
+  EXPECT_STREQ(ctx.origin, "a");
+  EXPECT_EQ(ctx.hop_num, 0);
+
+  {
+    ScopedLatencyTrace scoped_trace(&ctx);
+    for (uint32_t ii = 0; ii < LatencyTraceContext::kMaxHopNum + 2; ++ii) {
+      auto next_ctx = ForkLatencyTrace("b");
+      EXPECT_EQ(next_ctx.origin_ns, ctx.origin_ns);
+      ctx = next_ctx;
+    }
+    EXPECT_EQ(ctx.hop_num, LatencyTraceContext::kMaxHopNum + 2);
+    GetLatencyTracker().Record("fork");
+  }
+  EXPECT_EQ(ScopedLatencyTrace::Current(), nullptr);
+  // Nothing to record without a current trace.
+  GetLatencyTracker().Record("fork");
+
+  uint64_t count = 0;
+  EXPECT_EQ(GetStages("fork", &count), (std::vector<std::string>{"b", LatencyTracker::kEndStage}));
+  EXPECT_EQ(count, 1);
+  EXPECT_NE(GetLatencyTracker().Report().find("pipeline 'fork': count 1"), std::string::npos);
+}
+
+TEST_F(LatencyTraceTest, propagate_through_channel_executor_and_rpc) {
+  executor::LatencyTracedExecutor executor(std::make_unique<executor::GuardThreadExecutor>());
+  executor.Initialize("latency_test", YAML::Node(YAML::NodeType::Null));
+  executor.Start();
+
+  rpc::RpcManager rpc_manager;
+  rpc_manager.RegisterService<int, int>(
+      "plan", [](const std::shared_ptr<const int>& req, const std::shared_ptr<int>& rsp,
+                 rpc::RpcDoneCallback&& done) {
+        *rsp = *req + 1;
+        done(rpc::RpcStatus());
+      });
+  rpc_manager.Initialize(YAML::Node());
+  rpc_manager.Start();
+
+  channel::ChannelManager channel_manager;
+  channel_manager.Subscribe<int>(
+      "camera",
+      [&](const std::shared_ptr<const int>& msg, uint64_t) {
+        auto rsp = std::make_shared<int>();
+        rpc_manager.Invoke<int, int>("plan", msg, rsp, [&, rsp](rpc::RpcStatus status) {
+          EXPECT_TRUE(status.OK());
+          channel_manager.Publish<int>("cmd", rsp);
+        });
+      },
+      channel::SubscribeOptions{.executor = &executor});
+
+  std::promise<uint32_t> hop_num_promise;
+  channel_manager.Subscribe<int>("cmd", [&](const std::shared_ptr<const int>& msg, uint64_t) {
+    EXPECT_EQ(*msg, 2);
+    const auto* ctx_ptr = ScopedLatencyTrace::Current();
+    ASSERT_NE(ctx_ptr, nullptr);
+    EXPECT_STREQ(ctx_ptr->origin, "channel:camera");
+    GetLatencyTracker().Record("camera_to_cmd");
+    hop_num_promise.set_value(ctx_ptr->hop_num);
+  });
+  channel_manager.Initialize(YAML::Node());
+  channel_manager.Start();
+
+  channel_manager.Publish<int>("camera", std::make_shared<const int>(1));
+  EXPECT_EQ(hop_num_promise.get_future().get(), 3);
+
+  uint64_t count = 0;
+  EXPECT_EQ(GetStages("camera_to_cmd", &count),
+            (std::vector<std::string>{"executor:latency_test", "rpc:plan", "channel:cmd",
+                                      LatencyTracker::kEndStage}));
+  EXPECT_EQ(count, 1);
+
+  channel_manager.Shutdown();
+  rpc_manager.Shutdown();
+  executor.Shutdown();
+}
+
+TEST_F(LatencyTraceTest, timer_task_starts_without_trace) {
+  executor::LatencyTracedExecutor executor(std::make_unique<executor::TimeWheelExecutor>());
+  executor.Initialize("latency_timer_test", YAML::Load("dt_us: 1000"));
+  executor.Start();
+
+  std::promise<const LatencyTraceContext*> timer_promise;
+  auto ctx = ForkLatencyTrace("timer");
+  {
+    ScopedLatencyTrace scoped_trace(&ctx);
+    executor.ExecuteAt(executor.Now() + std::chrono::milliseconds(5),
+                       [&]() { timer_promise.set_value(ScopedLatencyTrace::Current()); });
+  }
+  EXPECT_EQ(timer_promise.get_future().get(), nullptr);
+
+  executor.Shutdown();
+}
+
+TEST_F(LatencyTraceTest, disabled) {
+  GetLatencyTracker().SetEnabled(false);
+
+  channel::ChannelManager channel_manager;
+  bool traced = true;
+  channel_manager.SubscribeRaw("a", [&](const channel::ChannelMessage& msg) {
+    traced = msg.trace_ptr != nullptr || ScopedLatencyTrace::Current() != nullptr;
+  });
+  channel_manager.Initialize(YAML::Node());
+  channel_manager.Start();
+
+  channel_manager.Publish<int>("a", std::make_shared<const int>(1));
+  EXPECT_FALSE(traced);
+  channel_manager.Shutdown();
+}
+
+}  // namespace nxpilot::runtime::core::trace
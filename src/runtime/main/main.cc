@@ -6,8 +6,22 @@
 #include "gflags/gflags.h"
 
 #include "runtime/core/ados_core.h"
+#include "runtime/core/supervisor/supervisor_module.h"
+#include "utils/common/string_tool.h"
 
 DEFINE_string(cfg_file_path, "", "config file path");
+DEFINE_string(cfg_overlay, "",
+              "comma separated config files merged onto cfg_file_path in order, e.g. per vehicle");
+DEFINE_string(cfg_snapshot_path, "",
+              "binary config snapshot, used instead of parsing cfg_file_path when up to date");
+DEFINE_bool(cfg_hot_reload, false,
+            "watch the config files and apply safe changes without restart");
+DEFINE_bool(compile_cfg_snapshot, false,
+            "compile cfg_file_path into cfg_snapshot_path and exit");
+DEFINE_string(lifecycle_trace_path, "",
+              "write the startup/shutdown profile as a chrome trace json file on exit");
+DEFINE_bool(supervisor, false,
+            "supervise the other runtime processes, needs the 'supervisor' module in the config");
 
 DEFINE_bool(h, false, "help");
 DEFINE_bool(v, false, "version");
@@ -50,16 +64,43 @@ int32_t main(int32_t argc, char** argv) {
   signal(SIGINT, SignalHandler);
   signal(SIGTERM, SignalHandler);
 
+  const auto cfg_overlay_paths = nxpilot::utils::common::SplitToVec(FLAGS_cfg_overlay, ',');
+
+  if (FLAGS_compile_cfg_snapshot) {
+    try {
+      nxpilot::runtime::core::configurator::ConfiguratorManager configurator_manager;
+      configurator_manager.Initialize(
+          FLAGS_cfg_file_path,
+          std::vector<std::filesystem::path>(cfg_overlay_paths.begin(), cfg_overlay_paths.end()));
+      configurator_manager.CompileSnapshot(FLAGS_cfg_snapshot_path);
+    } catch (const std::exception& e) {
+      std::cout << "NXpilot compile config snapshot failed. " << e.what() << std::endl;
+      return -1;
+    }
+    return 0;
+  }
+
   std::cout << "NXpilot start!" << std::endl;
   try {
     nxpilot::runtime::core::AdosCore core;
     global_core_ptr = &core;
-
-    nxpilot::runtime::core::AdosCore::Options options{.cfg_file_path = FLAGS_cfg_file_path};
+    if (FLAGS_supervisor) {
+      core.RegisterModule(
+          std::make_unique<nxpilot::runtime::core::supervisor::SupervisorModule>());
+    }
+
+    nxpilot::runtime::core::AdosCore::Options options{.cfg_file_path = FLAGS_cfg_file_path,
+                                                      .cfg_overlay_paths = cfg_overlay_paths,
+                                                      .cfg_snapshot_path = FLAGS_cfg_snapshot_path,
+                                                      .cfg_hot_reload = FLAGS_cfg_hot_reload};
     core.Initialize(options);
     core.Start();
     core.Shutdown();
     global_core_ptr = nullptr;
+
+    if (!FLAGS_lifecycle_trace_path.empty()) {
+      core.ExportLifecycleTrace(FLAGS_lifecycle_trace_path);
+    }
   } catch (const std::exception& e) {
     std::cout << "NXpilot run with exception and exit. " << e.what() << std::endl;
     return -1;
@@ -0,0 +1,140 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <sched.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/common/exception.h"
+
+namespace nxpilot::utils::common {
+
+// Parse the kernel cpu list format, e.g. "0-3,8,10-11". Return sorted unique cpu indexes.
+inline std::vector<uint32_t> ParseCpuList(std::string_view str) {
+  std::vector<uint32_t> cpu_vec;
+
+  auto parse_num = [str](std::string_view num_str) -> uint32_t {
+    AIMRT_ASSERT(!num_str.empty() && std::ranges::all_of(num_str, [](char c) {
+                   return c >= '0' && c <= '9';
+                 }),
+                 "Invalid cpu list '{}'", str);
+    return static_cast<uint32_t>(std::stoul(std::string(num_str)));
+  };
+
+  while (!str.empty() && (str.back() == '\n' || str.back() == ' ')) str.remove_suffix(1);
+
+  size_t pos = 0;
+  while (pos < str.size()) {
+    auto end = str.find(',', pos);
+    if (end == std::string_view::npos) end = str.size();
+    auto item = str.substr(pos, end - pos);
+    pos = end + 1;
+    if (item.empty()) continue;
+
+    auto dash_pos = item.find('-');
+    if (dash_pos == std::string_view::npos) {
+      cpu_vec.emplace_back(parse_num(item));
+      continue;
+    }
+
+    uint32_t first = parse_num(item.substr(0, dash_pos));
+    uint32_t last = parse_num(item.substr(dash_pos + 1));
+    AIMRT_ASSERT(first <= last, "Invalid cpu list '{}'", str);
+    for (uint32_t cpu = first; cpu <= last; ++cpu) cpu_vec.emplace_back(cpu);
+  }
+
+  std::ranges::sort(cpu_vec);
+  auto unique_ret = std::ranges::unique(cpu_vec);
+  cpu_vec.erase(unique_ret.begin(), unique_ret.end());
+  return cpu_vec;
+}
+
+// Inverse of 'ParseCpuList', 'cpu_vec' should be sorted.
+inline std::string FormatCpuList(const std::vector<uint32_t>& cpu_vec) {
+  std::string result;
+  for (size_t ii = 0; ii < cpu_vec.size();) {
+    size_t jj = ii;
+    while (jj + 1 < cpu_vec.size() && cpu_vec[jj + 1] == cpu_vec[jj] + 1) ++jj;
+
+    if (!result.empty()) result += ',';
+    result += std::to_string(cpu_vec[ii]);
+    if (jj > ii) result += '-' + std::to_string(cpu_vec[jj]);
+    ii = jj + 1;
+  }
+  return result;
+}
+
+struct CpuTopology {
+  std::vector<uint32_t> online_cpus;
+  // Cpus removed from the scheduler with 'isolcpus', the best place for real-time threads.
+  std::vector<uint32_t> isolated_cpus;
+  // Cpus of the cgroup cpuset, all online cpus if there is none.
+  std::vector<uint32_t> allowed_cpus;
+  // For every cpu index, the smallest cpu index of its physical core, so SMT siblings share it.
+  std::vector<uint32_t> physical_core_of_cpu;
+
+  bool IsOnline(uint32_t cpu) const { return std::ranges::binary_search(online_cpus, cpu); }
+  bool IsIsolated(uint32_t cpu) const { return std::ranges::binary_search(isolated_cpus, cpu); }
+  bool IsAllowed(uint32_t cpu) const { return std::ranges::binary_search(allowed_cpus, cpu); }
+  uint32_t PhysicalCore(uint32_t cpu) const {
+    return cpu < physical_core_of_cpu.size() ? physical_core_of_cpu[cpu] : cpu;
+  }
+};
+
+inline std::vector<uint32_t> GetCurrentProcessAffinity() {
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  AIMRT_ASSERT(sched_getaffinity(0, sizeof(cpuset), &cpuset) == 0,
+               "Call 'sched_getaffinity' failed");
+
+  std::vector<uint32_t> cpu_vec;
+  for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &cpuset)) cpu_vec.emplace_back(cpu);
+  }
+  return cpu_vec;
+}
+
+/**
+ * @brief Read the cpu topology from sysfs.
+ *
+ * Uses 'devices/system/cpu/{online,isolated}', 'cpuN/topology/thread_siblings_list' and the cgroup
+ * v2 'fs/cgroup/cpuset.cpus.effective' under 'sys_root'. Missing files are treated as absent
+ * features. The process affinity mask is not applied, see 'GetCurrentProcessAffinity'.
+ */
+inline CpuTopology LoadCpuTopology(const std::filesystem::path& sys_root = "/sys") {
+  auto read_file = [](const std::filesystem::path& path) -> std::string {
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) return {};
+    std::string content;
+    std::getline(ifs, content);
+    return content;
+  };
+
+  const auto cpu_dir = sys_root / "devices/system/cpu";
+  CpuTopology topology;
+  topology.online_cpus = ParseCpuList(read_file(cpu_dir / "online"));
+  topology.isolated_cpus = ParseCpuList(read_file(cpu_dir / "isolated"));
+
+  auto cgroup_cpus = read_file(sys_root / "fs/cgroup/cpuset.cpus.effective");
+  topology.allowed_cpus =
+      cgroup_cpus.empty() ? topology.online_cpus : ParseCpuList(cgroup_cpus);
+
+  const uint32_t max_cpu = topology.online_cpus.empty() ? 0 : topology.online_cpus.back();
+  topology.physical_core_of_cpu.resize(max_cpu + 1);
+  for (uint32_t cpu = 0; cpu <= max_cpu; ++cpu) {
+    auto sibling_vec = ParseCpuList(read_file(
+        cpu_dir / ("cpu" + std::to_string(cpu)) / "topology/thread_siblings_list"));
+    topology.physical_core_of_cpu[cpu] = sibling_vec.empty() ? cpu : sibling_vec.front();
+  }
+
+  return topology;
+}
+
+}  // namespace nxpilot::utils::common
@@ -0,0 +1,64 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <filesystem>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+#include "utils/common/cpu_topology_tool.h"
+
+namespace nxpilot::utils::common {
+
+TEST(CpuTopologyToolTest, ParseCpuList) {
+  EXPECT_EQ(ParseCpuList(""), std::vector<uint32_t>{});
+  EXPECT_EQ(ParseCpuList("0\n"), std::vector<uint32_t>{0});
+  EXPECT_EQ(ParseCpuList("8,0-3,2"), (std::vector<uint32_t>{0, 1, 2, 3, 8}));
+  EXPECT_EQ(ParseCpuList("1,,4-5"), (std::vector<uint32_t>{1, 4, 5}));
+
+  EXPECT_ANY_THROW(ParseCpuList("3-1"));
+  EXPECT_ANY_THROW(ParseCpuList("a"));
+  EXPECT_ANY_THROW(ParseCpuList("1-"));
+}
+
+TEST(CpuTopologyToolTest, FormatCpuList) {
+  EXPECT_EQ(FormatCpuList({}), "");
+  EXPECT_EQ(FormatCpuList({3}), "3");
+  EXPECT_EQ(FormatCpuList({0, 1, 2, 3, 8, 10, 11}), "0-3,8,10-11");
+  EXPECT_EQ(FormatCpuList(ParseCpuList("0-3,8,10-11")), "0-3,8,10-11");
+}
+
+TEST(CpuTopologyToolTest, LoadCpuTopology) {
+  const auto sys_root = std::filesystem::temp_directory_path() / "nxpilot_cpu_topology_test";
+  std::filesystem::remove_all(sys_root);
+
+  auto write_file = [&sys_root](const std::string& path, const std::string& content) {
+    std::filesystem::create_directories((sys_root / path).parent_path());
+    std::ofstream(sys_root / path) << content << "\n";
+  };
+
+  // 2 physical cores with 2 SMT siblings each, cpu 1 and 3 isolated, cgroup limited to 0-2.
+  write_file("devices/system/cpu/online", "0-3");
+  write_file("devices/system/cpu/isolated", "1,3");
+  write_file("devices/system/cpu/cpu0/topology/thread_siblings_list", "0,2");
+  write_file("devices/system/cpu/cpu1/topology/thread_siblings_list", "1,3");
+  write_file("devices/system/cpu/cpu2/topology/thread_siblings_list", "0,2");
+  write_file("devices/system/cpu/cpu3/topology/thread_siblings_list", "1,3");
+  write_file("fs/cgroup/cpuset.cpus.effective", "0-2");
+
+  auto topology = LoadCpuTopology(sys_root);
+  EXPECT_EQ(topology.online_cpus, (std::vector<uint32_t>{0, 1, 2, 3}));
+  EXPECT_EQ(topology.isolated_cpus, (std::vector<uint32_t>{1, 3}));
+  EXPECT_EQ(topology.allowed_cpus, (std::vector<uint32_t>{0, 1, 2}));
+  EXPECT_EQ(topology.PhysicalCore(2), 0);
+  EXPECT_EQ(topology.PhysicalCore(3), 1);
+  EXPECT_TRUE(topology.IsIsolated(3));
+  EXPECT_FALSE(topology.IsAllowed(3));
+
+  // Without a cgroup cpuset every online cpu is allowed.
+  std::filesystem::remove(sys_root / "fs/cgroup/cpuset.cpus.effective");
+  EXPECT_EQ(LoadCpuTopology(sys_root).allowed_cpus, topology.online_cpus);
+
+  std::filesystem::remove_all(sys_root);
+}
+
+}  // namespace nxpilot::utils::common
@@ -0,0 +1,214 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "utils/common/exception.h"
+#include "utils/common/string_tool.h"
+
+namespace nxpilot::utils::common {
+
+/**
+ * @brief A small DAG of named tasks, run with as much parallelism as the dependencies allow.
+ *
+ * A node becomes ready as soon as all of its dependencies have finished, so it does not wait for
+ * unrelated slower nodes. If a task throws, no new node is started, running nodes are waited for
+ * and the first exception is rethrown from 'Run'.
+ */
+class DependencyGraph {
+ public:
+  using Task = std::function<void()>;
+
+  struct NodeRecord {
+    std::string name;
+    std::chrono::steady_clock::time_point begin_time_point;
+    std::chrono::steady_clock::time_point end_time_point;
+    bool finished = false;
+  };
+
+  DependencyGraph() = default;
+  ~DependencyGraph() = default;
+
+  DependencyGraph(const DependencyGraph&) = delete;
+  DependencyGraph& operator=(const DependencyGraph&) = delete;
+
+  // Dependencies are referenced by name and may be added later. Nodes marked 'run_on_caller' are
+  // only run by the thread calling 'Run', e.g. for work bound to the main thread.
+  void AddNode(std::string_view name, Task&& task, std::vector<std::string> depends_on = {},
+               bool run_on_caller = false) {
+    AIMRT_ASSERT(node_idx_map_.emplace(name, node_vec_.size()).second, "Duplicate node '{}'",
+                 name);
+    node_vec_.emplace_back(Node{.name = std::string(name),
+                                .task = std::move(task),
+                                .depends_on = std::move(depends_on),
+                                .run_on_caller = run_on_caller});
+  }
+
+  size_t Size() const { return node_vec_.size(); }
+  std::string_view NodeName(size_t idx) const { return node_vec_[idx].name; }
+
+  // Indexes of all nodes in a valid execution order. Throws on unknown dependency or cycle.
+  std::vector<size_t> TopologicalOrder() const {
+    std::vector<uint32_t> in_degree_vec;
+    std::vector<std::vector<size_t>> successor_vec;
+    BuildEdges(in_degree_vec, successor_vec);
+    return TopologicalOrder(std::move(in_degree_vec), successor_vec);
+  }
+
+  // Run all tasks, using at most 'max_concurrency' threads including the calling one. Zero means
+  // the number of hardware threads.
+  void Run(uint32_t max_concurrency = 0) {
+    std::vector<uint32_t> in_degree_vec;
+    std::vector<std::vector<size_t>> successor_vec;
+    BuildEdges(in_degree_vec, successor_vec);
+    // Only to reject cycles before any task runs.
+    TopologicalOrder(in_degree_vec, successor_vec);
+
+    record_vec_.clear();
+    record_vec_.resize(node_vec_.size());
+    for (size_t ii = 0; ii < node_vec_.size(); ++ii) record_vec_[ii].name = node_vec_[ii].name;
+
+    RunContext ctx;
+    for (size_t ii = 0; ii < node_vec_.size(); ++ii) {
+      if (in_degree_vec[ii] == 0) PushReady(ctx, ii);
+    }
+
+    if (max_concurrency == 0) max_concurrency = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t helper_num =
+        std::min<size_t>(max_concurrency, node_vec_.size()) - (node_vec_.empty() ? 0 : 1);
+
+    std::vector<std::thread> helper_vec;
+    helper_vec.reserve(helper_num);
+    for (size_t ii = 0; ii < helper_num; ++ii) {
+      helper_vec.emplace_back([&]() { WorkLoop(ctx, in_degree_vec, successor_vec, false); });
+    }
+    WorkLoop(ctx, in_degree_vec, successor_vec, true);
+    for (auto& helper : helper_vec) helper.join();
+
+    if (ctx.exception_ptr) std::rethrow_exception(ctx.exception_ptr);
+  }
+
+  // Timing of every node in the last 'Run', in the order the nodes were added.
+  const std::vector<NodeRecord>& GetRecords() const { return record_vec_; }
+
+ private:
+  struct Node {
+    std::string name;
+    Task task;
+    std::vector<std::string> depends_on;
+    bool run_on_caller = false;
+  };
+
+  struct RunContext {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<size_t> ready_deque;
+    std::deque<size_t> caller_ready_deque;
+    size_t running_num = 0;
+    size_t finished_num = 0;
+    std::exception_ptr exception_ptr;
+  };
+
+  std::vector<size_t> TopologicalOrder(
+      std::vector<uint32_t> in_degree_vec,
+      const std::vector<std::vector<size_t>>& successor_vec) const {
+    std::vector<size_t> order;
+    order.reserve(node_vec_.size());
+    for (size_t ii = 0; ii < node_vec_.size(); ++ii) {
+      if (in_degree_vec[ii] == 0) order.push_back(ii);
+    }
+    for (size_t head = 0; head < order.size(); ++head) {
+      for (auto successor_idx : successor_vec[order[head]]) {
+        if (--in_degree_vec[successor_idx] == 0) order.push_back(successor_idx);
+      }
+    }
+
+    AIMRT_ASSERT(order.size() == node_vec_.size(), "Circular dependency detected in graph.");
+    return order;
+  }
+
+  void BuildEdges(std::vector<uint32_t>& in_degree_vec,
+                  std::vector<std::vector<size_t>>& successor_vec) const {
+    in_degree_vec.assign(node_vec_.size(), 0);
+    successor_vec.assign(node_vec_.size(), {});
+    for (size_t ii = 0; ii < node_vec_.size(); ++ii) {
+      for (const auto& dep_name : node_vec_[ii].depends_on) {
+        auto iter = node_idx_map_.find(dep_name);
+        AIMRT_ASSERT(iter != node_idx_map_.end(), "Node '{}' depends on unknown node '{}'",
+                     node_vec_[ii].name, dep_name);
+        successor_vec[iter->second].push_back(ii);
+        ++in_degree_vec[ii];
+      }
+    }
+  }
+
+  void PushReady(RunContext& ctx, size_t idx) const {
+    (node_vec_[idx].run_on_caller ? ctx.caller_ready_deque : ctx.ready_deque).push_back(idx);
+  }
+
+  void WorkLoop(RunContext& ctx, std::vector<uint32_t>& in_degree_vec,
+                const std::vector<std::vector<size_t>>& successor_vec, bool is_caller) {
+    std::unique_lock<std::mutex> lck(ctx.mutex);
+    while (true) {
+      auto has_work = [&]() {
+        return !ctx.exception_ptr &&
+               (!ctx.ready_deque.empty() || (is_caller && !ctx.caller_ready_deque.empty()));
+      };
+      auto all_done = [&]() {
+        return ctx.finished_num == node_vec_.size() ||
+               (ctx.exception_ptr && ctx.running_num == 0);
+      };
+      ctx.cond.wait(lck, [&]() { return has_work() || all_done(); });
+      if (!has_work()) return;
+
+      auto& deque =
+          (is_caller && !ctx.caller_ready_deque.empty()) ? ctx.caller_ready_deque : ctx.ready_deque;
+      size_t idx = deque.front();
+      deque.pop_front();
+      ++ctx.running_num;
+      lck.unlock();
+
+      std::exception_ptr exception_ptr;
+      auto& record = record_vec_[idx];
+      record.begin_time_point = std::chrono::steady_clock::now();
+      try {
+        node_vec_[idx].task();
+      } catch (...) {
+        exception_ptr = std::current_exception();
+      }
+      record.end_time_point = std::chrono::steady_clock::now();
+
+      lck.lock();
+      --ctx.running_num;
+      if (exception_ptr) {
+        if (!ctx.exception_ptr) ctx.exception_ptr = exception_ptr;
+      } else {
+        record.finished = true;
+        ++ctx.finished_num;
+        for (auto successor_idx : successor_vec[idx]) {
+          if (--in_degree_vec[successor_idx] == 0) PushReady(ctx, successor_idx);
+        }
+      }
+      ctx.cond.notify_all();
+    }
+  }
+
+ private:
+  std::vector<Node> node_vec_;
+  std::unordered_map<std::string, size_t, StringHash, std::equal_to<>> node_idx_map_;
+  std::vector<NodeRecord> record_vec_;
+};
+
+}  // namespace nxpilot::utils::common
@@ -0,0 +1,86 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utils/common/dependency_graph.h"
+
+namespace nxpilot::utils::common {
+
+TEST(DependencyGraphTest, TopologicalOrder) {
+  DependencyGraph graph;
+  graph.AddNode("c", [] {}, {"a", "b"});
+  graph.AddNode("a", [] {});
+  graph.AddNode("b", [] {}, {"a"});
+
+  std::vector<size_t> order = graph.TopologicalOrder();
+  ASSERT_EQ(order.size(), 3);
+  EXPECT_EQ(graph.NodeName(order[0]), "a");
+  EXPECT_EQ(graph.NodeName(order[1]), "b");
+  EXPECT_EQ(graph.NodeName(order[2]), "c");
+
+  DependencyGraph cycle_graph;
+  cycle_graph.AddNode("a", [] {}, {"b"});
+  cycle_graph.AddNode("b", [] {}, {"a"});
+  EXPECT_ANY_THROW(cycle_graph.TopologicalOrder());
+
+  DependencyGraph unknown_graph;
+  unknown_graph.AddNode("a", [] {}, {"x"});
+  EXPECT_ANY_THROW(unknown_graph.Run());
+
+  EXPECT_ANY_THROW(graph.AddNode("a", [] {}));
+}
+
+TEST(DependencyGraphTest, Run) {
+  std::mutex mutex;
+  std::vector<std::string> record_vec;
+  auto record = [&](std::string name) {
+    return [&, name]() {
+      std::lock_guard<std::mutex> lck(mutex);
+      record_vec.emplace_back(name);
+    };
+  };
+
+  const auto caller_thread_id = std::this_thread::get_id();
+  std::thread::id main_node_thread_id;
+
+  DependencyGraph graph;
+  graph.AddNode("init", record("init"));
+  graph.AddNode("left", record("left"), {"init"});
+  graph.AddNode("right", record("right"), {"init"});
+  graph.AddNode("main", [&]() { main_node_thread_id = std::this_thread::get_id(); }, {"init"},
+                true);
+  graph.AddNode("join", record("join"), {"left", "right", "main"});
+  graph.Run(4);
+
+  ASSERT_EQ(record_vec.size(), 4);
+  EXPECT_EQ(record_vec.front(), "init");
+  EXPECT_EQ(record_vec.back(), "join");
+  EXPECT_EQ(main_node_thread_id, caller_thread_id);
+
+  for (const auto& node_record : graph.GetRecords()) {
+    EXPECT_TRUE(node_record.finished);
+    EXPECT_LE(node_record.begin_time_point, node_record.end_time_point);
+  }
+}
+
+TEST(DependencyGraphTest, RunWithException) {
+  std::atomic_bool after_failed_run = false;
+
+  DependencyGraph graph;
+  graph.AddNode("ok", [] {});
+  graph.AddNode("failed", []() { throw std::runtime_error("failed"); });
+  graph.AddNode("after_failed", [&]() { after_failed_run = true; }, {"failed"});
+
+  EXPECT_THROW(graph.Run(2), std::runtime_error);
+  EXPECT_FALSE(after_failed_run);
+  EXPECT_FALSE(graph.GetRecords()[2].finished);
+}
+
+}  // namespace nxpilot::utils::common
@@ -0,0 +1,29 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nxpilot::utils::common {
+
+constexpr uint64_t kFnv1a64Offset = 0xcbf29ce484222325ULL;
+
+/**
+ * @brief 64-bit FNV-1a hash, stable across runs and platforms, e.g. for file checksums.
+ *
+ * @param data
+ * @param size
+ * @param hash hash of the preceding data, to hash several buffers as one
+ * @return uint64_t hash
+ */
+inline uint64_t HashFnv1a64(const void* data, size_t size, uint64_t hash = kFnv1a64Offset) {
+  const auto* ptr = static_cast<const uint8_t*>(data);
+  for (size_t ii = 0; ii < size; ++ii) {
+    hash ^= ptr[ii];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+}  // namespace nxpilot::utils::common
@@ -0,0 +1,23 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "gtest/gtest.h"
+
+#include <string_view>
+
+#include "utils/common/hash_tool.h"
+
+namespace nxpilot::utils::common {
+
+TEST(HashToolTest, fnv1a64) {
+  EXPECT_EQ(HashFnv1a64(nullptr, 0), kFnv1a64Offset);
+  EXPECT_EQ(HashFnv1a64("a", 1), 0xaf63dc4c8601ec8cULL);
+  EXPECT_EQ(HashFnv1a64("foobar", 6), 0x85944171f73967e8ULL);
+
+  // Chained buffers hash as one.
+  constexpr std::string_view kFoo = "foo";
+  constexpr std::string_view kBar = "bar";
+  EXPECT_EQ(HashFnv1a64(kBar.data(), kBar.size(), HashFnv1a64(kFoo.data(), kFoo.size())),
+            HashFnv1a64("foobar", 6));
+}
+
+}  // namespace nxpilot::utils::common
@@ -0,0 +1,105 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace nxpilot::utils::common {
+
+/**
+ * @brief Histogram of uint64 values, e.g. latencies in ns, recorded without locks.
+ *
+ * Buckets are log-linear: each power of 2 range is split into 'kSubBucketNum' buckets, so a
+ * percentile is off by less than 1/kSubBucketNum of its value. Readers may see a record that is
+ * only partially applied, e.g. counted but not yet summed.
+ */
+class Histogram {
+ public:
+  static constexpr uint32_t kSubBucketBits = 3;
+  static constexpr uint64_t kSubBucketNum = uint64_t(1) << kSubBucketBits;
+  static constexpr size_t kBucketNum = (64 - kSubBucketBits) * kSubBucketNum + kSubBucketNum;
+
+  Histogram() = default;
+
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  static size_t GetBucketIndex(uint64_t value) noexcept {
+    if (value < kSubBucketNum) return value;
+    const uint32_t shift = std::bit_width(value) - 1 - kSubBucketBits;
+    return shift * kSubBucketNum + (value >> shift);
+  }
+
+  // The largest value of bucket 'idx'.
+  static uint64_t GetBucketUpperBound(size_t idx) noexcept {
+    if (idx < 2 * kSubBucketNum) return idx;
+    const uint64_t shift = idx / kSubBucketNum - 1;
+    const uint64_t mantissa = idx % kSubBucketNum + kSubBucketNum;
+    return ((mantissa + 1) << shift) - 1;
+  }
+
+  void Record(uint64_t value) noexcept {
+    bucket_array_[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Add the records of 'other', e.g. to merge per thread shards.
+  void Merge(const Histogram& other) noexcept {
+    for (size_t ii = 0; ii < kBucketNum; ++ii) {
+      const uint64_t bucket_count = other.GetBucketCount(ii);
+      if (bucket_count != 0) bucket_array_[ii].fetch_add(bucket_count, std::memory_order_relaxed);
+    }
+    count_.fetch_add(other.GetCount(), std::memory_order_relaxed);
+    sum_.fetch_add(other.GetSum(), std::memory_order_relaxed);
+
+    const uint64_t value = other.GetMax();
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  uint64_t GetCount() const noexcept { return count_.load(std::memory_order_relaxed); }
+  uint64_t GetSum() const noexcept { return sum_.load(std::memory_order_relaxed); }
+  uint64_t GetMax() const noexcept { return max_.load(std::memory_order_relaxed); }
+  uint64_t GetBucketCount(size_t idx) const noexcept {
+    return bucket_array_[idx].load(std::memory_order_relaxed);
+  }
+
+  // Upper bound of the bucket holding the 'percentile' (0 to 100) value, capped by the max.
+  uint64_t GetPercentile(double percentile) const noexcept {
+    const uint64_t count = GetCount();
+    if (count == 0) return 0;
+
+    const auto rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (size_t ii = 0; ii < kBucketNum; ++ii) {
+      seen += GetBucketCount(ii);
+      if (seen > rank) return std::min(GetBucketUpperBound(ii), GetMax());
+    }
+    return GetMax();
+  }
+
+  void Reset() noexcept {
+    for (auto& bucket : bucket_array_) bucket.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  std::array<std::atomic_uint64_t, kBucketNum> bucket_array_{};
+  std::atomic_uint64_t count_ = 0;
+  std::atomic_uint64_t sum_ = 0;
+  std::atomic_uint64_t max_ = 0;
+};
+
+}  // namespace nxpilot::utils::common
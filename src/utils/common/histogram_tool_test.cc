@@ -0,0 +1,78 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utils/common/histogram_tool.h"
+
+namespace nxpilot::utils::common {
+
+TEST(HistogramToolTest, BucketIndex) {
+  for (uint64_t value : {uint64_t(0), uint64_t(7), uint64_t(8), uint64_t(15), uint64_t(16),
+                         uint64_t(17), uint64_t(1000), uint64_t(123456789), UINT64_MAX}) {
+    const size_t idx = Histogram::GetBucketIndex(value);
+    ASSERT_LT(idx, Histogram::kBucketNum);
+    EXPECT_LE(value, Histogram::GetBucketUpperBound(idx));
+    if (idx > 0) {
+      EXPECT_GT(value, Histogram::GetBucketUpperBound(idx - 1));
+    }
+  }
+  EXPECT_EQ(Histogram::GetBucketIndex(UINT64_MAX), Histogram::kBucketNum - 1);
+  EXPECT_EQ(Histogram::GetBucketUpperBound(Histogram::kBucketNum - 1), UINT64_MAX);
+}
+
+TEST(HistogramToolTest, Percentile) {
+  Histogram histogram;
+  EXPECT_EQ(histogram.GetPercentile(50), 0);
+
+  for (uint64_t ii = 1; ii <= 1000; ++ii) histogram.Record(ii * 1000);
+  EXPECT_EQ(histogram.GetCount(), 1000);
+  EXPECT_EQ(histogram.GetSum(), 500500000);
+  EXPECT_EQ(histogram.GetMax(), 1000000);
+  EXPECT_EQ(histogram.GetPercentile(100), 1000000);
+
+  // Within the bucket resolution.
+  const auto p50 = histogram.GetPercentile(50);
+  EXPECT_GE(p50, 500000);
+  EXPECT_LE(p50, 500000 + 500000 / Histogram::kSubBucketNum);
+  const auto p99 = histogram.GetPercentile(99);
+  EXPECT_GE(p99, 990000);
+  EXPECT_LE(p99, 1000000);
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.GetCount(), 0);
+  EXPECT_EQ(histogram.GetMax(), 0);
+}
+
+TEST(HistogramToolTest, Merge) {
+  Histogram histogram;
+  Histogram other;
+  for (uint64_t ii = 1; ii <= 100; ++ii) histogram.Record(ii);
+  for (uint64_t ii = 101; ii <= 200; ++ii) other.Record(ii);
+
+  histogram.Merge(other);
+  EXPECT_EQ(histogram.GetCount(), 200);
+  EXPECT_EQ(histogram.GetSum(), 20100);
+  EXPECT_EQ(histogram.GetMax(), 200);
+  EXPECT_GE(histogram.GetPercentile(50), 100);
+  EXPECT_LE(histogram.GetPercentile(50), 100 + 100 / Histogram::kSubBucketNum);
+  EXPECT_EQ(other.GetCount(), 100);
+}
+
+TEST(HistogramToolTest, MultipleThreadsRecord) {
+  Histogram histogram;
+  std::vector<std::thread> thread_vec;
+  for (uint64_t ii = 0; ii < 4; ++ii) {
+    thread_vec.emplace_back([&histogram, ii]() {
+      for (uint64_t jj = 0; jj < 10000; ++jj) histogram.Record(ii * 10000 + jj);
+    });
+  }
+  for (auto& thread : thread_vec) thread.join();
+
+  EXPECT_EQ(histogram.GetCount(), 40000);
+  EXPECT_EQ(histogram.GetMax(), 39999);
+}
+
+}  // namespace nxpilot::utils::common
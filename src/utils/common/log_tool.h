@@ -22,6 +22,16 @@ constexpr uint32_t kLogLevelWarn = 3;
 constexpr uint32_t kLogLevelError = 4;
 constexpr uint32_t kLogLevelFatal = 5;
 
+inline uint32_t GetLogLevelFromName(std::string_view lvl_name) {
+  static constexpr std::string_view kLvlNameArray[] = {"Trace", "Debug", "Info",
+                                                       "Warn",  "Error", "Fatal"};
+  for (uint32_t ii = 0; ii < sizeof(kLvlNameArray) / sizeof(kLvlNameArray[0]); ++ii) {
+    if (lvl_name == kLvlNameArray[ii]) return ii;
+  }
+  AIMRT_ASSERT(false, "Invalid log level '{}'", lvl_name);
+  return kLogLevelTrace;
+}
+
 class LogFormatter {
  public:
   static std::string Format(uint32_t lvl, uint32_t line, uint32_t column, const char* file_name,
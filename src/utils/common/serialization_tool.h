@@ -0,0 +1,52 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <concepts>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace nxpilot::utils::common {
+
+/**
+ * @brief Serialization customization point.
+ *
+ * Specialize this template for message types that need to cross a process boundary. Trivially
+ * copyable types and std::string are supported out of the box.
+ */
+template <typename T>
+struct SerializationTraits;
+
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+struct SerializationTraits<T> {
+  static void Serialize(const T& msg, std::string& buffer) {
+    buffer.append(reinterpret_cast<const char*>(&msg), sizeof(T));
+  }
+
+  static bool Deserialize(std::string_view buffer, T& msg) {
+    if (buffer.size() != sizeof(T)) return false;
+    std::memcpy(&msg, buffer.data(), sizeof(T));
+    return true;
+  }
+};
+
+template <>
+struct SerializationTraits<std::string> {
+  static void Serialize(const std::string& msg, std::string& buffer) { buffer.append(msg); }
+
+  static bool Deserialize(std::string_view buffer, std::string& msg) {
+    msg.assign(buffer);
+    return true;
+  }
+};
+
+template <typename T>
+concept Serializable = requires(const T& msg, T& out, std::string& buffer, std::string_view view) {
+  { SerializationTraits<T>::Serialize(msg, buffer) };
+  { SerializationTraits<T>::Deserialize(view, out) } -> std::convertible_to<bool>;
+};
+
+}  // namespace nxpilot::utils::common
@@ -3,6 +3,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace nxpilot::utils::common {
 
@@ -15,4 +17,17 @@ struct StringHash {
   std::size_t operator()(std::string const& str) const { return hash_type{}(str); }
 };
 
+// Split 'str' by 'sep', empty parts are skipped.
+inline std::vector<std::string> SplitToVec(std::string_view str, char sep) {
+  std::vector<std::string> result;
+  size_t pos = 0;
+  while (pos <= str.size()) {
+    auto end = str.find(sep, pos);
+    if (end == std::string_view::npos) end = str.size();
+    if (end > pos) result.emplace_back(str.substr(pos, end - pos));
+    pos = end + 1;
+  }
+  return result;
+}
+
 }  // namespace nxpilot::utils::common
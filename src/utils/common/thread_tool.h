@@ -2,7 +2,18 @@
 
 #pragma once
 
+#include <alloca.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <cstdint>
 #include <cstdlib>
+#include <mutex>
 #include <string_view>
 #include <vector>
 
@@ -21,7 +32,8 @@ inline void SetNameForCurrentThread(std::string_view thread_name) {
   }
 }
 
-inline void BindCpuForCurrentThread(const std::vector<uint32_t>& cpu_set) {
+// Work on any thread of this process, e.g. to change the placement of a running executor thread.
+inline void BindCpuForThread(pthread_t thread, const std::vector<uint32_t>& cpu_set) {
   if (cpu_set.empty()) {
     return;
   }
@@ -38,21 +50,57 @@ inline void BindCpuForCurrentThread(const std::vector<uint32_t>& cpu_set) {
     CPU_SET(cpu_idx, &cpuset);
   }
 
-  auto ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+  auto ret = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
   AIMRT_ASSERT(ret == 0, "Call 'pthread_setaffinity_np' get error, ret code '{}'", ret);
 }
 
-inline void SetCpuSchedForCurrentThread(std::string_view sched) {
+// Not exported by glibc, see 'include/uapi/linux/sched.h' and 'sched_setattr(2)'.
+inline constexpr uint32_t kSchedDeadline = 6;
+
+struct SchedDeadlineParam {
+  uint64_t runtime_ns = 0;
+  uint64_t deadline_ns = 0;
+  uint64_t period_ns = 0;
+};
+
+// sched format: SCHED_DEADLINE:<runtime_us>/<deadline_us>/<period_us>
+inline SchedDeadlineParam ParseSchedDeadline(std::string_view sched) {
+  constexpr std::string_view kPrefix = "SCHED_DEADLINE:";
+  AIMRT_ASSERT(sched.starts_with(kPrefix), "Invalid sched parm '{}'", sched);
+
+  uint64_t value_us[3] = {0, 0, 0};
+  auto param_str = sched.substr(kPrefix.size());
+  const char* begin = param_str.data();
+  const char* end = param_str.data() + param_str.size();
+  for (size_t ii = 0; ii < 3; ++ii) {
+    auto ret = std::from_chars(begin, end, value_us[ii]);
+    bool valid = ret.ec == std::errc() &&
+                 (ii == 2 ? ret.ptr == end : (ret.ptr != end && *ret.ptr == '/'));
+    AIMRT_ASSERT(valid, "Invalid sched parm '{}'", sched);
+    begin = ret.ptr + 1;
+  }
+  AIMRT_ASSERT(value_us[0] > 0 && value_us[0] <= value_us[1] && value_us[1] <= value_us[2],
+               "Invalid sched parm '{}', required 0 < runtime <= deadline <= period", sched);
+
+  return SchedDeadlineParam{.runtime_ns = value_us[0] * 1000,
+                            .deadline_ns = value_us[1] * 1000,
+                            .period_ns = value_us[2] * 1000};
+}
+
+inline void SetCpuSchedForThread(pthread_t thread, std::string_view sched) {
   if (sched.empty()) {
     return;
   }
 
+  AIMRT_ASSERT(!sched.starts_with("SCHED_DEADLINE"),
+               "SCHED_DEADLINE can only be set by the thread itself");
+
   if (sched == "SCHED_OTHER") {
     // sched format: SCHED_OTHER
     struct sched_param param {
       .sched_priority = 0
     };
-    int ret = pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    int ret = pthread_setschedparam(thread, SCHED_OTHER, &param);
     AIMRT_ASSERT(ret == 0, "Call 'pthread_setschedparam' get error, ret code '{}'", ret);
   } else {
     // sched format: SCHED_FIFO:10 or SCHED_RR:10
@@ -82,9 +130,123 @@ inline void SetCpuSchedForCurrentThread(std::string_view sched) {
       .sched_priority = sched_priority
     };
 
-    int ret = pthread_setschedparam(pthread_self(), policy, &param);
+    int ret = pthread_setschedparam(thread, policy, &param);
     AIMRT_ASSERT(ret == 0, "Call 'pthread_setschedparam' get error, ret code '{}'", ret);
   }
 }
 
+inline void BindCpuForCurrentThread(const std::vector<uint32_t>& cpu_set) {
+  BindCpuForThread(pthread_self(), cpu_set);
+}
+
+// Besides the formats of 'SetCpuSchedForThread', accept
+// 'SCHED_DEADLINE:<runtime_us>/<deadline_us>/<period_us>'. The kernel refuses SCHED_DEADLINE for
+// threads with a restricted cpu affinity, use an exclusive cpuset to place them.
+inline void SetCpuSchedForCurrentThread(std::string_view sched) {
+  if (!sched.starts_with("SCHED_DEADLINE")) {
+    SetCpuSchedForThread(pthread_self(), sched);
+    return;
+  }
+
+  auto param = ParseSchedDeadline(sched);
+  struct {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+  } attr{.size = sizeof(attr),
+         .sched_policy = kSchedDeadline,
+         .sched_flags = 0,
+         .sched_nice = 0,
+         .sched_priority = 0,
+         .sched_runtime = param.runtime_ns,
+         .sched_deadline = param.deadline_ns,
+         .sched_period = param.period_ns};
+
+  auto ret = syscall(SYS_sched_setattr, 0, &attr, 0);
+  AIMRT_ASSERT(ret == 0, "Call 'sched_setattr' get error, errno '{}'", errno);
+}
+
+// Lock all current and future pages of the process in memory, so real-time threads do not take
+// page faults on first touch or after swap out. Process wide and idempotent.
+inline void LockMemoryForProcess() {
+  AIMRT_ASSERT(mlockall(MCL_CURRENT | MCL_FUTURE) == 0, "Call 'mlockall' get error, errno '{}'",
+               errno);
+}
+
+// Stack kept out of 'PrefaultStackForCurrentThread', for the frames below it and the guard page.
+constexpr size_t kStackPrefaultMargin = 256 * 1024;
+
+// The largest size 'PrefaultStackForCurrentThread' accepts: the default stack size of new threads
+// minus 'kStackPrefaultMargin', 0 if the stack is not larger than the margin.
+inline size_t GetMaxStackPrefaultSize() {
+  pthread_attr_t attr;
+  size_t stack_size = 0;
+  if (pthread_attr_init(&attr) == 0) {
+    pthread_attr_getstacksize(&attr, &stack_size);
+    pthread_attr_destroy(&attr);
+  }
+  return stack_size > kStackPrefaultMargin ? stack_size - kStackPrefaultMargin : 0;
+}
+
+// Touch 'size' bytes of the current stack so the pages are mapped before the thread runs its hot
+// path. Not inlined, the stack frame is released on return while the pages stay mapped. Throw if
+// 'size' exceeds 'GetMaxStackPrefaultSize', 'alloca' would overflow the stack.
+[[gnu::noinline]] inline void PrefaultStackForCurrentThread(size_t size) {
+  constexpr size_t kPageSize = 4096;
+  const size_t max_size = GetMaxStackPrefaultSize();
+  AIMRT_ASSERT(size <= max_size, "Stack prefault size {} exceeds the limit {}", size, max_size);
+  volatile char* buf = static_cast<volatile char*>(alloca(size));
+  for (size_t ii = 0; ii < size; ii += kPageSize) buf[ii] = 0;
+}
+
+// The kernel may delay timer wake ups of the thread by up to 'slack_ns', 50us by default.
+inline void SetTimerSlackForCurrentThread(uint64_t slack_ns) {
+  AIMRT_ASSERT(prctl(PR_SET_TIMERSLACK, slack_ns, 0, 0, 0) == 0,
+               "Call 'prctl(PR_SET_TIMERSLACK)' get error, errno '{}'", errno);
+}
+
+// Keep cpu idle states with a wake up latency above 'latency_us' off, through the pm_qos interface
+// '/dev/cpu_dma_latency'. Process wide: the request holds while the file stays open, so it is
+// kept until exit, and the lowest latency asked for wins.
+inline void RequestCpuDmaLatency(int32_t latency_us) {
+  static std::mutex mutex;
+  static int fd = -1;
+  static int32_t cur_latency_us = INT32_MAX;
+
+  std::lock_guard<std::mutex> lck(mutex);
+  if (latency_us >= cur_latency_us) return;
+
+  if (fd < 0) {
+    fd = open("/dev/cpu_dma_latency", O_WRONLY | O_CLOEXEC);
+    AIMRT_ASSERT(fd >= 0, "Open '/dev/cpu_dma_latency' get error, errno '{}'", errno);
+  }
+  AIMRT_ASSERT(write(fd, &latency_us, sizeof(latency_us)) == sizeof(latency_us),
+               "Write '/dev/cpu_dma_latency' get error, errno '{}'", errno);
+  cur_latency_us = latency_us;
+}
+
+struct ThreadHardeningOptions {
+  bool lock_memory = false;
+  uint32_t prefault_stack_kb = 0;
+  uint64_t timer_slack_ns = 0;      // 0 keeps the kernel default
+  int32_t cpu_dma_latency_us = -1;  // negative keeps the kernel default
+
+  bool operator==(const ThreadHardeningOptions&) const = default;
+};
+
+// Call from the thread itself at startup, next to 'SetCpuSchedForCurrentThread'.
+inline void ApplyHardeningForCurrentThread(const ThreadHardeningOptions& options) {
+  if (options.lock_memory) LockMemoryForProcess();
+  if (options.prefault_stack_kb > 0) {
+    PrefaultStackForCurrentThread(options.prefault_stack_kb * 1024);
+  }
+  if (options.timer_slack_ns > 0) SetTimerSlackForCurrentThread(options.timer_slack_ns);
+  if (options.cpu_dma_latency_us >= 0) RequestCpuDmaLatency(options.cpu_dma_latency_us);
+}
+
 }  // namespace nxpilot::utils::common
@@ -1,6 +1,9 @@
 // Copyright (C) 2024. All rights reserved.
 
+#include <sys/prctl.h>
+
 #include <string>
+#include <thread>
 
 #include "gtest/gtest.h"
 
@@ -68,4 +71,31 @@ TEST(ThreadToolTest, SetCpuSchedForCurrentThread) {
                nxpilot::utils::common::NxpilotException);
 }
 
-}  // namespace nxpilot::utils::common
\ No newline at end of file
+TEST(ThreadToolTest, ParseSchedDeadline) {
+  auto param = ParseSchedDeadline("SCHED_DEADLINE:200/500/1000");
+  EXPECT_EQ(param.runtime_ns, 200000);
+  EXPECT_EQ(param.deadline_ns, 500000);
+  EXPECT_EQ(param.period_ns, 1000000);
+
+  EXPECT_ANY_THROW(ParseSchedDeadline("SCHED_DEADLINE:200/500"));
+  EXPECT_ANY_THROW(ParseSchedDeadline("SCHED_DEADLINE:200/500/1000/"));
+  EXPECT_ANY_THROW(ParseSchedDeadline("SCHED_DEADLINE:600/500/1000"));
+  EXPECT_ANY_THROW(ParseSchedDeadline("SCHED_DEADLINE:a/b/c"));
+
+  // Only the thread itself can switch to SCHED_DEADLINE.
+  EXPECT_ANY_THROW(SetCpuSchedForThread(pthread_self(), "SCHED_DEADLINE:200/500/1000"));
+}
+
+TEST(ThreadToolTest, ApplyHardeningForCurrentThread) {
+  std::thread t([]() {
+    // The kernel ignores the timer slack of real-time threads, drop what earlier tests set.
+    SetCpuSchedForCurrentThread("SCHED_OTHER");
+    EXPECT_NO_THROW(ApplyHardeningForCurrentThread(
+        ThreadHardeningOptions{.prefault_stack_kb = 256, .timer_slack_ns = 1}));
+    EXPECT_EQ(prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0), 1);
+    EXPECT_ANY_THROW(PrefaultStackForCurrentThread(GetMaxStackPrefaultSize() + 4096));
+  });
+  t.join();
+}
+
+}  // namespace nxpilot::utils::common
@@ -0,0 +1,117 @@
+// Copyright (C) 2024. All rights reserved.
+
+#pragma once
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/common/exception.h"
+
+namespace nxpilot::utils::common {
+
+/**
+ * @brief A complete ('X') or thread instant ('i') event of the Chrome trace event format,
+ * viewable in chrome://tracing or Perfetto.
+ */
+struct TraceEvent {
+  std::string name;
+  std::string category;
+  uint64_t ts_us = 0;
+  uint64_t dur_us = 0;  // ignored by instant events
+  uint64_t tid = 0;
+  char phase = 'X';
+};
+
+/**
+ * @brief Escape a string for a JSON string literal
+ *
+ * @param str
+ * @return std::string escaped string, without the quotes
+ */
+inline std::string EscapeJsonString(std::string_view str) {
+  std::string result;
+  result.reserve(str.size());
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          result += std::format("\\u{:04x}", static_cast<uint32_t>(c));
+        } else {
+          result += c;
+        }
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Append one event as a JSON object to 'out'
+ *
+ * @param event
+ * @param pid process id shown in the trace viewer
+ * @param out
+ */
+inline void AppendTraceEventJson(const TraceEvent& event, uint32_t pid, std::string& out) {
+  if (event.phase == 'i') {
+    out += std::format(R"({{"name":"{}","cat":"{}","ph":"i","s":"t","ts":{},"pid":{},"tid":{}}})",
+                       EscapeJsonString(event.name), EscapeJsonString(event.category),
+                       event.ts_us, pid, event.tid);
+    return;
+  }
+
+  out += std::format(R"({{"name":"{}","cat":"{}","ph":"X","ts":{},"dur":{},"pid":{},"tid":{}}})",
+                     EscapeJsonString(event.name), EscapeJsonString(event.category), event.ts_us,
+                     event.dur_us, pid, event.tid);
+}
+
+/**
+ * @brief Serialize events into a Chrome trace JSON document
+ *
+ * @param event_vec
+ * @return std::string JSON document
+ */
+inline std::string ToChromeTraceJson(const std::vector<TraceEvent>& event_vec) {
+  const uint32_t pid = static_cast<uint32_t>(getpid());
+
+  std::string out = R"({"traceEvents":[)";
+  for (size_t ii = 0; ii < event_vec.size(); ++ii) {
+    if (ii != 0) out += ",\n";
+    AppendTraceEventJson(event_vec[ii], pid, out);
+  }
+  out += R"(],"displayTimeUnit":"ms"})";
+  return out;
+}
+
+/**
+ * @brief Write events into a Chrome trace JSON file, throw if the file can not be written
+ *
+ * @param file_path
+ * @param event_vec
+ */
+inline void WriteChromeTraceFile(const std::string& file_path,
+                                 const std::vector<TraceEvent>& event_vec) {
+  std::ofstream ofs(file_path, std::ios::trunc);
+  AIMRT_ASSERT(ofs.is_open(), "Can not open trace file '{}'", file_path);
+  ofs << ToChromeTraceJson(event_vec);
+  AIMRT_ASSERT(ofs.good(), "Write trace file '{}' failed", file_path);
+}
+
+}  // namespace nxpilot::utils::common
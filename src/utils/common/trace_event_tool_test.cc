@@ -0,0 +1,32 @@
+// Copyright (C) 2024. All rights reserved.
+
+#include "gtest/gtest.h"
+
+#include "utils/common/trace_event_tool.h"
+
+namespace nxpilot::utils::common {
+
+TEST(TraceEventToolTest, EscapeJsonString) {
+  EXPECT_EQ(EscapeJsonString("abc"), "abc");
+  EXPECT_EQ(EscapeJsonString("a\"b\\c"), "a\\\"b\\\\c");
+  EXPECT_EQ(EscapeJsonString("a\nb"), "a\\nb");
+  EXPECT_EQ(EscapeJsonString(std::string_view("\x01", 1)), "\\u0001");
+}
+
+TEST(TraceEventToolTest, ToChromeTraceJson) {
+  EXPECT_EQ(ToChromeTraceJson({}), R"({"traceEvents":[],"displayTimeUnit":"ms"})");
+
+  std::string json = ToChromeTraceJson(
+      {TraceEvent{.name = "init", .category = "stage", .ts_us = 10, .dur_us = 5, .tid = 7}});
+  EXPECT_NE(json.find(R"("name":"init","cat":"stage","ph":"X","ts":10,"dur":5)"),
+            std::string::npos);
+  EXPECT_NE(json.find(R"("tid":7)"), std::string::npos);
+
+  json = ToChromeTraceJson({TraceEvent{
+      .name = "submit", .category = "task", .ts_us = 3, .dur_us = 5, .tid = 7, .phase = 'i'}});
+  EXPECT_NE(json.find(R"("name":"submit","cat":"task","ph":"i","s":"t","ts":3,"pid")"),
+            std::string::npos);
+  EXPECT_EQ(json.find("dur"), std::string::npos);
+}
+
+}  // namespace nxpilot::utils::common